@@ -4,9 +4,11 @@
 
 #pragma once
 
+#include <algorithm>
 #include <array>
 #include <cstddef>
-#include <deque>
+#include <vector>
+#include <boost/serialization/access.hpp>
 #include "common/common_types.h"
 
 namespace AudioCore {
@@ -23,8 +25,93 @@ using StereoFrame16 = std::array<std::array<s16, 2>, samples_per_frame>;
 /// The DSP is quadraphonic internally.
 using QuadFrame32 = std::array<std::array<s32, 4>, samples_per_frame>;
 
-/// A variable length buffer of signed PCM16 stereo samples.
-using StereoBuffer16 = std::deque<std::array<s16, 2>>;
+/**
+ * A variable length buffer of signed PCM16 stereo samples. Samples are stored contiguously and
+ * consumed from the front by advancing an offset, so consuming them never moves the remaining
+ * samples. Room for a few samples is kept in front of the data so that interpolation history can
+ * be prepended without reallocating.
+ */
+class StereoBuffer16 {
+public:
+    using value_type = std::array<s16, 2>;
+
+    /// Number of samples that can be prepended to a freshly created buffer in place, enough for
+    /// the interpolation history
+    static constexpr std::size_t HEADROOM = 8;
+
+    StereoBuffer16() = default;
+    explicit StereoBuffer16(std::size_t size) : samples(HEADROOM + size), offset(HEADROOM) {}
+
+    [[nodiscard]] std::size_t size() const {
+        return samples.size() - offset;
+    }
+
+    [[nodiscard]] bool empty() const {
+        return size() == 0;
+    }
+
+    [[nodiscard]] value_type* data() {
+        return samples.data() + offset;
+    }
+
+    [[nodiscard]] const value_type* data() const {
+        return samples.data() + offset;
+    }
+
+    [[nodiscard]] value_type* begin() {
+        return data();
+    }
+
+    [[nodiscard]] const value_type* begin() const {
+        return data();
+    }
+
+    [[nodiscard]] value_type* end() {
+        return samples.data() + samples.size();
+    }
+
+    [[nodiscard]] const value_type* end() const {
+        return samples.data() + samples.size();
+    }
+
+    value_type& operator[](std::size_t index) {
+        return samples[offset + index];
+    }
+
+    const value_type& operator[](std::size_t index) const {
+        return samples[offset + index];
+    }
+
+    void clear() {
+        samples.clear();
+        offset = 0;
+    }
+
+    /// Inserts a sample in front of the buffer
+    void push_front(const value_type& sample) {
+        if (offset == 0) {
+            samples.insert(samples.begin(), HEADROOM, value_type{});
+            offset = HEADROOM;
+        }
+        samples[--offset] = sample;
+    }
+
+    /// Removes count samples from the front of the buffer
+    void erase_front(std::size_t count) {
+        offset += std::min(count, size());
+    }
+
+private:
+    std::vector<value_type> samples;
+    std::size_t offset = 0;
+
+    template <class Archive>
+    void serialize(Archive& ar, const unsigned int) {
+        ar& samples;
+        ar& offset;
+    }
+    friend class boost::serialization::access;
+};
 
 constexpr std::size_t num_dsp_pipe = 8;
 enum class DspPipe {
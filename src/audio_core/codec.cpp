@@ -28,6 +28,7 @@ StereoBuffer16 DecodeADPCM(const u8* const data, const std::size_t sample_count,
     const std::size_t ret_size =
         sample_count % 2 == 0 ? sample_count : sample_count + 1; // Ensure multiple of two.
     StereoBuffer16 ret(ret_size);
+    std::array<s16, 2>* const out = ret.data();
 
     int yn1 = state.yn1, yn2 = state.yn2;
 
@@ -58,18 +59,17 @@ StereoBuffer16 DecodeADPCM(const u8* const data, const std::size_t sample_count,
             return (s16)val;
         };
 
-        std::size_t outputi = framei * SAMPLES_PER_FRAME;
-        std::size_t datai = framei * FRAME_LEN + 1;
-        for (std::size_t i = 0; i < SAMPLES_PER_FRAME && outputi < sample_count; i += 2) {
-            const s16 sample1 = decode_sample(SIGNED_NIBBLES[data[datai] >> 4]);
-            ret[outputi].fill(sample1);
-            outputi++;
-
-            const s16 sample2 = decode_sample(SIGNED_NIBBLES[data[datai] & 0xF]);
-            ret[outputi].fill(sample2);
-            outputi++;
-
-            datai++;
+        // The filter feeds back on itself, so samples are decoded serially. Only the bounds of
+        // the last frame need checking.
+        const std::size_t outputi = framei * SAMPLES_PER_FRAME;
+        const std::size_t frame_samples = std::min(SAMPLES_PER_FRAME, sample_count - outputi);
+        const u8* const frame_data = data + framei * FRAME_LEN + 1;
+        for (std::size_t i = 0; i < frame_samples; i += 2) {
+            const u8 byte = frame_data[i / 2];
+            const s16 sample1 = decode_sample(SIGNED_NIBBLES[byte >> 4]);
+            const s16 sample2 = decode_sample(SIGNED_NIBBLES[byte & 0xF]);
+            out[outputi + i] = {sample1, sample1};
+            out[outputi + i + 1] = {sample2, sample2};
         }
     }
 
@@ -88,15 +88,17 @@ StereoBuffer16 DecodePCM8(const unsigned num_channels, const u8* const data,
     };
 
     StereoBuffer16 ret(sample_count);
+    std::array<s16, 2>* const out = ret.data();
 
+    // The output is contiguous, so these loops are vectorized by the compiler
     if (num_channels == 1) {
         for (std::size_t i = 0; i < sample_count; i++) {
-            ret[i].fill(decode_sample(data[i]));
+            const s16 sample = decode_sample(data[i]);
+            out[i] = {sample, sample};
         }
     } else {
         for (std::size_t i = 0; i < sample_count; i++) {
-            ret[i][0] = decode_sample(data[i * 2 + 0]);
-            ret[i][1] = decode_sample(data[i * 2 + 1]);
+            out[i] = {decode_sample(data[i * 2 + 0]), decode_sample(data[i * 2 + 1])};
         }
     }
 
@@ -108,17 +110,17 @@ StereoBuffer16 DecodePCM16(const unsigned num_channels, const u8* const data,
     ASSERT(num_channels == 1 || num_channels == 2);
 
     StereoBuffer16 ret(sample_count);
+    std::array<s16, 2>* const out = ret.data();
 
     if (num_channels == 1) {
         for (std::size_t i = 0; i < sample_count; i++) {
             s16 sample;
             std::memcpy(&sample, data + i * sizeof(s16), sizeof(s16));
-            ret[i].fill(sample);
+            out[i] = {sample, sample};
         }
     } else {
-        for (std::size_t i = 0; i < sample_count; ++i) {
-            std::memcpy(&ret[i], data + i * sizeof(s16) * 2, 2 * sizeof(s16));
-        }
+        // Interleaved stereo PCM16 already has the layout of the buffer
+        std::memcpy(out, data, sample_count * sizeof(std::array<s16, 2>));
     }
 
     return ret;
@@ -2,6 +2,7 @@
 // Licensed under GPLv2 or any later version
 // Refer to the license.txt file included.
 
+#include <algorithm>
 #include <cstddef>
 #include "audio_core/dsp_interface.h"
 #include "audio_core/sink.h"
@@ -38,11 +39,15 @@ void DspInterface::EnableStretching(bool enable) {
     perform_time_stretching = enable;
 }
 
+void DspInterface::SetLatency(u32 milliseconds) {
+    latency_ms = std::clamp(milliseconds, min_latency_ms, max_latency_ms);
+}
+
 void DspInterface::OutputFrame(StereoFrame16 frame) {
     if (!sink)
         return;
 
-    fifo.Push(frame.data(), frame.size());
+    PushSamples(frame.data(), frame.size());
 
     if (Core::System::GetInstance().VideoDumper().IsDumping()) {
         Core::System::GetInstance().VideoDumper().AddAudioFrame(std::move(frame));
@@ -53,19 +58,47 @@ void DspInterface::OutputSample(std::array<s16, 2> sample) {
     if (!sink)
         return;
 
-    fifo.Push(&sample, 1);
+    PushSamples(&sample, 1);
 
     if (Core::System::GetInstance().VideoDumper().IsDumping()) {
         Core::System::GetInstance().VideoDumper().AddAudioSample(std::move(sample));
     }
 }
 
+void DspInterface::PushSamples(const std::array<s16, 2>* samples, std::size_t count) {
+    // The time stretcher keeps its own backlog at the latency target, and the callback drains the
+    // fifo completely for it. Otherwise samples beyond the latency target are dropped.
+    std::size_t max_queued = fifo_capacity;
+    if (!perform_time_stretching) {
+        const std::size_t latency_frames =
+            static_cast<std::size_t>(latency_ms) * native_sample_rate / 1000;
+        max_queued = std::clamp<std::size_t>(latency_frames, samples_per_frame, fifo_capacity);
+    }
+
+    const std::size_t queued = fifo.Size();
+    const std::size_t space = max_queued > queued ? max_queued - queued : 0;
+    const std::size_t pushed = fifo.Push(samples, std::min(count, space));
+    samples_pushed = true;
+
+    auto& perf_stats = Core::System::GetInstance().perf_stats;
+    if (!perf_stats) {
+        return;
+    }
+
+    if (pushed < count) {
+        perf_stats->AddAudioOverrun();
+    }
+    if (pending_underruns.load(std::memory_order_relaxed) != 0) {
+        perf_stats->AddAudioUnderruns(pending_underruns.exchange(0));
+    }
+}
+
 void DspInterface::OutputCallback(s16* buffer, std::size_t num_frames) {
     std::size_t frames_written;
     if (perform_time_stretching) {
-        const std::vector<s16> in{fifo.Pop()};
-        const std::size_t num_in{in.size() / 2};
-        frames_written = time_stretcher.Process(in.data(), num_in, buffer, num_frames);
+        const std::size_t num_in = fifo.Pop(stretch_buffer.data(), fifo_capacity);
+        time_stretcher.SetLatency(latency_ms / 1000.0);
+        frames_written = time_stretcher.Process(stretch_buffer.data(), num_in, buffer, num_frames);
     } else if (flushing_time_stretcher) {
         time_stretcher.Flush();
         frames_written = time_stretcher.Process(nullptr, 0, buffer, num_frames);
@@ -79,6 +112,10 @@ void DspInterface::OutputCallback(s16* buffer, std::size_t num_frames) {
         std::memcpy(&last_frame[0], buffer + 2 * (frames_written - 1), 2 * sizeof(s16));
     }
 
+    if (frames_written < num_frames && samples_pushed.exchange(false)) {
+        pending_underruns.fetch_add(1, std::memory_order_relaxed);
+    }
+
     // Hold last emitted frame; this prevents popping.
     for (std::size_t i = frames_written; i < num_frames; i++) {
         std::memcpy(buffer + 2 * i, &last_frame[0], 2 * sizeof(s16));
@@ -4,6 +4,8 @@
 
 #pragma once
 
+#include <array>
+#include <atomic>
 #include <memory>
 #include <vector>
 #include <boost/serialization/access.hpp>
@@ -99,19 +101,38 @@ public:
     Sink& GetSink();
     /// Enable/Disable audio stretching.
     void EnableStretching(bool enable);
+    /// Sets the target latency of the audio output, in milliseconds. Out of range values are
+    /// clamped, a latency of zero would leave the time stretcher without any backlog to aim for.
+    void SetLatency(u32 milliseconds);
 
 protected:
     void OutputFrame(StereoFrame16 frame);
     void OutputSample(std::array<s16, 2> sample);
 
 private:
+    static constexpr std::size_t fifo_capacity = 0x2000;
+    /// Latency bounds: one audio frame (~5ms), and however much the fifo can hold (~250ms)
+    static constexpr u32 min_latency_ms =
+        (samples_per_frame * 1000 + native_sample_rate - 1) / native_sample_rate;
+    static constexpr u32 max_latency_ms = fifo_capacity * 1000 / native_sample_rate;
+
     void FlushResidualStretcherAudio();
+    void PushSamples(const std::array<s16, 2>* samples, std::size_t count);
     void OutputCallback(s16* buffer, std::size_t num_frames);
 
     std::atomic<bool> perform_time_stretching = false;
     std::atomic<bool> flushing_time_stretcher = false;
-    Common::RingBuffer<s16, 0x2000, 2> fifo;
+    std::atomic<u32> latency_ms = 125;
+    Common::RingBuffer<s16, fifo_capacity, 2> fifo;
     std::array<s16, 2> last_frame{};
+    /// Samples handed to the time stretcher, kept here so that the callback doesn't allocate
+    std::array<s16, fifo_capacity * 2> stretch_buffer{};
+
+    /// Set when samples are pushed, and cleared when the sink runs out of them. This counts one
+    /// underrun per gap in the output rather than every callback while emulation is paused.
+    std::atomic<bool> samples_pushed = false;
+    /// Underruns seen by the sink callback that have not been reported to PerfStats yet
+    std::atomic<u32> pending_underruns = 0;
     TimeStretcher time_stretcher;
     std::unique_ptr<Sink> sink;
 
@@ -5,7 +5,6 @@
 #include <algorithm>
 #include <array>
 #include <cstddef>
-#include "audio_core/hle/common.h"
 #include "audio_core/hle/filter.h"
 #include "audio_core/hle/shared_memory.h"
 #include "common/common_types.h"
@@ -39,11 +38,11 @@ void SourceFilters::ProcessFrame(StereoFrame16& frame) {
         return;
 
     if (simple_filter_enabled) {
-        FilterFrame(frame, simple_filter);
+        simple_filter.ProcessFrame(frame);
     }
 
     if (biquad_filter_enabled) {
-        FilterFrame(frame, biquad_filter);
+        biquad_filter.ProcessFrame(frame);
     }
 }
 
@@ -63,16 +62,18 @@ void SourceFilters::SimpleFilter::Configure(
     b0 = config.b0;
 }
 
-std::array<s16, 2> SourceFilters::SimpleFilter::ProcessSample(const std::array<s16, 2>& x0) {
-    std::array<s16, 2> y0;
-    for (std::size_t i = 0; i < 2; i++) {
-        const s32 tmp = (b0 * x0[i] + a1 * y1[i]) >> 15;
-        y0[i] = std::clamp(tmp, -32768, 32767);
+void SourceFilters::SimpleFilter::ProcessFrame(StereoFrame16& frame) {
+    // Both channels are processed together, the recurrence is serial in time.
+    std::array<s32, 2> y = {y1[0], y1[1]};
+    for (auto& sample : frame) {
+        for (std::size_t i = 0; i < 2; i++) {
+            const s32 tmp = (b0 * sample[i] + a1 * y[i]) >> 15;
+            y[i] = std::clamp(tmp, -32768, 32767);
+            sample[i] = static_cast<s16>(y[i]);
+        }
     }
 
-    y1 = y0;
-
-    return y0;
+    y1 = {static_cast<s16>(y[0]), static_cast<s16>(y[1])};
 }
 
 // BiquadFilter
@@ -97,19 +98,43 @@ void SourceFilters::BiquadFilter::Configure(
     b2 = config.b2;
 }
 
-std::array<s16, 2> SourceFilters::BiquadFilter::ProcessSample(const std::array<s16, 2>& x0) {
-    std::array<s16, 2> y0;
-    for (std::size_t i = 0; i < 2; i++) {
-        const s32 tmp = (b0 * x0[i] + b1 * x1[i] + b2 * x2[i] + a1 * y1[i] + a2 * y2[i]) >> 14;
-        y0[i] = std::clamp(tmp, -32768, 32767);
+void SourceFilters::BiquadFilter::ProcessFrame(StereoFrame16& frame) {
+    constexpr std::size_t num_values = samples_per_frame * 2;
+
+    // The input history is prepended so that the feedforward terms, which only depend on the
+    // input, can be computed for the whole frame in a single loop that vectorizes.
+    std::array<s32, num_values + 4> x;
+    x[0] = x2[0];
+    x[1] = x2[1];
+    x[2] = x1[0];
+    x[3] = x1[1];
+    const s16* input = frame[0].data();
+    for (std::size_t i = 0; i < num_values; i++) {
+        x[i + 4] = input[i];
+    }
+
+    std::array<s32, num_values> feedforward;
+    for (std::size_t i = 0; i < num_values; i++) {
+        feedforward[i] = b0 * x[i + 4] + b1 * x[i + 2] + b2 * x[i];
     }
 
-    x2 = x1;
-    x1 = x0;
-    y2 = y1;
-    y1 = y0;
+    x2 = frame[samples_per_frame - 2];
+    x1 = frame[samples_per_frame - 1];
+
+    // Only the feedback terms are left in the recurrence, which is serial in time.
+    std::array<s32, 2> y_1 = {y1[0], y1[1]};
+    std::array<s32, 2> y_2 = {y2[0], y2[1]};
+    for (std::size_t samplei = 0; samplei < samples_per_frame; samplei++) {
+        for (std::size_t i = 0; i < 2; i++) {
+            const s32 tmp = (feedforward[samplei * 2 + i] + a1 * y_1[i] + a2 * y_2[i]) >> 14;
+            y_2[i] = y_1[i];
+            y_1[i] = std::clamp(tmp, -32768, 32767);
+            frame[samplei][i] = static_cast<s16>(y_1[i]);
+        }
+    }
 
-    return y0;
+    y2 = {static_cast<s16>(y_2[0]), static_cast<s16>(y_2[1])};
+    y1 = {static_cast<s16>(y_1[0]), static_cast<s16>(y_1[1])};
 }
 
 } // namespace AudioCore::HLE
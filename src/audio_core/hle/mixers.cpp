@@ -88,28 +88,39 @@ static s16 ClampToS16(s32 value) {
     return static_cast<s16>(std::clamp(value, -32768, 32767));
 }
 
-static std::array<s16, 2> AddAndClampToS16(const std::array<s16, 2>& a,
-                                           const std::array<s16, 2>& b) {
-    return {ClampToS16(static_cast<s32>(a[0]) + static_cast<s32>(b[0])),
-            ClampToS16(static_cast<s32>(a[1]) + static_cast<s32>(b[1]))};
+/**
+ * Downmixes a quadraphonic frame and accumulates it into a stereo frame. The loop is kept free of
+ * format dispatch and per-sample function objects so that it vectorizes. The gain is applied to
+ * each channel before summing, the rounding of the output depends on this order.
+ */
+template <DspConfiguration::OutputFormat output_format>
+static void DownmixAndMix(float gain, const QuadFrame32& samples, StereoFrame16& frame) {
+    for (std::size_t i = 0; i < samples_per_frame; i++) {
+        const s32* sample = samples[i].data();
+        s32 left, right;
+        if constexpr (output_format == DspConfiguration::OutputFormat::Mono) {
+            left = right = ClampToS16(static_cast<s32>(
+                (gain * sample[0] + gain * sample[1] + gain * sample[2] + gain * sample[3]) / 2));
+        } else {
+            left = ClampToS16(static_cast<s32>(gain * sample[0] + gain * sample[2]));
+            right = ClampToS16(static_cast<s32>(gain * sample[1] + gain * sample[3]));
+        }
+        frame[i][0] = ClampToS16(frame[i][0] + left);
+        frame[i][1] = ClampToS16(frame[i][1] + right);
+    }
 }
 
 void Mixers::DownmixAndMixIntoCurrentFrame(float gain, const QuadFrame32& samples) {
     // TODO(merry): Limiter. (Currently we're performing final mixing assuming a disabled limiter.)
 
+    // A muted mix contributes zero to every sample, and adding zero never saturates.
+    if (gain == 0.0f) {
+        return;
+    }
+
     switch (state.output_format) {
     case OutputFormat::Mono:
-        std::transform(
-            current_frame.begin(), current_frame.end(), samples.begin(), current_frame.begin(),
-            [gain](const std::array<s16, 2>& accumulator,
-                   const std::array<s32, 4>& sample) -> std::array<s16, 2> {
-                // Downmix to mono
-                s16 mono = ClampToS16(static_cast<s32>(
-                    (gain * sample[0] + gain * sample[1] + gain * sample[2] + gain * sample[3]) /
-                    2));
-                // Mix into current frame
-                return AddAndClampToS16(accumulator, {mono, mono});
-            });
+        DownmixAndMix<OutputFormat::Mono>(gain, samples, current_frame);
         return;
 
     case OutputFormat::Surround:
@@ -117,16 +128,7 @@ void Mixers::DownmixAndMixIntoCurrentFrame(float gain, const QuadFrame32& sample
         // fallthrough
 
     case OutputFormat::Stereo:
-        std::transform(
-            current_frame.begin(), current_frame.end(), samples.begin(), current_frame.begin(),
-            [gain](const std::array<s16, 2>& accumulator,
-                   const std::array<s32, 4>& sample) -> std::array<s16, 2> {
-                // Downmix to stereo
-                s16 left = ClampToS16(static_cast<s32>(gain * sample[0] + gain * sample[2]));
-                s16 right = ClampToS16(static_cast<s32>(gain * sample[1] + gain * sample[3]));
-                // Mix into current frame
-                return AddAndClampToS16(accumulator, {left, right});
-            });
+        DownmixAndMix<OutputFormat::Stereo>(gain, samples, current_frame);
         return;
     }
 
@@ -11,6 +11,7 @@
 #include "common/assert.h"
 #include "common/logging/log.h"
 #include "core/memory.h"
+#include "core/settings.h"
 
 namespace AudioCore::HLE {
 
@@ -30,12 +31,17 @@ void Source::MixInto(QuadFrame32& dest, std::size_t intermediate_mix_id) const {
         return;
 
     const std::array<float, 4>& gains = state.gain.at(intermediate_mix_id);
+
+    // Most sources only feed one of the intermediate mixes, the others have all gains set to zero.
+    if (std::all_of(gains.begin(), gains.end(), [](float gain) { return gain == 0.0f; }))
+        return;
+
     for (std::size_t samplei = 0; samplei < samples_per_frame; samplei++) {
         // Conversion from stereo (current_frame) to quadraphonic (dest) occurs here.
-        dest[samplei][0] += static_cast<s32>(gains[0] * current_frame[samplei][0]);
-        dest[samplei][1] += static_cast<s32>(gains[1] * current_frame[samplei][1]);
-        dest[samplei][2] += static_cast<s32>(gains[2] * current_frame[samplei][0]);
-        dest[samplei][3] += static_cast<s32>(gains[3] * current_frame[samplei][1]);
+        for (std::size_t channel = 0; channel < 4; channel++) {
+            dest[samplei][channel] +=
+                static_cast<s32>(gains[channel] * current_frame[samplei][channel % 2]);
+        }
     }
 }
 
@@ -224,9 +230,7 @@ void Source::ParseConfig(SourceConfiguration::Configuration& config,
                 if (state.current_buffer.size() < state.current_sample_number) {
                     state.current_sample_number = 0;
                 } else {
-                    state.current_buffer.erase(
-                        state.current_buffer.begin(),
-                        std::next(state.current_buffer.begin(), state.current_sample_number));
+                    state.current_buffer.erase_front(state.current_sample_number);
                 }
             }
         }
@@ -344,9 +348,14 @@ void Source::GenerateFrame() {
                                 current_frame, frame_position);
             break;
         case InterpolationMode::Polyphase:
-            // TODO(merry): Implement polyphase interpolation
-            AudioInterp::Linear(state.interp_state, state.current_buffer, state.rate_multiplier,
-                                current_frame, frame_position);
+            // The sinc filter is opt-in as it isn't hardware verified
+            if (Settings::values.enable_polyphase_filter) {
+                AudioInterp::Polyphase(state.interp_state, state.current_buffer,
+                                       state.rate_multiplier, current_frame, frame_position);
+            } else {
+                AudioInterp::Linear(state.interp_state, state.current_buffer,
+                                    state.rate_multiplier, current_frame, frame_position);
+            }
             break;
         default:
             UNIMPLEMENTED();
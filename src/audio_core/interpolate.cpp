@@ -3,6 +3,11 @@
 // Refer to the license.txt file included.
 
 #include <algorithm>
+#include <cmath>
+#include <numbers>
+#ifdef ARCHITECTURE_x86_64
+#include <emmintrin.h>
+#endif
 #include "audio_core/interpolate.h"
 #include "common/assert.h"
 
@@ -14,7 +19,8 @@ constexpr u64 scale_factor = 1 << 24;
 constexpr u64 scale_mask = scale_factor - 1;
 
 /// Here we step over the input in steps of rate, until we consume all of the input.
-/// Three adjacent samples are passed to fn each step.
+/// fn is passed a pointer to the current sample x[0] each step. The history before it can be read
+/// at negative indices, down to x[2 - history_size], and the samples x[1] and x[2] are available.
 template <typename Function>
 static void StepOverSamples(State& state, StereoBuffer16& input, float rate, StereoFrame16& output,
                             std::size_t& outputi, Function fn) {
@@ -23,54 +29,196 @@ static void StepOverSamples(State& state, StereoBuffer16& input, float rate, Ste
     if (input.empty())
         return;
 
-    input.insert(input.begin(), {state.xn2, state.xn1});
+    for (auto it = state.history.rbegin(); it != state.history.rend(); ++it) {
+        input.push_front(*it);
+    }
 
     const u64 step_size = static_cast<u64>(rate * scale_factor);
-    u64 fposition = state.fposition;
-    std::size_t inputi = 0;
-
-    while (outputi < output.size()) {
-        inputi = static_cast<std::size_t>(fposition / scale_factor);
-
-        if (inputi + 2 >= input.size()) {
-            inputi = input.size() - 2;
-            break;
-        }
-
-        u64 fraction = fposition & scale_mask;
-        output[outputi++] = fn(fraction, input[inputi], input[inputi + 1], input[inputi + 2]);
+    const u64 fposition = state.fposition;
+
+    // Work out upfront how many samples can be produced before the input runs out, which keeps
+    // the loop below free of exit conditions so that it can be vectorized.
+    const u64 end_position = (input.size() - history_size) * scale_factor;
+    const std::size_t output_left = output.size() - outputi;
+    std::size_t count = output_left;
+    if (fposition >= end_position) {
+        count = 0;
+    } else if (step_size != 0) {
+        const u64 steps_left = (end_position - fposition + step_size - 1) / step_size;
+        count = static_cast<std::size_t>(std::min<u64>(count, steps_left));
+    }
 
-        fposition += step_size;
+    const std::array<s16, 2>* samples = input.data() + history_size - 2;
+    std::array<s16, 2>* out = output.data() + outputi;
+    for (std::size_t i = 0; i < count; i++) {
+        const u64 position = fposition + i * step_size;
+        const std::size_t inputi = static_cast<std::size_t>(position / scale_factor);
+        out[i] = fn(position & scale_mask, samples + inputi);
+    }
+    outputi += count;
+
+    // The history is taken from the last sample used, or from the end if the input ran out
+    std::size_t inputi = input.size() - history_size;
+    if (count == output_left) {
+        inputi = count == 0 ? 0
+                            : static_cast<std::size_t>((fposition + (count - 1) * step_size) /
+                                                       scale_factor);
     }
 
-    state.xn2 = input[inputi];
-    state.xn1 = input[inputi + 1];
-    state.fposition = fposition - inputi * scale_factor;
+    std::copy_n(input.data() + inputi, history_size, state.history.begin());
+    state.fposition = fposition + count * step_size - inputi * scale_factor;
 
-    input.erase(input.begin(), std::next(input.begin(), inputi + 2));
+    input.erase_front(inputi + history_size);
 }
 
 void None(State& state, StereoBuffer16& input, float rate, StereoFrame16& output,
           std::size_t& outputi) {
-    StepOverSamples(
-        state, input, rate, output, outputi,
-        [](u64 fraction, const auto& x0, const auto& x1, const auto& x2) { return x0; });
+    StepOverSamples(state, input, rate, output, outputi,
+                    [](u64 fraction, const std::array<s16, 2>* x) { return x[0]; });
 }
 
 void Linear(State& state, StereoBuffer16& input, float rate, StereoFrame16& output,
             std::size_t& outputi) {
     // Note on accuracy: Some values that this produces are +/- 1 from the actual firmware.
     StepOverSamples(state, input, rate, output, outputi,
-                    [](u64 fraction, const auto& x0, const auto& x1, const auto& x2) {
+                    [](u64 fraction, const std::array<s16, 2>* x) {
                         // This is a saturated subtraction. (Verified by black-box fuzzing.)
-                        s64 delta0 = std::clamp<s64>(x1[0] - x0[0], -32768, 32767);
-                        s64 delta1 = std::clamp<s64>(x1[1] - x0[1], -32768, 32767);
+                        s64 delta0 = std::clamp<s64>(x[1][0] - x[0][0], -32768, 32767);
+                        s64 delta1 = std::clamp<s64>(x[1][1] - x[0][1], -32768, 32767);
 
                         return std::array<s16, 2>{
-                            static_cast<s16>(x0[0] + fraction * delta0 / scale_factor),
-                            static_cast<s16>(x0[1] + fraction * delta1 / scale_factor),
+                            static_cast<s16>(x[0][0] + fraction * delta0 / scale_factor),
+                            static_cast<s16>(x[0][1] + fraction * delta1 / scale_factor),
                         };
                     });
 }
 
+// The polyphase filter reads the whole history and x[0] to x[2], and interpolates between x[-2]
+// and x[-1], which is two samples later than the other modes.
+constexpr std::size_t polyphase_taps = history_size + 1;
+constexpr std::size_t polyphase_center_tap = polyphase_taps / 2 - 1;
+constexpr u64 polyphase_phase_bits = 7;
+constexpr std::size_t polyphase_phases = 1 << polyphase_phase_bits;
+constexpr int polyphase_coeff_bits = 14;
+
+/// Filter coefficients of one phase. Each channel has its own set of weights for the interleaved
+/// stereo taps, with zeros at the other channel. This turns each channel into a plain dot product
+/// over contiguous 16-bit values, which maps onto multiply-add instructions.
+struct alignas(16) PolyphaseCoefficients {
+    std::array<s16, polyphase_taps * 2> left;
+    std::array<s16, polyphase_taps * 2> right;
+};
+
+using PolyphaseTable = std::array<PolyphaseCoefficients, polyphase_phases>;
+
+/// Generates a Blackman windowed sinc filter with the given cutoff, relative to the input Nyquist
+/// frequency. The coefficients of each phase sum up to exactly one.
+static PolyphaseTable GeneratePolyphaseTable(double cutoff) {
+    constexpr double pi = std::numbers::pi;
+    constexpr s32 one = 1 << polyphase_coeff_bits;
+
+    PolyphaseTable table{};
+    for (std::size_t phase = 0; phase < polyphase_phases; phase++) {
+        const double fraction = static_cast<double>(phase) / polyphase_phases;
+
+        std::array<double, polyphase_taps> coeffs;
+        double sum = 0.0;
+        for (std::size_t tap = 0; tap < polyphase_taps; tap++) {
+            const double t = static_cast<double>(tap) - polyphase_center_tap - fraction;
+            const double sinc = t == 0.0 ? 1.0 : std::sin(pi * cutoff * t) / (pi * cutoff * t);
+            const double w = (t + polyphase_taps / 2) / polyphase_taps;
+            const double window = 0.42 - 0.5 * std::cos(2 * pi * w) + 0.08 * std::cos(4 * pi * w);
+            coeffs[tap] = sinc * window;
+            sum += coeffs[tap];
+        }
+
+        s32 total = 0;
+        for (std::size_t tap = 0; tap < polyphase_taps; tap++) {
+            const s32 coeff = static_cast<s32>(std::lround(coeffs[tap] / sum * one));
+            table[phase].left[tap * 2] = table[phase].right[tap * 2 + 1] = static_cast<s16>(coeff);
+            total += coeff;
+        }
+
+        // Rounding error goes to the tap closest to the output position
+        const std::size_t nearest = polyphase_center_tap + (fraction > 0.5 ? 1 : 0);
+        table[phase].left[nearest * 2] += static_cast<s16>(one - total);
+        table[phase].right[nearest * 2 + 1] += static_cast<s16>(one - total);
+    }
+    return table;
+}
+
+/// Picks the filter for the given rate. Decimation needs a lower cutoff to avoid aliasing, and
+/// there are tables for a few rate ranges rather than one per rate.
+static const PolyphaseTable& GetPolyphaseTable(float rate) {
+    static const std::array<PolyphaseTable, 4> tables = {
+        GeneratePolyphaseTable(1.0),
+        GeneratePolyphaseTable(0.75),
+        GeneratePolyphaseTable(0.5),
+        GeneratePolyphaseTable(0.33),
+    };
+
+    if (rate <= 1.0f) {
+        return tables[0];
+    } else if (rate <= 4.0f / 3.0f) {
+        return tables[1];
+    } else if (rate <= 2.0f) {
+        return tables[2];
+    }
+    return tables[3];
+}
+
+/// Applies one phase of the filter to 8 interleaved stereo samples
+static std::array<s16, 2> ApplyPolyphaseFilter(const PolyphaseCoefficients& coeffs,
+                                               const s16* taps) {
+    constexpr s32 round = 1 << (polyphase_coeff_bits - 1);
+
+#ifdef ARCHITECTURE_x86_64
+    // Compilers don't reliably turn the reductions below into multiply-adds once the loops have
+    // been unrolled, so this is done by hand. SSE2 is always available on x86-64.
+    const __m128i taps_lo = _mm_loadu_si128(reinterpret_cast<const __m128i*>(taps));
+    const __m128i taps_hi = _mm_loadu_si128(reinterpret_cast<const __m128i*>(taps + 8));
+    const auto* left = reinterpret_cast<const __m128i*>(coeffs.left.data());
+    const auto* right = reinterpret_cast<const __m128i*>(coeffs.right.data());
+    const __m128i sum_left = _mm_add_epi32(_mm_madd_epi16(taps_lo, _mm_load_si128(left)),
+                                           _mm_madd_epi16(taps_hi, _mm_load_si128(left + 1)));
+    const __m128i sum_right = _mm_add_epi32(_mm_madd_epi16(taps_lo, _mm_load_si128(right)),
+                                            _mm_madd_epi16(taps_hi, _mm_load_si128(right + 1)));
+
+    // Horizontal sums, leaving the left channel in the first lane and the right one in the second
+    __m128i sum = _mm_add_epi32(_mm_unpacklo_epi32(sum_left, sum_right),
+                                _mm_unpackhi_epi32(sum_left, sum_right));
+    sum = _mm_add_epi32(sum, _mm_srli_si128(sum, 8));
+    sum = _mm_srai_epi32(_mm_add_epi32(sum, _mm_set1_epi32(round)), polyphase_coeff_bits);
+
+    // Packing saturates to the s16 range
+    const u32 packed = static_cast<u32>(_mm_cvtsi128_si32(_mm_packs_epi32(sum, sum)));
+    return {static_cast<s16>(packed & 0xFFFF), static_cast<s16>(packed >> 16)};
+#else
+    s32 sum_left = 0;
+    for (std::size_t i = 0; i < polyphase_taps * 2; i++) {
+        sum_left += coeffs.left[i] * taps[i];
+    }
+    s32 sum_right = 0;
+    for (std::size_t i = 0; i < polyphase_taps * 2; i++) {
+        sum_right += coeffs.right[i] * taps[i];
+    }
+
+    return {
+        static_cast<s16>(std::clamp((sum_left + round) >> polyphase_coeff_bits, -32768, 32767)),
+        static_cast<s16>(std::clamp((sum_right + round) >> polyphase_coeff_bits, -32768, 32767)),
+    };
+#endif
+}
+
+void Polyphase(State& state, StereoBuffer16& input, float rate, StereoFrame16& output,
+               std::size_t& outputi) {
+    const PolyphaseTable& table = GetPolyphaseTable(rate);
+    StepOverSamples(state, input, rate, output, outputi,
+                    [&table](u64 fraction, const std::array<s16, 2>* x) {
+                        const std::array<s16, 2>* taps = x + 2 - history_size;
+                        return ApplyPolyphaseFilter(
+                            table[fraction >> (24 - polyphase_phase_bits)], taps->data());
+                    });
+}
+
 } // namespace AudioCore::AudioInterp
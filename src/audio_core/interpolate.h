@@ -5,19 +5,17 @@
 #pragma once
 
 #include <array>
-#include <deque>
 #include "audio_core/audio_types.h"
 #include "common/common_types.h"
 
 namespace AudioCore::AudioInterp {
 
-/// A variable length buffer of signed PCM16 stereo samples.
-using StereoBuffer16 = std::deque<std::array<s16, 2>>;
+/// Number of historical samples kept between calls, as needed by the widest filter.
+constexpr std::size_t history_size = 7;
 
 struct State {
-    /// Two historical samples.
-    std::array<s16, 2> xn1 = {}; ///< x[n-1]
-    std::array<s16, 2> xn2 = {}; ///< x[n-2]
+    /// Historical samples, oldest first. The last two are x[n-2] and x[n-1].
+    std::array<std::array<s16, 2>, history_size> history = {};
     /// Current fractional position.
     u64 fposition = 0;
 };
@@ -46,4 +44,17 @@ void None(State& state, StereoBuffer16& input, float rate, StereoFrame16& output
 void Linear(State& state, StereoBuffer16& input, float rate, StereoFrame16& output,
             std::size_t& outputi);
 
+/**
+ * Polyphase interpolation with an 8-tap windowed sinc filter. The cutoff of the filter is lowered
+ * when decimating to reduce aliasing. There is a four-sample predelay.
+ * @param state Interpolation state.
+ * @param input Input buffer.
+ * @param rate Stretch factor. Must be a positive non-zero value.
+ *             rate > 1.0 performs decimation and rate < 1.0 performs upsampling.
+ * @param output The resampled audio buffer.
+ * @param outputi The index of output to start writing to.
+ */
+void Polyphase(State& state, StereoBuffer16& input, float rate, StereoFrame16& output,
+               std::size_t& outputi);
+
 } // namespace AudioCore::AudioInterp
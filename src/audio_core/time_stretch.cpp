@@ -28,12 +28,16 @@ void TimeStretcher::SetOutputSampleRate(unsigned int sample_rate) {
     sample_rate = native_sample_rate;
 }
 
+void TimeStretcher::SetLatency(double seconds) {
+    latency = seconds;
+}
+
 std::size_t TimeStretcher::Process(const s16* in, std::size_t num_in, s16* out,
                                    std::size_t num_out) {
     const double time_delta = static_cast<double>(num_out) / sample_rate; // seconds
     double current_ratio = static_cast<double>(num_in) / static_cast<double>(num_out);
 
-    const double max_latency = 0.25; // seconds
+    const double max_latency = latency * 2; // seconds
     const double max_backlog = sample_rate * max_latency;
     const double backlog_fullness = sound_touch->numSamples() / max_backlog;
     if (backlog_fullness > 4.0) {
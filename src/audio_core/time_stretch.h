@@ -22,6 +22,9 @@ public:
 
     void SetOutputSampleRate(unsigned int sample_rate);
 
+    /// Sets the amount of audio the stretcher aims to keep buffered, in seconds
+    void SetLatency(double seconds);
+
     /// @param in       Input sample buffer
     /// @param num_in   Number of input frames in `in`
     /// @param out      Output sample buffer
@@ -37,6 +40,7 @@ private:
     unsigned int sample_rate;
     std::unique_ptr<soundtouch::SoundTouch> sound_touch;
     double stretch_ratio = 1.0;
+    double latency = 0.125;
 };
 
 } // namespace AudioCore
@@ -2,6 +2,7 @@
 // Licensed under GPLv2 or any later version
 // Refer to the license.txt file included.
 
+#include <chrono>
 #include <iostream>
 #include <memory>
 #include <regex>
@@ -31,7 +32,9 @@
 #include "common/scope_exit.h"
 #include "common/string_util.h"
 #include "core/core.h"
+#include "core/custom_tex_pack.h"
 #include "core/dumping/backend.h"
+#include "core/dumping/image_sequence_backend.h"
 #include "core/file_sys/cia_container.h"
 #include "core/frontend/applets/default_applets.h"
 #include "core/frontend/framebuffer_layout.h"
@@ -71,6 +74,10 @@ static void PrintHelp(const char* argv0) {
                  "-a, --movie-record-author=AUTHOR Sets the author of the movie to be recorded\n"
                  "-p, --movie-play=[file]    Playback the movie (game inputs) from the given file\n"
                  "-d, --dump-video=[file]    Dumps audio and video to the given video file\n"
+                 "--dump-frames=[dir]  Dumps video frames as PNG images and audio as WAV to dir\n"
+                 "--headless           Run without a window, frame limiting or audio output\n"
+                 "--frames=NUMBER      Exit after emulating NUMBER frames\n"
+                 "-t, --pack-textures=TITLEID Converts the custom textures of a title into a pack\n"
                  "-f, --fullscreen     Start in fullscreen mode\n"
                  "-h, --help           Display this help and exit\n"
                  "-v, --version        Output version information and exit\n";
@@ -198,6 +205,9 @@ int main(int argc, char** argv) {
     std::string movie_record_author;
     std::string movie_play;
     std::string dump_video;
+    std::string dump_frames;
+    bool headless = false;
+    u64 max_frames = 0;
 
     InitializeLogging();
 
@@ -228,6 +238,10 @@ int main(int argc, char** argv) {
         {"movie-record-author", required_argument, 0, 'a'},
         {"movie-play", required_argument, 0, 'p'},
         {"dump-video", required_argument, 0, 'd'},
+        {"dump-frames", required_argument, 0, 'D'},
+        {"headless", no_argument, 0, 'H'},
+        {"frames", required_argument, 0, 'N'},
+        {"pack-textures", required_argument, 0, 't'},
         {"fullscreen", no_argument, 0, 'f'},
         {"help", no_argument, 0, 'h'},
         {"version", no_argument, 0, 'v'},
@@ -235,7 +249,7 @@ int main(int argc, char** argv) {
     };
 
     while (optind < argc) {
-        int arg = getopt_long(argc, argv, "g:i:m:r:p:fhv", long_options, &option_index);
+        int arg = getopt_long(argc, argv, "g:i:m:r:p:t:fhv", long_options, &option_index);
         if (arg != -1) {
             switch (static_cast<char>(arg)) {
             case 'g':
@@ -304,6 +318,52 @@ int main(int argc, char** argv) {
             case 'd':
                 dump_video = optarg;
                 break;
+            case 'D':
+                dump_frames = optarg;
+                break;
+            case 'H':
+                headless = true;
+                break;
+            case 'N':
+                errno = 0;
+                max_frames = std::strtoull(optarg, &endarg, 0);
+                if (endarg == optarg)
+                    errno = EINVAL;
+                if (errno != 0) {
+                    perror("--frames");
+                    exit(1);
+                }
+                break;
+            case 't': {
+                errno = 0;
+                const u64 program_id = std::strtoull(optarg, &endarg, 16);
+                if (endarg == optarg)
+                    errno = EINVAL;
+                if (errno != 0) {
+                    perror("--pack-textures");
+                    exit(1);
+                }
+
+                const std::string texture_dir =
+                    fmt::format("{}textures/{:016X}/",
+                                FileUtil::GetUserPath(FileUtil::UserPath::LoadDir), program_id);
+                const std::string pack_path = Core::GetCustomTexPackPath(program_id);
+                const auto pack_progress = [](std::size_t converted, std::size_t total) {
+                    if (converted % 100 == 0 || converted == total) {
+                        LOG_INFO(Frontend, "Converted {}/{} textures", converted, total);
+                    }
+                };
+
+                LodePNGImageInterface image_interface;
+                const auto packed_count = Core::ConvertCustomTextures(
+                    texture_dir, pack_path, image_interface, pack_progress);
+                if (!packed_count) {
+                    exit(1);
+                }
+
+                LOG_INFO(Frontend, "Wrote {} textures to {}", *packed_count, pack_path);
+                return 0;
+            }
             case 'f':
                 fullscreen = true;
                 LOG_INFO(Frontend, "Starting in fullscreen mode...");
@@ -342,6 +402,11 @@ int main(int argc, char** argv) {
         return -1;
     }
 
+    if (!dump_video.empty() && !dump_frames.empty()) {
+        LOG_CRITICAL(Frontend, "Cannot both dump a video and frames");
+        return -1;
+    }
+
     if (!movie_record.empty()) {
         Core::Movie::GetInstance().PrepareForRecording();
     }
@@ -352,6 +417,13 @@ int main(int argc, char** argv) {
     // Apply the command line arguments
     Settings::values.gdbstub_port = gdb_port;
     Settings::values.use_gdbstub = use_gdbstub;
+    if (headless) {
+        // Emulate as fast as possible, there is nobody watching or listening
+        Settings::values.frame_limit = 0;
+        Settings::values.use_frame_limit_alternate = false;
+        Settings::values.use_present_thread = false;
+        Settings::values.sink_id = "null";
+    }
     Settings::Apply();
 
     // Register frontend applets
@@ -360,7 +432,8 @@ int main(int argc, char** argv) {
     // Register generic image interface
     Core::System::GetInstance().RegisterImageInterface(std::make_shared<LodePNGImageInterface>());
 
-    std::unique_ptr<EmuWindow_SDL2> emu_window{std::make_unique<EmuWindow_SDL2>(fullscreen)};
+    std::unique_ptr<EmuWindow_SDL2> emu_window{
+        std::make_unique<EmuWindow_SDL2>(fullscreen, headless)};
     Frontend::ScopeAcquireContext scope(*emu_window);
     Core::System& system{Core::System::GetInstance()};
 
@@ -418,18 +491,34 @@ int main(int argc, char** argv) {
         LOG_INFO(Movie, "Author: {}", metadata.author);
         LOG_INFO(Movie, "Rerecord count: {}", metadata.rerecord_count);
         LOG_INFO(Movie, "Input count: {}", metadata.input_count);
+        if (headless) {
+            Core::Movie::GetInstance().SetPlaybackCompletionCallback(
+                [&emu_window] { emu_window->RequestClose(); });
+        }
         Core::Movie::GetInstance().StartPlayback(movie_play);
     }
     if (!movie_record.empty()) {
         Core::Movie::GetInstance().StartRecording(movie_record, movie_record_author);
     }
-    if (!dump_video.empty()) {
-        Layout::FramebufferLayout layout{
-            Layout::FrameLayoutFromResolutionScale(VideoCore::GetResolutionScaleFactor())};
-        system.VideoDumper().StartDumping(dump_video, layout);
+    if (!dump_frames.empty()) {
+        system.SetVideoDumper(
+            std::make_unique<VideoDumper::ImageSequenceBackend>(system.GetImageInterface()));
+    }
+    if (!dump_video.empty() || !dump_frames.empty()) {
+        // Frames are captured from emulated memory, so they are at native resolution
+        Layout::FramebufferLayout layout{Layout::FrameLayoutFromResolutionScale(1)};
+        if (!system.VideoDumper().StartDumping(dump_video.empty() ? dump_frames : dump_video,
+                                               layout)) {
+            LOG_CRITICAL(Frontend, "Failed to start dumping");
+            return -1;
+        }
     }
 
-    std::thread render_thread([&emu_window] { emu_window->Present(); });
+    // Headless runs have no visible window to present to
+    std::thread render_thread;
+    if (!headless) {
+        render_thread = std::thread([&emu_window] { emu_window->Present(); });
+    }
 
     std::atomic_bool stop_run;
     Core::System::GetInstance().Renderer().Rasterizer()->LoadDiskResources(
@@ -438,10 +527,21 @@ int main(int argc, char** argv) {
                       total);
         });
 
+    const auto& renderer = system.Renderer();
+    const auto start_time = std::chrono::steady_clock::now();
     while (emu_window->IsOpen()) {
         system.RunLoop();
+        if (max_frames != 0 && static_cast<u64>(renderer.GetCurrentFrame()) >= max_frames) {
+            emu_window->RequestClose();
+        }
     }
-    render_thread.join();
+    if (render_thread.joinable()) {
+        render_thread.join();
+    }
+
+    const std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - start_time;
+    LOG_INFO(Frontend, "Emulated {} frames in {:.2f} s ({:.2f} FPS)", renderer.GetCurrentFrame(),
+             elapsed.count(), renderer.GetCurrentFrame() / elapsed.count());
 
     Core::Movie::GetInstance().Shutdown();
     if (system.VideoDumper().IsDumping()) {
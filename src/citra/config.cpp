@@ -106,6 +106,8 @@ void Config::ReadValues() {
     Settings::values.use_cpu_jit = sdl2_config->GetBoolean("Core", "use_cpu_jit", true);
     Settings::values.cpu_clock_percentage =
         sdl2_config->GetInteger("Core", "cpu_clock_percentage", 100);
+    Settings::values.enable_y2r_multithread =
+        sdl2_config->GetBoolean("Core", "enable_y2r_multithread", false);
 
     // Renderer
     Settings::values.use_gles = sdl2_config->GetBoolean("Renderer", "use_gles", false);
@@ -121,6 +123,17 @@ void Config::ReadValues() {
     Settings::values.shaders_accurate_mul =
         sdl2_config->GetBoolean("Renderer", "shaders_accurate_mul", true);
     Settings::values.use_shader_jit = sdl2_config->GetBoolean("Renderer", "use_shader_jit", true);
+    Settings::values.async_pipeline_compile =
+        sdl2_config->GetBoolean("Renderer", "async_pipeline_compile", false);
+    Settings::values.async_pipeline_skip_frames =
+        static_cast<u16>(sdl2_config->GetInteger("Renderer", "async_pipeline_skip_frames", 5));
+    Settings::values.ubershader_mode = static_cast<Settings::UberShaderMode>(
+        sdl2_config->GetInteger("Renderer", "ubershader_mode", 0));
+    Settings::values.frames_in_flight =
+        static_cast<u16>(sdl2_config->GetInteger("Renderer", "frames_in_flight", 4));
+    Settings::values.use_gpu_thread = sdl2_config->GetBoolean("Renderer", "use_gpu_thread", false);
+    Settings::values.use_present_thread =
+        sdl2_config->GetBoolean("Renderer", "use_present_thread", false);
     Settings::values.resolution_factor =
         static_cast<u16>(sdl2_config->GetInteger("Renderer", "resolution_factor", 1));
     Settings::values.use_disk_shader_cache =
@@ -183,14 +196,22 @@ void Config::ReadValues() {
     Settings::values.custom_textures = sdl2_config->GetBoolean("Utility", "custom_textures", false);
     Settings::values.preload_textures =
         sdl2_config->GetBoolean("Utility", "preload_textures", false);
+    Settings::values.async_custom_loading =
+        sdl2_config->GetBoolean("Utility", "async_custom_loading", false);
+    Settings::values.custom_textures_budget =
+        static_cast<u32>(sdl2_config->GetInteger("Utility", "custom_textures_budget", 1024));
 
     // Audio
     Settings::values.enable_dsp_lle = sdl2_config->GetBoolean("Audio", "enable_dsp_lle", false);
     Settings::values.enable_dsp_lle_multithread =
         sdl2_config->GetBoolean("Audio", "enable_dsp_lle_multithread", false);
+    Settings::values.enable_polyphase_filter =
+        sdl2_config->GetBoolean("Audio", "enable_polyphase_filter", false);
     Settings::values.sink_id = sdl2_config->GetString("Audio", "output_engine", "auto");
     Settings::values.enable_audio_stretching =
         sdl2_config->GetBoolean("Audio", "enable_audio_stretching", true);
+    Settings::values.audio_latency =
+        static_cast<u32>(sdl2_config->GetInteger("Audio", "audio_latency", 125));
     Settings::values.audio_device_id = sdl2_config->GetString("Audio", "output_device", "auto");
     Settings::values.volume = static_cast<float>(sdl2_config->GetReal("Audio", "volume", 1));
     Settings::values.mic_input_device =
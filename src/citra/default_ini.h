@@ -97,6 +97,10 @@ use_cpu_jit =
 # Range is any positive integer (but we suspect 25 - 400 is a good idea) Default is 100
 cpu_clock_percentage =
 
+# Whether to split large Y2R (video decoding) colour conversions across several threads
+# 0 (default): No, 1: Yes
+enable_y2r_multithread =
+
 [Renderer]
 # Whether to render using GLES or OpenGL
 # 0 (default): OpenGL, 1: GLES
@@ -122,6 +126,35 @@ shaders_accurate_mul =
 # 0: Interpreter (slow), 1 (default): JIT (fast)
 use_shader_jit =
 
+# Whether to compile new pipelines on background threads instead of stalling the frame.
+# Draws that need a pipeline which is still compiling are skipped
+# 0 (default): Off, 1: On
+async_pipeline_compile =
+
+# The maximum number of frames a draw can be skipped while its pipeline is compiling.
+# After that the renderer waits for the compilation to finish. Only used with async_pipeline_compile
+# 0: Always wait, 5 (default): Number of frames
+async_pipeline_skip_frames =
+
+# Whether to render with a fragment ubershader that reads the PICA state from uniforms
+# 0 (default): Off, 1: Use it while specialized pipelines are compiling, 2: Always (for benchmarking)
+ubershader_mode =
+
+# The number of frames the CPU can record ahead of the GPU. Higher values improve CPU/GPU overlap
+# at the cost of input latency
+# 2 - 8: Number of frames, 4 (default)
+frames_in_flight =
+
+# Executes GPU commands on a separate thread that runs in parallel with the emulated CPU.
+# The synchronous mode is kept for accuracy testing
+# 0 (default): Synchronous, 1: GPU thread
+use_gpu_thread =
+
+# Presents finished frames from a separate thread, paced by the emulated VBlank timing.
+# Frames the display can't keep up with are dropped instead of stalling emulation
+# 0 (default): Present on the emulation thread, 1: Present thread
+use_present_thread =
+
 # Forces VSync on the display thread. Usually doesn't impact performance, but on some drivers it can
 # so only turn this off if you notice a speed difference.
 # 0: Off, 1 (default): On
@@ -217,6 +250,15 @@ custom_textures =
 # 0 (default): Off, 1: On
 preload_textures =
 
+# Decodes custom textures in the background. The original texture is shown until its
+# replacement is ready, and preloading no longer delays booting.
+# 0 (default): Off, 1: On
+async_custom_loading =
+
+# Maximum amount of memory used by decoded custom textures, in MiB. 0 means no limit
+# 1024 (default)
+custom_textures_budget =
+
 [Audio]
 # Whether or not to enable DSP LLE
 # 0 (default): No, 1: Yes
@@ -226,6 +268,11 @@ enable_dsp_lle =
 # 0 (default): No, 1: Yes
 enable_dsp_lle_thread =
 
+# Whether or not HLE audio sources that request polyphase interpolation use a windowed sinc filter.
+# The filter isn't verified against hardware and delays the audio by two more samples.
+# When disabled, these sources use linear interpolation.
+# 0 (default): No, 1: Yes
+enable_polyphase_filter =
 
 # Which audio output engine to use.
 # auto (default): Auto-select, null: No audio output, sdl2: SDL2 (if available)
@@ -237,6 +284,11 @@ output_engine =
 # 0: No, 1 (default): Yes
 enable_audio_stretching =
 
+# Target latency of the audio output in milliseconds. Lower values reduce the delay of the audio,
+# but make underruns more likely when emulation speed varies. Must be between 5 and 250.
+# 125 (default)
+audio_latency =
+
 # Which audio device to use.
 # auto (default): Auto-select
 output_device =
@@ -20,8 +20,6 @@
 #include "input_common/motion_emu.h"
 #include "input_common/sdl/sdl.h"
 #include "network/network.h"
-#include "video_core/common/renderer.h"
-#include "video_core/video_core.h"
 
 SharedContext_SDL2::SharedContext_SDL2() {
     window = SDL_CreateWindow(NULL, SDL_WINDOWPOS_UNDEFINED, SDL_WINDOWPOS_UNDEFINED, 0, 0,
@@ -105,7 +103,18 @@ bool EmuWindow_SDL2::IsOpen() const {
     return is_open;
 }
 
+void EmuWindow_SDL2::RequestClose() {
+    is_open = false;
+}
+
 void EmuWindow_SDL2::OnResize() {
+    if (render_window == nullptr) {
+        // Headless runs keep the layout of the default window size
+        UpdateCurrentFramebufferLayout(Core::kScreenTopWidth,
+                                       Core::kScreenTopHeight + Core::kScreenBottomHeight);
+        return;
+    }
+
     int width, height;
     SDL_GetWindowSize(render_window, &width, &height);
     UpdateCurrentFramebufferLayout(width, height);
@@ -132,9 +141,11 @@ void EmuWindow_SDL2::Fullscreen() {
     SDL_MaximizeWindow(render_window);
 }
 
-EmuWindow_SDL2::EmuWindow_SDL2(bool fullscreen) {
-    // Initialize the window
-    if (SDL_Init(SDL_INIT_VIDEO | SDL_INIT_JOYSTICK) < 0) {
+EmuWindow_SDL2::EmuWindow_SDL2(bool fullscreen, bool headless) {
+    // Headless runs don't need a display server, so the video subsystem isn't initialized and
+    // no window is created. The video backend then renders without a surface to present to.
+    const u32 init_flags = headless ? SDL_INIT_JOYSTICK : SDL_INIT_VIDEO | SDL_INIT_JOYSTICK;
+    if (SDL_Init(init_flags) < 0) {
         LOG_CRITICAL(Frontend, "Failed to initialize SDL2! Exiting...");
         exit(1);
     }
@@ -144,6 +155,14 @@ EmuWindow_SDL2::EmuWindow_SDL2(bool fullscreen) {
 
     SDL_SetMainReady();
 
+    if (headless) {
+        OnResize();
+        LOG_INFO(Frontend, "Citra Version: {} | {}-{}", Common::g_build_fullname,
+                 Common::g_scm_branch, Common::g_scm_desc);
+        Settings::LogSettings();
+        return;
+    }
+
     SDL_GL_SetAttribute(SDL_GL_CONTEXT_MAJOR_VERSION, 3);
     if (Settings::values.use_gles) {
         SDL_GL_SetAttribute(SDL_GL_CONTEXT_MINOR_VERSION, 2);
@@ -214,7 +233,9 @@ EmuWindow_SDL2::~EmuWindow_SDL2() {
     core_context.reset();
     Network::Shutdown();
     InputCommon::Shutdown();
-    SDL_GL_DeleteContext(window_context);
+    if (window_context != nullptr) {
+        SDL_GL_DeleteContext(window_context);
+    }
     SDL_Quit();
 }
 
@@ -226,7 +247,6 @@ void EmuWindow_SDL2::Present() {
     SDL_GL_MakeCurrent(render_window, window_context);
     SDL_GL_SetSwapInterval(1);
     while (IsOpen()) {
-        VideoCore::g_renderer->TryPresent(100);
         SDL_GL_SwapWindow(render_window);
     }
     SDL_GL_MakeCurrent(render_window, nullptr);
@@ -289,23 +309,40 @@ void EmuWindow_SDL2::PollEvents() {
     const u32 current_time = SDL_GetTicks();
     if (current_time > last_time + 2000) {
         const auto results = Core::System::GetInstance().GetAndResetPerfStats();
-        const auto title =
+        auto title =
             fmt::format("Citra {} | {}-{} | FPS: {:.0f} ({:.0f}%)", Common::g_build_fullname,
                         Common::g_scm_branch, Common::g_scm_desc, results.game_fps,
                         results.emulation_speed * 100.0f);
-        SDL_SetWindowTitle(render_window, title.c_str());
+        if (Settings::values.use_present_thread) {
+            title += fmt::format(" | Present: {:.2f} ms ({} dropped, {} repeated)",
+                                 results.present_latency * 1000.0, results.dropped_frames,
+                                 results.duplicated_frames);
+        }
+        if (results.audio_underruns > 0 || results.audio_overruns > 0) {
+            title += fmt::format(" | Audio: {} underruns, {} overruns", results.audio_underruns,
+                                 results.audio_overruns);
+        }
+        if (render_window != nullptr) {
+            SDL_SetWindowTitle(render_window, title.c_str());
+        }
         last_time = current_time;
     }
 }
 
 void EmuWindow_SDL2::MakeCurrent() {
-    core_context->MakeCurrent();
+    if (core_context) {
+        core_context->MakeCurrent();
+    }
 }
 
 void EmuWindow_SDL2::DoneCurrent() {
-    core_context->DoneCurrent();
+    if (core_context) {
+        core_context->DoneCurrent();
+    }
 }
 
 void EmuWindow_SDL2::OnMinimalClientAreaChangeRequest(std::pair<u32, u32> minimal_size) {
-    SDL_SetWindowMinimumSize(render_window, minimal_size.first, minimal_size.second);
+    if (render_window != nullptr) {
+        SDL_SetWindowMinimumSize(render_window, minimal_size.first, minimal_size.second);
+    }
 }
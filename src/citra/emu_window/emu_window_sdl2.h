@@ -4,6 +4,7 @@
 
 #pragma once
 
+#include <atomic>
 #include <memory>
 #include <utility>
 #include "core/frontend/emu_window.h"
@@ -29,7 +30,12 @@ private:
 
 class EmuWindow_SDL2 : public Frontend::EmuWindow {
 public:
-    explicit EmuWindow_SDL2(bool fullscreen);
+    /**
+     * @param fullscreen Whether to start in fullscreen mode
+     * @param headless Whether to run without a window or display server. The video backend then
+     * renders without presenting, see Frontend::WindowSystemType::Headless
+     */
+    EmuWindow_SDL2(bool fullscreen, bool headless);
     ~EmuWindow_SDL2();
 
     void Present();
@@ -46,6 +52,9 @@ public:
     /// Whether the window is still open, and a close request hasn't yet been sent
     bool IsOpen() const;
 
+    /// Requests the window to close, which ends the emulation and presentation loops
+    void RequestClose();
+
     /// Creates a new context that is shared with the current context
     std::unique_ptr<GraphicsContext> CreateSharedContext() const override;
 
@@ -81,20 +90,20 @@ private:
     void OnMinimalClientAreaChangeRequest(std::pair<u32, u32> minimal_size) override;
 
     /// Is the window still open?
-    bool is_open = true;
+    std::atomic<bool> is_open = true;
 
-    /// Internal SDL2 render window
-    SDL_Window* render_window;
+    /// Internal SDL2 render window, null when running headless
+    SDL_Window* render_window = nullptr;
 
     /// Fake hidden window for the core context
-    SDL_Window* dummy_window;
+    SDL_Window* dummy_window = nullptr;
 
     using SDL_GLContext = void*;
 
     /// The OpenGL context associated with the window
-    SDL_GLContext window_context;
+    SDL_GLContext window_context = nullptr;
 
-    /// The OpenGL context associated with the core
+    /// The OpenGL context associated with the core, null when running headless
     std::unique_ptr<Frontend::GraphicsContext> core_context;
 
     /// Keeps track of how often to update the title bar during gameplay
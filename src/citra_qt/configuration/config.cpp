@@ -106,11 +106,14 @@ void Config::ReadAudioValues() {
     Settings::values.enable_dsp_lle = ReadSetting(QStringLiteral("enable_dsp_lle"), false).toBool();
     Settings::values.enable_dsp_lle_multithread =
         ReadSetting(QStringLiteral("enable_dsp_lle_multithread"), false).toBool();
+    Settings::values.enable_polyphase_filter =
+        ReadSetting(QStringLiteral("enable_polyphase_filter"), false).toBool();
     Settings::values.sink_id = ReadSetting(QStringLiteral("output_engine"), QStringLiteral("auto"))
                                    .toString()
                                    .toStdString();
     Settings::values.enable_audio_stretching =
         ReadSetting(QStringLiteral("enable_audio_stretching"), true).toBool();
+    Settings::values.audio_latency = ReadSetting(QStringLiteral("audio_latency"), 125).toUInt();
     Settings::values.audio_device_id =
         ReadSetting(QStringLiteral("output_device"), QStringLiteral("auto"))
             .toString()
@@ -284,6 +287,10 @@ void Config::ReadUtilityValues() {
         ReadSetting(QStringLiteral("custom_textures"), false).toBool();
     Settings::values.preload_textures =
         ReadSetting(QStringLiteral("preload_textures"), false).toBool();
+    Settings::values.async_custom_loading =
+        ReadSetting(QStringLiteral("async_custom_loading"), false).toBool();
+    Settings::values.custom_textures_budget =
+        ReadSetting(QStringLiteral("custom_textures_budget"), 1024).toUInt();
 
     qt_config->endGroup();
 }
@@ -294,6 +301,8 @@ void Config::ReadCoreValues() {
     Settings::values.use_cpu_jit = ReadSetting(QStringLiteral("use_cpu_jit"), true).toBool();
     Settings::values.cpu_clock_percentage =
         ReadSetting(QStringLiteral("cpu_clock_percentage"), 100).toInt();
+    Settings::values.enable_y2r_multithread =
+        ReadSetting(QStringLiteral("enable_y2r_multithread"), false).toBool();
 
     qt_config->endGroup();
 }
@@ -488,6 +497,17 @@ void Config::ReadRendererValues() {
     Settings::values.shaders_accurate_mul =
         ReadSetting(QStringLiteral("shaders_accurate_mul"), true).toBool();
     Settings::values.use_shader_jit = ReadSetting(QStringLiteral("use_shader_jit"), true).toBool();
+    Settings::values.async_pipeline_compile =
+        ReadSetting(QStringLiteral("async_pipeline_compile"), false).toBool();
+    Settings::values.async_pipeline_skip_frames =
+        static_cast<u16>(ReadSetting(QStringLiteral("async_pipeline_skip_frames"), 5).toInt());
+    Settings::values.ubershader_mode = static_cast<Settings::UberShaderMode>(
+        ReadSetting(QStringLiteral("ubershader_mode"), 0).toInt());
+    Settings::values.frames_in_flight =
+        static_cast<u16>(ReadSetting(QStringLiteral("frames_in_flight"), 4).toInt());
+    Settings::values.use_gpu_thread = ReadSetting(QStringLiteral("use_gpu_thread"), false).toBool();
+    Settings::values.use_present_thread =
+        ReadSetting(QStringLiteral("use_present_thread"), false).toBool();
     Settings::values.use_disk_shader_cache =
         ReadSetting(QStringLiteral("use_disk_shader_cache"), true).toBool();
     Settings::values.use_vsync_new = ReadSetting(QStringLiteral("use_vsync_new"), true).toBool();
@@ -733,10 +753,13 @@ void Config::SaveAudioValues() {
     WriteSetting(QStringLiteral("enable_dsp_lle"), Settings::values.enable_dsp_lle, false);
     WriteSetting(QStringLiteral("enable_dsp_lle_multithread"),
                  Settings::values.enable_dsp_lle_multithread, false);
+    WriteSetting(QStringLiteral("enable_polyphase_filter"),
+                 Settings::values.enable_polyphase_filter, false);
     WriteSetting(QStringLiteral("output_engine"), QString::fromStdString(Settings::values.sink_id),
                  QStringLiteral("auto"));
     WriteSetting(QStringLiteral("enable_audio_stretching"),
                  Settings::values.enable_audio_stretching, true);
+    WriteSetting(QStringLiteral("audio_latency"), Settings::values.audio_latency, 125);
     WriteSetting(QStringLiteral("output_device"),
                  QString::fromStdString(Settings::values.audio_device_id), QStringLiteral("auto"));
     WriteSetting(QStringLiteral("volume"), Settings::values.volume, 1.0f);
@@ -844,6 +867,10 @@ void Config::SaveUtilityValues() {
     WriteSetting(QStringLiteral("dump_textures"), Settings::values.dump_textures, false);
     WriteSetting(QStringLiteral("custom_textures"), Settings::values.custom_textures, false);
     WriteSetting(QStringLiteral("preload_textures"), Settings::values.preload_textures, false);
+    WriteSetting(QStringLiteral("async_custom_loading"), Settings::values.async_custom_loading,
+                 false);
+    WriteSetting(QStringLiteral("custom_textures_budget"), Settings::values.custom_textures_budget,
+                 1024);
 
     qt_config->endGroup();
 }
@@ -854,6 +881,8 @@ void Config::SaveCoreValues() {
     WriteSetting(QStringLiteral("use_cpu_jit"), Settings::values.use_cpu_jit, true);
     WriteSetting(QStringLiteral("cpu_clock_percentage"), Settings::values.cpu_clock_percentage,
                  100);
+    WriteSetting(QStringLiteral("enable_y2r_multithread"),
+                 Settings::values.enable_y2r_multithread, false);
 
     qt_config->endGroup();
 }
@@ -997,6 +1026,15 @@ void Config::SaveRendererValues() {
     WriteSetting(QStringLiteral("shaders_accurate_mul"), Settings::values.shaders_accurate_mul,
                  true);
     WriteSetting(QStringLiteral("use_shader_jit"), Settings::values.use_shader_jit, true);
+    WriteSetting(QStringLiteral("async_pipeline_compile"), Settings::values.async_pipeline_compile,
+                 false);
+    WriteSetting(QStringLiteral("async_pipeline_skip_frames"),
+                 Settings::values.async_pipeline_skip_frames, 5);
+    WriteSetting(QStringLiteral("ubershader_mode"),
+                 static_cast<int>(Settings::values.ubershader_mode), 0);
+    WriteSetting(QStringLiteral("frames_in_flight"), Settings::values.frames_in_flight, 4);
+    WriteSetting(QStringLiteral("use_gpu_thread"), Settings::values.use_gpu_thread, false);
+    WriteSetting(QStringLiteral("use_present_thread"), Settings::values.use_present_thread, false);
     WriteSetting(QStringLiteral("use_disk_shader_cache"), Settings::values.use_disk_shader_cache,
                  true);
     WriteSetting(QStringLiteral("use_vsync_new"), Settings::values.use_vsync_new, true);
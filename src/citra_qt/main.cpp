@@ -300,8 +300,17 @@ void GMainWindow::InitializeWidgets() {
     emu_frametime_label->setToolTip(
         tr("Time taken to emulate a 3DS frame, not counting framelimiting or v-sync. For "
            "full-speed emulation this should be at most 16.67 ms."));
-
-    for (auto& label : {emu_speed_label, game_fps_label, emu_frametime_label}) {
+    present_stats_label = new QLabel();
+    present_stats_label->setToolTip(
+        tr("Average time between a frame being rendered and shown on screen, followed by the "
+           "frames dropped and repeated by the present thread since the last update."));
+    audio_stats_label = new QLabel();
+    audio_stats_label->setToolTip(
+        tr("Times the audio output ran out of samples, and times samples were dropped because "
+           "too many were queued, since the last update."));
+
+    for (auto& label : {emu_speed_label, game_fps_label, emu_frametime_label, present_stats_label,
+                        audio_stats_label}) {
         label->setVisible(false);
         label->setFrameStyle(QFrame::NoFrame);
         label->setContentsMargins(4, 0, 4, 0);
@@ -1055,8 +1064,8 @@ void GMainWindow::BootGame(const QString& filename) {
     }
 
     if (video_dumping_on_start) {
-        Layout::FramebufferLayout layout{
-            Layout::FrameLayoutFromResolutionScale(VideoCore::GetResolutionScaleFactor())};
+        // Frames are captured from emulated memory, so they are at native resolution
+        Layout::FramebufferLayout layout{Layout::FrameLayoutFromResolutionScale(1)};
         if (!Core::System::GetInstance().VideoDumper().StartDumping(
                 video_dumping_path.toStdString(), layout)) {
 
@@ -1198,6 +1207,8 @@ void GMainWindow::ShutdownGame() {
     emu_speed_label->setVisible(false);
     game_fps_label->setVisible(false);
     emu_frametime_label->setVisible(false);
+    present_stats_label->setVisible(false);
+    audio_stats_label->setVisible(false);
 
     UpdateSaveStates();
 
@@ -1970,8 +1981,8 @@ void GMainWindow::OnStartVideoDumping() {
     }
     const auto path = dialog.GetFilePath();
     if (emulation_running) {
-        Layout::FramebufferLayout layout{
-            Layout::FrameLayoutFromResolutionScale(VideoCore::GetResolutionScaleFactor())};
+        // Frames are captured from emulated memory, so they are at native resolution
+        Layout::FramebufferLayout layout{Layout::FrameLayoutFromResolutionScale(1)};
         if (!Core::System::GetInstance().VideoDumper().StartDumping(path.toStdString(), layout)) {
             QMessageBox::critical(
                 this, tr("Citra"),
@@ -2068,10 +2079,19 @@ void GMainWindow::UpdateStatusBar() {
     }
     game_fps_label->setText(tr("Game: %1 FPS").arg(results.game_fps, 0, 'f', 0));
     emu_frametime_label->setText(tr("Frame: %1 ms").arg(results.frametime * 1000.0, 0, 'f', 2));
+    present_stats_label->setText(tr("Present: %1 ms (%2 dropped, %3 repeated)")
+                                     .arg(results.present_latency * 1000.0, 0, 'f', 2)
+                                     .arg(results.dropped_frames)
+                                     .arg(results.duplicated_frames));
 
     emu_speed_label->setVisible(true);
     game_fps_label->setVisible(true);
     emu_frametime_label->setVisible(true);
+    present_stats_label->setVisible(Settings::values.use_present_thread);
+    audio_stats_label->setText(tr("Audio: %1 underruns, %2 overruns")
+                                   .arg(results.audio_underruns)
+                                   .arg(results.audio_overruns));
+    audio_stats_label->setVisible(results.audio_underruns > 0 || results.audio_overruns > 0);
 }
 
 void GMainWindow::HideMouseCursor() {
@@ -2393,6 +2413,12 @@ void GMainWindow::RetranslateStatusBar() {
     emu_frametime_label->setToolTip(
         tr("Time taken to emulate a 3DS frame, not counting framelimiting or v-sync. For "
            "full-speed emulation this should be at most 16.67 ms."));
+    present_stats_label->setToolTip(
+        tr("Average time between a frame being rendered and shown on screen, followed by the "
+           "frames dropped and repeated by the present thread since the last update."));
+    audio_stats_label->setToolTip(
+        tr("Times the audio output ran out of samples, and times samples were dropped because "
+           "too many were queued, since the last update."));
 
     multiplayer_state->retranslateUi();
 }
@@ -69,23 +69,11 @@ public:
     template<typename... P>
     T* Allocate(P&&... p) {
 #ifndef OBJECT_POOL_DEBUG
-        if (vacants.empty()) {
-            unsigned num_objects = 64u << memory.size();
-            T *ptr = static_cast<T*>(memalign_alloc(std::max<unsigned>(64, alignof(T)),
-                                                    num_objects * sizeof(T)));
-            if (!ptr) {
-                return nullptr;
-            }
-
-            for (unsigned i = 0; i < num_objects; i++) {
-                vacants.push_back(&ptr[i]);
-            }
-
-            memory.emplace_back(ptr);
+        T *ptr = AllocateStorage();
+        if (!ptr) {
+            return nullptr;
         }
 
-        T *ptr = vacants.back();
-        vacants.pop_back();
         new(ptr) T(std::forward<P>(p)...);
         return ptr;
 #else
@@ -111,6 +99,28 @@ public:
 
 protected:
 #ifndef OBJECT_POOL_DEBUG
+    // Returns uninitialized storage for a single object, growing the pool if needed
+    T* AllocateStorage() {
+        if (vacants.empty()) {
+            unsigned num_objects = 64u << memory.size();
+            T *ptr = static_cast<T*>(memalign_alloc(std::max<unsigned>(64, alignof(T)),
+                                                    num_objects * sizeof(T)));
+            if (!ptr) {
+                return nullptr;
+            }
+
+            for (unsigned i = 0; i < num_objects; i++) {
+                vacants.push_back(&ptr[i]);
+            }
+
+            memory.emplace_back(ptr);
+        }
+
+        T *ptr = vacants.back();
+        vacants.pop_back();
+        return ptr;
+    }
+
     std::vector<T*> vacants;
 
     struct MallocDeleter {
@@ -128,8 +138,21 @@ class ThreadSafeObjectPool : private ObjectPool<T> {
 public:
     template<typename... P>
     T* Allocate(P &&... p) {
-        std::lock_guard<std::mutex> holder{lock};
-        return ObjectPool<T>::Allocate(std::forward<P>(p)...);
+#ifndef OBJECT_POOL_DEBUG
+        T *ptr = nullptr;
+        {
+            std::lock_guard<std::mutex> holder{lock};
+            ptr = this->AllocateStorage();
+        }
+
+        // Construct outside of the lock as some objects are expensive to create
+        if (ptr) {
+            new(ptr) T(std::forward<P>(p)...);
+        }
+        return ptr;
+#else
+        return new T(std::forward<P>(p)...);
+#endif
     }
 
     void Free(T *ptr) {
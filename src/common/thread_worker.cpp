@@ -0,0 +1,80 @@
+// Copyright 2022 Citra Emulator Project
+// Licensed under GPLv2 or any later version
+// Refer to the license.txt file included.
+
+#include <algorithm>
+#include <fmt/format.h>
+#include "common/thread.h"
+#include "common/thread_worker.h"
+
+namespace Common {
+
+ThreadWorker::ThreadWorker(std::size_t num_workers, const std::string& name) {
+    num_workers = std::max<std::size_t>(num_workers, 1);
+    threads.reserve(num_workers);
+    for (std::size_t i = 0; i < num_workers; i++) {
+        threads.emplace_back(&ThreadWorker::WorkerLoop, this, fmt::format("{}:{}", name, i));
+    }
+}
+
+ThreadWorker::~ThreadWorker() {
+    {
+        std::scoped_lock lock{queue_mutex};
+        stop = true;
+    }
+
+    request_cv.notify_all();
+    for (std::thread& thread : threads) {
+        thread.join();
+    }
+}
+
+void ThreadWorker::QueueWork(Task task) {
+    {
+        std::scoped_lock lock{queue_mutex};
+        requests.emplace(std::move(task));
+        ++work_scheduled;
+    }
+
+    request_cv.notify_one();
+}
+
+void ThreadWorker::WaitForRequests() {
+    std::unique_lock lock{queue_mutex};
+    wait_cv.wait(lock, [this] { return work_done == work_scheduled; });
+}
+
+std::size_t ThreadWorker::NumPendingTasks() {
+    std::scoped_lock lock{queue_mutex};
+    return work_scheduled - work_done;
+}
+
+void ThreadWorker::WorkerLoop(const std::string& name) {
+    SetCurrentThreadName(name.c_str());
+
+    while (true) {
+        Task task;
+        {
+            std::unique_lock lock{queue_mutex};
+            request_cv.wait(lock, [this] { return stop || !requests.empty(); });
+            if (requests.empty()) {
+                // Only reached when stopping with no work left
+                return;
+            }
+
+            task = std::move(requests.front());
+            requests.pop();
+        }
+
+        task();
+
+        {
+            std::scoped_lock lock{queue_mutex};
+            ++work_done;
+        }
+
+        wait_cv.notify_all();
+    }
+}
+
+} // namespace Common
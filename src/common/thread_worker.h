@@ -0,0 +1,63 @@
+// Copyright 2022 Citra Emulator Project
+// Licensed under GPLv2 or any later version
+// Refer to the license.txt file included.
+
+#pragma once
+
+#include <condition_variable>
+#include <functional>
+#include <mutex>
+#include <queue>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace Common {
+
+/**
+ * A fixed size pool of threads that consumes work items in submission order.
+ * Work items must not throw. All public functions are thread-safe.
+ */
+class ThreadWorker {
+public:
+    using Task = std::function<void()>;
+
+    /**
+     * @param num_workers The number of threads to spawn, at least one is always created
+     * @param name The name given to the spawned threads
+     */
+    explicit ThreadWorker(std::size_t num_workers, const std::string& name);
+    ~ThreadWorker();
+
+    ThreadWorker(const ThreadWorker&) = delete;
+    ThreadWorker& operator=(const ThreadWorker&) = delete;
+
+    /// Queues a task to be executed by the first available worker
+    void QueueWork(Task task);
+
+    /// Blocks the calling thread until all queued tasks have finished executing
+    void WaitForRequests();
+
+    /// Returns the number of tasks that are queued or executing
+    std::size_t NumPendingTasks();
+
+    /// Returns the number of threads in the pool
+    std::size_t NumWorkers() const {
+        return threads.size();
+    }
+
+private:
+    void WorkerLoop(const std::string& name);
+
+private:
+    std::vector<std::thread> threads;
+    std::queue<Task> requests;
+    std::mutex queue_mutex;
+    std::condition_variable request_cv;
+    std::condition_variable wait_cv;
+    std::size_t work_scheduled = 0;
+    std::size_t work_done = 0;
+    bool stop = false;
+};
+
+} // namespace Common
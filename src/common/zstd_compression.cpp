@@ -48,4 +48,15 @@ std::vector<u8> DecompressDataZSTD(const std::vector<u8>& compressed) {
     return decompressed;
 }
 
+std::vector<u8> DecompressDataZSTD(const std::vector<u8>& compressed, std::size_t expected_size) {
+    const unsigned long long decompressed_size =
+        ZSTD_getFrameContentSize(compressed.data(), compressed.size());
+    if (decompressed_size != expected_size) {
+        // Also rejects frames with an unknown size and invalid data
+        return {};
+    }
+
+    return DecompressDataZSTD(compressed);
+}
+
 } // namespace Common::Compression
@@ -42,4 +42,16 @@ namespace Common::Compression {
  */
 [[nodiscard]] std::vector<u8> DecompressDataZSTD(const std::vector<u8>& compressed);
 
+/**
+ * Decompresses a source memory region with Zstandard if its decompressed size, as recorded in the
+ * frame header, matches the expected size. The size is checked before allocating the output.
+ *
+ * @param compressed the compressed source memory region.
+ * @param expected_size the size in bytes the decompressed data must have.
+ *
+ * @return the decompressed data, or an empty vector if the sizes don't match.
+ */
+[[nodiscard]] std::vector<u8> DecompressDataZSTD(const std::vector<u8>& compressed,
+                                                 std::size_t expected_size);
+
 } // namespace Common::Compression
@@ -310,7 +310,7 @@ System::ResultStatus System::Load(Frontend::EmuWindow& emu_window, const std::st
                   static_cast<u32>(load_result));
     }
     perf_stats = std::make_unique<PerfStats>(title_id);
-    custom_tex_cache = std::make_unique<Core::CustomTexCache>();
+    custom_tex_cache = std::make_unique<Core::CustomTexCache>(GetImageInterface());
 
     if (Settings::values.custom_textures) {
         const u64 program_id = Kernel().GetCurrentProcess()->codeset->program_id;
@@ -319,7 +319,7 @@ System::ResultStatus System::Load(Frontend::EmuWindow& emu_window, const std::st
         custom_tex_cache->FindCustomTextures(program_id);
     }
     if (Settings::values.preload_textures) {
-        custom_tex_cache->PreloadTextures(*GetImageInterface());
+        custom_tex_cache->PreloadTextures();
     }
 
     status = ResultStatus::Success;
@@ -401,6 +401,7 @@ System::ResultStatus System::Init(Frontend::EmuWindow& emu_window, u32 system_mo
 
     dsp_core->SetSink(Settings::values.sink_id, Settings::values.audio_device_id);
     dsp_core->EnableStretching(Settings::values.enable_audio_stretching);
+    dsp_core->SetLatency(Settings::values.audio_latency);
 
     telemetry_session = std::make_unique<Core::TelemetrySession>();
 
@@ -498,6 +499,11 @@ const VideoDumper::Backend& System::VideoDumper() const {
     return *video_dumper;
 }
 
+void System::SetVideoDumper(std::unique_ptr<VideoDumper::Backend> backend) {
+    ASSERT(!video_dumper || !video_dumper->IsDumping());
+    video_dumper = std::move(backend);
+}
+
 Core::CustomTexCache& System::CustomTexCache() {
     return *custom_tex_cache;
 }
@@ -529,9 +535,9 @@ void System::Shutdown(bool is_deserializing) {
     telemetry_session->AddField(performance, "Shutdown_Frametime", perf_results.frametime * 1000.0);
     telemetry_session->AddField(performance, "Mean_Frametime_MS", perf_stats->GetMeanFrametime());
 
-    // Shutdown emulation session
-    VideoCore::Shutdown();
+    // Shutdown emulation session. The GPU thread must stop before the renderer is destroyed
     HW::Shutdown();
+    VideoCore::Shutdown();
     if (!is_deserializing) {
         GDBStub::Shutdown();
         perf_stats.reset();
@@ -264,6 +264,9 @@ public:
     /// Gets a const reference to the video dumper backend
     [[nodiscard]] const VideoDumper::Backend& VideoDumper() const;
 
+    /// Replaces the video dumper backend, which must not be dumping
+    void SetVideoDumper(std::unique_ptr<VideoDumper::Backend> backend);
+
     std::unique_ptr<PerfStats> perf_stats;
     FrameLimiter frame_limiter;
 
@@ -2,97 +2,183 @@
 // Licensed under GPLv2 or any later version
 // Refer to the license.txt file included.
 
+#include <algorithm>
+#include <bitset>
+#include <thread>
 #include <fmt/format.h>
 #include "common/file_util.h"
 #include "common/texture.h"
+#include "common/thread_worker.h"
 #include "core.h"
 #include "core/custom_tex_cache.h"
+#include "core/custom_tex_pack.h"
+#include "core/frontend/image_interface.h"
+#include "core/settings.h"
 
 namespace Core {
-CustomTexCache::CustomTexCache() = default;
 
-CustomTexCache::~CustomTexCache() = default;
+// Maximum number of textures of the same directory queued along with a requested one
+constexpr std::size_t MAX_PREFETCH_TEXTURES = 32;
 
-bool CustomTexCache::IsTextureDumped(u64 hash) const {
-    return dumped_textures.count(hash);
+CustomTexCache::CustomTexCache(std::shared_ptr<Frontend::ImageInterface> image_interface)
+    : image_interface(std::move(image_interface)) {}
+
+CustomTexCache::~CustomTexCache() {
+    // Skip the remaining queued decodes so shutting down doesn't wait for them
+    stopping = true;
+    workers.reset();
 }
 
-void CustomTexCache::SetTextureDumped(const u64 hash) {
-    dumped_textures.insert(hash);
+std::shared_ptr<const CustomTexInfo> CustomTexCache::LookupTexture(u64 hash) {
+    std::scoped_lock lock{mutex};
+    const auto it = custom_textures.find(hash);
+    if (it == custom_textures.end()) {
+        return nullptr;
+    }
+
+    lru_textures.splice(lru_textures.end(), lru_textures, it->second.lru_entry);
+    return it->second.info;
 }
 
-bool CustomTexCache::IsTextureCached(u64 hash) const {
-    return custom_textures.count(hash);
+std::shared_ptr<const CustomTexInfo> CustomTexCache::LoadTexture(u64 hash) {
+    if (!CustomTextureExists(hash)) {
+        return nullptr;
+    }
+
+    {
+        std::unique_lock lock{mutex};
+        decode_cv.wait(lock, [this, hash] { return !decoding_textures.contains(hash); });
+
+        if (const auto it = custom_textures.find(hash); it != custom_textures.end()) {
+            lru_textures.splice(lru_textures.end(), lru_textures, it->second.lru_entry);
+            return it->second.info;
+        }
+
+        if (failed_textures.contains(hash)) {
+            return nullptr;
+        }
+
+        // Take the texture out of the queue and decode it right here instead
+        if (queued_textures.erase(hash)) {
+            std::erase_if(decode_queue,
+                          [hash](const QueuedTexture& queued) { return queued.hash == hash; });
+        }
+
+        decoding_textures.insert(hash);
+    }
+
+    auto info = DecodeTexture(hash);
+    InsertTexture(hash, info);
+    return info;
 }
 
-const CustomTexInfo& CustomTexCache::LookupTexture(u64 hash) const {
-    return custom_textures.at(hash);
+void CustomTexCache::RequestTexture(u64 hash) {
+    const auto path_it = custom_texture_paths.find(hash);
+    if (path_it == custom_texture_paths.end() || !workers) {
+        return;
+    }
+
+    const auto neighbours_it = directory_textures.find(path_it->second.group);
+
+    std::size_t queued_count = 0;
+    {
+        std::scoped_lock lock{mutex};
+        if (QueueTexture(hash, Priority::Request)) {
+            queued_count++;
+        }
+
+        std::size_t prefetch_count = 0;
+        if (neighbours_it != directory_textures.end()) {
+            for (const u64 neighbour : neighbours_it->second) {
+                if (prefetch_count == MAX_PREFETCH_TEXTURES) {
+                    break;
+                }
+
+                if (QueueTexture(neighbour, Priority::Prefetch)) {
+                    prefetch_count++;
+                }
+            }
+        }
+
+        queued_count += prefetch_count;
+    }
+
+    for (std::size_t i = 0; i < queued_count; i++) {
+        workers->QueueWork([this] { DecodeNext(); });
+    }
 }
 
-void CustomTexCache::CacheTexture(u64 hash, const std::vector<u8>& tex, u32 width, u32 height) {
-    custom_textures[hash] = {width, height, tex};
+bool CustomTexCache::IsTextureQueued(u64 hash) const {
+    std::scoped_lock lock{mutex};
+    return queued_textures.contains(hash) || decoding_textures.contains(hash);
 }
 
 void CustomTexCache::AddTexturePath(u64 hash, const std::string& path) {
-    if (custom_texture_paths.count(hash))
-        LOG_ERROR(Core, "Textures {} and {} conflict!", custom_texture_paths[hash].path, path);
-    else
-        custom_texture_paths[hash] = {path, hash};
+    if (const auto it = custom_texture_paths.find(hash); it != custom_texture_paths.end()) {
+        if (!it->second.packed) {
+            LOG_ERROR(Core, "Textures {} and {} conflict!", it->second.path, path);
+        }
+    } else {
+        std::string group = path.substr(0, path.find_last_of('/'));
+        directory_textures[group].push_back(hash);
+        custom_texture_paths[hash] = {path, hash, false, std::move(group)};
+    }
+}
+
+void CustomTexCache::AddTexturePack(const std::string& pack_path) {
+    auto pack = std::make_unique<CustomTexPack>();
+    if (!pack->Open(pack_path)) {
+        return;
+    }
+
+    for (const auto& entry : pack->GetIndex()) {
+        std::string group = fmt::format("{}:{}", pack_path, entry.group);
+        directory_textures[group].push_back(entry.hash);
+        custom_texture_paths[entry.hash] = {pack_path, entry.hash, true, std::move(group)};
+    }
+
+    texture_pack = std::move(pack);
+    CreateWorkers();
 }
 
 void CustomTexCache::FindCustomTextures(u64 program_id) {
-    // Custom textures are currently stored as
-    // [TitleID]/tex1_[width]x[height]_[64-bit hash]_[format].png
+    const std::string pack_path = GetCustomTexPackPath(program_id);
+    if (FileUtil::Exists(pack_path)) {
+        AddTexturePack(pack_path);
+    }
 
     const std::string load_path = fmt::format(
         "{}textures/{:016X}/", FileUtil::GetUserPath(FileUtil::UserPath::LoadDir), program_id);
 
-    if (FileUtil::Exists(load_path)) {
-        FileUtil::FSTEntry texture_dir;
-        std::vector<FileUtil::FSTEntry> textures;
-        // 64 nested folders should be plenty for most cases
-        FileUtil::ScanDirectoryTree(load_path, texture_dir, 64);
-        FileUtil::GetAllFilesFromNestedEntries(texture_dir, textures);
-
-        for (const auto& file : textures) {
-            if (file.isDirectory)
-                continue;
-            if (file.virtualName.substr(0, 5) != "tex1_")
-                continue;
-
-            u32 width;
-            u32 height;
-            u64 hash;
-            u32 format; // unused
-            // TODO: more modern way of doing this
-            if (std::sscanf(file.virtualName.c_str(), "tex1_%ux%u_%llX_%u.png", &width, &height,
-                            &hash, &format) == 4) {
-                AddTexturePath(hash, file.physicalName);
-            }
-        }
+    for (const auto& path_info : ScanTextureDirectory(load_path)) {
+        AddTexturePath(path_info.hash, path_info.path);
     }
+
+    CreateWorkers();
 }
 
-void CustomTexCache::PreloadTextures(Frontend::ImageInterface& image_interface) {
-    for (const auto& path : custom_texture_paths) {
-        const auto& path_info = path.second;
-        Core::CustomTexInfo tex_info;
-        if (image_interface.DecodePNG(tex_info.tex, tex_info.width, tex_info.height,
-                                      path_info.path)) {
-            // Make sure the texture size is a power of 2
-            std::bitset<32> width_bits(tex_info.width);
-            std::bitset<32> height_bits(tex_info.height);
-            if (width_bits.count() == 1 && height_bits.count() == 1) {
-                LOG_DEBUG(Render_OpenGL, "Loaded custom texture from {}", path_info.path);
-                Common::FlipRGBA8Texture(tex_info.tex, tex_info.width, tex_info.height);
-                CacheTexture(path_info.hash, tex_info.tex, tex_info.width, tex_info.height);
-            } else {
-                LOG_ERROR(Render_OpenGL, "Texture {} size is not a power of 2", path_info.path);
+void CustomTexCache::PreloadTextures() {
+    if (!workers) {
+        return;
+    }
+
+    std::size_t queued_count = 0;
+    {
+        std::scoped_lock lock{mutex};
+        for (const auto& [hash, path_info] : custom_texture_paths) {
+            if (QueueTexture(hash, Priority::Preload)) {
+                queued_count++;
             }
-        } else {
-            LOG_ERROR(Render_OpenGL, "Failed to load custom texture {}", path_info.path);
         }
     }
+
+    for (std::size_t i = 0; i < queued_count; i++) {
+        workers->QueueWork([this] { DecodeNext(); });
+    }
+
+    if (!Settings::values.async_custom_loading) {
+        workers->WaitForRequests();
+    }
 }
 
 bool CustomTexCache::CustomTextureExists(u64 hash) const {
@@ -106,4 +192,171 @@ const CustomTexPathInfo& CustomTexCache::LookupTexturePathInfo(u64 hash) const {
 bool CustomTexCache::IsTexturePathMapEmpty() const {
     return custom_texture_paths.size() == 0;
 }
+
+std::vector<CustomTexPathInfo> CustomTexCache::ScanTextureDirectory(const std::string& load_path) {
+    // Custom textures are currently stored as
+    // [TitleID]/tex1_[width]x[height]_[64-bit hash]_[format].png
+    std::vector<CustomTexPathInfo> texture_paths;
+    if (!FileUtil::Exists(load_path)) {
+        return texture_paths;
+    }
+
+    FileUtil::FSTEntry texture_dir;
+    std::vector<FileUtil::FSTEntry> textures;
+    // 64 nested folders should be plenty for most cases
+    FileUtil::ScanDirectoryTree(load_path, texture_dir, 64);
+    FileUtil::GetAllFilesFromNestedEntries(texture_dir, textures);
+
+    for (const auto& file : textures) {
+        if (file.isDirectory)
+            continue;
+        if (file.virtualName.substr(0, 5) != "tex1_")
+            continue;
+
+        u32 width;
+        u32 height;
+        u64 hash;
+        u32 format; // unused
+        // TODO: more modern way of doing this
+        if (std::sscanf(file.virtualName.c_str(), "tex1_%ux%u_%llX_%u.png", &width, &height,
+                        &hash, &format) == 4) {
+            texture_paths.push_back({file.physicalName, hash});
+        }
+    }
+
+    return texture_paths;
+}
+
+std::shared_ptr<CustomTexInfo> CustomTexCache::DecodePNGTexture(
+    Frontend::ImageInterface& image_interface, const std::string& path) {
+    auto tex_info = std::make_shared<CustomTexInfo>();
+    if (!image_interface.DecodePNG(tex_info->tex, tex_info->width, tex_info->height, path)) {
+        LOG_ERROR(Render_OpenGL, "Failed to load custom texture {}", path);
+        return nullptr;
+    }
+
+    // Make sure the texture size is a power of 2
+    const std::bitset<32> width_bits(tex_info->width);
+    const std::bitset<32> height_bits(tex_info->height);
+    if (width_bits.count() != 1 || height_bits.count() != 1) {
+        LOG_ERROR(Render_OpenGL, "Texture {} size is not a power of 2", path);
+        return nullptr;
+    }
+
+    LOG_DEBUG(Render_OpenGL, "Loaded custom texture from {}", path);
+    Common::FlipRGBA8Texture(tex_info->tex, tex_info->width, tex_info->height);
+    return tex_info;
+}
+
+bool CustomTexCache::QueueTexture(u64 hash, Priority priority) {
+    if (custom_textures.contains(hash) || decoding_textures.contains(hash) ||
+        failed_textures.contains(hash)) {
+        return false;
+    }
+
+    // The queue is ordered by priority, entries of the same priority in request order
+    const auto insert_before = [this](Priority queued_priority) {
+        return std::find_if(decode_queue.begin(), decode_queue.end(),
+                            [queued_priority](const QueuedTexture& queued) {
+                                return queued.priority > queued_priority;
+                            });
+    };
+
+    if (queued_textures.contains(hash)) {
+        if (priority != Priority::Request) {
+            return false;
+        }
+
+        // Promote the queued entry so the texture is decoded next, without queueing more work
+        std::erase_if(decode_queue,
+                      [hash](const QueuedTexture& queued) { return queued.hash == hash; });
+        decode_queue.insert(insert_before(priority), QueuedTexture{hash, priority});
+        return false;
+    }
+
+    queued_textures.insert(hash);
+    if (priority == Priority::Preload) {
+        decode_queue.push_back(QueuedTexture{hash, priority});
+    } else {
+        decode_queue.insert(insert_before(priority), QueuedTexture{hash, priority});
+    }
+
+    return true;
+}
+
+void CustomTexCache::DecodeNext() {
+    u64 hash;
+    {
+        std::scoped_lock lock{mutex};
+        if (decode_queue.empty()) {
+            // The texture was decoded by LoadTexture in the meantime
+            return;
+        }
+
+        const QueuedTexture queued = decode_queue.front();
+        decode_queue.pop_front();
+        queued_textures.erase(queued.hash);
+
+        const std::size_t budget = GetBudget();
+        const bool over_budget = budget != 0 && cached_bytes >= budget;
+        if (stopping || (queued.priority != Priority::Request && over_budget)) {
+            return;
+        }
+
+        hash = queued.hash;
+        decoding_textures.insert(hash);
+    }
+
+    InsertTexture(hash, DecodeTexture(hash));
+}
+
+std::shared_ptr<const CustomTexInfo> CustomTexCache::DecodeTexture(u64 hash) const {
+    const auto& path_info = custom_texture_paths.at(hash);
+    if (path_info.packed) {
+        return texture_pack->ReadTexture(hash);
+    }
+
+    return DecodePNGTexture(*image_interface, path_info.path);
+}
+
+void CustomTexCache::InsertTexture(u64 hash, std::shared_ptr<const CustomTexInfo> info) {
+    {
+        std::scoped_lock lock{mutex};
+        decoding_textures.erase(hash);
+
+        if (!info) {
+            failed_textures.insert(hash);
+        } else {
+            cached_bytes += info->tex.size();
+            lru_textures.push_back(hash);
+            custom_textures.emplace(hash,
+                                    CachedTexture{std::move(info), std::prev(lru_textures.end())});
+
+            // Surfaces keep their textures alive, eviction only drops the reference of the cache
+            const std::size_t budget = GetBudget();
+            while (budget != 0 && cached_bytes > budget && lru_textures.size() > 1) {
+                const auto it = custom_textures.find(lru_textures.front());
+                cached_bytes -= it->second.info->tex.size();
+                custom_textures.erase(it);
+                lru_textures.pop_front();
+            }
+        }
+    }
+
+    decode_cv.notify_all();
+}
+
+std::size_t CustomTexCache::GetBudget() const {
+    return static_cast<std::size_t>(Settings::values.custom_textures_budget) * 1024 * 1024;
+}
+
+void CustomTexCache::CreateWorkers() {
+    if (custom_texture_paths.empty() || workers) {
+        return;
+    }
+
+    const std::size_t num_workers = std::max(std::thread::hardware_concurrency() / 2, 1U);
+    workers = std::make_unique<Common::ThreadWorker>(num_workers, "CustomTexDecoder");
+}
+
 } // namespace Core
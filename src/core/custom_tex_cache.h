@@ -4,12 +4,22 @@
 
 #pragma once
 
+#include <atomic>
+#include <condition_variable>
+#include <deque>
+#include <list>
+#include <memory>
+#include <mutex>
 #include <string>
 #include <unordered_map>
 #include <unordered_set>
 #include <vector>
 #include "common/common_types.h"
 
+namespace Common {
+class ThreadWorker;
+}
+
 namespace Frontend {
 class ImageInterface;
 } // namespace Frontend
@@ -25,31 +35,115 @@ struct CustomTexInfo {
 struct CustomTexPathInfo {
     std::string path;
     u64 hash;
+    bool packed = false; ///< The texture is stored in the texture pack at path
+    std::string group;   ///< Key of the textures prefetched along with this one
 };
 
+class CustomTexPack;
+
+/**
+ * Tracks the custom textures of the running title and decodes them on a pool of worker threads.
+ * Decoded textures are shared with the surfaces using them and the least recently used ones are
+ * evicted once the memory budget is exceeded. Textures requested by the renderer are decoded
+ * before preloads, together with the textures in the same directory of the pack, which are
+ * likely to be needed soon after. Unless stated otherwise, all functions are thread-safe.
+ */
 // TODO: think of a better name for this class...
 class CustomTexCache {
 public:
-    explicit CustomTexCache();
+    explicit CustomTexCache(std::shared_ptr<Frontend::ImageInterface> image_interface);
     ~CustomTexCache();
 
-    bool IsTextureDumped(u64 hash) const;
-    void SetTextureDumped(u64 hash);
+    /// Returns the decoded texture or nullptr when it isn't decoded yet
+    std::shared_ptr<const CustomTexInfo> LookupTexture(u64 hash);
+
+    /// Returns the decoded texture, decoding it on the calling thread if it isn't yet.
+    /// Returns nullptr when the texture doesn't exist or can't be decoded.
+    std::shared_ptr<const CustomTexInfo> LoadTexture(u64 hash);
 
-    bool IsTextureCached(u64 hash) const;
-    const CustomTexInfo& LookupTexture(u64 hash) const;
-    void CacheTexture(u64 hash, const std::vector<u8>& tex, u32 width, u32 height);
+    /// Queues the texture and its neighbours in the pack for decoding ahead of any preloads
+    void RequestTexture(u64 hash);
 
+    /// Returns true when the texture is queued or being decoded
+    bool IsTextureQueued(u64 hash) const;
+
+    /// Adds a texture to the pack. Not thread-safe, must be called before decoding starts
     void AddTexturePath(u64 hash, const std::string& path);
+    /// Adds the textures of a texture pack. Not thread-safe, must be called before decoding starts
+    void AddTexturePack(const std::string& pack_path);
+    /// Finds the textures of the title, textures in its pack take precedence over loose ones.
+    /// Not thread-safe, must be called before decoding starts
     void FindCustomTextures(u64 program_id);
-    void PreloadTextures(Frontend::ImageInterface& image_interface);
+
+    /// Decodes textures on the worker threads until the memory budget is reached. Unless
+    /// async_custom_loading is enabled, this waits for the decoding to finish.
+    void PreloadTextures();
+
     bool CustomTextureExists(u64 hash) const;
     const CustomTexPathInfo& LookupTexturePathInfo(u64 hash) const;
     bool IsTexturePathMapEmpty() const;
 
+    /// Returns the loose PNG textures found under a directory
+    static std::vector<CustomTexPathInfo> ScanTextureDirectory(const std::string& load_path);
+
+    /// Decodes a PNG texture, returns nullptr when it can't be used as a custom texture
+    static std::shared_ptr<CustomTexInfo> DecodePNGTexture(
+        Frontend::ImageInterface& image_interface, const std::string& path);
+
+private:
+    enum class Priority {
+        Request,  ///< Needed by a surface, always decoded
+        Prefetch, ///< Likely needed soon, skipped when over the memory budget
+        Preload,  ///< Loaded ahead of time, skipped when over the memory budget
+    };
+
+    struct QueuedTexture {
+        u64 hash;
+        Priority priority;
+    };
+
+    struct CachedTexture {
+        std::shared_ptr<const CustomTexInfo> info;
+        std::list<u64>::iterator lru_entry;
+    };
+
+    /// Queues a texture for decoding after the queued textures of the same or higher priority.
+    /// Returns false when no additional work needs to be queued
+    bool QueueTexture(u64 hash, Priority priority);
+
+    /// Decodes the texture at the front of the queue, run by the worker threads
+    void DecodeNext();
+
+    /// Decodes the texture from the pack or its PNG, returns nullptr on failure
+    std::shared_ptr<const CustomTexInfo> DecodeTexture(u64 hash) const;
+
+    /// Stores the result of a decode and evicts textures when over the memory budget
+    void InsertTexture(u64 hash, std::shared_ptr<const CustomTexInfo> info);
+
+    /// Returns the memory budget in bytes
+    std::size_t GetBudget() const;
+
+    /// Starts the decoding threads once there are textures to decode
+    void CreateWorkers();
+
 private:
-    std::unordered_set<u64> dumped_textures;
-    std::unordered_map<u64, CustomTexInfo> custom_textures;
+    std::shared_ptr<Frontend::ImageInterface> image_interface;
+    std::unique_ptr<Common::ThreadWorker> workers;
+    std::unique_ptr<CustomTexPack> texture_pack;
+    std::atomic<bool> stopping{false};
+
     std::unordered_map<u64, CustomTexPathInfo> custom_texture_paths;
+    std::unordered_map<std::string, std::vector<u64>> directory_textures;
+
+    // Decoding state, protected by the mutex
+    mutable std::mutex mutex;
+    std::condition_variable decode_cv;
+    std::unordered_map<u64, CachedTexture> custom_textures;
+    std::list<u64> lru_textures;
+    std::size_t cached_bytes = 0;
+    std::deque<QueuedTexture> decode_queue;
+    std::unordered_set<u64> queued_textures;
+    std::unordered_set<u64> decoding_textures;
+    std::unordered_set<u64> failed_textures;
 };
 } // namespace Core
@@ -0,0 +1,225 @@
+// Copyright 2022 Citra Emulator Project
+// Licensed under GPLv2 or any later version
+// Refer to the license.txt file included.
+
+#include <algorithm>
+#include <atomic>
+#include <thread>
+#include <unordered_map>
+#include <fmt/format.h>
+#include "common/logging/log.h"
+#include "common/thread_worker.h"
+#include "common/zstd_compression.h"
+#include "core/custom_tex_pack.h"
+
+namespace Core {
+
+constexpr u32 PACK_MAGIC = 0x4B505443; // "CTPK"
+
+// Decoded textures compress well, higher levels only slow down the conversion
+constexpr s32 PACK_COMPRESSION_LEVEL = 9;
+
+// Upper bound for the dimensions of packed textures, so their decoded size can't overflow
+constexpr u32 MAX_TEXTURE_DIMENSION = 16384;
+
+bool CustomTexPack::Open(const std::string& path) {
+    file = FileUtil::IOFile(path, "rb");
+    if (!file.IsOpen()) {
+        LOG_ERROR(Core, "Failed to open texture pack {}", path);
+        return false;
+    }
+
+    Header header{};
+    if (file.ReadBytes(&header, sizeof(Header)) != sizeof(Header) || header.magic != PACK_MAGIC) {
+        LOG_ERROR(Core, "Texture pack {} is invalid", path);
+        return false;
+    }
+
+    if (header.version != VERSION) {
+        LOG_ERROR(Core, "Texture pack {} has unsupported version {}", path, header.version);
+        return false;
+    }
+
+    const u64 file_size = file.GetSize();
+    const u64 index_size = static_cast<u64>(header.num_textures) * sizeof(IndexEntry);
+    if (header.index_offset > file_size || index_size > file_size - header.index_offset) {
+        LOG_ERROR(Core, "Texture pack {} is truncated", path);
+        return false;
+    }
+
+    index.resize(header.num_textures);
+    if (!file.Seek(header.index_offset, SEEK_SET) ||
+        file.ReadArray(index.data(), index.size()) != index.size()) {
+        LOG_ERROR(Core, "Failed to read the index of texture pack {}", path);
+        index.clear();
+        return false;
+    }
+
+    const bool valid =
+        std::all_of(index.begin(), index.end(), [file_size](const IndexEntry& entry) {
+            return entry.offset <= file_size && entry.compressed_size <= file_size - entry.offset &&
+                   entry.width <= MAX_TEXTURE_DIMENSION && entry.height <= MAX_TEXTURE_DIMENSION;
+        });
+    if (!valid) {
+        LOG_ERROR(Core, "Texture pack {} has invalid entries", path);
+        index.clear();
+        return false;
+    }
+
+    std::sort(index.begin(), index.end(),
+              [](const IndexEntry& lhs, const IndexEntry& rhs) { return lhs.hash < rhs.hash; });
+
+    LOG_INFO(Core, "Opened texture pack {} with {} textures", path, index.size());
+    return true;
+}
+
+std::shared_ptr<CustomTexInfo> CustomTexPack::ReadTexture(u64 hash) {
+    const auto it = std::lower_bound(
+        index.begin(), index.end(), hash,
+        [](const IndexEntry& entry, u64 value) { return entry.hash < value; });
+    if (it == index.end() || it->hash != hash) {
+        return nullptr;
+    }
+
+    std::vector<u8> compressed(it->compressed_size);
+    {
+        std::scoped_lock lock{file_mutex};
+        if (!file.Seek(it->offset, SEEK_SET) ||
+            file.ReadBytes(compressed.data(), compressed.size()) != compressed.size()) {
+            LOG_ERROR(Core, "Failed to read packed texture {:016X}", hash);
+            file.Clear();
+            return nullptr;
+        }
+    }
+
+    // The size stored in the compressed frame is checked before anything is allocated for it
+    const std::size_t tex_size = static_cast<std::size_t>(it->width) * it->height * 4;
+    auto tex_info = std::make_shared<CustomTexInfo>();
+    tex_info->width = it->width;
+    tex_info->height = it->height;
+    tex_info->tex = Common::Compression::DecompressDataZSTD(compressed, tex_size);
+    if (tex_size == 0 || tex_info->tex.size() != tex_size) {
+        LOG_ERROR(Core, "Packed texture {:016X} is corrupted", hash);
+        return nullptr;
+    }
+
+    return tex_info;
+}
+
+bool CustomTexPackWriter::Open(const std::string& path) {
+    file = FileUtil::IOFile(path, "wb");
+    if (!file.IsOpen()) {
+        LOG_ERROR(Core, "Failed to create texture pack {}", path);
+        return false;
+    }
+
+    // The header is written again once the index offset is known
+    const CustomTexPack::Header header{};
+    return file.WriteObject(header) == 1;
+}
+
+bool CustomTexPackWriter::AddTexture(u64 hash, u32 group, const CustomTexInfo& info) {
+    const std::vector<u8> compressed = Common::Compression::CompressDataZSTD(
+        info.tex.data(), info.tex.size(), PACK_COMPRESSION_LEVEL);
+    if (compressed.empty()) {
+        return false;
+    }
+
+    std::scoped_lock lock{mutex};
+    const u64 offset = file.Tell();
+    if (file.WriteBytes(compressed.data(), compressed.size()) != compressed.size()) {
+        return false;
+    }
+
+    index.push_back(CustomTexPack::IndexEntry{
+        .hash = hash,
+        .offset = offset,
+        .compressed_size = static_cast<u32>(compressed.size()),
+        .width = info.width,
+        .height = info.height,
+        .group = group,
+    });
+    return true;
+}
+
+bool CustomTexPackWriter::Finish() {
+    std::scoped_lock lock{mutex};
+    std::sort(index.begin(), index.end(),
+              [](const auto& lhs, const auto& rhs) { return lhs.hash < rhs.hash; });
+
+    const CustomTexPack::Header header{
+        .magic = PACK_MAGIC,
+        .version = CustomTexPack::VERSION,
+        .index_offset = file.Tell(),
+        .num_textures = static_cast<u32>(index.size()),
+        .reserved = 0,
+    };
+
+    if (file.WriteArray(index.data(), index.size()) != index.size() ||
+        !file.Seek(0, SEEK_SET) || file.WriteObject(header) != 1) {
+        return false;
+    }
+
+    return file.Close();
+}
+
+std::string GetCustomTexPackPath(u64 program_id) {
+    return fmt::format("{}textures/{:016X}.pack",
+                       FileUtil::GetUserPath(FileUtil::UserPath::LoadDir), program_id);
+}
+
+std::optional<std::size_t> ConvertCustomTextures(
+    const std::string& texture_dir, const std::string& pack_path,
+    Frontend::ImageInterface& image_interface,
+    const std::function<void(std::size_t, std::size_t)>& progress) {
+    const std::vector<CustomTexPathInfo> textures =
+        CustomTexCache::ScanTextureDirectory(texture_dir);
+
+    CustomTexPackWriter writer;
+    if (!writer.Open(pack_path)) {
+        return std::nullopt;
+    }
+
+    // Textures of the same directory share a group, so they keep being prefetched together
+    std::unordered_map<std::string, u32> groups;
+    std::atomic<std::size_t> written_count{0};
+    std::atomic<bool> write_failed{false};
+    std::mutex progress_mutex;
+    std::size_t converted_count = 0;
+
+    {
+        Common::ThreadWorker workers(std::thread::hardware_concurrency(), "CustomTexConverter");
+        for (const CustomTexPathInfo& path_info : textures) {
+            const std::string& path = path_info.path;
+            const std::string directory = path.substr(0, path.find_last_of('/'));
+            const u32 group = groups.try_emplace(directory, static_cast<u32>(groups.size()))
+                                  .first->second;
+
+            workers.QueueWork([&, path_info, group] {
+                const auto tex_info = CustomTexCache::DecodePNGTexture(image_interface,
+                                                                       path_info.path);
+                if (tex_info) {
+                    if (writer.AddTexture(path_info.hash, group, *tex_info)) {
+                        written_count++;
+                    } else {
+                        write_failed = true;
+                    }
+                }
+
+                std::scoped_lock lock{progress_mutex};
+                progress(++converted_count, textures.size());
+            });
+        }
+
+        workers.WaitForRequests();
+    }
+
+    if (write_failed || !writer.Finish()) {
+        LOG_ERROR(Core, "Failed to write texture pack {}", pack_path);
+        return std::nullopt;
+    }
+
+    return written_count.load();
+}
+
+} // namespace Core
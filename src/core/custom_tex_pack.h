@@ -0,0 +1,99 @@
+// Copyright 2022 Citra Emulator Project
+// Licensed under GPLv2 or any later version
+// Refer to the license.txt file included.
+
+#pragma once
+
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <optional>
+#include <string>
+#include <vector>
+#include "common/common_types.h"
+#include "common/file_util.h"
+#include "core/custom_tex_cache.h"
+
+namespace Frontend {
+class ImageInterface;
+} // namespace Frontend
+
+namespace Core {
+
+/**
+ * Single file container for the custom textures of a title. Textures are stored already decoded
+ * and flipped as RGBA8 and compressed with zstd one by one, so loading one only takes a read and
+ * a decompression instead of decoding a PNG. The header is followed by the textures and the
+ * index sorted by hash, which is kept in memory while the pack is open.
+ */
+class CustomTexPack {
+public:
+    struct Header {
+        u32 magic;
+        u32 version;
+        u64 index_offset;
+        u32 num_textures;
+        u32 reserved;
+    };
+    static_assert(sizeof(Header) == 24, "CustomTexPack::Header has incorrect size");
+
+    struct IndexEntry {
+        u64 hash;
+        u64 offset;
+        u32 compressed_size;
+        u32 width;
+        u32 height;
+        u32 group; ///< Directory of the texture in the converted pack, used for prefetching
+    };
+    static_assert(sizeof(IndexEntry) == 32, "CustomTexPack::IndexEntry has incorrect size");
+
+    static constexpr u32 VERSION = 1;
+
+    /// Opens a pack and reads its index, returns false when the file isn't a valid pack
+    bool Open(const std::string& path);
+
+    const std::vector<IndexEntry>& GetIndex() const {
+        return index;
+    }
+
+    /// Reads and decompresses a texture, returns nullptr when it can't be read. Thread-safe.
+    std::shared_ptr<CustomTexInfo> ReadTexture(u64 hash);
+
+private:
+    std::mutex file_mutex;
+    FileUtil::IOFile file;
+    std::vector<IndexEntry> index;
+};
+
+/// Writes the textures of a new pack
+class CustomTexPackWriter {
+public:
+    /// Creates the pack file, replacing an existing one
+    bool Open(const std::string& path);
+
+    /// Compresses and appends a texture. Thread-safe.
+    bool AddTexture(u64 hash, u32 group, const CustomTexInfo& info);
+
+    /// Writes the index, the pack can't be opened before this is called
+    bool Finish();
+
+private:
+    std::mutex mutex;
+    FileUtil::IOFile file;
+    std::vector<CustomTexPack::IndexEntry> index;
+};
+
+/// Returns the path of the texture pack of a title
+std::string GetCustomTexPackPath(u64 program_id);
+
+/**
+ * Converts the loose PNG textures found under a directory into a pack.
+ * @param progress Called with the number of converted textures and the total number of textures
+ * @returns The number of textures written or std::nullopt when the pack couldn't be written
+ */
+std::optional<std::size_t> ConvertCustomTextures(
+    const std::string& texture_dir, const std::string& pack_path,
+    Frontend::ImageInterface& image_interface,
+    const std::function<void(std::size_t, std::size_t)>& progress);
+
+} // namespace Core
@@ -28,6 +28,10 @@ public:
 class Backend {
 public:
     virtual ~Backend();
+
+    /// Returns a frame to render the next dumped frame into, its buffer may be reused
+    virtual VideoFrame AcquireVideoFrame(std::size_t width, std::size_t height);
+
     virtual bool StartDumping(const std::string& path, const Layout::FramebufferLayout& layout) = 0;
     virtual void AddVideoFrame(VideoFrame frame) = 0;
     virtual void AddAudioFrame(AudioCore::StereoFrame16 frame) = 0;
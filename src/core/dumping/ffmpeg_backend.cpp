@@ -2,13 +2,16 @@
 // Licensed under GPLv2 or any later version
 // Refer to the license.txt file included.
 
+#include <algorithm>
 #include <unordered_set>
+#include "common/alignment.h"
 #include "common/assert.h"
 #include "common/file_util.h"
 #include "common/logging/log.h"
 #include "common/param_package.h"
 #include "common/string_util.h"
 #include "core/dumping/ffmpeg_backend.h"
+#include "core/dumping/yuv_converter.h"
 #include "core/hw/gpu.h"
 #include "core/settings.h"
 #include "video_core/renderer_base.h"
@@ -137,6 +140,10 @@ bool FFmpegVideoStream::Init(FFmpegMuxer& muxer, const Layout::FramebufferLayout
     if (format_context->oformat->flags & AVFMT_GLOBALHEADER)
         codec_context->flags |= AV_CODEC_FLAG_GLOBAL_HEADER;
 
+    // Let the encoder pick its thread count, the encoder options can still override this
+    codec_context->thread_count = 0;
+    codec_context->thread_type = FF_THREAD_FRAME | FF_THREAD_SLICE;
+
     AVDictionary* options = ToAVDictionary(Settings::values.video_encoder_options);
     if (avcodec_open2(codec_context.get(), codec, &options) < 0) {
         LOG_ERROR(Render, "Could not open video codec");
@@ -167,6 +174,13 @@ bool FFmpegVideoStream::Init(FFmpegMuxer& muxer, const Layout::FramebufferLayout
         return false;
     }
 
+    // YUV420P, the format used by most encoders, is converted by us on multiple threads
+    if (codec_context->pix_fmt == AV_PIX_FMT_YUV420P) {
+        conversion_workers = std::make_unique<Common::ThreadWorker>(
+            std::thread::hardware_concurrency() / 2, "VideoDumpConversion");
+        return true;
+    }
+
     // Create SWS Context
     auto* context = sws_getCachedContext(
         sws_context.get(), layout.width, layout.height, pixel_format, layout.width, layout.height,
@@ -183,6 +197,36 @@ void FFmpegVideoStream::Free() {
     current_frame.reset();
     scaled_frame.reset();
     sws_context.reset();
+    conversion_workers.reset();
+}
+
+void FFmpegVideoStream::ConvertFrame(const VideoFrame& frame) {
+    if (!conversion_workers) {
+        if (sws_context) {
+            sws_scale(sws_context.get(), current_frame->data, current_frame->linesize, 0,
+                      layout.height, scaled_frame->data, scaled_frame->linesize);
+        }
+        return;
+    }
+
+    const YUV420PPlanes planes{
+        .data = {scaled_frame->data[0], scaled_frame->data[1], scaled_frame->data[2]},
+        .strides = {static_cast<std::size_t>(scaled_frame->linesize[0]),
+                    static_cast<std::size_t>(scaled_frame->linesize[1]),
+                    static_cast<std::size_t>(scaled_frame->linesize[2])},
+    };
+
+    // Bands start at even rows so that each one covers whole rows of the chroma planes
+    const u32 num_bands = static_cast<u32>(conversion_workers->NumWorkers());
+    const u32 band_rows = Common::AlignUp((layout.height + num_bands - 1) / num_bands, 2);
+    for (u32 row = 0; row < layout.height; row += band_rows) {
+        conversion_workers->QueueWork([this, &frame, &planes, row, band_rows] {
+            ConvertBGRAToYUV420P(frame.data.data(), frame.stride, layout.width, layout.height,
+                                 row, row + band_rows, planes);
+        });
+    }
+
+    conversion_workers->WaitForRequests();
 }
 
 void FFmpegVideoStream::ProcessFrame(VideoFrame& frame) {
@@ -202,10 +246,7 @@ void FFmpegVideoStream::ProcessFrame(VideoFrame& frame) {
         LOG_ERROR(Render, "Video frame dropped: Could not prepare frame");
         return;
     }
-    if (sws_context) {
-        sws_scale(sws_context.get(), current_frame->data, current_frame->linesize, 0, layout.height,
-                  scaled_frame->data, scaled_frame->linesize);
-    }
+    ConvertFrame(frame);
     scaled_frame->pts = frame_count++;
 
     // Encode frame
@@ -507,23 +548,24 @@ bool FFmpegBackend::StartDumping(const std::string& path, const Layout::Framebuf
 
     video_layout = layout;
 
+    {
+        std::scoped_lock lock{video_queue_mutex};
+        video_frame_queue.clear();
+        video_queue_stats = {};
+    }
+
     if (video_processing_thread.joinable())
         video_processing_thread.join();
     video_processing_thread = std::thread([&] {
-        event1.Set();
         while (true) {
-            event2.Wait();
-            current_buffer = (current_buffer + 1) % 2;
-            next_buffer = (current_buffer + 1) % 2;
-            event1.Set();
-            // Process this frame
-            auto& frame = video_frame_buffers[current_buffer];
+            VideoFrame frame = PopVideoFrame();
             if (frame.width == 0 && frame.height == 0) {
                 // An empty frame marks the end of frame data
                 ffmpeg.FlushVideo();
                 break;
             }
             ffmpeg.ProcessVideoFrame(frame);
+            RecycleVideoFrame(std::move(frame));
         }
         // Finish audio execution first if not done yet
         if (audio_processing_thread.joinable())
@@ -553,10 +595,68 @@ bool FFmpegBackend::StartDumping(const std::string& path, const Layout::Framebuf
     return true;
 }
 
+VideoFrame FFmpegBackend::AcquireVideoFrame(std::size_t width, std::size_t height) {
+    VideoFrame frame;
+    frame.width = width;
+    frame.height = height;
+    frame.stride = static_cast<u32>(width * 4);
+    {
+        std::scoped_lock lock{frame_pool_mutex};
+        if (!frame_pool.empty()) {
+            frame.data = std::move(frame_pool.back());
+            frame_pool.pop_back();
+        }
+    }
+
+    frame.data.resize(width * height * 4);
+    return frame;
+}
+
 void FFmpegBackend::AddVideoFrame(VideoFrame frame) {
-    event1.Wait();
-    video_frame_buffers[next_buffer] = std::move(frame);
-    event2.Set();
+    {
+        std::unique_lock lock{video_queue_mutex};
+        if (video_frame_queue.size() >= MAX_QUEUED_FRAMES) {
+            // The encoder can't keep up, throttle emulation instead of growing the queue
+            const auto stall_begin = std::chrono::steady_clock::now();
+            frame_popped_cv.wait(lock,
+                                 [this] { return video_frame_queue.size() < MAX_QUEUED_FRAMES; });
+            video_queue_stats.stalls++;
+            video_queue_stats.stall_time += std::chrono::duration_cast<std::chrono::microseconds>(
+                std::chrono::steady_clock::now() - stall_begin);
+        }
+
+        video_frame_queue.push_back(std::move(frame));
+        video_queue_stats.max_queued_frames =
+            std::max(video_queue_stats.max_queued_frames, video_frame_queue.size());
+    }
+
+    frame_queued_cv.notify_one();
+}
+
+VideoFrame FFmpegBackend::PopVideoFrame() {
+    VideoFrame frame;
+    {
+        std::unique_lock lock{video_queue_mutex};
+        frame_queued_cv.wait(lock, [this] { return !video_frame_queue.empty(); });
+        frame = std::move(video_frame_queue.front());
+        video_frame_queue.pop_front();
+    }
+
+    frame_popped_cv.notify_one();
+    return frame;
+}
+
+void FFmpegBackend::RecycleVideoFrame(VideoFrame&& frame) {
+    {
+        std::scoped_lock lock{video_queue_mutex};
+        video_queue_stats.frames_encoded++;
+    }
+
+    // Frames in the queue, the one being encoded and the one being rendered
+    std::scoped_lock lock{frame_pool_mutex};
+    if (frame_pool.size() < MAX_QUEUED_FRAMES + 2) {
+        frame_pool.push_back(std::move(frame.data));
+    }
 }
 
 void FFmpegBackend::AddAudioFrame(AudioCore::StereoFrame16 frame) {
@@ -600,8 +700,17 @@ Layout::FramebufferLayout FFmpegBackend::GetLayout() const {
     return video_layout;
 }
 
+VideoQueueStats FFmpegBackend::GetVideoQueueStats() const {
+    std::scoped_lock lock{video_queue_mutex};
+    return video_queue_stats;
+}
+
 void FFmpegBackend::EndDumping() {
-    LOG_INFO(Render, "Ending frame dumping");
+    const VideoQueueStats stats = GetVideoQueueStats();
+    LOG_INFO(Render,
+             "Ending frame dumping: {} frames encoded, up to {} queued, {} stalls for {} ms",
+             stats.frames_encoded, stats.max_queued_frames, stats.stalls,
+             stats.stall_time.count() / 1000);
 
     ffmpeg.WriteTrailer();
     ffmpeg.Free();
@@ -5,7 +5,9 @@
 #pragma once
 
 #include <atomic>
+#include <chrono>
 #include <condition_variable>
+#include <deque>
 #include <limits>
 #include <memory>
 #include <mutex>
@@ -14,6 +16,7 @@
 #include <vector>
 #include "common/common_types.h"
 #include "common/thread.h"
+#include "common/thread_worker.h"
 #include "common/threadsafe_queue.h"
 #include "core/dumping/backend.h"
 
@@ -69,7 +72,8 @@ protected:
 
 /**
  * A FFmpegStream used for video data.
- * Rescales, encodes and writes a frame.
+ * Rescales, encodes and writes a frame. Frames for encoders taking YUV420P are converted in
+ * horizontal bands on a pool of threads, other pixel formats go through swscale.
  */
 class FFmpegVideoStream : public FFmpegStream {
 public:
@@ -86,11 +90,14 @@ private:
         }
     };
 
+    void ConvertFrame(const VideoFrame& frame);
+
     u64 frame_count{};
 
     std::unique_ptr<AVFrame, AVFrameDeleter> current_frame{};
     std::unique_ptr<AVFrame, AVFrameDeleter> scaled_frame{};
     std::unique_ptr<SwsContext, SwsContextDeleter> sws_context{};
+    std::unique_ptr<Common::ThreadWorker> conversion_workers{};
     Layout::FramebufferLayout layout;
 
     /// The pixel format the frames are stored in
@@ -160,14 +167,28 @@ private:
     friend class FFmpegStream;
 };
 
+/// Statistics of the queue of video frames waiting to be encoded
+struct VideoQueueStats {
+    u64 frames_encoded = 0;
+    std::size_t max_queued_frames = 0;
+    u64 stalls = 0; ///< Number of frames that had to wait for space in the queue
+    std::chrono::microseconds stall_time{}; ///< Time the emulation spent waiting on the encoder
+};
+
 /**
  * FFmpeg video dumping backend.
- * This class implements a double buffer.
+ * Video frames are encoded on a separate thread from a bounded queue, once it's full adding a
+ * frame blocks until the encoder catches up. The buffers of encoded frames are kept in a pool
+ * and handed out again by AcquireVideoFrame.
  */
 class FFmpegBackend : public Backend {
 public:
+    /// Maximum number of frames waiting to be encoded
+    static constexpr std::size_t MAX_QUEUED_FRAMES = 4;
+
     FFmpegBackend();
     ~FFmpegBackend() override;
+    VideoFrame AcquireVideoFrame(std::size_t width, std::size_t height) override;
     bool StartDumping(const std::string& path, const Layout::FramebufferLayout& layout) override;
     void AddVideoFrame(VideoFrame frame) override;
     void AddAudioFrame(AudioCore::StereoFrame16 frame) override;
@@ -175,20 +196,28 @@ public:
     void StopDumping() override;
     bool IsDumping() const override;
     Layout::FramebufferLayout GetLayout() const override;
+    VideoQueueStats GetVideoQueueStats() const;
 
 private:
     void EndDumping();
+    VideoFrame PopVideoFrame();
+    void RecycleVideoFrame(VideoFrame&& frame);
 
     std::atomic_bool is_dumping = false; ///< Whether the backend is currently dumping
 
     FFmpegMuxer ffmpeg{};
 
     Layout::FramebufferLayout video_layout;
-    std::array<VideoFrame, 2> video_frame_buffers;
-    u32 current_buffer = 0, next_buffer = 1;
-    Common::Event event1, event2;
+    mutable std::mutex video_queue_mutex;
+    std::condition_variable frame_queued_cv;
+    std::condition_variable frame_popped_cv;
+    std::deque<VideoFrame> video_frame_queue;
+    VideoQueueStats video_queue_stats{};
     std::thread video_processing_thread;
 
+    std::mutex frame_pool_mutex;
+    std::vector<std::vector<u8>> frame_pool;
+
     std::array<Common::SPSCQueue<VariableAudioFrame>, 2> audio_frame_queues;
     std::thread audio_processing_thread;
 
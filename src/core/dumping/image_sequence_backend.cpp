@@ -0,0 +1,154 @@
+// Copyright 2022 Citra Emulator Project
+// Licensed under GPLv2 or any later version
+// Refer to the license.txt file included.
+
+#include <algorithm>
+#include <thread>
+#include <fmt/format.h>
+#include "common/logging/log.h"
+#include "common/swap.h"
+#include "core/dumping/image_sequence_backend.h"
+#include "core/frontend/image_interface.h"
+
+namespace VideoDumper {
+
+constexpr std::string_view AUDIO_FILE = "audio.wav";
+
+/// Canonical header of a 16-bit PCM stereo WAV file
+struct WAVHeader {
+    std::array<char, 4> riff_id{'R', 'I', 'F', 'F'};
+    u32_le riff_size;
+    std::array<char, 4> wave_id{'W', 'A', 'V', 'E'};
+    std::array<char, 4> fmt_id{'f', 'm', 't', ' '};
+    u32_le fmt_size{16};
+    u16_le audio_format{1};
+    u16_le num_channels{2};
+    u32_le sample_rate{AudioCore::native_sample_rate};
+    u32_le byte_rate{AudioCore::native_sample_rate * 4};
+    u16_le block_align{4};
+    u16_le bits_per_sample{16};
+    std::array<char, 4> data_id{'d', 'a', 't', 'a'};
+    u32_le data_size;
+};
+static_assert(sizeof(WAVHeader) == 44, "WAVHeader has incorrect size");
+
+ImageSequenceBackend::ImageSequenceBackend(
+    std::shared_ptr<Frontend::ImageInterface> image_interface)
+    : image_interface{std::move(image_interface)},
+      encoders{std::max(std::thread::hardware_concurrency(), 2U) - 1, "ImageSequenceEncoder"} {}
+
+ImageSequenceBackend::~ImageSequenceBackend() {
+    if (is_dumping) {
+        StopDumping();
+    }
+}
+
+bool ImageSequenceBackend::StartDumping(const std::string& path,
+                                        const Layout::FramebufferLayout& layout) {
+    directory = path;
+    if (directory.empty() || directory.back() != '/') {
+        directory += '/';
+    }
+
+    if (!FileUtil::CreateFullPath(directory)) {
+        LOG_ERROR(Render, "Unable to create {}", directory);
+        return false;
+    }
+
+    audio_file = FileUtil::IOFile(directory + std::string{AUDIO_FILE}, "wb");
+    if (!audio_file.IsOpen()) {
+        LOG_ERROR(Render, "Unable to open {}{}", directory, AUDIO_FILE);
+        return false;
+    }
+
+    audio_bytes = 0;
+    WriteWAVHeader();
+
+    video_layout = layout;
+    frame_count = 0;
+    is_dumping = true;
+    LOG_INFO(Render, "Dumping frames to {}", directory);
+    return true;
+}
+
+void ImageSequenceBackend::AddVideoFrame(VideoFrame frame) {
+    if (!is_dumping) {
+        return;
+    }
+
+    // Uncapped emulation produces frames faster than they can be encoded, so throttle it
+    if (encoders.NumPendingTasks() >= MAX_QUEUED_FRAMES) {
+        encoders.WaitForRequests();
+    }
+
+    const std::string path = fmt::format("{}{:08d}.png", directory, frame_count++);
+    encoders.QueueWork([this, path, frame = std::move(frame)]() mutable {
+        WriteFrame(path, frame);
+    });
+}
+
+void ImageSequenceBackend::WriteFrame(const std::string& path, VideoFrame& frame) {
+    std::vector<u8> rgba(frame.width * frame.height * 4);
+    for (std::size_t y = 0; y < frame.height; y++) {
+        const u8* src = frame.data.data() + y * frame.stride;
+        u8* dst = rgba.data() + y * frame.width * 4;
+        for (std::size_t x = 0; x < frame.width; x++) {
+            dst[x * 4] = src[x * 4 + 2];
+            dst[x * 4 + 1] = src[x * 4 + 1];
+            dst[x * 4 + 2] = src[x * 4];
+            dst[x * 4 + 3] = 255;
+        }
+    }
+
+    if (!image_interface->EncodePNG(path, rgba, static_cast<u32>(frame.width),
+                                    static_cast<u32>(frame.height))) {
+        LOG_ERROR(Render, "Failed to write frame {}", path);
+    }
+}
+
+void ImageSequenceBackend::AddAudioFrame(AudioCore::StereoFrame16 frame) {
+    std::scoped_lock lock{audio_mutex};
+    if (audio_file.IsOpen()) {
+        audio_bytes += static_cast<u32>(audio_file.WriteArray(frame.data(), frame.size()) * 4);
+    }
+}
+
+void ImageSequenceBackend::AddAudioSample(const std::array<s16, 2>& sample) {
+    std::scoped_lock lock{audio_mutex};
+    if (audio_file.IsOpen()) {
+        audio_bytes += static_cast<u32>(audio_file.WriteObject(sample) * 4);
+    }
+}
+
+void ImageSequenceBackend::WriteWAVHeader() {
+    WAVHeader header{};
+    header.riff_size = static_cast<u32>(sizeof(WAVHeader) - 8 + audio_bytes);
+    header.data_size = audio_bytes;
+
+    audio_file.Seek(0, SEEK_SET);
+    audio_file.WriteObject(header);
+    audio_file.Seek(0, SEEK_END);
+}
+
+void ImageSequenceBackend::StopDumping() {
+    is_dumping = false;
+    encoders.WaitForRequests();
+
+    std::scoped_lock lock{audio_mutex};
+    if (audio_file.IsOpen()) {
+        WriteWAVHeader();
+        audio_file.Close();
+    }
+
+    LOG_INFO(Render, "Dumped {} frames to {}", frame_count, directory);
+}
+
+bool ImageSequenceBackend::IsDumping() const {
+    return is_dumping.load(std::memory_order_relaxed);
+}
+
+Layout::FramebufferLayout ImageSequenceBackend::GetLayout() const {
+    return video_layout;
+}
+
+} // namespace VideoDumper
@@ -0,0 +1,59 @@
+// Copyright 2022 Citra Emulator Project
+// Licensed under GPLv2 or any later version
+// Refer to the license.txt file included.
+
+#pragma once
+
+#include <atomic>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <vector>
+#include "common/file_util.h"
+#include "common/thread_worker.h"
+#include "core/dumping/backend.h"
+
+namespace Frontend {
+class ImageInterface;
+}
+
+namespace VideoDumper {
+
+/**
+ * Dumps every video frame to a numbered PNG file and the audio to a WAV file in a directory,
+ * for tools that consume raw image sequences. Frames are encoded on a worker pool.
+ */
+class ImageSequenceBackend : public Backend {
+public:
+    /// Maximum number of frames waiting to be encoded before the emulation thread blocks
+    static constexpr std::size_t MAX_QUEUED_FRAMES = 8;
+
+    explicit ImageSequenceBackend(std::shared_ptr<Frontend::ImageInterface> image_interface);
+    ~ImageSequenceBackend() override;
+
+    bool StartDumping(const std::string& path, const Layout::FramebufferLayout& layout) override;
+    void AddVideoFrame(VideoFrame frame) override;
+    void AddAudioFrame(AudioCore::StereoFrame16 frame) override;
+    void AddAudioSample(const std::array<s16, 2>& sample) override;
+    void StopDumping() override;
+    bool IsDumping() const override;
+    Layout::FramebufferLayout GetLayout() const override;
+
+private:
+    void WriteFrame(const std::string& path, VideoFrame& frame);
+    void WriteWAVHeader();
+
+    std::shared_ptr<Frontend::ImageInterface> image_interface;
+    std::atomic_bool is_dumping = false; ///< Whether the backend is currently dumping
+
+    std::string directory;
+    Layout::FramebufferLayout video_layout;
+    u64 frame_count = 0;
+    Common::ThreadWorker encoders;
+
+    std::mutex audio_mutex;
+    FileUtil::IOFile audio_file;
+    u32 audio_bytes = 0;
+};
+
+} // namespace VideoDumper
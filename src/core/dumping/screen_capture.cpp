@@ -0,0 +1,124 @@
+// Copyright 2022 Citra Emulator Project
+// Licensed under GPLv2 or any later version
+// Refer to the license.txt file included.
+
+#include <algorithm>
+#include "common/color.h"
+#include "common/logging/log.h"
+#include "core/dumping/backend.h"
+#include "core/dumping/screen_capture.h"
+#include "core/memory.h"
+#include "video_core/common/rasterizer.h"
+#include "video_core/common/renderer.h"
+#include "video_core/video_core.h"
+
+namespace VideoDumper {
+
+using PixelFormat = GPU::Regs::PixelFormat;
+
+template <PixelFormat format>
+static Common::Vec4<u8> DecodePixel(const u8* bytes) {
+    if constexpr (format == PixelFormat::RGBA8) {
+        return Color::DecodeRGBA8(bytes);
+    } else if constexpr (format == PixelFormat::RGB8) {
+        return Color::DecodeRGB8(bytes);
+    } else if constexpr (format == PixelFormat::RGB565) {
+        return Color::DecodeRGB565(bytes);
+    } else if constexpr (format == PixelFormat::RGB5A1) {
+        return Color::DecodeRGB5A1(bytes);
+    } else {
+        return Color::DecodeRGBA4(bytes);
+    }
+}
+
+template <PixelFormat format>
+static void ComposeScreenImpl(const u8* framebuffer, const GPU::Regs::FramebufferConfig& config,
+                              const Common::Rectangle<u32>& rect, bool is_rotated,
+                              VideoFrame& frame) {
+    constexpr u32 bytes_per_pixel = format == PixelFormat::RGBA8  ? 4
+                                    : format == PixelFormat::RGB8 ? 3
+                                                                  : 2;
+    const u32 fb_width = config.width;
+    const u32 fb_height = config.height;
+    const u32 width = rect.GetWidth();
+    const u32 height = rect.GetHeight();
+    if (fb_width == 0 || fb_height == 0 || width == 0 || height == 0 ||
+        rect.left >= frame.width || rect.top >= frame.height) {
+        return;
+    }
+
+    const u32 x_end = std::min<u32>(width, static_cast<u32>(frame.width) - rect.left);
+    const u32 y_end = std::min<u32>(height, static_cast<u32>(frame.height) - rect.top);
+    for (u32 y = 0; y < y_end; y++) {
+        u8* dst = frame.data.data() + (rect.top + y) * frame.stride + rect.left * 4;
+        for (u32 x = 0; x < x_end; x++) {
+            // Framebuffer rows are LCD columns, see DisplayRenderer::DrawSingleScreen
+            const u32 row = is_rotated ? x * fb_height / width
+                                       : fb_height - 1 - y * fb_height / height;
+            const u32 column = is_rotated ? fb_width - 1 - y * fb_width / height
+                                          : fb_width - 1 - x * fb_width / width;
+            const auto color =
+                DecodePixel<format>(framebuffer + row * config.stride + column * bytes_per_pixel);
+
+            dst[x * 4] = color.b();
+            dst[x * 4 + 1] = color.g();
+            dst[x * 4 + 2] = color.r();
+            dst[x * 4 + 3] = 255;
+        }
+    }
+}
+
+void ComposeScreen(const u8* framebuffer, const GPU::Regs::FramebufferConfig& config,
+                   const Common::Rectangle<u32>& rect, bool is_rotated, VideoFrame& frame) {
+    switch (config.color_format) {
+    case PixelFormat::RGBA8:
+        return ComposeScreenImpl<PixelFormat::RGBA8>(framebuffer, config, rect, is_rotated, frame);
+    case PixelFormat::RGB8:
+        return ComposeScreenImpl<PixelFormat::RGB8>(framebuffer, config, rect, is_rotated, frame);
+    case PixelFormat::RGB565:
+        return ComposeScreenImpl<PixelFormat::RGB565>(framebuffer, config, rect, is_rotated,
+                                                      frame);
+    case PixelFormat::RGB5A1:
+        return ComposeScreenImpl<PixelFormat::RGB5A1>(framebuffer, config, rect, is_rotated,
+                                                      frame);
+    case PixelFormat::RGBA4:
+        return ComposeScreenImpl<PixelFormat::RGBA4>(framebuffer, config, rect, is_rotated,
+                                                     frame);
+    default:
+        LOG_ERROR(Render, "Unknown framebuffer format {}", config.format);
+    }
+}
+
+void CaptureVideoFrame(Backend& backend, Memory::MemorySystem& memory) {
+    const auto layout = backend.GetLayout();
+    VideoFrame frame = backend.AcquireVideoFrame(layout.width, layout.height);
+    std::fill(frame.data.begin(), frame.data.end(), u8{0});
+
+    const auto capture_screen = [&](const GPU::Regs::FramebufferConfig& config,
+                                    const Common::Rectangle<u32>& rect) {
+        const PAddr address = config.active_fb == 0 ? config.address_left1 : config.address_left2;
+        const u32 size = config.stride * config.height;
+
+        // The hardware renderer may only have the framebuffer in its surface cache
+        VideoCore::g_renderer->Rasterizer()->FlushRegion(address, size);
+
+        const u8* framebuffer = memory.GetPhysicalPointer(address);
+        if (!framebuffer) {
+            LOG_WARNING(Render, "Framebuffer at 0x{:08X} is not in mapped memory", address);
+            return;
+        }
+
+        ComposeScreen(framebuffer, config, rect, layout.is_rotated, frame);
+    };
+
+    if (layout.top_screen_enabled) {
+        capture_screen(GPU::g_regs.framebuffer_config[0], layout.top_screen);
+    }
+    if (layout.bottom_screen_enabled) {
+        capture_screen(GPU::g_regs.framebuffer_config[1], layout.bottom_screen);
+    }
+
+    backend.AddVideoFrame(std::move(frame));
+}
+
+} // namespace VideoDumper
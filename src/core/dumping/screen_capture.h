@@ -0,0 +1,39 @@
+// Copyright 2022 Citra Emulator Project
+// Licensed under GPLv2 or any later version
+// Refer to the license.txt file included.
+
+#pragma once
+
+#include "common/common_types.h"
+#include "common/math_util.h"
+#include "core/hw/gpu.h"
+
+namespace Memory {
+class MemorySystem;
+}
+
+namespace VideoDumper {
+
+class Backend;
+class VideoFrame;
+
+/**
+ * Draws an LCD framebuffer of the emulated GPU into a region of a BGRA frame. The framebuffer
+ * is stored rotated like the LCD panels, so it is rotated back according to the layout and
+ * scaled to the region with nearest neighbour sampling.
+ * @param framebuffer Framebuffer contents in the format described by config
+ * @param rect Region of the frame to draw to, in top-down coordinates
+ * @param is_rotated Whether the layout shows the screens rotated, see FramebufferLayout
+ */
+void ComposeScreen(const u8* framebuffer, const GPU::Regs::FramebufferConfig& config,
+                   const Common::Rectangle<u32>& rect, bool is_rotated, VideoFrame& frame);
+
+/**
+ * Captures the displayed framebuffers of both screens from emulated memory and adds them to the
+ * backend as a frame of its layout. This works for every renderer as the rasterizer cache is
+ * flushed to memory first, so it should be called once per VBlank. The framebuffers are at
+ * native resolution, so the layout should be too, or the screens get upscaled without any detail.
+ */
+void CaptureVideoFrame(Backend& backend, Memory::MemorySystem& memory);
+
+} // namespace VideoDumper
@@ -0,0 +1,66 @@
+// Copyright 2022 Citra Emulator Project
+// Licensed under GPLv2 or any later version
+// Refer to the license.txt file included.
+
+#include <algorithm>
+#include "common/assert.h"
+#include "core/dumping/yuv_converter.h"
+
+namespace VideoDumper {
+
+// 8.8 fixed point BT.601 limited range coefficients
+static constexpr s32 ComputeY(s32 r, s32 g, s32 b) {
+    return ((66 * r + 129 * g + 25 * b + 128) >> 8) + 16;
+}
+
+// Chroma is computed from the sum of a 2x2 block, which adds two more fractional bits
+static constexpr s32 ComputeU(s32 r, s32 g, s32 b) {
+    return ((-38 * r - 74 * g + 112 * b + 512) >> 10) + 128;
+}
+
+static constexpr s32 ComputeV(s32 r, s32 g, s32 b) {
+    return ((112 * r - 94 * g - 18 * b + 512) >> 10) + 128;
+}
+
+void ConvertBGRAToYUV420P(const u8* src, std::size_t src_stride, u32 width, u32 height,
+                          u32 row_begin, u32 row_end, const YUV420PPlanes& dst) {
+    ASSERT_MSG(row_begin % 2 == 0, "Conversion must start at an even row");
+    row_end = std::min(row_end, height);
+
+    const auto [y_plane, u_plane, v_plane] = dst.data;
+    const auto [y_stride, u_stride, v_stride] = dst.strides;
+
+    for (u32 y = row_begin; y < row_end; y += 2) {
+        // The last row of images with an odd height is used for both rows of the chroma block
+        const u32 next_y = std::min(y + 1, height - 1);
+        const u8* row0 = src + y * src_stride;
+        const u8* row1 = src + next_y * src_stride;
+        u8* y_row0 = y_plane + y * y_stride;
+        u8* y_row1 = y_plane + next_y * y_stride;
+
+        // The loops only use plain integer arithmetic so the compiler can vectorize them
+        for (u32 x = 0; x < width; x++) {
+            y_row0[x] = static_cast<u8>(ComputeY(row0[x * 4 + 2], row0[x * 4 + 1], row0[x * 4]));
+        }
+
+        for (u32 x = 0; x < width; x++) {
+            y_row1[x] = static_cast<u8>(ComputeY(row1[x * 4 + 2], row1[x * 4 + 1], row1[x * 4]));
+        }
+
+        u8* u_row = u_plane + (y / 2) * u_stride;
+        u8* v_row = v_plane + (y / 2) * v_stride;
+        for (u32 x = 0; x < width; x += 2) {
+            const u32 next_x = std::min(x + 1, width - 1);
+            const s32 b = row0[x * 4] + row0[next_x * 4] + row1[x * 4] + row1[next_x * 4];
+            const s32 g = row0[x * 4 + 1] + row0[next_x * 4 + 1] + row1[x * 4 + 1] +
+                          row1[next_x * 4 + 1];
+            const s32 r = row0[x * 4 + 2] + row0[next_x * 4 + 2] + row1[x * 4 + 2] +
+                          row1[next_x * 4 + 2];
+
+            u_row[x / 2] = static_cast<u8>(ComputeU(r, g, b));
+            v_row[x / 2] = static_cast<u8>(ComputeV(r, g, b));
+        }
+    }
+}
+
+} // namespace VideoDumper
@@ -0,0 +1,31 @@
+// Copyright 2022 Citra Emulator Project
+// Licensed under GPLv2 or any later version
+// Refer to the license.txt file included.
+
+#pragma once
+
+#include <array>
+#include <cstddef>
+#include "common/common_types.h"
+
+namespace VideoDumper {
+
+/// Destination planes of a YUV 4:2:0 planar image
+struct YUV420PPlanes {
+    std::array<u8*, 3> data;
+    std::array<std::size_t, 3> strides;
+};
+
+/**
+ * Converts a range of rows of a BGRA image to YUV 4:2:0 planar with BT.601 limited range
+ * coefficients, the default of swscale. Chroma is averaged over 2x2 blocks, so disjoint row
+ * ranges starting at even rows can be converted in parallel.
+ * @param src BGRA image, top row first
+ * @param src_stride Size in bytes of a row of the source image
+ * @param row_begin First row to convert, must be even
+ * @param row_end Row after the last row to convert
+ */
+void ConvertBGRAToYUV420P(const u8* src, std::size_t src_stride, u32 width, u32 height,
+                          u32 row_begin, u32 row_end, const YUV420PPlanes& dst);
+
+} // namespace VideoDumper
@@ -518,8 +518,13 @@ void Y2R_U::StartConversion(Kernel::HLERequestContext& ctx) {
     // dst_image_size would seem to be perfect for this, but it doesn't include the gap :(
     u32 total_output_size =
         conversion.input_lines * (conversion.dst.transfer_unit + conversion.dst.gap);
-    Memory::RasterizerFlushVirtualRegion(conversion.dst.address, total_output_size,
-                                         Memory::FlushMode::FlushAndInvalidate);
+    // When the conversion overwrites the whole output region, surfaces cached there are dropped
+    // without downloading their contents first. This is the common case of videos decoded into
+    // a texture or framebuffer that is already cached by the rasterizer.
+    const auto flush_mode = HW::Y2R::OverwritesOutputRegion(conversion, total_output_size)
+                                ? Memory::FlushMode::Invalidate
+                                : Memory::FlushMode::FlushAndInvalidate;
+    Memory::RasterizerFlushVirtualRegion(conversion.dst.address, total_output_size, flush_mode);
 
     HW::Y2R::PerformConversion(system.Memory(), conversion);
 
@@ -3,26 +3,31 @@
 // Refer to the license.txt file included.
 
 #include <cstring>
+#include <memory>
 #include <numeric>
+#include <span>
 #include <type_traits>
+#include <vector>
 #include "common/alignment.h"
-#include "common/color.h"
 #include "common/common_types.h"
 #include "common/logging/log.h"
 #include "common/microprofile.h"
-#include "common/vector_math.h"
 #include "core/core.h"
 #include "core/core_timing.h"
+#include "core/dumping/backend.h"
+#include "core/dumping/screen_capture.h"
 #include "core/hle/service/gsp/gsp.h"
 #include "core/hw/gpu.h"
+#include "core/hw/gpu_thread.h"
+#include "core/hw/gpu_transfer.h"
 #include "core/hw/hw.h"
 #include "core/memory.h"
+#include "core/settings.h"
 #include "core/tracer/recorder.h"
 #include "video_core/command_processor.h"
 #include "video_core/debug_utils/debug_utils.h"
 #include "video_core/common/rasterizer.h"
 #include "video_core/common/renderer.h"
-#include "video_core/utils.h"
 #include "video_core/video_core.h"
 
 namespace GPU {
@@ -32,6 +37,13 @@ Memory::MemorySystem* g_memory;
 
 /// Event id for CoreTiming
 static Core::TimingEventType* vblank_event;
+static Core::TimingEventType* completion_event;
+
+/// Delay between queuing work on the GPU thread and delivering the interrupts it raises
+constexpr u64 gpu_thread_sync_ticks = BASE_CLOCK_RATE_ARM11 / 10000;
+
+/// Executes triggered GPU work when the GPU thread is enabled
+static std::unique_ptr<GPUThread> gpu_thread;
 
 template <typename T>
 inline void Read(T& var, const u32 raw_addr) {
@@ -44,34 +56,15 @@ inline void Read(T& var, const u32 raw_addr) {
         return;
     }
 
-    var = g_regs[addr / 4];
-}
-
-static Common::Vec4<u8> DecodePixel(Regs::PixelFormat input_format, const u8* src_pixel) {
-    switch (input_format) {
-    case Regs::PixelFormat::RGBA8:
-        return Color::DecodeRGBA8(src_pixel);
-
-    case Regs::PixelFormat::RGB8:
-        return Color::DecodeRGB8(src_pixel);
+    // The guest may be polling for the completion of work queued on the GPU thread
+    SyncGPUThread();
 
-    case Regs::PixelFormat::RGB565:
-        return Color::DecodeRGB565(src_pixel);
-
-    case Regs::PixelFormat::RGB5A1:
-        return Color::DecodeRGB5A1(src_pixel);
-
-    case Regs::PixelFormat::RGBA4:
-        return Color::DecodeRGBA4(src_pixel);
-
-    default:
-        LOG_ERROR(HW_GPU, "Unknown source framebuffer format {:x}", input_format);
-        return {0, 0, 0, 0};
-    }
+    var = g_regs[addr / 4];
 }
 
 MICROPROFILE_DEFINE(GPU_DisplayTransfer, "GPU", "DisplayTransfer", MP_RGB(100, 100, 255));
 MICROPROFILE_DEFINE(GPU_CmdlistProcessing, "GPU", "Cmdlist Processing", MP_RGB(100, 255, 100));
+MICROPROFILE_DEFINE(GPU_ThreadSync, "GPU", "GPU Thread Sync", MP_RGB(255, 100, 100));
 
 static void MemoryFill(const Regs::MemoryFillConfig& config) {
     const PAddr start_addr = config.GetStartAddress();
@@ -103,27 +96,7 @@ static void MemoryFill(const Regs::MemoryFillConfig& config) {
     Memory::RasterizerInvalidateRegion(config.GetStartAddress(),
                                        config.GetEndAddress() - config.GetStartAddress());
 
-    if (config.fill_24bit) {
-        // fill with 24-bit values
-        for (u8* ptr = start; ptr < end; ptr += 3) {
-            ptr[0] = config.value_24bit_r;
-            ptr[1] = config.value_24bit_g;
-            ptr[2] = config.value_24bit_b;
-        }
-    } else if (config.fill_32bit) {
-        // fill with 32-bit values
-        if (end > start) {
-            u32 value = config.value_32bit;
-            std::size_t len = (end - start) / sizeof(u32);
-            for (std::size_t i = 0; i < len; ++i)
-                memcpy(&start[i * sizeof(u32)], &value, sizeof(u32));
-        }
-    } else {
-        // fill with 16-bit values
-        u16 value_16bit = config.value_16bit.Value();
-        for (u8* ptr = start; ptr < end; ptr += sizeof(u16))
-            memcpy(ptr, &value_16bit, sizeof(u16));
-    }
+    SoftwareMemoryFill(config, start, end);
 }
 
 static void DisplayTransfer(const Regs::DisplayTransferConfig& config) {
@@ -193,113 +166,7 @@ static void DisplayTransfer(const Regs::DisplayTransferConfig& config) {
     Memory::RasterizerFlushRegion(config.GetPhysicalInputAddress(), input_size);
     Memory::RasterizerInvalidateRegion(config.GetPhysicalOutputAddress(), output_size);
 
-    for (u32 y = 0; y < output_height; ++y) {
-        for (u32 x = 0; x < output_width; ++x) {
-            Common::Vec4<u8> src_color;
-
-            // Calculate the [x,y] position of the input image
-            // based on the current output position and the scale
-            u32 input_x = x << horizontal_scale;
-            u32 input_y = y << vertical_scale;
-
-            u32 output_y;
-            if (config.flip_vertically) {
-                // Flip the y value of the output data,
-                // we do this after calculating the [x,y] position of the input image
-                // to account for the scaling options.
-                output_y = output_height - y - 1;
-            } else {
-                output_y = y;
-            }
-
-            u32 dst_bytes_per_pixel = GPU::Regs::BytesPerPixel(config.output_format);
-            u32 src_bytes_per_pixel = GPU::Regs::BytesPerPixel(config.input_format);
-            u32 src_offset;
-            u32 dst_offset;
-
-            if (config.input_linear) {
-                if (!config.dont_swizzle) {
-                    // Interpret the input as linear and the output as tiled
-                    u32 coarse_y = output_y & ~7;
-                    u32 stride = output_width * dst_bytes_per_pixel;
-
-                    src_offset = (input_x + input_y * config.input_width) * src_bytes_per_pixel;
-                    dst_offset = VideoCore::GetMortonOffset(x, output_y, dst_bytes_per_pixel) +
-                                 coarse_y * stride;
-                } else {
-                    // Both input and output are linear
-                    src_offset = (input_x + input_y * config.input_width) * src_bytes_per_pixel;
-                    dst_offset = (x + output_y * output_width) * dst_bytes_per_pixel;
-                }
-            } else {
-                if (!config.dont_swizzle) {
-                    // Interpret the input as tiled and the output as linear
-                    u32 coarse_y = input_y & ~7;
-                    u32 stride = config.input_width * src_bytes_per_pixel;
-
-                    src_offset = VideoCore::GetMortonOffset(input_x, input_y, src_bytes_per_pixel) +
-                                 coarse_y * stride;
-                    dst_offset = (x + output_y * output_width) * dst_bytes_per_pixel;
-                } else {
-                    // Both input and output are tiled
-                    u32 out_coarse_y = output_y & ~7;
-                    u32 out_stride = output_width * dst_bytes_per_pixel;
-
-                    u32 in_coarse_y = input_y & ~7;
-                    u32 in_stride = config.input_width * src_bytes_per_pixel;
-
-                    src_offset = VideoCore::GetMortonOffset(input_x, input_y, src_bytes_per_pixel) +
-                                 in_coarse_y * in_stride;
-                    dst_offset = VideoCore::GetMortonOffset(x, output_y, dst_bytes_per_pixel) +
-                                 out_coarse_y * out_stride;
-                }
-            }
-
-            const u8* src_pixel = src_pointer + src_offset;
-            src_color = DecodePixel(config.input_format, src_pixel);
-            if (config.scaling == config.ScaleX) {
-                Common::Vec4<u8> pixel =
-                    DecodePixel(config.input_format, src_pixel + src_bytes_per_pixel);
-                src_color = ((src_color + pixel) / 2).Cast<u8>();
-            } else if (config.scaling == config.ScaleXY) {
-                Common::Vec4<u8> pixel1 =
-                    DecodePixel(config.input_format, src_pixel + 1 * src_bytes_per_pixel);
-                Common::Vec4<u8> pixel2 =
-                    DecodePixel(config.input_format, src_pixel + 2 * src_bytes_per_pixel);
-                Common::Vec4<u8> pixel3 =
-                    DecodePixel(config.input_format, src_pixel + 3 * src_bytes_per_pixel);
-                src_color = (((src_color + pixel1) + (pixel2 + pixel3)) / 4).Cast<u8>();
-            }
-
-            u8* dst_pixel = dst_pointer + dst_offset;
-            switch (config.output_format) {
-            case Regs::PixelFormat::RGBA8:
-                Color::EncodeRGBA8(src_color, dst_pixel);
-                break;
-
-            case Regs::PixelFormat::RGB8:
-                Color::EncodeRGB8(src_color, dst_pixel);
-                break;
-
-            case Regs::PixelFormat::RGB565:
-                Color::EncodeRGB565(src_color, dst_pixel);
-                break;
-
-            case Regs::PixelFormat::RGB5A1:
-                Color::EncodeRGB5A1(src_color, dst_pixel);
-                break;
-
-            case Regs::PixelFormat::RGBA4:
-                Color::EncodeRGBA4(src_color, dst_pixel);
-                break;
-
-            default:
-                LOG_ERROR(HW_GPU, "Unknown destination framebuffer format {:x}",
-                          static_cast<u32>(config.output_format.Value()));
-                break;
-            }
-        }
-    }
+    SoftwareDisplayTransfer(config, src_pointer, dst_pointer);
 }
 
 static void TextureCopy(const Regs::DisplayTransferConfig& config) {
@@ -360,28 +227,142 @@ static void TextureCopy(const Regs::DisplayTransferConfig& config) {
                                                       : Memory::RasterizerInvalidateRegion;
     FlushInvalidate_fn(config.GetPhysicalOutputAddress(), static_cast<u32>(contiguous_output_size));
 
-    u32 remaining_input = input_width;
-    u32 remaining_output = output_width;
-    while (remaining_size > 0) {
-        u32 copy_size = std::min({remaining_input, remaining_output, remaining_size});
+    SoftwareTextureCopy(config, src_pointer, dst_pointer);
+}
 
-        std::memcpy(dst_pointer, src_pointer, copy_size);
-        src_pointer += copy_size;
-        dst_pointer += copy_size;
+static void ExecuteMemoryFill(const Regs::MemoryFillConfig& config, bool is_second_filler) {
+    MemoryFill(config);
+    LOG_TRACE(HW_GPU, "MemoryFill from {:#010X} to {:#010X}", config.GetStartAddress(),
+              config.GetEndAddress());
+
+    // It seems that it won't signal interrupt if "address_start" is zero.
+    // TODO: hwtest this
+    if (config.GetStartAddress() != 0) {
+        if (!is_second_filler) {
+            SignalInterrupt(Service::GSP::InterruptId::PSC0);
+        } else {
+            SignalInterrupt(Service::GSP::InterruptId::PSC1);
+        }
+    }
+}
+
+static void ExecuteDisplayTransfer(const Regs::DisplayTransferConfig& config) {
+    MICROPROFILE_SCOPE(GPU_DisplayTransfer);
+
+    if (Pica::g_debug_context)
+        Pica::g_debug_context->OnEvent(Pica::DebugContext::Event::IncomingDisplayTransfer,
+                                       nullptr);
+
+    if (config.is_texture_copy) {
+        TextureCopy(config);
+        LOG_TRACE(HW_GPU,
+                  "TextureCopy: {:#X} bytes from {:#010X}({}+{})-> "
+                  "{:#010X}({}+{}), flags {:#010X}",
+                  config.texture_copy.size, config.GetPhysicalInputAddress(),
+                  config.texture_copy.input_width * 16, config.texture_copy.input_gap * 16,
+                  config.GetPhysicalOutputAddress(), config.texture_copy.output_width * 16,
+                  config.texture_copy.output_gap * 16, config.flags);
+    } else {
+        DisplayTransfer(config);
+        LOG_TRACE(HW_GPU,
+                  "DisplayTransfer: {:#010X}({}x{})-> "
+                  "{:#010X}({}x{}), dst format {:x}, flags {:#010X}",
+                  config.GetPhysicalInputAddress(), config.input_width.Value(),
+                  config.input_height.Value(), config.GetPhysicalOutputAddress(),
+                  config.output_width.Value(), config.output_height.Value(),
+                  static_cast<u32>(config.output_format.Value()), config.flags);
+    }
 
-        remaining_input -= copy_size;
-        remaining_output -= copy_size;
-        remaining_size -= copy_size;
+    SignalInterrupt(Service::GSP::InterruptId::PPF);
+}
 
-        if (remaining_input == 0) {
-            remaining_input = input_width;
-            src_pointer += input_gap;
-        }
-        if (remaining_output == 0) {
-            remaining_output = output_width;
-            dst_pointer += output_gap;
-        }
+static void ExecuteCommandList(PAddr address, u32 size) {
+    MICROPROFILE_SCOPE(GPU_CmdlistProcessing);
+    Pica::CommandProcessor::ProcessCommandList(address, size);
+}
+
+static void ExecuteCommandList(PAddr address, std::span<const u32> list) {
+    MICROPROFILE_SCOPE(GPU_CmdlistProcessing);
+    Pica::CommandProcessor::ProcessCommandList(address, list);
+}
+
+/// Runs a command popped by the GPU thread
+static void ExecuteCommand(const CommandData& command) {
+    if (const auto* list = std::get_if<CommandListCommand>(&command)) {
+        ExecuteCommandList(list->address, list->list);
+    } else if (const auto* fill = std::get_if<MemoryFillCommand>(&command)) {
+        ExecuteMemoryFill(fill->config, fill->is_second_filler);
+    } else if (const auto* transfer = std::get_if<DisplayTransferCommand>(&command)) {
+        ExecuteDisplayTransfer(transfer->config);
+    }
+}
+
+/// Returns true when triggered work should be handed to the GPU thread
+static bool UseGPUThread() {
+    // The tracer expects the memory accessed by a trigger to be read before it returns
+    if (Pica::g_debug_context && Pica::g_debug_context->recorder) {
+        SyncGPUThread();
+        return false;
+    }
+
+    return gpu_thread != nullptr;
+}
+
+/// Queues work on the GPU thread and schedules the delivery of the interrupts it raises
+static void PushCommand(CommandData&& command) {
+    const u64 fence = gpu_thread->PushCommand(std::move(command));
+    Core::System::GetInstance().CoreTiming().ScheduleEvent(gpu_thread_sync_ticks,
+                                                           completion_event, fence);
+}
+
+/// Queues a copy of the command list on the GPU thread
+static void SubmitCommandList(PAddr address, u32 size) {
+    const auto* buffer = reinterpret_cast<const u32*>(g_memory->GetPhysicalPointer(address));
+    const std::span<const u32> list{buffer, buffer ? size / sizeof(u32) : 0};
+
+    // A jump continues with another command buffer that the copy doesn't cover, so such
+    // lists are processed right away with the GPU thread idle
+    if (buffer == nullptr || Pica::CommandProcessor::HasCommandBufferJump(list)) {
+        SyncGPUThread();
+        ExecuteCommandList(address, size);
+        return;
+    }
+
+    PushCommand(CommandListCommand{address, std::vector<u32>(list.begin(), list.end())});
+}
+
+/// Waits for the work identified by the fence and signals the interrupts raised so far
+static void CompletionCallback(u64 fence, s64 cycles_late) {
+    if (!gpu_thread) {
+        return;
+    }
+
+    // The guest may access the results once it receives the interrupts, so the page table
+    // changes of the GPU thread have to be in place by then
+    gpu_thread->WaitForFence(fence);
+    g_memory->ApplyDeferredRasterizerMarks();
+    for (const auto interrupt_id : gpu_thread->TakeInterrupts()) {
+        Service::GSP::SignalInterrupt(interrupt_id);
+    }
+}
+
+void SignalInterrupt(Service::GSP::InterruptId interrupt_id) {
+    if (gpu_thread && GPUThread::IsGPUThread()) {
+        gpu_thread->DeferInterrupt(interrupt_id);
+        return;
     }
+
+    Service::GSP::SignalInterrupt(interrupt_id);
+}
+
+void SyncGPUThread() {
+    if (!gpu_thread || GPUThread::IsGPUThread()) {
+        return;
+    }
+
+    MICROPROFILE_SCOPE(GPU_ThreadSync);
+    gpu_thread->WaitIdle();
+    g_memory->ApplyDeferredRasterizerMarks();
 }
 
 template <typename T>
@@ -406,18 +387,10 @@ inline void Write(u32 addr, const T data) {
         auto& config = g_regs.memory_fill_config[is_second_filler];
 
         if (config.trigger) {
-            MemoryFill(config);
-            LOG_TRACE(HW_GPU, "MemoryFill from {:#010X} to {:#010X}", config.GetStartAddress(),
-                      config.GetEndAddress());
-
-            // It seems that it won't signal interrupt if "address_start" is zero.
-            // TODO: hwtest this
-            if (config.GetStartAddress() != 0) {
-                if (!is_second_filler) {
-                    Service::GSP::SignalInterrupt(Service::GSP::InterruptId::PSC0);
-                } else {
-                    Service::GSP::SignalInterrupt(Service::GSP::InterruptId::PSC1);
-                }
+            if (UseGPUThread()) {
+                PushCommand(MemoryFillCommand{config, is_second_filler});
+            } else {
+                ExecuteMemoryFill(config, is_second_filler);
             }
 
             // Reset "trigger" flag and set the "finish" flag
@@ -429,37 +402,15 @@ inline void Write(u32 addr, const T data) {
     }
 
     case GPU_REG_INDEX(display_transfer_config.trigger): {
-        MICROPROFILE_SCOPE(GPU_DisplayTransfer);
-
         const auto& config = g_regs.display_transfer_config;
         if (config.trigger & 1) {
-
-            if (Pica::g_debug_context)
-                Pica::g_debug_context->OnEvent(Pica::DebugContext::Event::IncomingDisplayTransfer,
-                                               nullptr);
-
-            if (config.is_texture_copy) {
-                TextureCopy(config);
-                LOG_TRACE(HW_GPU,
-                          "TextureCopy: {:#X} bytes from {:#010X}({}+{})-> "
-                          "{:#010X}({}+{}), flags {:#010X}",
-                          config.texture_copy.size, config.GetPhysicalInputAddress(),
-                          config.texture_copy.input_width * 16, config.texture_copy.input_gap * 16,
-                          config.GetPhysicalOutputAddress(), config.texture_copy.output_width * 16,
-                          config.texture_copy.output_gap * 16, config.flags);
+            if (UseGPUThread()) {
+                PushCommand(DisplayTransferCommand{config});
             } else {
-                DisplayTransfer(config);
-                LOG_TRACE(HW_GPU,
-                          "DisplayTransfer: {:#010X}({}x{})-> "
-                          "{:#010X}({}x{}), dst format {:x}, flags {:#010X}",
-                          config.GetPhysicalInputAddress(), config.input_width.Value(),
-                          config.input_height.Value(), config.GetPhysicalOutputAddress(),
-                          config.output_width.Value(), config.output_height.Value(),
-                          static_cast<u32>(config.output_format.Value()), config.flags);
+                ExecuteDisplayTransfer(config);
             }
 
             g_regs.display_transfer_config.trigger = 0;
-            Service::GSP::SignalInterrupt(Service::GSP::InterruptId::PPF);
         }
         break;
     }
@@ -468,9 +419,11 @@ inline void Write(u32 addr, const T data) {
     case GPU_REG_INDEX(command_processor_config.trigger): {
         const auto& config = g_regs.command_processor_config;
         if (config.trigger & 1) {
-            MICROPROFILE_SCOPE(GPU_CmdlistProcessing);
-
-            Pica::CommandProcessor::ProcessCommandList(config.GetPhysicalAddress(), config.size);
+            if (UseGPUThread()) {
+                SubmitCommandList(config.GetPhysicalAddress(), config.size);
+            } else {
+                ExecuteCommandList(config.GetPhysicalAddress(), config.size);
+            }
 
             g_regs.command_processor_config.trigger = 0;
         }
@@ -504,7 +457,14 @@ template void Write<u8>(u32 addr, const u8 data);
 
 /// Update hardware
 static void VBlankCallback(u64 userdata, s64 cycles_late) {
-    VideoCore::g_renderer->SwapBuffers();
+    // Presentation reads the framebuffers written by the GPU thread
+    SyncGPUThread();
+    VideoCore::g_renderer->SwapBuffers(Core::System::GetInstance().CoreTiming().GetGlobalTimeUs());
+
+    // Dumped frames are captured from emulated memory so they are independent of the renderer
+    if (auto& video_dumper = Core::System::GetInstance().VideoDumper(); video_dumper.IsDumping()) {
+        VideoDumper::CaptureVideoFrame(video_dumper, *g_memory);
+    }
 
     // Signal to GSP that GPU interrupt has occurred
     // TODO(yuriks): hwtest to determine if PDC0 is for the Top screen and PDC1 for the Sub
@@ -551,13 +511,20 @@ void Init(Memory::MemorySystem& memory) {
 
     Core::Timing& timing = Core::System::GetInstance().CoreTiming();
     vblank_event = timing.RegisterEvent("GPU::VBlankCallback", VBlankCallback);
+    completion_event = timing.RegisterEvent("GPU::CompletionCallback", CompletionCallback);
     timing.ScheduleEvent(frame_ticks, vblank_event);
 
+    if (Settings::values.use_gpu_thread) {
+        gpu_thread = std::make_unique<GPUThread>(ExecuteCommand);
+    }
+
     LOG_DEBUG(HW_GPU, "initialized OK");
 }
 
 /// Shutdown hardware
 void Shutdown() {
+    gpu_thread.reset();
+    g_memory->ApplyDeferredRasterizerMarks();
     LOG_DEBUG(HW_GPU, "shutdown OK");
 }
 
@@ -18,6 +18,10 @@ namespace Memory {
 class MemorySystem;
 }
 
+namespace Service::GSP {
+enum class InterruptId : u8;
+}
+
 namespace GPU {
 
 // Measured on hardware to be 2240568 timer cycles or 4481136 ARM11 cycles
@@ -320,6 +324,18 @@ void Read(T& var, const u32 addr);
 template <typename T>
 void Write(u32 addr, const T data);
 
+/**
+ * Signals a GSP interrupt raised by the GPU. Interrupts raised on the GPU thread are
+ * deferred until the emulation thread observes the completion of the work that raised them
+ */
+void SignalInterrupt(Service::GSP::InterruptId interrupt_id);
+
+/**
+ * Waits for the GPU thread to finish all queued work and applies the page table changes it
+ * deferred. Does nothing in synchronous mode
+ */
+void SyncGPUThread();
+
 /// Initialize hardware
 void Init(Memory::MemorySystem& memory);
 
@@ -0,0 +1,87 @@
+// Copyright 2022 Citra Emulator Project
+// Licensed under GPLv2 or any later version
+// Refer to the license.txt file included.
+
+#include <algorithm>
+#include <utility>
+#include "common/microprofile.h"
+#include "common/thread.h"
+#include "core/hw/gpu_thread.h"
+
+namespace GPU {
+
+static thread_local bool is_gpu_thread = false;
+
+GPUThread::GPUThread(Handler handler) : handler(std::move(handler)) {
+    thread = std::thread(&GPUThread::ThreadLoop, this);
+}
+
+GPUThread::~GPUThread() {
+    PushCommand(ExitCommand{});
+    thread.join();
+}
+
+u64 GPUThread::PushCommand(CommandData&& data) {
+    const u64 fence = ++last_fence;
+    queue.Push(CommandDataContainer{std::move(data), fence});
+    return fence;
+}
+
+void GPUThread::WaitForFence(u64 fence) {
+    // Fences restored from a save state may belong to a previous thread instance
+    fence = std::min(fence, last_fence);
+    if (signaled_fence.load(std::memory_order_acquire) >= fence) {
+        return;
+    }
+
+    std::unique_lock lock{fence_mutex};
+    fence_cv.wait(lock, [this, fence] {
+        return signaled_fence.load(std::memory_order_acquire) >= fence;
+    });
+}
+
+void GPUThread::WaitIdle() {
+    WaitForFence(last_fence);
+}
+
+void GPUThread::DeferInterrupt(Service::GSP::InterruptId interrupt_id) {
+    std::scoped_lock lock{interrupt_mutex};
+    pending_interrupts.push_back(interrupt_id);
+}
+
+std::vector<Service::GSP::InterruptId> GPUThread::TakeInterrupts() {
+    std::scoped_lock lock{interrupt_mutex};
+    return std::exchange(pending_interrupts, {});
+}
+
+bool GPUThread::IsGPUThread() {
+    return is_gpu_thread;
+}
+
+void GPUThread::ThreadLoop() {
+    is_gpu_thread = true;
+    Common::SetCurrentThreadName("GPUThread");
+    MicroProfileOnThreadCreate("GPUThread");
+
+    while (true) {
+        CommandDataContainer command = queue.PopWait();
+        const bool exit = std::holds_alternative<ExitCommand>(command.data);
+        if (!exit) {
+            handler(command.data);
+        }
+
+        {
+            std::scoped_lock lock{fence_mutex};
+            signaled_fence.store(command.fence, std::memory_order_release);
+        }
+        fence_cv.notify_all();
+
+        if (exit) {
+            break;
+        }
+    }
+
+    MicroProfileOnThreadExit();
+}
+
+} // namespace GPU
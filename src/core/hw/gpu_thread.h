@@ -0,0 +1,104 @@
+// Copyright 2022 Citra Emulator Project
+// Licensed under GPLv2 or any later version
+// Refer to the license.txt file included.
+
+#pragma once
+
+#include <atomic>
+#include <condition_variable>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <variant>
+#include <vector>
+#include "common/common_types.h"
+#include "common/threadsafe_queue.h"
+#include "core/hle/service/gsp/gsp_gpu.h"
+#include "core/hw/gpu.h"
+
+namespace GPU {
+
+/// Processes a copy of a PICA command list, taken as the guest may reuse its memory right away
+struct CommandListCommand {
+    PAddr address = 0;
+    std::vector<u32> list;
+};
+
+/// Executes a memory fill with the register state captured when it was triggered
+struct MemoryFillCommand {
+    Regs::MemoryFillConfig config{};
+    bool is_second_filler = false;
+};
+
+/// Executes a display transfer or texture copy with the captured register state
+struct DisplayTransferCommand {
+    Regs::DisplayTransferConfig config{};
+};
+
+/// Makes the GPU thread exit its loop
+struct ExitCommand {};
+
+using CommandData =
+    std::variant<ExitCommand, CommandListCommand, MemoryFillCommand, DisplayTransferCommand>;
+
+struct CommandDataContainer {
+    CommandData data;
+    u64 fence = 0;
+};
+
+/**
+ * Executes GPU work on a dedicated thread so the ARM11 emulation thread only has to
+ * wait when the guest observes the results. Commands are pushed by the emulation thread
+ * through a lock-free queue and each one is assigned an increasing fence value.
+ * Interrupts raised while executing a command are deferred until the emulation thread
+ * collects them with TakeInterrupts.
+ */
+class GPUThread {
+public:
+    using Handler = std::function<void(const CommandData&)>;
+
+    explicit GPUThread(Handler handler);
+    ~GPUThread();
+
+    GPUThread(const GPUThread&) = delete;
+    GPUThread& operator=(const GPUThread&) = delete;
+
+    /// Queues a command and returns the fence that will be signaled once it completes
+    u64 PushCommand(CommandData&& data);
+
+    /// Blocks until the command with the provided fence has finished executing
+    void WaitForFence(u64 fence);
+
+    /// Blocks until all queued commands have finished executing
+    void WaitIdle();
+
+    /// Returns true when all queued commands have finished executing
+    bool IsIdle() const {
+        return signaled_fence.load(std::memory_order_acquire) == last_fence;
+    }
+
+    /// Records an interrupt raised by the GPU thread
+    void DeferInterrupt(Service::GSP::InterruptId interrupt_id);
+
+    /// Returns the interrupts raised since the last call
+    std::vector<Service::GSP::InterruptId> TakeInterrupts();
+
+    /// Returns true when called from the GPU thread
+    static bool IsGPUThread();
+
+private:
+    void ThreadLoop();
+
+private:
+    Handler handler;
+    Common::SPSCQueue<CommandDataContainer> queue;
+    u64 last_fence = 0;
+    std::atomic<u64> signaled_fence{0};
+    std::mutex fence_mutex;
+    std::condition_variable fence_cv;
+    std::mutex interrupt_mutex;
+    std::vector<Service::GSP::InterruptId> pending_interrupts;
+    std::thread thread;
+};
+
+} // namespace GPU
@@ -0,0 +1,359 @@
+// Copyright 2022 Citra Emulator Project
+// Licensed under GPLv2 or any later version
+// Refer to the license.txt file included.
+
+#include <algorithm>
+#include <array>
+#include <cstring>
+#include <vector>
+#include "common/alignment.h"
+#include "common/assert.h"
+#include "common/logging/log.h"
+#include "common/swap.h"
+#include "core/hw/gpu_transfer.h"
+#include "video_core/utils.h"
+
+namespace GPU {
+
+namespace {
+
+using PixelFormat = Regs::PixelFormat;
+using DisplayTransferConfig = Regs::DisplayTransferConfig;
+
+// Decoded pixels are packed as R | G << 8 | B << 16 | A << 24
+
+/// Morton index of every pixel in a row of an 8x8 tile, for each of the 8 rows
+constexpr std::array<std::array<u32, 8>, 8> morton_rows = [] {
+    std::array<std::array<u32, 8>, 8> rows{};
+    for (u32 y = 0; y < 8; y++) {
+        for (u32 x = 0; x < 8; x++) {
+            rows[y][x] = VideoCore::MortonInterleave(x, y);
+        }
+    }
+    return rows;
+}();
+
+inline u32 Load16(const u8* bytes) {
+    u16_le value;
+    std::memcpy(&value, bytes, sizeof(value));
+    return value;
+}
+
+inline void Store16(u8* bytes, u32 value) {
+    const u16_le data = static_cast<u16>(value);
+    std::memcpy(bytes, &data, sizeof(data));
+}
+
+// Expands the low bits of a value to 8 bits, matching Color::ConvertNTo8
+inline u32 Expand5(u32 value) {
+    return (value << 3) | (value >> 2);
+}
+
+inline u32 Expand6(u32 value) {
+    return (value << 2) | (value >> 4);
+}
+
+inline u32 Expand4(u32 value) {
+    return (value << 4) | value;
+}
+
+inline u32 Pack(u32 r, u32 g, u32 b, u32 a) {
+    return r | (g << 8) | (b << 16) | (a << 24);
+}
+
+template <PixelFormat format>
+inline u32 DecodePixel(const u8* bytes) {
+    if constexpr (format == PixelFormat::RGBA8) {
+        return Pack(bytes[3], bytes[2], bytes[1], bytes[0]);
+    } else if constexpr (format == PixelFormat::RGB8) {
+        return Pack(bytes[2], bytes[1], bytes[0], 255);
+    } else if constexpr (format == PixelFormat::RGB565) {
+        const u32 pixel = Load16(bytes);
+        return Pack(Expand5((pixel >> 11) & 0x1F), Expand6((pixel >> 5) & 0x3F),
+                    Expand5(pixel & 0x1F), 255);
+    } else if constexpr (format == PixelFormat::RGB5A1) {
+        const u32 pixel = Load16(bytes);
+        return Pack(Expand5((pixel >> 11) & 0x1F), Expand5((pixel >> 6) & 0x1F),
+                    Expand5((pixel >> 1) & 0x1F), (pixel & 0x1) * 255);
+    } else {
+        const u32 pixel = Load16(bytes);
+        return Pack(Expand4((pixel >> 12) & 0xF), Expand4((pixel >> 8) & 0xF),
+                    Expand4((pixel >> 4) & 0xF), Expand4(pixel & 0xF));
+    }
+}
+
+template <PixelFormat format>
+inline void EncodePixel(u32 color, u8* bytes) {
+    const u32 r = color & 0xFF;
+    const u32 g = (color >> 8) & 0xFF;
+    const u32 b = (color >> 16) & 0xFF;
+    const u32 a = color >> 24;
+    if constexpr (format == PixelFormat::RGBA8) {
+        bytes[0] = static_cast<u8>(a);
+        bytes[1] = static_cast<u8>(b);
+        bytes[2] = static_cast<u8>(g);
+        bytes[3] = static_cast<u8>(r);
+    } else if constexpr (format == PixelFormat::RGB8) {
+        bytes[0] = static_cast<u8>(b);
+        bytes[1] = static_cast<u8>(g);
+        bytes[2] = static_cast<u8>(r);
+    } else if constexpr (format == PixelFormat::RGB565) {
+        Store16(bytes, ((r >> 3) << 11) | ((g >> 2) << 5) | (b >> 3));
+    } else if constexpr (format == PixelFormat::RGB5A1) {
+        Store16(bytes, ((r >> 3) << 11) | ((g >> 3) << 6) | ((b >> 3) << 1) | (a >> 7));
+    } else {
+        Store16(bytes, ((r >> 4) << 12) | ((g >> 4) << 8) | ((b >> 4) << 4) | (a >> 4));
+    }
+}
+
+/// Decodes a row of pixels. Tiled rows are gathered one tile at a time.
+template <PixelFormat format, bool tiled>
+void DecodeRow(const u8* src, u32 y, u32 stride, u32 count, u32* out) {
+    constexpr u32 bpp = format == PixelFormat::RGBA8 ? 4 : format == PixelFormat::RGB8 ? 3 : 2;
+    if constexpr (tiled) {
+        const u8* row = src + (y & ~7u) * stride;
+        const auto& morton = morton_rows[y & 7];
+        for (u32 x = 0; x < count; x += 8) {
+            const u8* tile = row + x * 8 * bpp;
+            const u32 tile_count = std::min(count - x, 8u);
+            for (u32 i = 0; i < tile_count; i++) {
+                out[x + i] = DecodePixel<format>(tile + morton[i] * bpp);
+            }
+        }
+    } else {
+        const u8* row = src + y * stride;
+        for (u32 x = 0; x < count; x++) {
+            out[x] = DecodePixel<format>(row + x * bpp);
+        }
+    }
+}
+
+/// Encodes a row of pixels. Tiled rows are scattered one tile at a time.
+template <PixelFormat format, bool tiled>
+void EncodeRow(const u32* in, u32 y, u32 stride, u32 count, u8* dst) {
+    constexpr u32 bpp = format == PixelFormat::RGBA8 ? 4 : format == PixelFormat::RGB8 ? 3 : 2;
+    if constexpr (tiled) {
+        u8* row = dst + (y & ~7u) * stride;
+        const auto& morton = morton_rows[y & 7];
+        for (u32 x = 0; x < count; x += 8) {
+            u8* tile = row + x * 8 * bpp;
+            const u32 tile_count = std::min(count - x, 8u);
+            for (u32 i = 0; i < tile_count; i++) {
+                EncodePixel<format>(in[x + i], tile + morton[i] * bpp);
+            }
+        }
+    } else {
+        u8* row = dst + y * stride;
+        for (u32 x = 0; x < count; x++) {
+            EncodePixel<format>(in[x], row + x * bpp);
+        }
+    }
+}
+
+using DecodeRowFunc = void (*)(const u8*, u32, u32, u32, u32*);
+using EncodeRowFunc = void (*)(const u32*, u32, u32, u32, u8*);
+
+template <bool tiled>
+DecodeRowFunc GetDecodeRow(PixelFormat format) {
+    switch (format) {
+    case PixelFormat::RGBA8:
+        return &DecodeRow<PixelFormat::RGBA8, tiled>;
+    case PixelFormat::RGB8:
+        return &DecodeRow<PixelFormat::RGB8, tiled>;
+    case PixelFormat::RGB565:
+        return &DecodeRow<PixelFormat::RGB565, tiled>;
+    case PixelFormat::RGB5A1:
+        return &DecodeRow<PixelFormat::RGB5A1, tiled>;
+    case PixelFormat::RGBA4:
+        return &DecodeRow<PixelFormat::RGBA4, tiled>;
+    default:
+        return nullptr;
+    }
+}
+
+template <bool tiled>
+EncodeRowFunc GetEncodeRow(PixelFormat format) {
+    switch (format) {
+    case PixelFormat::RGBA8:
+        return &EncodeRow<PixelFormat::RGBA8, tiled>;
+    case PixelFormat::RGB8:
+        return &EncodeRow<PixelFormat::RGB8, tiled>;
+    case PixelFormat::RGB565:
+        return &EncodeRow<PixelFormat::RGB565, tiled>;
+    case PixelFormat::RGB5A1:
+        return &EncodeRow<PixelFormat::RGB5A1, tiled>;
+    case PixelFormat::RGBA4:
+        return &EncodeRow<PixelFormat::RGBA4, tiled>;
+    default:
+        return nullptr;
+    }
+}
+
+/// Averages horizontal pixel pairs, rounding down each channel
+void DownscaleRowX(const u32* in, u32 count, u32* out) {
+    for (u32 x = 0; x < count; x++) {
+        const u32 a = in[2 * x];
+        const u32 b = in[2 * x + 1];
+        out[x] = (a & b) + (((a ^ b) & 0xFEFEFEFE) >> 1);
+    }
+}
+
+/// Averages 2x2 pixel blocks, rounding down each channel
+void DownscaleRowXY(const u32* in0, const u32* in1, u32 count, u32* out) {
+    for (u32 x = 0; x < count; x++) {
+        const u32 a = in0[2 * x];
+        const u32 b = in0[2 * x + 1];
+        const u32 c = in1[2 * x];
+        const u32 d = in1[2 * x + 1];
+
+        // Sum the even and odd channels in separate 16-bit lanes so they can't overflow
+        const u32 even = (a & 0x00FF00FF) + (b & 0x00FF00FF) + (c & 0x00FF00FF) + (d & 0x00FF00FF);
+        const u32 odd = ((a >> 8) & 0x00FF00FF) + ((b >> 8) & 0x00FF00FF) +
+                        ((c >> 8) & 0x00FF00FF) + ((d >> 8) & 0x00FF00FF);
+        out[x] = ((even >> 2) & 0x00FF00FF) | (((odd >> 2) & 0x00FF00FF) << 8);
+    }
+}
+
+} // Anonymous namespace
+
+void SoftwareDisplayTransfer(const DisplayTransferConfig& config, const u8* src, u8* dst) {
+    const u32 horizontal_scale = config.scaling != config.NoScale ? 1 : 0;
+    const u32 vertical_scale = config.scaling == config.ScaleXY ? 1 : 0;
+
+    const u32 output_width = config.output_width >> horizontal_scale;
+    const u32 output_height = config.output_height >> vertical_scale;
+    const u32 input_count = output_width << horizontal_scale;
+
+    const PixelFormat input_format = config.input_format;
+    const PixelFormat output_format = config.output_format;
+
+    // The input is tiled unless it's linear, the output is the opposite unless swizzling is off
+    const bool input_tiled = !config.input_linear;
+    const bool output_tiled = config.input_linear != config.dont_swizzle;
+
+    const DecodeRowFunc decode_row =
+        input_tiled ? GetDecodeRow<true>(input_format) : GetDecodeRow<false>(input_format);
+    const EncodeRowFunc encode_row =
+        output_tiled ? GetEncodeRow<true>(output_format) : GetEncodeRow<false>(output_format);
+
+    if (!encode_row) {
+        LOG_ERROR(HW_GPU, "Unknown destination framebuffer format {:x}",
+                  static_cast<u32>(output_format));
+        return;
+    }
+
+    std::vector<u32> row0(input_count);
+    std::vector<u32> row1(vertical_scale ? input_count : 0);
+    std::vector<u32> scaled(horizontal_scale ? output_width : 0);
+
+    const u32 input_stride = config.input_width * Regs::BytesPerPixel(input_format);
+    const u32 output_stride = output_width * Regs::BytesPerPixel(output_format);
+
+    for (u32 y = 0; y < output_height; ++y) {
+        const u32 input_y = y << vertical_scale;
+        if (decode_row) {
+            decode_row(src, input_y, input_stride, input_count, row0.data());
+            if (vertical_scale) {
+                decode_row(src, input_y + 1, input_stride, input_count, row1.data());
+            }
+        } else {
+            LOG_ERROR(HW_GPU, "Unknown source framebuffer format {:x}",
+                      static_cast<u32>(input_format));
+        }
+
+        const u32* row = row0.data();
+        if (config.scaling == config.ScaleX) {
+            DownscaleRowX(row0.data(), output_width, scaled.data());
+            row = scaled.data();
+        } else if (config.scaling == config.ScaleXY) {
+            DownscaleRowXY(row0.data(), row1.data(), output_width, scaled.data());
+            row = scaled.data();
+        }
+
+        // Flip the output row after the input position was calculated to account for scaling
+        const u32 output_y = config.flip_vertically ? output_height - y - 1 : y;
+        encode_row(row, output_y, output_stride, output_width, dst);
+    }
+}
+
+void SoftwareTextureCopy(const DisplayTransferConfig& config, const u8* src, u8* dst) {
+    u32 remaining_size = Common::AlignDown(config.texture_copy.size, 16);
+
+    const u32 input_gap = config.texture_copy.input_gap * 16;
+    const u32 output_gap = config.texture_copy.output_gap * 16;
+
+    // Zero gap means contiguous input/output even if width = 0
+    const u32 input_width = input_gap == 0 ? remaining_size : config.texture_copy.input_width * 16;
+    const u32 output_width =
+        output_gap == 0 ? remaining_size : config.texture_copy.output_width * 16;
+
+    // Matching layouts copy whole rows without splitting them at the other side's row ends
+    if (input_width == output_width) {
+        while (remaining_size > 0) {
+            const u32 copy_size = std::min(input_width, remaining_size);
+            std::memcpy(dst, src, copy_size);
+            src += copy_size + input_gap;
+            dst += copy_size + output_gap;
+            remaining_size -= copy_size;
+        }
+        return;
+    }
+
+    u32 remaining_input = input_width;
+    u32 remaining_output = output_width;
+    while (remaining_size > 0) {
+        const u32 copy_size = std::min({remaining_input, remaining_output, remaining_size});
+
+        std::memcpy(dst, src, copy_size);
+        src += copy_size;
+        dst += copy_size;
+
+        remaining_input -= copy_size;
+        remaining_output -= copy_size;
+        remaining_size -= copy_size;
+
+        if (remaining_input == 0) {
+            remaining_input = input_width;
+            src += input_gap;
+        }
+        if (remaining_output == 0) {
+            remaining_output = output_width;
+            dst += output_gap;
+        }
+    }
+}
+
+void FillPattern(u8* dst, std::size_t size, const u8* pattern, u32 pattern_size) {
+    constexpr std::size_t BLOCK_SIZE = 48;
+    ASSERT(pattern_size != 0 && BLOCK_SIZE % pattern_size == 0);
+
+    std::array<u8, BLOCK_SIZE> block;
+    for (std::size_t i = 0; i < BLOCK_SIZE; i++) {
+        block[i] = pattern[i % pattern_size];
+    }
+
+    u8* const end = dst + size;
+    for (; static_cast<std::size_t>(end - dst) >= BLOCK_SIZE; dst += BLOCK_SIZE) {
+        std::memcpy(dst, block.data(), BLOCK_SIZE);
+    }
+    std::memcpy(dst, block.data(), end - dst);
+}
+
+void SoftwareMemoryFill(const Regs::MemoryFillConfig& config, u8* start, u8* end) {
+    // The fill value is stored in memory order for every width
+    std::array<u8, sizeof(u32)> pattern;
+    std::memcpy(pattern.data(), &config.value_32bit, sizeof(u32));
+
+    const std::size_t length = end - start;
+    if (config.fill_24bit) {
+        // 16 and 24-bit fills always write whole pixels, even past the end address
+        FillPattern(start, Common::AlignUp<std::size_t>(length, 3), pattern.data(), 3);
+    } else if (config.fill_32bit) {
+        // 32-bit fills stop at the last whole pixel before the end address
+        FillPattern(start, Common::AlignDown<std::size_t>(length, 4), pattern.data(), 4);
+    } else {
+        FillPattern(start, Common::AlignUp<std::size_t>(length, 2), pattern.data(), 2);
+    }
+}
+
+} // namespace GPU
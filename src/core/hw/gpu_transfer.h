@@ -0,0 +1,50 @@
+// Copyright 2022 Citra Emulator Project
+// Licensed under GPLv2 or any later version
+// Refer to the license.txt file included.
+
+#pragma once
+
+#include <cstddef>
+#include "common/common_types.h"
+#include "core/hw/gpu.h"
+
+namespace GPU {
+
+/**
+ * Converts the pixels of a display transfer on the CPU. Pixels are processed a row at a time:
+ * each row is decoded to RGBA8, downscaled and encoded to the output format, with tiled rows
+ * gathered and scattered through a per-row Morton table instead of per-pixel offsets.
+ * @param config Display transfer configuration. The scaling mode must be supported.
+ * @param src Pointer to the start of the input image
+ * @param dst Pointer to the start of the output image
+ */
+void SoftwareDisplayTransfer(const Regs::DisplayTransferConfig& config, const u8* src, u8* dst);
+
+/**
+ * Copies the data of a texture copy on the CPU, respecting the input and output gaps.
+ * @param config Display transfer configuration with the texture copy fields set
+ * @param src Pointer to the start of the input data
+ * @param dst Pointer to the start of the output data
+ */
+void SoftwareTextureCopy(const Regs::DisplayTransferConfig& config, const u8* src, u8* dst);
+
+/**
+ * Fills memory with a repeating byte pattern. The pattern is broadcast into a 48 byte block,
+ * which is a multiple of every fill width and of the vector register size, so the fill is done
+ * with whole vector stores instead of one pixel at a time.
+ * @param dst Pointer to the start of the memory to fill
+ * @param size Number of bytes to fill
+ * @param pattern Pointer to the pattern bytes
+ * @param pattern_size Size of the pattern in bytes. Must be 2, 3 or 4.
+ */
+void FillPattern(u8* dst, std::size_t size, const u8* pattern, u32 pattern_size);
+
+/**
+ * Executes a memory fill on the CPU.
+ * @param config Memory fill configuration
+ * @param start Pointer to the start of the memory to fill
+ * @param end Pointer to the end of the memory to fill
+ */
+void SoftwareMemoryFill(const Regs::MemoryFillConfig& config, u8* start, u8* end);
+
+} // namespace GPU
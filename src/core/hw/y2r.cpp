@@ -5,15 +5,19 @@
 #include <algorithm>
 #include <array>
 #include <cstddef>
+#include <cstring>
 #include <memory>
+#include <thread>
+#include <type_traits>
 #include "common/assert.h"
-#include "common/color.h"
 #include "common/common_types.h"
-#include "common/vector_math.h"
+#include "common/swap.h"
+#include "common/thread_worker.h"
 #include "core/core.h"
 #include "core/hle/service/y2r_u.h"
 #include "core/hw/y2r.h"
 #include "core/memory.h"
+#include "core/settings.h"
 
 namespace HW::Y2R {
 
@@ -23,55 +27,65 @@ static const std::size_t MAX_TILES = 1024 / 8;
 static const std::size_t TILE_SIZE = 8 * 8;
 using ImageTile = std::array<u32, TILE_SIZE>;
 
-/// Converts a image strip from the source YUV format into individual 8x8 RGB32 tiles.
-static void ConvertYUVToRGB(InputFormat input_format, const u8* input_Y, const u8* input_U,
-                            const u8* input_V, ImageTile output[], unsigned int width,
-                            unsigned int height, const CoefficientSet& coefficients) {
+/// Minimum number of strips given to each thread when a conversion is split across threads
+static const unsigned int MIN_STRIPS_PER_THREAD = 8;
+
+/// Converts a image strip from the source YUV format into individual 8x8 RGB32 tiles. Each line
+/// is converted in two passes over linear buffers: the first one unpacks the samples and computes
+/// the chroma terms shared by each pixel pair, and the second one applies the per-pixel luma term,
+/// which keeps the inner loops free of format dispatch and tile addressing so they vectorize.
+template <InputFormat input_format>
+static void ConvertYUVToRGB(const u8* input_Y, const u8* input_U, const u8* input_V,
+                            ImageTile output[], unsigned int width, unsigned int height,
+                            const CoefficientSet& coefficients) {
+    constexpr std::size_t MAX_WIDTH = MAX_TILES * 8;
+    std::array<s32, MAX_WIDTH> luma;
+    std::array<s32, MAX_WIDTH> r_chroma;
+    std::array<s32, MAX_WIDTH> g_chroma;
+    std::array<s32, MAX_WIDTH> b_chroma;
+    std::array<u32, MAX_WIDTH> line;
+    const auto& c = coefficients;
 
     for (unsigned int y = 0; y < height; ++y) {
-        for (unsigned int x = 0; x < width; ++x) {
-            s32 Y = 0;
-            s32 U = 0;
-            s32 V = 0;
-            switch (input_format) {
-            case InputFormat::YUV422_Indiv8:
-            case InputFormat::YUV422_Indiv16:
-                Y = input_Y[y * width + x];
-                U = input_U[(y * width + x) / 2];
-                V = input_V[(y * width + x) / 2];
-                break;
-            case InputFormat::YUV420_Indiv8:
-            case InputFormat::YUV420_Indiv16:
-                Y = input_Y[y * width + x];
-                U = input_U[((y / 2) * width + x) / 2];
-                V = input_V[((y / 2) * width + x) / 2];
-                break;
-            case InputFormat::YUYV422_Interleaved:
-                Y = input_Y[(y * width + x) * 2];
-                U = input_Y[(y * width + (x / 2) * 2) * 2 + 1];
-                V = input_Y[(y * width + (x / 2) * 2) * 2 + 3];
-                break;
+        const auto unpack_pair = [&](unsigned int x, s32 Y0, s32 Y1, s32 U, s32 V) {
+            luma[x] = c[0] * Y0;
+            luma[x + 1] = c[0] * Y1;
+            r_chroma[x] = r_chroma[x + 1] = c[1] * V;
+            g_chroma[x] = g_chroma[x + 1] = c[2] * V + c[3] * U;
+            b_chroma[x] = b_chroma[x + 1] = c[4] * U;
+        };
+
+        if constexpr (input_format == InputFormat::YUYV422_Interleaved) {
+            const u8* line_YUYV = input_Y + y * width * 2;
+            for (unsigned int x = 0; x < width; x += 2) {
+                const u8* pair = line_YUYV + x * 2;
+                unpack_pair(x, pair[0], pair[2], pair[1], pair[3]);
+            }
+        } else {
+            constexpr bool is_420 = input_format == InputFormat::YUV420_Indiv8 ||
+                                    input_format == InputFormat::YUV420_Indiv16;
+            const unsigned int chroma_y = is_420 ? y / 2 : y;
+            const u8* line_Y = input_Y + y * width;
+            const u8* line_U = input_U + chroma_y * width / 2;
+            const u8* line_V = input_V + chroma_y * width / 2;
+            for (unsigned int x = 0; x < width; x += 2) {
+                unpack_pair(x, line_Y[x], line_Y[x + 1], line_U[x / 2], line_V[x / 2]);
             }
+        }
+
+        // This conversion process is bit-exact with hardware, as far as could be tested.
+        const s32 rounding_offset = 0x18;
+        for (unsigned int x = 0; x < width; ++x) {
+            const s32 r = ((luma[x] + r_chroma[x]) >> 3) + c[5] + rounding_offset;
+            const s32 g = ((luma[x] - g_chroma[x]) >> 3) + c[6] + rounding_offset;
+            const s32 b = ((luma[x] + b_chroma[x]) >> 3) + c[7] + rounding_offset;
+            line[x] = ((u32)std::clamp(r >> 5, 0, 0xFF) << 24) |
+                      ((u32)std::clamp(g >> 5, 0, 0xFF) << 16) |
+                      ((u32)std::clamp(b >> 5, 0, 0xFF) << 8);
+        }
 
-            // This conversion process is bit-exact with hardware, as far as could be tested.
-            auto& c = coefficients;
-            s32 cY = c[0] * Y;
-
-            s32 r = cY + c[1] * V;
-            s32 g = cY - c[2] * V - c[3] * U;
-            s32 b = cY + c[4] * U;
-
-            const s32 rounding_offset = 0x18;
-            r = (r >> 3) + c[5] + rounding_offset;
-            g = (g >> 3) + c[6] + rounding_offset;
-            b = (b >> 3) + c[7] + rounding_offset;
-
-            unsigned int tile = x / 8;
-            unsigned int tile_x = x % 8;
-            u32* out = &output[tile][y * 8 + tile_x];
-            *out = ((u32)std::clamp(r >> 5, 0, 0xFF) << 24) |
-                   ((u32)std::clamp(g >> 5, 0, 0xFF) << 16) |
-                   ((u32)std::clamp(b >> 5, 0, 0xFF) << 8);
+        for (unsigned int tile = 0; tile < width / 8; ++tile) {
+            std::memcpy(&output[tile][y * 8], &line[tile * 8], 8 * sizeof(u32));
         }
     }
 }
@@ -100,47 +114,75 @@ static void ReceiveData(Memory::MemorySystem& memory, u8* output, ConversionBuff
     }
 }
 
+static constexpr std::size_t BytesPerPixel(OutputFormat output_format) {
+    switch (output_format) {
+    case OutputFormat::RGBA8:
+        return 4;
+    case OutputFormat::RGB8:
+        return 3;
+    case OutputFormat::RGB5A1:
+    case OutputFormat::RGB565:
+        return 2;
+    }
+    return 0;
+}
+
+/// Encodes RGB32 pixels to the output format, see the Color::Encode* functions.
+template <OutputFormat output_format>
+static void EncodePixels(const u32* input, u8* output, std::size_t count, u8 alpha) {
+    for (std::size_t i = 0; i < count; ++i) {
+        const u32 color = input[i];
+        if constexpr (output_format == OutputFormat::RGBA8) {
+            const u32_le data = (color & 0xFFFFFF00) | alpha;
+            std::memcpy(output + i * 4, &data, sizeof(data));
+        } else if constexpr (output_format == OutputFormat::RGB8) {
+            output[i * 3 + 0] = static_cast<u8>(color >> 8);
+            output[i * 3 + 1] = static_cast<u8>(color >> 16);
+            output[i * 3 + 2] = static_cast<u8>(color >> 24);
+        } else if constexpr (output_format == OutputFormat::RGB5A1) {
+            const u16_le data = static_cast<u16>(((color >> 27) << 11) |
+                                                 (((color >> 19) & 0x1F) << 6) |
+                                                 (((color >> 11) & 0x1F) << 1) | (alpha >> 7));
+            std::memcpy(output + i * 2, &data, sizeof(data));
+        } else if constexpr (output_format == OutputFormat::RGB565) {
+            const u16_le data = static_cast<u16>(((color >> 27) << 11) |
+                                                 (((color >> 18) & 0x3F) << 5) |
+                                                 ((color >> 11) & 0x1F));
+            std::memcpy(output + i * 2, &data, sizeof(data));
+        }
+    }
+}
+
 /// Convert intermediate RGB32 format to the final output format while simulating an outgoing CDMA
 /// transfer.
+template <OutputFormat output_format>
 static void SendData(Memory::MemorySystem& memory, const u32* input, ConversionBuffer& buf,
-                     int amount_of_data, OutputFormat output_format, u8 alpha) {
+                     int amount_of_data, u8 alpha) {
+    constexpr std::size_t bytes_per_pixel = BytesPerPixel(output_format);
 
     u8* output = memory.GetPointer(buf.address);
 
-    while (amount_of_data > 0) {
-        u8* unit_end = output + buf.transfer_unit;
-        while (output < unit_end) {
-            u32 color = *input++;
-            Common::Vec4<u8> col_vec{(u8)(color >> 24), (u8)(color >> 16), (u8)(color >> 8), alpha};
-
-            switch (output_format) {
-            case OutputFormat::RGBA8:
-                Color::EncodeRGBA8(col_vec, output);
-                output += 4;
-                break;
-            case OutputFormat::RGB8:
-                Color::EncodeRGB8(col_vec, output);
-                output += 3;
-                break;
-            case OutputFormat::RGB5A1:
-                Color::EncodeRGB5A1(col_vec, output);
-                output += 2;
-                break;
-            case OutputFormat::RGB565:
-                Color::EncodeRGB565(col_vec, output);
-                output += 2;
-                break;
-            }
+    // Whole pixels are always written, so the last pixel of a transfer unit that is not a multiple
+    // of the pixel size spills over into the gap.
+    const std::size_t unit_pixels = (buf.transfer_unit + bytes_per_pixel - 1) / bytes_per_pixel;
 
-            amount_of_data -= 1;
-        }
+    while (amount_of_data > 0) {
+        EncodePixels<output_format>(input, output, unit_pixels, alpha);
+        input += unit_pixels;
+        amount_of_data -= static_cast<int>(unit_pixels);
 
-        output += buf.gap;
+        output += unit_pixels * bytes_per_pixel + buf.gap;
         buf.address += buf.transfer_unit + buf.gap;
         buf.image_size -= buf.transfer_unit;
     }
 }
 
+/// Advances a CDMA buffer past the given number of transfers without accessing memory.
+static void SkipTransfers(ConversionBuffer& buf, std::size_t count) {
+    buf.address += static_cast<VAddr>(count * (buf.transfer_unit + buf.gap));
+    buf.image_size -= static_cast<u32>(count * buf.transfer_unit);
+}
+
 static const u8 linear_lut[TILE_SIZE] = {
     // clang-format off
      0,  1,  2,  3,  4,  5,  6,  7,
@@ -210,6 +252,231 @@ static void WriteTileToOutput(u32* output, const ImageTile& tile, int height, in
     }
 }
 
+/// Scratch memory used to convert a single strip.
+struct StripBuffers {
+    explicit StripBuffers(std::size_t line_width)
+        : data(new u8[line_width * 8 * 4]), tiles(new ImageTile[line_width / 8]) {}
+
+    /// Buffer used as a CDMA source/target.
+    std::unique_ptr<u8[]> data;
+    /// Intermediate storage for decoded 8x8 image tiles. Always stored as RGB32.
+    std::unique_ptr<ImageTile[]> tiles;
+};
+
+/// Converts the strip starting at line `y`, advancing the CDMA buffers of `cvt` past it.
+static void ConvertStrip(Memory::MemorySystem& memory, ConversionConfiguration& cvt,
+                         unsigned int y, StripBuffers& buffers, const u8* tile_remap) {
+    const std::size_t num_tiles = cvt.input_line_width / 8;
+    const unsigned int row_height = std::min(cvt.input_lines - y, 8u);
+    ImageTile tmp_tile;
+
+    // Total size in pixels of incoming data required for this strip.
+    const std::size_t row_data_size = row_height * cvt.input_line_width;
+
+    u8* input_Y = buffers.data.get();
+    u8* input_U = input_Y + 8 * cvt.input_line_width;
+    u8* input_V = input_U + 8 * cvt.input_line_width / 2;
+    ImageTile* tiles = buffers.tiles.get();
+
+    const auto convert = [&](auto format_constant) {
+        ConvertYUVToRGB<decltype(format_constant)::value>(
+            input_Y, input_U, input_V, tiles, cvt.input_line_width, row_height, cvt.coefficients);
+    };
+
+    switch (cvt.input_format) {
+    case InputFormat::YUV422_Indiv8:
+        ReceiveData<1>(memory, input_Y, cvt.src_Y, row_data_size);
+        ReceiveData<1>(memory, input_U, cvt.src_U, row_data_size / 2);
+        ReceiveData<1>(memory, input_V, cvt.src_V, row_data_size / 2);
+        convert(std::integral_constant<InputFormat, InputFormat::YUV422_Indiv8>{});
+        break;
+    case InputFormat::YUV420_Indiv8:
+        ReceiveData<1>(memory, input_Y, cvt.src_Y, row_data_size);
+        ReceiveData<1>(memory, input_U, cvt.src_U, row_data_size / 4);
+        ReceiveData<1>(memory, input_V, cvt.src_V, row_data_size / 4);
+        convert(std::integral_constant<InputFormat, InputFormat::YUV420_Indiv8>{});
+        break;
+    case InputFormat::YUV422_Indiv16:
+        ReceiveData<2>(memory, input_Y, cvt.src_Y, row_data_size);
+        ReceiveData<2>(memory, input_U, cvt.src_U, row_data_size / 2);
+        ReceiveData<2>(memory, input_V, cvt.src_V, row_data_size / 2);
+        convert(std::integral_constant<InputFormat, InputFormat::YUV422_Indiv16>{});
+        break;
+    case InputFormat::YUV420_Indiv16:
+        ReceiveData<2>(memory, input_Y, cvt.src_Y, row_data_size);
+        ReceiveData<2>(memory, input_U, cvt.src_U, row_data_size / 4);
+        ReceiveData<2>(memory, input_V, cvt.src_V, row_data_size / 4);
+        convert(std::integral_constant<InputFormat, InputFormat::YUV420_Indiv16>{});
+        break;
+    case InputFormat::YUYV422_Interleaved:
+        input_U = nullptr;
+        input_V = nullptr;
+        ReceiveData<1>(memory, input_Y, cvt.src_YUYV, row_data_size * 2);
+        convert(std::integral_constant<InputFormat, InputFormat::YUYV422_Interleaved>{});
+        break;
+    }
+
+    u32* output_buffer = reinterpret_cast<u32*>(buffers.data.get());
+
+    for (std::size_t i = 0; i < num_tiles; ++i) {
+        int image_strip_width = 0;
+        int output_stride = 0;
+
+        switch (cvt.rotation) {
+        case Rotation::None:
+            RotateTile0(tiles[i], tmp_tile, row_height, tile_remap);
+            image_strip_width = cvt.input_line_width;
+            output_stride = 8;
+            break;
+        case Rotation::Clockwise_90:
+            RotateTile90(tiles[i], tmp_tile, row_height, tile_remap);
+            image_strip_width = 8;
+            output_stride = 8 * row_height;
+            break;
+        case Rotation::Clockwise_180:
+            // For 180 and 270 degree rotations we also invert the order of tiles in the strip,
+            // since the rotates are done individually on each tile.
+            RotateTile180(tiles[num_tiles - i - 1], tmp_tile, row_height, tile_remap);
+            image_strip_width = cvt.input_line_width;
+            output_stride = 8;
+            break;
+        case Rotation::Clockwise_270:
+            RotateTile270(tiles[num_tiles - i - 1], tmp_tile, row_height, tile_remap);
+            image_strip_width = 8;
+            output_stride = 8 * row_height;
+            break;
+        }
+
+        switch (cvt.block_alignment) {
+        case BlockAlignment::Linear:
+            WriteTileToOutput(output_buffer, tmp_tile, row_height, image_strip_width);
+            output_buffer += output_stride;
+            break;
+        case BlockAlignment::Block8x8:
+            WriteTileToOutput(output_buffer, tmp_tile, 8, 8);
+            output_buffer += TILE_SIZE;
+            break;
+        }
+    }
+
+    const u32* rgb_data = reinterpret_cast<u32*>(buffers.data.get());
+    const u8 alpha = static_cast<u8>(cvt.alpha);
+    switch (cvt.output_format) {
+    case OutputFormat::RGBA8:
+        SendData<OutputFormat::RGBA8>(memory, rgb_data, cvt.dst, (int)row_data_size, alpha);
+        break;
+    case OutputFormat::RGB8:
+        SendData<OutputFormat::RGB8>(memory, rgb_data, cvt.dst, (int)row_data_size, alpha);
+        break;
+    case OutputFormat::RGB5A1:
+        SendData<OutputFormat::RGB5A1>(memory, rgb_data, cvt.dst, (int)row_data_size, alpha);
+        break;
+    case OutputFormat::RGB565:
+        SendData<OutputFormat::RGB565>(memory, rgb_data, cvt.dst, (int)row_data_size, alpha);
+        break;
+    }
+}
+
+/// Advances the CDMA buffers of `cvt` past the strip starting at line `y` exactly like
+/// ConvertStrip does, without accessing memory.
+static void SkipStrip(ConversionConfiguration& cvt, unsigned int y) {
+    const unsigned int row_height = std::min(cvt.input_lines - y, 8u);
+    const std::size_t row_data_size = row_height * cvt.input_line_width;
+
+    const auto skip_input = [](ConversionBuffer& buf, std::size_t amount, std::size_t n) {
+        SkipTransfers(buf, amount / (buf.transfer_unit / n));
+    };
+
+    switch (cvt.input_format) {
+    case InputFormat::YUV422_Indiv8:
+    case InputFormat::YUV422_Indiv16: {
+        const std::size_t n = cvt.input_format == InputFormat::YUV422_Indiv16 ? 2 : 1;
+        skip_input(cvt.src_Y, row_data_size, n);
+        skip_input(cvt.src_U, row_data_size / 2, n);
+        skip_input(cvt.src_V, row_data_size / 2, n);
+        break;
+    }
+    case InputFormat::YUV420_Indiv8:
+    case InputFormat::YUV420_Indiv16: {
+        const std::size_t n = cvt.input_format == InputFormat::YUV420_Indiv16 ? 2 : 1;
+        skip_input(cvt.src_Y, row_data_size, n);
+        skip_input(cvt.src_U, row_data_size / 4, n);
+        skip_input(cvt.src_V, row_data_size / 4, n);
+        break;
+    }
+    case InputFormat::YUYV422_Interleaved:
+        skip_input(cvt.src_YUYV, row_data_size * 2, 1);
+        break;
+    }
+
+    const std::size_t unit_pixels = cvt.dst.transfer_unit / BytesPerPixel(cvt.output_format);
+    SkipTransfers(cvt.dst, (row_data_size + unit_pixels - 1) / unit_pixels);
+}
+
+/// Returns true when the strip input amounts are whole multiples of the input transfer units.
+static bool IsInputTransferAligned(const ConversionConfiguration& cvt, std::size_t row_data_size) {
+    const auto aligned = [](const ConversionBuffer& buf, std::size_t amount, std::size_t n) {
+        const std::size_t output_unit = buf.transfer_unit / n;
+        return output_unit != 0 && amount % output_unit == 0;
+    };
+
+    switch (cvt.input_format) {
+    case InputFormat::YUV422_Indiv8:
+        return aligned(cvt.src_Y, row_data_size, 1) && aligned(cvt.src_U, row_data_size / 2, 1) &&
+               aligned(cvt.src_V, row_data_size / 2, 1);
+    case InputFormat::YUV420_Indiv8:
+        return aligned(cvt.src_Y, row_data_size, 1) && aligned(cvt.src_U, row_data_size / 4, 1) &&
+               aligned(cvt.src_V, row_data_size / 4, 1);
+    case InputFormat::YUV422_Indiv16:
+        return aligned(cvt.src_Y, row_data_size, 2) && aligned(cvt.src_U, row_data_size / 2, 2) &&
+               aligned(cvt.src_V, row_data_size / 2, 2);
+    case InputFormat::YUV420_Indiv16:
+        return aligned(cvt.src_Y, row_data_size, 2) && aligned(cvt.src_U, row_data_size / 4, 2) &&
+               aligned(cvt.src_V, row_data_size / 4, 2);
+    case InputFormat::YUYV422_Interleaved:
+        return aligned(cvt.src_YUYV, row_data_size * 2, 1);
+    }
+    return false;
+}
+
+/// Returns true when a strip is written out in whole output transfer units. Otherwise the last
+/// unit of the strip also writes stale pixels left in the CDMA buffer by the previous strip.
+static bool IsOutputTransferAligned(const ConversionConfiguration& cvt,
+                                    std::size_t row_data_size) {
+    const std::size_t bytes_per_pixel = BytesPerPixel(cvt.output_format);
+    const std::size_t unit_pixels = cvt.dst.transfer_unit / bytes_per_pixel;
+    return unit_pixels != 0 && cvt.dst.transfer_unit % bytes_per_pixel == 0 &&
+           row_data_size % unit_pixels == 0;
+}
+
+/**
+ * Returns true when the strips of a conversion can be converted independently. This requires the
+ * buffer addresses at the start of each strip to be computable up front, and each strip to only
+ * transfer its own pixels.
+ */
+static bool CanConvertStripsInParallel(const ConversionConfiguration& cvt) {
+    const auto aligned = [&cvt](std::size_t row_data_size) {
+        return IsInputTransferAligned(cvt, row_data_size) &&
+               IsOutputTransferAligned(cvt, row_data_size);
+    };
+
+    const unsigned int last_height = cvt.input_lines % 8;
+    return aligned(8 * cvt.input_line_width) &&
+           (last_height == 0 || aligned(last_height * cvt.input_line_width));
+}
+
+static Common::ThreadWorker& GetConversionWorkers() {
+    static Common::ThreadWorker workers{std::max(1U, std::thread::hardware_concurrency() / 2),
+                                        "Y2RWorker"};
+    return workers;
+}
+
+bool OverwritesOutputRegion(const ConversionConfiguration& cvt, u32 output_size) {
+    const std::size_t image_size =
+        cvt.input_line_width * cvt.input_lines * BytesPerPixel(cvt.output_format);
+    return cvt.dst.gap == 0 && output_size <= image_size;
+}
+
 /**
  * Performs a Y2R colorspace conversion.
  *
@@ -246,7 +513,9 @@ static void WriteTileToOutput(u32* output, const ImageTile& tile, int height, in
  * In this implementation, to avoid the combinatorial explosion of parameter combinations, common
  * intermediate formats are used and where possible tables or parameters are used instead of
  * diverging code paths to keep the amount of branches in check. Some steps are also merged to
- * increase efficiency.
+ * increase efficiency. The input and output formats are template parameters of the per-pixel
+ * kernels, and since the buffer addresses at the start of each strip can be computed up front,
+ * large images with well-formed transfer units can optionally be split across worker threads.
  *
  * Output for all valid settings combinations matches hardware, however output in some edge-cases
  * differs:
@@ -267,12 +536,6 @@ void PerformConversion(Memory::MemorySystem& memory, ConversionConfiguration& cv
     std::size_t num_tiles = cvt.input_line_width / 8;
     ASSERT(num_tiles <= MAX_TILES);
 
-    // Buffer used as a CDMA source/target.
-    std::unique_ptr<u8[]> data_buffer(new u8[cvt.input_line_width * 8 * 4]);
-    // Intermediate storage for decoded 8x8 image tiles. Always stored as RGB32.
-    std::unique_ptr<ImageTile[]> tiles(new ImageTile[num_tiles]);
-    ImageTile tmp_tile;
-
     // LUT used to remap writes to a tile. Used to allow linear or swizzled output without
     // requiring two different code paths.
     const u8* tile_remap = nullptr;
@@ -285,96 +548,55 @@ void PerformConversion(Memory::MemorySystem& memory, ConversionConfiguration& cv
         break;
     }
 
-    for (unsigned int y = 0; y < cvt.input_lines; y += 8) {
-        unsigned int row_height = std::min(cvt.input_lines - y, 8u);
-
-        // Total size in pixels of incoming data required for this strip.
-        const std::size_t row_data_size = row_height * cvt.input_line_width;
-
-        u8* input_Y = data_buffer.get();
-        u8* input_U = input_Y + 8 * cvt.input_line_width;
-        u8* input_V = input_U + 8 * cvt.input_line_width / 2;
+    const unsigned int num_strips = (cvt.input_lines + 7) / 8;
+    std::size_t num_threads = 1;
+    if (Settings::values.enable_y2r_multithread) {
+        num_threads = std::min<std::size_t>(GetConversionWorkers().NumWorkers() + 1,
+                                            num_strips / MIN_STRIPS_PER_THREAD);
+    }
 
-        switch (cvt.input_format) {
-        case InputFormat::YUV422_Indiv8:
-            ReceiveData<1>(memory, input_Y, cvt.src_Y, row_data_size);
-            ReceiveData<1>(memory, input_U, cvt.src_U, row_data_size / 2);
-            ReceiveData<1>(memory, input_V, cvt.src_V, row_data_size / 2);
-            break;
-        case InputFormat::YUV420_Indiv8:
-            ReceiveData<1>(memory, input_Y, cvt.src_Y, row_data_size);
-            ReceiveData<1>(memory, input_U, cvt.src_U, row_data_size / 4);
-            ReceiveData<1>(memory, input_V, cvt.src_V, row_data_size / 4);
-            break;
-        case InputFormat::YUV422_Indiv16:
-            ReceiveData<2>(memory, input_Y, cvt.src_Y, row_data_size);
-            ReceiveData<2>(memory, input_U, cvt.src_U, row_data_size / 2);
-            ReceiveData<2>(memory, input_V, cvt.src_V, row_data_size / 2);
-            break;
-        case InputFormat::YUV420_Indiv16:
-            ReceiveData<2>(memory, input_Y, cvt.src_Y, row_data_size);
-            ReceiveData<2>(memory, input_U, cvt.src_U, row_data_size / 4);
-            ReceiveData<2>(memory, input_V, cvt.src_V, row_data_size / 4);
-            break;
-        case InputFormat::YUYV422_Interleaved:
-            input_U = nullptr;
-            input_V = nullptr;
-            ReceiveData<1>(memory, input_Y, cvt.src_YUYV, row_data_size * 2);
-            break;
+    if (num_threads <= 1 || !CanConvertStripsInParallel(cvt)) {
+        StripBuffers buffers{cvt.input_line_width};
+        for (unsigned int y = 0; y < cvt.input_lines; y += 8) {
+            ConvertStrip(memory, cvt, y, buffers, tile_remap);
         }
+        return;
+    }
 
-        // Note(yuriks): If additional optimization is required, input_format can be moved to a
-        // template parameter, so that its dispatch can be moved to outside the inner loop.
-        ConvertYUVToRGB(cvt.input_format, input_Y, input_U, input_V, tiles.get(),
-                        cvt.input_line_width, row_height, cvt.coefficients);
-
-        u32* output_buffer = reinterpret_cast<u32*>(data_buffer.get());
-
-        for (std::size_t i = 0; i < num_tiles; ++i) {
-            int image_strip_width = 0;
-            int output_stride = 0;
-
-            switch (cvt.rotation) {
-            case Rotation::None:
-                RotateTile0(tiles[i], tmp_tile, row_height, tile_remap);
-                image_strip_width = cvt.input_line_width;
-                output_stride = 8;
-                break;
-            case Rotation::Clockwise_90:
-                RotateTile90(tiles[i], tmp_tile, row_height, tile_remap);
-                image_strip_width = 8;
-                output_stride = 8 * row_height;
-                break;
-            case Rotation::Clockwise_180:
-                // For 180 and 270 degree rotations we also invert the order of tiles in the strip,
-                // since the rotates are done individually on each tile.
-                RotateTile180(tiles[num_tiles - i - 1], tmp_tile, row_height, tile_remap);
-                image_strip_width = cvt.input_line_width;
-                output_stride = 8;
-                break;
-            case Rotation::Clockwise_270:
-                RotateTile270(tiles[num_tiles - i - 1], tmp_tile, row_height, tile_remap);
-                image_strip_width = 8;
-                output_stride = 8 * row_height;
-                break;
+    // Split the strips in contiguous ranges, each converted from a copy of the configuration
+    // advanced to the start of its range. The calling thread converts the last range and `cvt`
+    // ends up advanced past the whole image, like in the serial path.
+    const unsigned int strips_per_thread = (num_strips + num_threads - 1) / num_threads;
+    auto& workers = GetConversionWorkers();
+    ConversionConfiguration thread_cvt = cvt;
+    for (unsigned int strip = 0; strip < num_strips; strip += strips_per_thread) {
+        const unsigned int first_line = strip * 8;
+        const unsigned int last_line =
+            std::min<unsigned int>(cvt.input_lines, (strip + strips_per_thread) * 8);
+        auto convert_range = [&memory, tile_remap, first_line, last_line,
+                                    range_cvt = thread_cvt]() mutable {
+            StripBuffers buffers{range_cvt.input_line_width};
+            for (unsigned int y = first_line; y < last_line; y += 8) {
+                ConvertStrip(memory, range_cvt, y, buffers, tile_remap);
             }
+        };
 
-            switch (cvt.block_alignment) {
-            case BlockAlignment::Linear:
-                WriteTileToOutput(output_buffer, tmp_tile, row_height, image_strip_width);
-                output_buffer += output_stride;
-                break;
-            case BlockAlignment::Block8x8:
-                WriteTileToOutput(output_buffer, tmp_tile, 8, 8);
-                output_buffer += TILE_SIZE;
-                break;
-            }
+        for (unsigned int y = first_line; y < last_line; y += 8) {
+            SkipStrip(thread_cvt, y);
         }
 
-        // Note(yuriks): If additional optimization is required, output_format can be moved to a
-        // template parameter, so that its dispatch can be moved to outside the inner loop.
-        SendData(memory, reinterpret_cast<u32*>(data_buffer.get()), cvt.dst, (int)row_data_size,
-                 cvt.output_format, (u8)cvt.alpha);
+        if (last_line < cvt.input_lines) {
+            workers.QueueWork(convert_range);
+        } else {
+            convert_range();
+        }
     }
+
+    workers.WaitForRequests();
+    cvt.src_Y = thread_cvt.src_Y;
+    cvt.src_U = thread_cvt.src_U;
+    cvt.src_V = thread_cvt.src_V;
+    cvt.src_YUYV = thread_cvt.src_YUYV;
+    cvt.dst = thread_cvt.dst;
 }
 } // namespace HW::Y2R
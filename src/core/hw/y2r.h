@@ -4,6 +4,8 @@
 
 #pragma once
 
+#include "common/common_types.h"
+
 namespace Memory {
 class MemorySystem;
 }
@@ -13,5 +15,12 @@ struct ConversionConfiguration;
 } // namespace Service::Y2R
 
 namespace HW::Y2R {
+/**
+ * Returns true when a conversion writes every byte of its output region, which is the case when
+ * the output transfers have no gaps and the image fills all of them.
+ * @param output_size Size in bytes of the output region, including the gaps
+ */
+bool OverwritesOutputRegion(const Service::Y2R::ConversionConfiguration& cvt, u32 output_size);
+
 void PerformConversion(Memory::MemorySystem& memory, Service::Y2R::ConversionConfiguration& cvt);
 } // namespace HW::Y2R
@@ -4,6 +4,8 @@
 
 #include <array>
 #include <cstring>
+#include <mutex>
+#include <utility>
 #include <boost/serialization/array.hpp>
 #include <boost/serialization/binary_object.hpp>
 #include "audio_core/dsp_interface.h"
@@ -19,6 +21,8 @@
 #include "core/hle/kernel/memory.h"
 #include "core/hle/kernel/process.h"
 #include "core/hle/lock.h"
+#include "core/hw/gpu.h"
+#include "core/hw/gpu_thread.h"
 #include "core/memory.h"
 #include "core/settings.h"
 //#include "video_core/renderer_base.h"
@@ -94,6 +98,16 @@ public:
     RasterizerCacheMarker cache_marker;
     std::vector<std::shared_ptr<PageTable>> page_table_list;
 
+    /// A cache mark made by the GPU thread that the emulation thread has yet to apply
+    struct DeferredMark {
+        PAddr start;
+        u32 size;
+        bool cached;
+    };
+
+    std::mutex deferred_marks_mutex;
+    std::vector<DeferredMark> deferred_marks;
+
     AudioCore::DspInterface* dsp = nullptr;
 
     std::shared_ptr<BackingMem> fcram_mem;
@@ -564,6 +578,33 @@ void MemorySystem::RasterizerMarkRegionCached(PAddr start, u32 size, bool cached
         return;
     }
 
+    if (GPU::GPUThread::IsGPUThread()) {
+        std::scoped_lock lock{impl->deferred_marks_mutex};
+        impl->deferred_marks.push_back({start, size, cached});
+        return;
+    }
+
+    // Marks of the GPU thread that are still pending were made earlier, so they go first
+    ApplyDeferredRasterizerMarks();
+    MarkRegionCached(start, size, cached);
+}
+
+void MemorySystem::ApplyDeferredRasterizerMarks() {
+    std::vector<Impl::DeferredMark> marks;
+    {
+        std::scoped_lock lock{impl->deferred_marks_mutex};
+        if (impl->deferred_marks.empty()) {
+            return;
+        }
+        marks = std::exchange(impl->deferred_marks, {});
+    }
+
+    for (const auto& mark : marks) {
+        MarkRegionCached(mark.start, mark.size, mark.cached);
+    }
+}
+
+void MemorySystem::MarkRegionCached(PAddr start, u32 size, bool cached) {
     u32 num_pages = ((start + size - 1) >> PAGE_BITS) - (start >> PAGE_BITS) + 1;
     PAddr paddr = start;
 
@@ -614,6 +655,8 @@ void RasterizerFlushRegion(PAddr start, u32 size) {
         return;
     }
 
+    GPU::SyncGPUThread();
+
     VideoCore::g_renderer->Rasterizer()->FlushRegion(start, size);
 }
 
@@ -622,6 +665,8 @@ void RasterizerInvalidateRegion(PAddr start, u32 size) {
         return;
     }
 
+    GPU::SyncGPUThread();
+
     VideoCore::g_renderer->Rasterizer()->InvalidateRegion(start, size);
 }
 
@@ -632,6 +677,8 @@ void RasterizerFlushAndInvalidateRegion(PAddr start, u32 size) {
         return;
     }
 
+    GPU::SyncGPUThread();
+
     VideoCore::g_renderer->Rasterizer()->FlushAndInvalidateRegion(start, size);
 }
 
@@ -642,6 +689,8 @@ void RasterizerClearAll(bool flush) {
         return;
     }
 
+    GPU::SyncGPUThread();
+
     VideoCore::g_renderer->Rasterizer()->ClearAll(flush);
 }
 
@@ -652,6 +701,8 @@ void RasterizerFlushVirtualRegion(VAddr start, u32 size, FlushMode mode) {
         return;
     }
 
+    GPU::SyncGPUThread();
+
     VAddr end = start + size;
 
     auto CheckRegion = [&](VAddr region_start, VAddr region_end, PAddr paddr_region_start) {
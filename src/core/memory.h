@@ -382,10 +382,15 @@ public:
     MemoryRef GetFCRAMRef(std::size_t offset) const;
 
     /**
-     * Mark each page touching the region as cached.
+     * Mark each page touching the region as cached. When called from the GPU thread the change
+     * is deferred until the emulation thread applies it, as the CPU reads the page tables
+     * without any synchronization.
      */
     void RasterizerMarkRegionCached(PAddr start, u32 size, bool cached);
 
+    /// Applies the cache marks deferred by the GPU thread. Must be called on the emulation thread
+    void ApplyDeferredRasterizerMarks();
+
     /// Registers page table for rasterizer cache marking
     void RegisterPageTable(std::shared_ptr<PageTable> page_table);
 
@@ -412,6 +417,9 @@ private:
      */
     MemoryRef GetPointerForRasterizerCache(VAddr addr) const;
 
+    /// Updates the page tables for a change of the cached state of the region
+    void MarkRegionCached(PAddr start, u32 size, bool cached);
+
     void MapPages(PageTable& page_table, u32 base, u32 size, MemoryRef memory, PageType type);
 
     class Impl;
@@ -73,6 +73,37 @@ void PerfStats::EndGameFrame() {
     game_frames += 1;
 }
 
+void PerfStats::AddPresentedFrame(Clock::duration latency) {
+    std::lock_guard lock{object_mutex};
+
+    accumulated_present_latency += latency;
+    presented_frames += 1;
+}
+
+void PerfStats::AddDuplicatedFrame() {
+    std::lock_guard lock{object_mutex};
+
+    duplicated_frames += 1;
+}
+
+void PerfStats::AddDroppedFrame() {
+    std::lock_guard lock{object_mutex};
+
+    dropped_frames += 1;
+}
+
+void PerfStats::AddAudioUnderruns(u32 count) {
+    std::lock_guard lock{object_mutex};
+
+    audio_underruns += count;
+}
+
+void PerfStats::AddAudioOverrun() {
+    std::lock_guard lock{object_mutex};
+
+    audio_overruns += 1;
+}
+
 double PerfStats::GetMeanFrametime() const {
     std::lock_guard lock{object_mutex};
 
@@ -100,6 +131,14 @@ PerfStats::Results PerfStats::GetAndResetStats(microseconds current_system_time_
     results.frametime = duration_cast<DoubleSecs>(accumulated_frametime).count() /
                         static_cast<double>(system_frames);
     results.emulation_speed = system_us_per_second.count() / 1'000'000.0;
+    results.present_latency =
+        presented_frames > 0 ? duration_cast<DoubleSecs>(accumulated_present_latency).count() /
+                                   static_cast<double>(presented_frames)
+                             : 0.0;
+    results.dropped_frames = dropped_frames;
+    results.duplicated_frames = duplicated_frames;
+    results.audio_underruns = audio_underruns;
+    results.audio_overruns = audio_overruns;
 
     // Reset counters
     reset_point = now;
@@ -107,6 +146,12 @@ PerfStats::Results PerfStats::GetAndResetStats(microseconds current_system_time_
     accumulated_frametime = Clock::duration::zero();
     system_frames = 0;
     game_frames = 0;
+    accumulated_present_latency = Clock::duration::zero();
+    presented_frames = 0;
+    dropped_frames = 0;
+    duplicated_frames = 0;
+    audio_underruns = 0;
+    audio_overruns = 0;
 
     return results;
 }
@@ -34,12 +34,33 @@ public:
         double frametime;
         /// Ratio of walltime / emulated time elapsed
         double emulation_speed;
+        /// Average time between a frame being submitted and presented, in seconds
+        double present_latency;
+        /// Frames replaced in the present mailbox before they were presented
+        u32 dropped_frames;
+        /// Frames presented again because no new frame was ready in time
+        u32 duplicated_frames;
+        /// Times the audio output ran out of samples
+        u32 audio_underruns;
+        /// Times audio samples were dropped because the output queue was full
+        u32 audio_overruns;
     };
 
     void BeginSystemFrame();
     void EndSystemFrame();
     void EndGameFrame();
 
+    /// Records a new frame shown by the present thread and how long it waited since submission
+    void AddPresentedFrame(Clock::duration latency);
+    /// Records a frame that was shown again because no new frame was ready in time
+    void AddDuplicatedFrame();
+    /// Records a frame that was replaced before the present thread could show it
+    void AddDroppedFrame();
+    /// Records times the audio output ran out of samples
+    void AddAudioUnderruns(u32 count);
+    /// Records audio samples being dropped because the output queue was full
+    void AddAudioOverrun();
+
     Results GetAndResetStats(std::chrono::microseconds current_system_time_us);
 
     /**
@@ -75,6 +96,16 @@ private:
     u32 system_frames = 0;
     /// Cumulative number of game frames (GSP frame submissions) since last reset
     u32 game_frames = 0;
+    /// Cumulative submission to presentation latency of presented frames since last reset
+    Clock::duration accumulated_present_latency = Clock::duration::zero();
+    /// Cumulative number of new frames shown by the present thread since last reset
+    u32 presented_frames = 0;
+    /// Cumulative number of dropped and duplicated frames since last reset
+    u32 dropped_frames = 0;
+    u32 duplicated_frames = 0;
+    /// Cumulative number of audio underruns and overruns since last reset
+    u32 audio_underruns = 0;
+    u32 audio_overruns = 0;
 
     /// Point when the previous system frame ended
     Clock::time_point previous_frame_end = reset_point;
@@ -49,6 +49,7 @@ void Apply() {
         system.CoreTiming().UpdateClockSpeed(values.cpu_clock_percentage);
         Core::DSP().SetSink(values.sink_id, values.audio_device_id);
         Core::DSP().EnableStretching(values.enable_audio_stretching);
+        Core::DSP().SetLatency(values.audio_latency);
 
         auto hid = Service::HID::GetModule(system);
         if (hid) {
@@ -80,12 +81,19 @@ void LogSettings() {
     LOG_INFO(Config, "Citra Configuration:");
     log_setting("Core_UseCpuJit", values.use_cpu_jit);
     log_setting("Core_CPUClockPercentage", values.cpu_clock_percentage);
+    log_setting("Core_EnableY2RMultithread", values.enable_y2r_multithread);
     log_setting("Renderer_UseGLES", values.use_gles);
     log_setting("Renderer_UseHwRenderer", values.use_hw_renderer);
     log_setting("Renderer_UseHwShader", values.use_hw_shader);
     log_setting("Renderer_SeparableShader", values.separable_shader);
     log_setting("Renderer_ShadersAccurateMul", values.shaders_accurate_mul);
     log_setting("Renderer_UseShaderJit", values.use_shader_jit);
+    log_setting("Renderer_AsyncPipelineCompile", values.async_pipeline_compile);
+    log_setting("Renderer_AsyncPipelineSkipFrames", values.async_pipeline_skip_frames);
+    log_setting("Renderer_UberShaderMode", values.ubershader_mode);
+    log_setting("Renderer_FramesInFlight", values.frames_in_flight);
+    log_setting("Renderer_UseGPUThread", values.use_gpu_thread);
+    log_setting("Renderer_UsePresentThread", values.use_present_thread);
     log_setting("Renderer_UseResolutionFactor", values.resolution_factor);
     log_setting("Renderer_FrameLimit", values.frame_limit);
     log_setting("Renderer_UseFrameLimitAlternate", values.use_frame_limit_alternate);
@@ -101,11 +109,15 @@ void LogSettings() {
     log_setting("Layout_UprightScreen", values.upright_screen);
     log_setting("Utility_DumpTextures", values.dump_textures);
     log_setting("Utility_CustomTextures", values.custom_textures);
+    log_setting("Utility_AsyncCustomLoading", values.async_custom_loading);
+    log_setting("Utility_CustomTexturesBudget", values.custom_textures_budget);
     log_setting("Utility_UseDiskShaderCache", values.use_disk_shader_cache);
     log_setting("Audio_EnableDspLle", values.enable_dsp_lle);
     log_setting("Audio_EnableDspLleMultithread", values.enable_dsp_lle_multithread);
+    log_setting("Audio_EnablePolyphaseFilter", values.enable_polyphase_filter);
     log_setting("Audio_OutputEngine", values.sink_id);
     log_setting("Audio_EnableAudioStretching", values.enable_audio_stretching);
+    log_setting("Audio_Latency", values.audio_latency);
     log_setting("Audio_OutputDevice", values.audio_device_id);
     log_setting("Audio_InputDeviceType", values.mic_input_type);
     log_setting("Audio_InputDevice", values.mic_input_device);
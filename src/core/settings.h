@@ -19,6 +19,12 @@ enum class RendererBackend : u32 {
     Vulkan = 1,
 };
 
+enum class UberShaderMode : u32 {
+    Disabled = 0, ///< Only use specialized fragment shaders
+    Fallback = 1, ///< Use the ubershader while specialized pipelines are compiling
+    Always = 2,   ///< Always use the ubershader, useful for benchmarking
+};
+
 enum class InitClock {
     SystemTime = 0,
     FixedTime = 1,
@@ -154,6 +160,7 @@ struct Values {
     // Core
     bool use_cpu_jit;
     int cpu_clock_percentage;
+    bool enable_y2r_multithread;
 
     // Data Storage
     bool use_virtual_sd;
@@ -174,6 +181,12 @@ struct Values {
     bool separable_shader;
     bool use_disk_shader_cache;
     bool shaders_accurate_mul;
+    bool async_pipeline_compile;
+    u16 async_pipeline_skip_frames;
+    UberShaderMode ubershader_mode;
+    u16 frames_in_flight;
+    bool use_gpu_thread;
+    bool use_present_thread;
     bool use_shader_jit;
     u16 resolution_factor;
     bool use_frame_limit_alternate;
@@ -211,14 +224,18 @@ struct Values {
     bool dump_textures;
     bool custom_textures;
     bool preload_textures;
+    bool async_custom_loading;
+    u32 custom_textures_budget;
 
     bool use_vsync_new;
 
     // Audio
     bool enable_dsp_lle;
     bool enable_dsp_lle_multithread;
+    bool enable_polyphase_filter;
     std::string sink_id;
     bool enable_audio_stretching;
+    u32 audio_latency;
     std::string audio_device_id;
     float volume;
     MicInputType mic_input_type;
@@ -0,0 +1,107 @@
+// Copyright 2022 Citra Emulator Project
+// Licensed under GPLv2 or any later version
+// Refer to the license.txt file included.
+
+#include <algorithm>
+#include <random>
+#include <catch2/catch_test_macros.hpp>
+#include "audio_core/hle/filter.h"
+
+namespace {
+
+using namespace AudioCore;
+using Configuration = HLE::SourceConfiguration::Configuration;
+
+/// Per-sample reference implementation of the simple filter
+struct ReferenceSimpleFilter {
+    std::array<s16, 2> ProcessSample(const std::array<s16, 2>& x0) {
+        std::array<s16, 2> y0;
+        for (std::size_t i = 0; i < 2; i++) {
+            const s32 tmp = (b0 * x0[i] + a1 * y1[i]) >> 15;
+            y0[i] = std::clamp(tmp, -32768, 32767);
+        }
+        y1 = y0;
+        return y0;
+    }
+
+    s32 a1, b0;
+    std::array<s16, 2> y1{};
+};
+
+/// Per-sample reference implementation of the biquad filter
+struct ReferenceBiquadFilter {
+    std::array<s16, 2> ProcessSample(const std::array<s16, 2>& x0) {
+        std::array<s16, 2> y0;
+        for (std::size_t i = 0; i < 2; i++) {
+            const s32 tmp = (b0 * x0[i] + b1 * x1[i] + b2 * x2[i] + a1 * y1[i] + a2 * y2[i]) >> 14;
+            y0[i] = std::clamp(tmp, -32768, 32767);
+        }
+        x2 = x1;
+        x1 = x0;
+        y2 = y1;
+        y1 = y0;
+        return y0;
+    }
+
+    s32 a1, a2, b0, b1, b2;
+    std::array<s16, 2> x1{};
+    std::array<s16, 2> x2{};
+    std::array<s16, 2> y1{};
+    std::array<s16, 2> y2{};
+};
+
+} // Anonymous namespace
+
+TEST_CASE("SourceFilters matches the per-sample filters", "[audio_core][hle]") {
+    std::mt19937 rng(5678);
+    std::uniform_int_distribution<int> sample_dist(-32768, 32767);
+    // Kept small enough that the five products of the biquad can't overflow s32
+    std::uniform_int_distribution<int> coeff_dist(-0x2000, 0x2000);
+
+    for (const bool simple : {false, true}) {
+        for (const bool biquad : {false, true}) {
+            Configuration::SimpleFilter simple_config;
+            simple_config.b0 = static_cast<s16>(coeff_dist(rng));
+            simple_config.a1 = static_cast<s16>(coeff_dist(rng));
+
+            Configuration::BiquadFilter biquad_config;
+            biquad_config.a2 = static_cast<s16>(coeff_dist(rng));
+            biquad_config.a1 = static_cast<s16>(coeff_dist(rng));
+            biquad_config.b2 = static_cast<s16>(coeff_dist(rng));
+            biquad_config.b1 = static_cast<s16>(coeff_dist(rng));
+            biquad_config.b0 = static_cast<s16>(coeff_dist(rng));
+
+            HLE::SourceFilters filters;
+            filters.Enable(simple, biquad);
+            filters.Configure(simple_config);
+            filters.Configure(biquad_config);
+
+            ReferenceSimpleFilter reference_simple{simple_config.a1, simple_config.b0};
+            ReferenceBiquadFilter reference_biquad{biquad_config.a1, biquad_config.a2,
+                                                   biquad_config.b0, biquad_config.b1,
+                                                   biquad_config.b2};
+
+            // Several frames, so that the filter state is carried over between them
+            for (int frame_index = 0; frame_index < 8; frame_index++) {
+                StereoFrame16 frame;
+                for (auto& sample : frame) {
+                    sample = {static_cast<s16>(sample_dist(rng)),
+                              static_cast<s16>(sample_dist(rng))};
+                }
+
+                StereoFrame16 reference_frame = frame;
+                for (auto& sample : reference_frame) {
+                    if (simple) {
+                        sample = reference_simple.ProcessSample(sample);
+                    }
+                    if (biquad) {
+                        sample = reference_biquad.ProcessSample(sample);
+                    }
+                }
+
+                filters.ProcessFrame(frame);
+                REQUIRE(frame == reference_frame);
+            }
+        }
+    }
+}
@@ -0,0 +1,108 @@
+// Copyright 2022 Citra Emulator Project
+// Licensed under GPLv2 or any later version
+// Refer to the license.txt file included.
+
+#include <algorithm>
+#include <random>
+#include <catch2/catch_test_macros.hpp>
+#include "audio_core/hle/mixers.h"
+
+namespace {
+
+using namespace AudioCore;
+using OutputFormat = HLE::DspConfiguration::OutputFormat;
+
+s16 ClampToS16(s32 value) {
+    return static_cast<s16>(std::clamp(value, -32768, 32767));
+}
+
+/// Per-sample reference implementation of the final downmix
+void ReferenceDownmix(OutputFormat format, float gain, const QuadFrame32& samples,
+                      StereoFrame16& frame) {
+    for (std::size_t i = 0; i < samples_per_frame; i++) {
+        const auto& sample = samples[i];
+        s16 left, right;
+        if (format == OutputFormat::Mono) {
+            left = right = ClampToS16(static_cast<s32>(
+                (gain * sample[0] + gain * sample[1] + gain * sample[2] + gain * sample[3]) / 2));
+        } else {
+            left = ClampToS16(static_cast<s32>(gain * sample[0] + gain * sample[2]));
+            right = ClampToS16(static_cast<s32>(gain * sample[1] + gain * sample[3]));
+        }
+        frame[i][0] = ClampToS16(frame[i][0] + left);
+        frame[i][1] = ClampToS16(frame[i][1] + right);
+    }
+}
+
+} // Anonymous namespace
+
+TEST_CASE("Mixers matches the per-sample downmix", "[audio_core][hle]") {
+    std::mt19937 rng(91011);
+    // Wide enough that both the downmix and the accumulation saturate
+    std::uniform_int_distribution<s32> sample_dist(-60000, 60000);
+    std::uniform_real_distribution<float> volume_dist(0.0f, 1.5f);
+
+    for (const auto format : {OutputFormat::Mono, OutputFormat::Stereo, OutputFormat::Surround}) {
+        for (const bool aux_enabled : {false, true}) {
+            HLE::Mixers mixers;
+            for (int frame_index = 0; frame_index < 4; frame_index++) {
+                HLE::DspConfiguration config{};
+                config.output_format = format;
+                config.output_format_dirty.Assign(1);
+                config.mixer1_enabled = aux_enabled;
+                config.mixer1_enabled_dirty.Assign(1);
+                config.mixer2_enabled = aux_enabled;
+                config.mixer2_enabled_dirty.Assign(1);
+
+                // One of the mixes is muted, as is common
+                std::array<float, 3> volumes{volume_dist(rng), 0.0f, volume_dist(rng)};
+                for (std::size_t mix = 0; mix < 3; mix++) {
+                    config.volume[mix] = volumes[mix];
+                }
+                config.volume_0_dirty.Assign(1);
+                config.volume_1_dirty.Assign(1);
+                config.volume_2_dirty.Assign(1);
+
+                std::array<QuadFrame32, 3> input;
+                for (auto& mix : input) {
+                    for (auto& sample : mix) {
+                        for (auto& value : sample) {
+                            value = sample_dist(rng);
+                        }
+                    }
+                }
+
+                HLE::IntermediateMixSamples read_samples{};
+                for (std::size_t channel = 0; channel < 4; channel++) {
+                    for (std::size_t i = 0; i < samples_per_frame; i++) {
+                        read_samples.mix1.pcm32[channel][i] = sample_dist(rng);
+                        read_samples.mix2.pcm32[channel][i] = sample_dist(rng);
+                    }
+                }
+                HLE::IntermediateMixSamples write_samples{};
+
+                mixers.Tick(config, read_samples, write_samples, input);
+
+                // The auxiliary mixes are replaced by the samples returned by the application
+                std::array<QuadFrame32, 3> mixed = input;
+                if (aux_enabled) {
+                    for (std::size_t channel = 0; channel < 4; channel++) {
+                        for (std::size_t i = 0; i < samples_per_frame; i++) {
+                            mixed[1][i][channel] = read_samples.mix1.pcm32[channel][i];
+                            mixed[2][i][channel] = read_samples.mix2.pcm32[channel][i];
+                            REQUIRE(write_samples.mix1.pcm32[channel][i] == input[1][i][channel]);
+                            REQUIRE(write_samples.mix2.pcm32[channel][i] == input[2][i][channel]);
+                        }
+                    }
+                }
+
+                StereoFrame16 reference_frame{};
+                for (std::size_t mix = 0; mix < 3; mix++) {
+                    ReferenceDownmix(format, volumes[mix], mixed[mix], reference_frame);
+                }
+
+                REQUIRE(mixers.GetOutput() == reference_frame);
+            }
+        }
+    }
+}
@@ -0,0 +1,135 @@
+// Copyright 2022 Citra Emulator Project
+// Licensed under GPLv2 or any later version
+// Refer to the license.txt file included.
+
+#include <array>
+#include <random>
+#include <catch2/benchmark/catch_benchmark.hpp>
+#include <catch2/catch_test_macros.hpp>
+#include "audio_core/hle/shared_memory.h"
+#include "audio_core/hle/source.h"
+#include "core/memory.h"
+
+namespace {
+
+using namespace AudioCore;
+using Configuration = HLE::SourceConfiguration::Configuration;
+
+constexpr u32 BUFFER_LENGTH = 4096;
+constexpr u32 BUFFER_SIZE = BUFFER_LENGTH * 4;
+
+/// Configures a source to loop an embedded buffer
+void ConfigureSource(Configuration& config, std::size_t source_id, Configuration::Format format,
+                     Configuration::MonoOrStereo mono_or_stereo,
+                     Configuration::InterpolationMode interpolation, float rate) {
+    config = {};
+    config.enable = 1;
+    config.enable_dirty.Assign(1);
+    config.rate_multiplier = rate;
+    config.rate_multiplier_dirty.Assign(1);
+    config.interpolation_mode = interpolation;
+    config.interpolation_dirty.Assign(1);
+    config.gain[0][0] = 1.0f;
+    config.gain[0][1] = 1.0f;
+    config.gain_0_dirty.Assign(1);
+    config.adpcm_coefficients_dirty.Assign(1);
+
+    config.physical_address = static_cast<u32>(Memory::FCRAM_PADDR + source_id * BUFFER_SIZE);
+    config.length = BUFFER_LENGTH;
+    config.format.Assign(format);
+    config.mono_or_stereo.Assign(mono_or_stereo);
+    config.is_looping.Assign(1);
+    config.buffer_id = static_cast<u16>(source_id + 1);
+    config.embedded_buffer_dirty.Assign(1);
+}
+
+/// Holds the 24 sources of the DSP and the emulated memory their buffers are read from
+struct SourceFixture {
+    SourceFixture() {
+        std::mt19937 rng(42);
+        u8* fcram = memory.GetFCRAMPointer(0);
+        for (std::size_t i = 0; i < HLE::num_sources * BUFFER_SIZE; i++) {
+            fcram[i] = static_cast<u8>(rng());
+        }
+
+        for (std::size_t i = 0; i < HLE::num_sources; i++) {
+            sources[i] = std::make_unique<HLE::Source>(i);
+            sources[i]->SetMemory(memory);
+        }
+
+        // ADPCM coefficients are 11 bit fixed point, keep the filters stable
+        for (std::size_t i = 0; i < 16; i++) {
+            adpcm_coeffs[i] = static_cast<s16>(i % 2 == 0 ? 0x400 : -0x100);
+        }
+    }
+
+    /// Runs one audio frame the way DspHle::Impl::GenerateCurrentFrame does
+    std::array<QuadFrame32, 3> Tick() {
+        std::array<QuadFrame32, 3> intermediate_mixes{};
+        for (std::size_t i = 0; i < HLE::num_sources; i++) {
+            sources[i]->Tick(configs[i], adpcm_coeffs);
+            for (std::size_t mix = 0; mix < 3; mix++) {
+                sources[i]->MixInto(intermediate_mixes[mix], mix);
+            }
+        }
+        return intermediate_mixes;
+    }
+
+    Memory::MemorySystem memory;
+    std::array<std::unique_ptr<HLE::Source>, HLE::num_sources> sources;
+    std::array<Configuration, HLE::num_sources> configs{};
+    s16_le adpcm_coeffs[16]{};
+};
+
+} // Anonymous namespace
+
+TEST_CASE("HLE::Source loops a PCM16 buffer", "[audio_core][hle]") {
+    SourceFixture fixture;
+    ConfigureSource(fixture.configs[0], 0, Configuration::Format::PCM16,
+                    Configuration::MonoOrStereo::Stereo, Configuration::InterpolationMode::None,
+                    1.0f);
+
+    const s16* pcm = reinterpret_cast<const s16*>(fixture.memory.GetFCRAMPointer(0));
+    const auto mixes = fixture.Tick();
+
+    // There is a two-sample predelay, after which the buffer is played back unchanged
+    REQUIRE(mixes[0][0][0] == 0);
+    REQUIRE(mixes[0][1][0] == 0);
+    for (std::size_t i = 2; i < samples_per_frame; i++) {
+        REQUIRE(mixes[0][i][0] == pcm[(i - 2) * 2]);
+        REQUIRE(mixes[0][i][1] == pcm[(i - 2) * 2 + 1]);
+    }
+}
+
+TEST_CASE("HLE::Source throughput", "[.benchmark][audio_core][hle]") {
+    using Format = Configuration::Format;
+    using MonoOrStereo = Configuration::MonoOrStereo;
+    using InterpolationMode = Configuration::InterpolationMode;
+
+    const auto configure = [](SourceFixture& fixture, Format format, MonoOrStereo mono_or_stereo,
+                              InterpolationMode interpolation) {
+        for (std::size_t i = 0; i < HLE::num_sources; i++) {
+            // Mix of sample rates as games use, from 11kHz up to 48kHz content
+            const float rate = 0.35f + 0.05f * static_cast<float>(i);
+            ConfigureSource(fixture.configs[i], i, format, mono_or_stereo, interpolation, rate);
+        }
+    };
+
+    SourceFixture adpcm;
+    configure(adpcm, Format::ADPCM, MonoOrStereo::Mono, InterpolationMode::Linear);
+    BENCHMARK("24 ADPCM sources, linear interpolation") {
+        return adpcm.Tick();
+    };
+
+    SourceFixture pcm16;
+    configure(pcm16, Format::PCM16, MonoOrStereo::Stereo, InterpolationMode::Linear);
+    BENCHMARK("24 stereo PCM16 sources, linear interpolation") {
+        return pcm16.Tick();
+    };
+
+    SourceFixture pcm8;
+    configure(pcm8, Format::PCM8, MonoOrStereo::Mono, InterpolationMode::None);
+    BENCHMARK("24 mono PCM8 sources, no interpolation") {
+        return pcm8.Tick();
+    };
+}
@@ -0,0 +1,225 @@
+// Copyright 2022 Citra Emulator Project
+// Licensed under GPLv2 or any later version
+// Refer to the license.txt file included.
+
+#include <algorithm>
+#include <cmath>
+#include <deque>
+#include <numbers>
+#include <random>
+#include <catch2/benchmark/catch_benchmark.hpp>
+#include <catch2/catch_test_macros.hpp>
+#include "audio_core/interpolate.h"
+
+namespace {
+
+using namespace AudioCore;
+
+constexpr u64 scale_factor = 1 << 24;
+constexpr u64 scale_mask = scale_factor - 1;
+
+struct ReferenceState {
+    std::array<s16, 2> xn1 = {};
+    std::array<s16, 2> xn2 = {};
+    u64 fposition = 0;
+};
+
+/// The original deque based implementation, which inserts and erases at the front every call
+template <typename Function>
+void ReferenceStepOverSamples(ReferenceState& state, std::deque<std::array<s16, 2>>& input,
+                              float rate, StereoFrame16& output, std::size_t& outputi,
+                              Function fn) {
+    if (input.empty())
+        return;
+
+    input.insert(input.begin(), {state.xn2, state.xn1});
+
+    const u64 step_size = static_cast<u64>(rate * scale_factor);
+    u64 fposition = state.fposition;
+    std::size_t inputi = 0;
+
+    while (outputi < output.size()) {
+        inputi = static_cast<std::size_t>(fposition / scale_factor);
+
+        if (inputi + 2 >= input.size()) {
+            inputi = input.size() - 2;
+            break;
+        }
+
+        u64 fraction = fposition & scale_mask;
+        output[outputi++] = fn(fraction, input[inputi], input[inputi + 1], input[inputi + 2]);
+
+        fposition += step_size;
+    }
+
+    state.xn2 = input[inputi];
+    state.xn1 = input[inputi + 1];
+    state.fposition = fposition - inputi * scale_factor;
+
+    input.erase(input.begin(), std::next(input.begin(), inputi + 2));
+}
+
+std::array<s16, 2> ReferenceLinear(u64 fraction, const std::array<s16, 2>& x0,
+                                   const std::array<s16, 2>& x1, const std::array<s16, 2>&) {
+    s64 delta0 = std::clamp<s64>(x1[0] - x0[0], -32768, 32767);
+    s64 delta1 = std::clamp<s64>(x1[1] - x0[1], -32768, 32767);
+
+    return std::array<s16, 2>{
+        static_cast<s16>(x0[0] + fraction * delta0 / scale_factor),
+        static_cast<s16>(x0[1] + fraction * delta1 / scale_factor),
+    };
+}
+
+/// Resamples a whole buffer, one frame at a time
+template <typename Function>
+std::vector<std::array<s16, 2>> Resample(Function interpolate, const StereoBuffer16& buffer,
+                                         float rate, std::size_t num_frames) {
+    AudioInterp::State state{};
+    std::vector<std::array<s16, 2>> result;
+    StereoBuffer16 input = buffer;
+    for (std::size_t frame = 0; frame < num_frames && !input.empty(); frame++) {
+        StereoFrame16 output{};
+        std::size_t outputi = 0;
+        interpolate(state, input, rate, output, outputi);
+        result.insert(result.end(), output.begin(), output.begin() + outputi);
+    }
+    return result;
+}
+
+/// Generates a stereo sine wave, with the channels in opposite phase
+StereoBuffer16 MakeSine(std::size_t size, double period) {
+    StereoBuffer16 buffer(size);
+    for (std::size_t i = 0; i < size; i++) {
+        const double value = 16000.0 * std::sin(2 * std::numbers::pi * i / period);
+        buffer[i] = {static_cast<s16>(value), static_cast<s16>(-value)};
+    }
+    return buffer;
+}
+
+} // Anonymous namespace
+
+TEST_CASE("AudioInterp::Linear matches the deque implementation", "[audio_core]") {
+    std::mt19937 rng(1234);
+    std::uniform_int_distribution<int> sample_dist(-32768, 32767);
+    std::uniform_int_distribution<std::size_t> length_dist(1, 400);
+
+    for (const float rate : {0.25f, 0.5f, 1.0f, 1.37f, 2.0f, 3.9f}) {
+        AudioInterp::State state{};
+        ReferenceState reference_state{};
+        StereoFrame16 output{};
+        StereoFrame16 reference_output{};
+
+        for (int frame = 0; frame < 64; frame++) {
+            std::size_t outputi = 0;
+            std::size_t reference_outputi = 0;
+
+            // Feed buffers of random lengths until the frame is filled, as Source does
+            while (outputi < output.size()) {
+                StereoBuffer16 input(length_dist(rng));
+                for (auto& sample : input) {
+                    sample = {static_cast<s16>(sample_dist(rng)),
+                              static_cast<s16>(sample_dist(rng))};
+                }
+                std::deque<std::array<s16, 2>> reference_input(input.begin(), input.end());
+
+                while (!input.empty() && outputi < output.size()) {
+                    AudioInterp::Linear(state, input, rate, output, outputi);
+                    ReferenceStepOverSamples(reference_state, reference_input, rate,
+                                             reference_output, reference_outputi, ReferenceLinear);
+
+                    REQUIRE(outputi == reference_outputi);
+                    REQUIRE(input.size() == reference_input.size());
+                    REQUIRE(std::equal(input.begin(), input.end(), reference_input.begin()));
+                }
+            }
+
+            REQUIRE(output == reference_output);
+            REQUIRE(state.fposition == reference_state.fposition);
+            REQUIRE(state.history[AudioInterp::history_size - 1] == reference_state.xn1);
+            REQUIRE(state.history[AudioInterp::history_size - 2] == reference_state.xn2);
+        }
+    }
+}
+
+TEST_CASE("StereoBuffer16 consumes and prepends in place", "[audio_core]") {
+    StereoBuffer16 buffer(4);
+    for (std::size_t i = 0; i < buffer.size(); i++) {
+        buffer[i] = {static_cast<s16>(i), static_cast<s16>(-static_cast<s16>(i))};
+    }
+
+    const auto* data = buffer.data();
+    buffer.push_front({10, 10});
+    buffer.push_front({20, 20});
+    REQUIRE(buffer.size() == 6);
+    REQUIRE(buffer.data() == data - 2);
+    REQUIRE(buffer[0] == std::array<s16, 2>{20, 20});
+
+    buffer.erase_front(3);
+    REQUIRE(buffer.size() == 3);
+    REQUIRE(buffer[0] == std::array<s16, 2>{1, -1});
+
+    // Prepending past the headroom reallocates
+    for (std::size_t i = 0; i < StereoBuffer16::HEADROOM + 2; i++) {
+        buffer.push_front({static_cast<s16>(30 + i), static_cast<s16>(30 + i)});
+    }
+    REQUIRE(buffer.size() == StereoBuffer16::HEADROOM + 5);
+    REQUIRE(buffer[0] == std::array<s16, 2>{39, 39});
+    REQUIRE(buffer[StereoBuffer16::HEADROOM + 2] == std::array<s16, 2>{1, -1});
+
+    buffer.erase_front(100);
+    REQUIRE(buffer.empty());
+}
+
+TEST_CASE("AudioInterp::Polyphase passes through at unity rate", "[audio_core]") {
+    std::mt19937 rng(42);
+    std::uniform_int_distribution<int> sample_dist(-32768, 32767);
+    StereoBuffer16 input(samples_per_frame * 4);
+    for (auto& sample : input) {
+        sample = {static_cast<s16>(sample_dist(rng)), static_cast<s16>(sample_dist(rng))};
+    }
+
+    const auto output = Resample(AudioInterp::Polyphase, input, 1.0f, 4);
+
+    // There is a four-sample predelay
+    REQUIRE(output.size() == input.size());
+    for (std::size_t i = 0; i < 4; i++) {
+        REQUIRE(output[i] == std::array<s16, 2>{0, 0});
+    }
+    for (std::size_t i = 4; i < output.size(); i++) {
+        REQUIRE(output[i] == input[i - 4]);
+    }
+}
+
+TEST_CASE("AudioInterp::Polyphase preserves a sine wave", "[audio_core]") {
+    constexpr double period = 40.0;
+    const StereoBuffer16 input = MakeSine(samples_per_frame * 8, period);
+
+    for (const float rate : {0.37f, 0.5f, 0.8f, 1.25f}) {
+        const auto output = Resample(AudioInterp::Polyphase, input, rate, 16);
+        REQUIRE(output.size() > 64);
+
+        for (std::size_t i = 0; i < output.size(); i++) {
+            // Skip the start, where the filter still reads the zeroed history
+            const double position = i * static_cast<double>(rate) - 4;
+            if (position < 4) {
+                continue;
+            }
+            const double expected = 16000.0 * std::sin(2 * std::numbers::pi * position / period);
+            REQUIRE(std::abs(output[i][0] - expected) < 160.0);
+            REQUIRE(std::abs(output[i][1] + expected) < 160.0);
+        }
+    }
+}
+
+TEST_CASE("AudioInterp throughput", "[.benchmark][audio_core]") {
+    const StereoBuffer16 input = MakeSine(samples_per_frame * 64, 40.0);
+
+    for (const float rate : {0.5f, 1.37f}) {
+        BENCHMARK("Linear, rate " + std::to_string(rate)) {
+            return Resample(AudioInterp::Linear, input, rate, 32);
+        };
+        BENCHMARK("Polyphase, rate " + std::to_string(rate)) {
+            return Resample(AudioInterp::Polyphase, input, rate, 32);
+        };
+    }
+}
@@ -0,0 +1,79 @@
+// Copyright 2022 Citra Emulator Project
+// Licensed under GPLv2 or any later version
+// Refer to the license.txt file included.
+
+#include <algorithm>
+#include <array>
+#include <thread>
+#include <catch2/catch_test_macros.hpp>
+#include "common/ring_buffer.h"
+
+namespace Common {
+
+TEST_CASE("RingBuffer: Basic Tests", "[common]") {
+    RingBuffer<s16, 4, 2> buf;
+    REQUIRE(buf.Size() == 0);
+
+    // Pushing past the capacity only pushes what fits
+    const std::array<s16, 10> input{1, 2, 3, 4, 5, 6, 7, 8, 9, 10};
+    REQUIRE(buf.Push(input.data(), 5) == 4);
+    REQUIRE(buf.Size() == 4);
+
+    std::array<s16, 4> output{};
+    REQUIRE(buf.Pop(output.data(), 2) == 2);
+    REQUIRE(output == std::array<s16, 4>{1, 2, 3, 4});
+
+    // Wraps around the end of the storage
+    REQUIRE(buf.Push(input.data() + 8, 1) == 1);
+    REQUIRE(buf.Size() == 3);
+    std::array<s16, 6> rest{};
+    REQUIRE(buf.Pop(rest.data(), 8) == 3);
+    REQUIRE(rest == std::array<s16, 6>{5, 6, 7, 8, 9, 10});
+    REQUIRE(buf.Size() == 0);
+    REQUIRE(buf.Pop(rest.data(), 1) == 0);
+}
+
+TEST_CASE("RingBuffer: Threaded Test", "[common]") {
+    RingBuffer<u32, 1024, 2> buf;
+    constexpr u32 count = 50'000;
+
+    // The consumer must see every slot, in order and fully written
+    std::thread producer{[&buf] {
+        u32 next = 0;
+        while (next < count) {
+            // Never push past count, the consumer stops as soon as it has seen that many
+            const u32 slot_count = std::min<u32>(32, count - next);
+            std::array<u32, 64> slots;
+            for (u32 i = 0; i < slot_count; i++) {
+                slots[i * 2] = next + i;
+                slots[i * 2 + 1] = ~(next + i);
+            }
+
+            const std::size_t pushed = buf.Push(slots.data(), slot_count);
+            if (pushed == 0) {
+                std::this_thread::yield();
+            }
+            next += static_cast<u32>(pushed);
+        }
+    }};
+
+    u32 expected = 0;
+    bool in_order = true;
+    while (expected < count) {
+        std::array<u32, 50> slots;
+        const std::size_t popped = buf.Pop(slots.data(), slots.size() / 2);
+        if (popped == 0) {
+            std::this_thread::yield();
+        }
+        for (std::size_t i = 0; i < popped; i++) {
+            in_order &= slots[i * 2] == expected && slots[i * 2 + 1] == ~expected;
+            expected++;
+        }
+    }
+    producer.join();
+
+    REQUIRE(in_order);
+    REQUIRE(buf.Size() == 0);
+}
+
+} // namespace Common
@@ -0,0 +1,57 @@
+// Copyright 2022 Citra Emulator Project
+// Licensed under GPLv2 or any later version
+// Refer to the license.txt file included.
+
+#include <filesystem>
+#include <thread>
+#include <catch2/catch_test_macros.hpp>
+#include "core/custom_tex_cache.h"
+#include "core/custom_tex_pack.h"
+#include "core/settings.h"
+
+static Core::CustomTexInfo MakeTexture(u32 width, u32 height, u8 seed) {
+    Core::CustomTexInfo info{width, height, std::vector<u8>(width * height * 4)};
+    for (std::size_t i = 0; i < info.tex.size(); i++) {
+        info.tex[i] = static_cast<u8>(i * seed);
+    }
+    return info;
+}
+
+TEST_CASE("CustomTexCache prefetches the group of a packed texture", "[core][custom_tex]") {
+    const std::string path =
+        (std::filesystem::temp_directory_path() / "citra_custom_tex_cache_test.pack").string();
+
+    const Core::CustomTexInfo requested = MakeTexture(16, 8, 3);
+    {
+        Core::CustomTexPackWriter writer;
+        REQUIRE(writer.Open(path));
+        REQUIRE(writer.AddTexture(0x1, 0, requested));
+        REQUIRE(writer.AddTexture(0x2, 0, MakeTexture(4, 4, 5)));
+        REQUIRE(writer.AddTexture(0x3, 1, MakeTexture(8, 8, 7)));
+        REQUIRE(writer.Finish());
+    }
+
+    // No memory budget, so prefetched textures are never skipped
+    Settings::values.custom_textures_budget = 0;
+
+    {
+        Core::CustomTexCache cache{nullptr};
+        cache.AddTexturePack(path);
+        REQUIRE(cache.LookupTexturePathInfo(0x1).packed);
+
+        cache.RequestTexture(0x1);
+        const auto loaded = cache.LoadTexture(0x1);
+        REQUIRE(loaded);
+        REQUIRE(loaded->tex == requested.tex);
+
+        // The texture of the same group is decoded along with it, the other one isn't
+        while (cache.IsTextureQueued(0x2)) {
+            std::this_thread::yield();
+        }
+        REQUIRE(cache.LookupTexture(0x2));
+        REQUIRE(!cache.IsTextureQueued(0x3));
+        REQUIRE(!cache.LookupTexture(0x3));
+    }
+
+    std::filesystem::remove(path);
+}
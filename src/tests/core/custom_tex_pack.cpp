@@ -0,0 +1,98 @@
+// Copyright 2022 Citra Emulator Project
+// Licensed under GPLv2 or any later version
+// Refer to the license.txt file included.
+
+#include <filesystem>
+#include <fstream>
+#include <catch2/catch_test_macros.hpp>
+#include "core/custom_tex_pack.h"
+
+static Core::CustomTexInfo MakeTexture(u32 width, u32 height, u8 seed) {
+    Core::CustomTexInfo info{width, height, std::vector<u8>(width * height * 4)};
+    for (std::size_t i = 0; i < info.tex.size(); i++) {
+        info.tex[i] = static_cast<u8>(i * seed);
+    }
+    return info;
+}
+
+TEST_CASE("CustomTexPack round trips textures", "[core][custom_tex]") {
+    const std::string path =
+        (std::filesystem::temp_directory_path() / "citra_custom_tex_pack_test.pack").string();
+
+    const Core::CustomTexInfo first = MakeTexture(16, 8, 3);
+    const Core::CustomTexInfo second = MakeTexture(4, 4, 7);
+
+    {
+        Core::CustomTexPackWriter writer;
+        REQUIRE(writer.Open(path));
+        REQUIRE(writer.AddTexture(0xDEADBEEF, 1, first));
+        REQUIRE(writer.AddTexture(0x1234, 0, second));
+        REQUIRE(writer.Finish());
+    }
+
+    Core::CustomTexPack pack;
+    REQUIRE(pack.Open(path));
+
+    // The index is sorted by hash and keeps the directory groups
+    const auto& index = pack.GetIndex();
+    REQUIRE(index.size() == 2);
+    REQUIRE(index[0].hash == 0x1234);
+    REQUIRE(index[0].group == 0);
+    REQUIRE(index[1].hash == 0xDEADBEEF);
+    REQUIRE(index[1].group == 1);
+
+    const auto loaded = pack.ReadTexture(0xDEADBEEF);
+    REQUIRE(loaded);
+    REQUIRE(loaded->width == first.width);
+    REQUIRE(loaded->height == first.height);
+    REQUIRE(loaded->tex == first.tex);
+
+    REQUIRE(pack.ReadTexture(0x1234)->tex == second.tex);
+    REQUIRE(!pack.ReadTexture(0x5678));
+
+    std::filesystem::remove(path);
+}
+
+static void PatchIndexEntry(const std::string& path,
+                            void (*patch)(Core::CustomTexPack::IndexEntry& entry)) {
+    std::fstream file(path, std::ios::in | std::ios::out | std::ios::binary);
+    Core::CustomTexPack::Header header{};
+    file.read(reinterpret_cast<char*>(&header), sizeof(header));
+
+    Core::CustomTexPack::IndexEntry entry{};
+    file.seekg(static_cast<std::streamoff>(header.index_offset));
+    file.read(reinterpret_cast<char*>(&entry), sizeof(entry));
+    patch(entry);
+    file.seekp(static_cast<std::streamoff>(header.index_offset));
+    file.write(reinterpret_cast<const char*>(&entry), sizeof(entry));
+}
+
+TEST_CASE("CustomTexPack rejects corrupted entries", "[core][custom_tex]") {
+    const std::string path =
+        (std::filesystem::temp_directory_path() / "citra_custom_tex_pack_corrupt.pack").string();
+
+    const auto write_pack = [&path] {
+        Core::CustomTexPackWriter writer;
+        REQUIRE(writer.Open(path));
+        REQUIRE(writer.AddTexture(0xDEADBEEF, 0, MakeTexture(16, 8, 3)));
+        REQUIRE(writer.Finish());
+    };
+
+    // Offsets that overflow when the compressed size is added to them
+    write_pack();
+    PatchIndexEntry(path, [](Core::CustomTexPack::IndexEntry& entry) {
+        entry.offset = ~u64{0} - entry.compressed_size / 2;
+    });
+    REQUIRE(!Core::CustomTexPack{}.Open(path));
+
+    // Dimensions that don't match the size of the compressed data
+    write_pack();
+    PatchIndexEntry(path, [](Core::CustomTexPack::IndexEntry& entry) { entry.width *= 2; });
+    {
+        Core::CustomTexPack pack;
+        REQUIRE(pack.Open(path));
+        REQUIRE(!pack.ReadTexture(0xDEADBEEF));
+    }
+
+    std::filesystem::remove(path);
+}
@@ -0,0 +1,73 @@
+// Copyright 2022 Citra Emulator Project
+// Licensed under GPLv2 or any later version
+// Refer to the license.txt file included.
+
+#include <vector>
+#include <catch2/catch_test_macros.hpp>
+#include "core/dumping/backend.h"
+#include "core/dumping/screen_capture.h"
+
+namespace {
+
+constexpr u32 FB_WIDTH = 2;
+constexpr u32 FB_HEIGHT = 3;
+
+/// Creates an RGB8 framebuffer where the blue channel of each pixel stores its position
+std::vector<u8> MakeFramebuffer(GPU::Regs::FramebufferConfig& config) {
+    config.width.Assign(FB_WIDTH);
+    config.height.Assign(FB_HEIGHT);
+    config.color_format.Assign(GPU::Regs::PixelFormat::RGB8);
+    config.stride = FB_WIDTH * 3;
+
+    std::vector<u8> framebuffer(FB_WIDTH * FB_HEIGHT * 3);
+    for (u32 row = 0; row < FB_HEIGHT; row++) {
+        for (u32 column = 0; column < FB_WIDTH; column++) {
+            framebuffer[(row * FB_WIDTH + column) * 3] = static_cast<u8>(row * FB_WIDTH + column);
+        }
+    }
+    return framebuffer;
+}
+
+u8 BlueAt(const VideoDumper::VideoFrame& frame, u32 x, u32 y) {
+    return frame.data[y * frame.stride + x * 4];
+}
+
+} // Anonymous namespace
+
+TEST_CASE("ComposeScreen rotates the LCD framebuffer", "[core][dumping]") {
+    GPU::Regs::FramebufferConfig config{};
+    const auto framebuffer = MakeFramebuffer(config);
+
+    VideoDumper::NullBackend backend;
+    auto frame = backend.AcquireVideoFrame(FB_HEIGHT, FB_WIDTH);
+    VideoDumper::ComposeScreen(framebuffer.data(), config, {0, 0, FB_HEIGHT, FB_WIDTH}, true,
+                               frame);
+
+    // Frame columns are framebuffer rows, frame rows are reversed framebuffer columns
+    for (u32 y = 0; y < FB_WIDTH; y++) {
+        for (u32 x = 0; x < FB_HEIGHT; x++) {
+            REQUIRE(BlueAt(frame, x, y) == x * FB_WIDTH + (FB_WIDTH - 1 - y));
+        }
+    }
+    REQUIRE(frame.data[3] == 255);
+}
+
+TEST_CASE("ComposeScreen scales to the upright layout region", "[core][dumping]") {
+    GPU::Regs::FramebufferConfig config{};
+    const auto framebuffer = MakeFramebuffer(config);
+
+    // Draw at twice the native size with an offset, leaving the rest of the frame untouched
+    VideoDumper::NullBackend backend;
+    auto frame = backend.AcquireVideoFrame(FB_WIDTH * 2 + 1, FB_HEIGHT * 2);
+    VideoDumper::ComposeScreen(framebuffer.data(), config, {1, 0, FB_WIDTH * 2 + 1, FB_HEIGHT * 2},
+                               false, frame);
+
+    for (u32 y = 0; y < FB_HEIGHT * 2; y++) {
+        REQUIRE(BlueAt(frame, 0, y) == 0);
+        for (u32 x = 0; x < FB_WIDTH * 2; x++) {
+            const u32 row = FB_HEIGHT - 1 - y / 2;
+            const u32 column = FB_WIDTH - 1 - x / 2;
+            REQUIRE(BlueAt(frame, x + 1, y) == row * FB_WIDTH + column);
+        }
+    }
+}
@@ -0,0 +1,83 @@
+// Copyright 2022 Citra Emulator Project
+// Licensed under GPLv2 or any later version
+// Refer to the license.txt file included.
+
+#include <vector>
+#include <catch2/catch_test_macros.hpp>
+#include "core/dumping/yuv_converter.h"
+
+namespace {
+
+struct YUVImage {
+    YUVImage(u32 width, u32 height)
+        : y(width * height), u(((width + 1) / 2) * ((height + 1) / 2)), v(u.size()),
+          planes{{y.data(), u.data(), v.data()}, {width, (width + 1) / 2, (width + 1) / 2}} {}
+
+    std::vector<u8> y, u, v;
+    VideoDumper::YUV420PPlanes planes;
+};
+
+std::vector<u8> MakeImage(u32 width, u32 height, u8 b, u8 g, u8 r) {
+    std::vector<u8> image(width * height * 4);
+    for (std::size_t i = 0; i < image.size(); i += 4) {
+        image[i] = b;
+        image[i + 1] = g;
+        image[i + 2] = r;
+        image[i + 3] = 255;
+    }
+    return image;
+}
+
+} // Anonymous namespace
+
+TEST_CASE("ConvertBGRAToYUV420P matches BT.601 limited range", "[core][dumping]") {
+    constexpr u32 width = 4;
+    constexpr u32 height = 2;
+
+    const auto convert = [](u8 b, u8 g, u8 r) {
+        YUVImage yuv(width, height);
+        const auto image = MakeImage(width, height, b, g, r);
+        VideoDumper::ConvertBGRAToYUV420P(image.data(), width * 4, width, height, 0, height,
+                                          yuv.planes);
+        return yuv;
+    };
+
+    const auto white = convert(255, 255, 255);
+    REQUIRE(white.y[0] == 235);
+    REQUIRE(white.u[0] == 128);
+    REQUIRE(white.v[0] == 128);
+
+    const auto black = convert(0, 0, 0);
+    REQUIRE(black.y[0] == 16);
+    REQUIRE(black.u[0] == 128);
+    REQUIRE(black.v[0] == 128);
+
+    const auto red = convert(0, 0, 255);
+    REQUIRE(red.y[7] == 82);
+    REQUIRE(red.u[1] == 90);
+    REQUIRE(red.v[1] == 240);
+}
+
+TEST_CASE("ConvertBGRAToYUV420P converts bands independently", "[core][dumping]") {
+    constexpr u32 width = 7;
+    constexpr u32 height = 9;
+
+    std::vector<u8> image(width * height * 4);
+    for (std::size_t i = 0; i < image.size(); i++) {
+        image[i] = static_cast<u8>(i * 37);
+    }
+
+    YUVImage whole(width, height);
+    VideoDumper::ConvertBGRAToYUV420P(image.data(), width * 4, width, height, 0, height,
+                                      whole.planes);
+
+    YUVImage bands(width, height);
+    for (u32 row = 0; row < height; row += 4) {
+        VideoDumper::ConvertBGRAToYUV420P(image.data(), width * 4, width, height, row, row + 4,
+                                          bands.planes);
+    }
+
+    REQUIRE(bands.y == whole.y);
+    REQUIRE(bands.u == whole.u);
+    REQUIRE(bands.v == whole.v);
+}
@@ -0,0 +1,254 @@
+// Copyright 2022 Citra Emulator Project
+// Licensed under GPLv2 or any later version
+// Refer to the license.txt file included.
+
+#include <algorithm>
+#include <cstring>
+#include <random>
+#include <vector>
+#include <catch2/benchmark/catch_benchmark.hpp>
+#include <catch2/catch_test_macros.hpp>
+#include "common/color.h"
+#include "core/hw/gpu.h"
+#include "core/hw/gpu_transfer.h"
+#include "video_core/utils.h"
+
+using GPU::Regs;
+using PixelFormat = Regs::PixelFormat;
+
+namespace {
+
+constexpr std::array<PixelFormat, 5> formats = {PixelFormat::RGBA8, PixelFormat::RGB8,
+                                                PixelFormat::RGB565, PixelFormat::RGB5A1,
+                                                PixelFormat::RGBA4};
+
+Common::Vec4<u8> DecodePixel(PixelFormat format, const u8* src_pixel) {
+    switch (format) {
+    case PixelFormat::RGBA8:
+        return Color::DecodeRGBA8(src_pixel);
+    case PixelFormat::RGB8:
+        return Color::DecodeRGB8(src_pixel);
+    case PixelFormat::RGB565:
+        return Color::DecodeRGB565(src_pixel);
+    case PixelFormat::RGB5A1:
+        return Color::DecodeRGB5A1(src_pixel);
+    case PixelFormat::RGBA4:
+        return Color::DecodeRGBA4(src_pixel);
+    default:
+        return {0, 0, 0, 0};
+    }
+}
+
+// Per-pixel implementation the row kernels replaced, used as the reference
+void ReferenceDisplayTransfer(const Regs::DisplayTransferConfig& config, const u8* src_pointer,
+                              u8* dst_pointer) {
+    const u32 horizontal_scale = config.scaling != config.NoScale ? 1 : 0;
+    const u32 vertical_scale = config.scaling == config.ScaleXY ? 1 : 0;
+    const u32 output_width = config.output_width >> horizontal_scale;
+    const u32 output_height = config.output_height >> vertical_scale;
+    const u32 dst_bytes_per_pixel = Regs::BytesPerPixel(config.output_format);
+    const u32 src_bytes_per_pixel = Regs::BytesPerPixel(config.input_format);
+
+    for (u32 y = 0; y < output_height; ++y) {
+        for (u32 x = 0; x < output_width; ++x) {
+            const u32 input_x = x << horizontal_scale;
+            const u32 input_y = y << vertical_scale;
+            const u32 output_y = config.flip_vertically ? output_height - y - 1 : y;
+
+            u32 src_offset;
+            u32 dst_offset;
+            if (config.input_linear) {
+                src_offset = (input_x + input_y * config.input_width) * src_bytes_per_pixel;
+                if (!config.dont_swizzle) {
+                    dst_offset = VideoCore::GetMortonOffset(x, output_y, dst_bytes_per_pixel) +
+                                 (output_y & ~7) * output_width * dst_bytes_per_pixel;
+                } else {
+                    dst_offset = (x + output_y * output_width) * dst_bytes_per_pixel;
+                }
+            } else {
+                src_offset = VideoCore::GetMortonOffset(input_x, input_y, src_bytes_per_pixel) +
+                             (input_y & ~7) * config.input_width * src_bytes_per_pixel;
+                if (!config.dont_swizzle) {
+                    dst_offset = (x + output_y * output_width) * dst_bytes_per_pixel;
+                } else {
+                    dst_offset = VideoCore::GetMortonOffset(x, output_y, dst_bytes_per_pixel) +
+                                 (output_y & ~7) * output_width * dst_bytes_per_pixel;
+                }
+            }
+
+            const u8* src_pixel = src_pointer + src_offset;
+            Common::Vec4<u8> src_color = DecodePixel(config.input_format, src_pixel);
+            if (config.scaling == config.ScaleX) {
+                Common::Vec4<u8> pixel =
+                    DecodePixel(config.input_format, src_pixel + src_bytes_per_pixel);
+                src_color = ((src_color + pixel) / 2).Cast<u8>();
+            } else if (config.scaling == config.ScaleXY) {
+                Common::Vec4<u8> pixel1 =
+                    DecodePixel(config.input_format, src_pixel + 1 * src_bytes_per_pixel);
+                Common::Vec4<u8> pixel2 =
+                    DecodePixel(config.input_format, src_pixel + 2 * src_bytes_per_pixel);
+                Common::Vec4<u8> pixel3 =
+                    DecodePixel(config.input_format, src_pixel + 3 * src_bytes_per_pixel);
+                src_color = (((src_color + pixel1) + (pixel2 + pixel3)) / 4).Cast<u8>();
+            }
+
+            u8* dst_pixel = dst_pointer + dst_offset;
+            switch (config.output_format) {
+            case PixelFormat::RGBA8:
+                Color::EncodeRGBA8(src_color, dst_pixel);
+                break;
+            case PixelFormat::RGB8:
+                Color::EncodeRGB8(src_color, dst_pixel);
+                break;
+            case PixelFormat::RGB565:
+                Color::EncodeRGB565(src_color, dst_pixel);
+                break;
+            case PixelFormat::RGB5A1:
+                Color::EncodeRGB5A1(src_color, dst_pixel);
+                break;
+            case PixelFormat::RGBA4:
+                Color::EncodeRGBA4(src_color, dst_pixel);
+                break;
+            default:
+                break;
+            }
+        }
+    }
+}
+
+Regs::DisplayTransferConfig MakeConfig(u32 width, u32 height, PixelFormat input_format,
+                                       PixelFormat output_format, bool input_linear,
+                                       bool dont_swizzle, bool flip,
+                                       Regs::DisplayTransferConfig::ScalingMode scaling) {
+    Regs::DisplayTransferConfig config{};
+    config.input_width.Assign(width);
+    config.input_height.Assign(height);
+    config.output_width.Assign(width);
+    config.output_height.Assign(height);
+    config.input_format.Assign(input_format);
+    config.output_format.Assign(output_format);
+    config.input_linear.Assign(input_linear);
+    config.dont_swizzle.Assign(dont_swizzle);
+    config.flip_vertically.Assign(flip);
+    config.scaling.Assign(scaling);
+    return config;
+}
+
+std::vector<u8> RandomBuffer(std::size_t size, u32 seed) {
+    std::mt19937 rng{seed};
+    std::uniform_int_distribution<u32> dist{0, 255};
+    std::vector<u8> buffer(size);
+    std::generate(buffer.begin(), buffer.end(), [&] { return static_cast<u8>(dist(rng)); });
+    return buffer;
+}
+
+} // Anonymous namespace
+
+TEST_CASE("SoftwareDisplayTransfer matches the per-pixel implementation", "[core][hw][gpu]") {
+    constexpr u32 width = 72;
+    constexpr u32 height = 40;
+    const std::vector<u8> src = RandomBuffer(width * height * 4, 1234);
+
+    for (const PixelFormat input_format : formats) {
+        for (const PixelFormat output_format : formats) {
+            for (const u32 flags : {0u, 1u, 2u, 3u, 4u, 5u, 6u, 7u}) {
+                const bool input_linear = flags & 1;
+                const bool dont_swizzle = flags & 2;
+                const bool flip = flags & 4;
+                for (const auto scaling : {Regs::DisplayTransferConfig::NoScale,
+                                           Regs::DisplayTransferConfig::ScaleX,
+                                           Regs::DisplayTransferConfig::ScaleXY}) {
+                    // Scaling is only supported with tiled input
+                    if (input_linear && scaling != Regs::DisplayTransferConfig::NoScale) {
+                        continue;
+                    }
+
+                    const auto config = MakeConfig(width, height, input_format, output_format,
+                                                   input_linear, dont_swizzle, flip, scaling);
+                    std::vector<u8> expected(width * height * 4, 0xCD);
+                    std::vector<u8> result(width * height * 4, 0xCD);
+                    ReferenceDisplayTransfer(config, src.data(), expected.data());
+                    GPU::SoftwareDisplayTransfer(config, src.data(), result.data());
+                    REQUIRE(result == expected);
+                }
+            }
+        }
+    }
+}
+
+TEST_CASE("SoftwareTextureCopy respects gaps", "[core][hw][gpu]") {
+    const std::vector<u8> src = RandomBuffer(0x400, 5678);
+    std::vector<u8> dst(0x400, 0xCD);
+
+    Regs::DisplayTransferConfig config{};
+    config.texture_copy.size = 0x100;
+    config.texture_copy.input_width.Assign(2);
+    config.texture_copy.input_gap.Assign(1);
+    config.texture_copy.output_width.Assign(4);
+    config.texture_copy.output_gap.Assign(2);
+    GPU::SoftwareTextureCopy(config, src.data(), dst.data());
+
+    // Input rows of 32 bytes skip 16 bytes, output rows of 64 bytes skip 32 bytes
+    for (u32 i = 0; i < 0x100; i++) {
+        const u32 src_offset = (i / 32) * 48 + i % 32;
+        const u32 dst_offset = (i / 64) * 96 + i % 64;
+        REQUIRE(dst[dst_offset] == src[src_offset]);
+    }
+    REQUIRE(dst[64] == 0xCD);
+}
+
+TEST_CASE("SoftwareMemoryFill matches the per-pixel loops", "[core][hw][gpu]") {
+    for (const u32 width : {2u, 3u, 4u}) {
+        for (u32 length = 1; length < 200; length++) {
+            Regs::MemoryFillConfig config{};
+            config.value_32bit = 0x12345678;
+            config.fill_24bit.Assign(width == 3);
+            config.fill_32bit.Assign(width == 4);
+
+            std::vector<u8> expected(256, 0xCD);
+            std::vector<u8> result(256, 0xCD);
+            u8* const end = expected.data() + length;
+            if (width == 4) {
+                for (u8* ptr = expected.data(); ptr + 4 <= end; ptr += 4) {
+                    std::memcpy(ptr, &config.value_32bit, 4);
+                }
+            } else {
+                for (u8* ptr = expected.data(); ptr < end; ptr += width) {
+                    std::memcpy(ptr, &config.value_32bit, width);
+                }
+            }
+
+            GPU::SoftwareMemoryFill(config, result.data(), result.data() + length);
+            REQUIRE(result == expected);
+        }
+    }
+}
+
+TEST_CASE("SoftwareDisplayTransfer throughput", "[.benchmark][core][hw][gpu]") {
+    constexpr u32 width = 240;
+    constexpr u32 height = 400;
+    const std::vector<u8> src = RandomBuffer(width * height * 4, 42);
+    std::vector<u8> dst(width * height * 4);
+
+    const auto config = MakeConfig(width, height, PixelFormat::RGBA8, PixelFormat::RGB8, false,
+                                   false, false, Regs::DisplayTransferConfig::NoScale);
+    const auto scaled_config = MakeConfig(width, height, PixelFormat::RGBA8, PixelFormat::RGB565,
+                                          false, false, false, Regs::DisplayTransferConfig::ScaleXY);
+
+    BENCHMARK("Reference RGBA8 to RGB8") {
+        ReferenceDisplayTransfer(config, src.data(), dst.data());
+        return dst[0];
+    };
+    BENCHMARK("Row kernels RGBA8 to RGB8") {
+        GPU::SoftwareDisplayTransfer(config, src.data(), dst.data());
+        return dst[0];
+    };
+    BENCHMARK("Reference RGBA8 to RGB565 2x2 downscale") {
+        ReferenceDisplayTransfer(scaled_config, src.data(), dst.data());
+        return dst[0];
+    };
+    BENCHMARK("Row kernels RGBA8 to RGB565 2x2 downscale") {
+        GPU::SoftwareDisplayTransfer(scaled_config, src.data(), dst.data());
+        return dst[0];
+    };
+}
@@ -0,0 +1,408 @@
+// Copyright 2022 Citra Emulator Project
+// Licensed under GPLv2 or any later version
+// Refer to the license.txt file included.
+
+#include <algorithm>
+#include <array>
+#include <cstring>
+#include <memory>
+#include <random>
+#include <vector>
+#include <catch2/catch_test_macros.hpp>
+#include "common/color.h"
+#include "common/vector_math.h"
+#include "core/hle/service/y2r_u.h"
+#include "core/hw/y2r.h"
+#include "core/memory.h"
+#include "core/settings.h"
+
+using namespace Service::Y2R;
+
+namespace {
+
+constexpr u16 WIDTH = 320;
+constexpr u16 LINES = 240;
+
+// Each buffer gets its own megabyte of the linear heap
+constexpr u32 REGION_SIZE = 0x100000;
+constexpr VAddr SRC_Y = Memory::LINEAR_HEAP_VADDR;
+constexpr VAddr SRC_U = SRC_Y + REGION_SIZE;
+constexpr VAddr SRC_V = SRC_U + REGION_SIZE;
+constexpr VAddr SRC_YUYV = SRC_V + REGION_SIZE;
+constexpr VAddr DST = SRC_YUYV + REGION_SIZE;
+
+// ITU Rec. BT.601 with TV ranges, the offsets exercise the negative clamping
+constexpr CoefficientSet coefficients = {0x12A, 0x198, 0xD1, 0x64, 0x204, -0x1BE, 0x87, -0x22F};
+
+constexpr std::array<InputFormat, 5> input_formats = {
+    InputFormat::YUV422_Indiv8, InputFormat::YUV420_Indiv8, InputFormat::YUV422_Indiv16,
+    InputFormat::YUV420_Indiv16, InputFormat::YUYV422_Interleaved};
+constexpr std::array<OutputFormat, 4> output_formats = {OutputFormat::RGBA8, OutputFormat::RGB8,
+                                                        OutputFormat::RGB5A1, OutputFormat::RGB565};
+constexpr std::array<Rotation, 4> rotations = {Rotation::None, Rotation::Clockwise_90,
+                                               Rotation::Clockwise_180, Rotation::Clockwise_270};
+constexpr std::array<BlockAlignment, 2> alignments = {BlockAlignment::Linear,
+                                                      BlockAlignment::Block8x8};
+
+u16 OutputBytesPerPixel(OutputFormat format) {
+    switch (format) {
+    case OutputFormat::RGBA8:
+        return 4;
+    case OutputFormat::RGB8:
+        return 3;
+    default:
+        return 2;
+    }
+}
+
+void SetBuffer(ConversionBuffer& buf, VAddr address, u32 image_size, u16 transfer_unit, u16 gap) {
+    buf.address = address;
+    buf.image_size = image_size;
+    buf.transfer_unit = transfer_unit;
+    buf.gap = gap;
+}
+
+/// Builds a configuration whose strips transfer whole units, so it can be converted in parallel
+ConversionConfiguration MakeConfig(InputFormat input_format, OutputFormat output_format,
+                                   Rotation rotation, BlockAlignment alignment) {
+    ConversionConfiguration cvt{};
+    cvt.input_format = input_format;
+    cvt.output_format = output_format;
+    cvt.rotation = rotation;
+    cvt.block_alignment = alignment;
+    cvt.input_line_width = WIDTH;
+    cvt.input_lines = LINES;
+    cvt.coefficients = coefficients;
+    cvt.alpha = 0xAB;
+
+    const u16 n = input_format == InputFormat::YUV422_Indiv16 ||
+                          input_format == InputFormat::YUV420_Indiv16
+                      ? 2
+                      : 1;
+    const u32 chroma_lines = input_format == InputFormat::YUV420_Indiv8 ||
+                                     input_format == InputFormat::YUV420_Indiv16
+                                 ? LINES / 2
+                                 : LINES;
+    SetBuffer(cvt.src_Y, SRC_Y, WIDTH * LINES * n, WIDTH * n, 8);
+    SetBuffer(cvt.src_U, SRC_U, WIDTH / 2 * chroma_lines * n, WIDTH / 2 * n, 4);
+    SetBuffer(cvt.src_V, SRC_V, WIDTH / 2 * chroma_lines * n, WIDTH / 2 * n, 0);
+    SetBuffer(cvt.src_YUYV, SRC_YUYV, WIDTH * LINES * 2, WIDTH * 2, 16);
+
+    const u16 bpp = OutputBytesPerPixel(output_format);
+    SetBuffer(cvt.dst, DST, WIDTH * LINES * bpp, WIDTH * bpp, 16);
+    return cvt;
+}
+
+// Per-pixel implementation the templated kernels replaced, used as the reference
+namespace Reference {
+
+constexpr std::size_t TILE_SIZE = 8 * 8;
+using ImageTile = std::array<u32, TILE_SIZE>;
+
+void ConvertYUVToRGB(InputFormat input_format, const u8* input_Y, const u8* input_U,
+                     const u8* input_V, ImageTile output[], unsigned int width,
+                     unsigned int height, const CoefficientSet& c) {
+    for (unsigned int y = 0; y < height; ++y) {
+        for (unsigned int x = 0; x < width; ++x) {
+            s32 Y = 0;
+            s32 U = 0;
+            s32 V = 0;
+            switch (input_format) {
+            case InputFormat::YUV422_Indiv8:
+            case InputFormat::YUV422_Indiv16:
+                Y = input_Y[y * width + x];
+                U = input_U[(y * width + x) / 2];
+                V = input_V[(y * width + x) / 2];
+                break;
+            case InputFormat::YUV420_Indiv8:
+            case InputFormat::YUV420_Indiv16:
+                Y = input_Y[y * width + x];
+                U = input_U[((y / 2) * width + x) / 2];
+                V = input_V[((y / 2) * width + x) / 2];
+                break;
+            case InputFormat::YUYV422_Interleaved:
+                Y = input_Y[(y * width + x) * 2];
+                U = input_Y[(y * width + (x / 2) * 2) * 2 + 1];
+                V = input_Y[(y * width + (x / 2) * 2) * 2 + 3];
+                break;
+            }
+
+            const s32 cY = c[0] * Y;
+            s32 r = cY + c[1] * V;
+            s32 g = cY - c[2] * V - c[3] * U;
+            s32 b = cY + c[4] * U;
+
+            const s32 rounding_offset = 0x18;
+            r = (r >> 3) + c[5] + rounding_offset;
+            g = (g >> 3) + c[6] + rounding_offset;
+            b = (b >> 3) + c[7] + rounding_offset;
+
+            output[x / 8][y * 8 + x % 8] = (static_cast<u32>(std::clamp(r >> 5, 0, 0xFF)) << 24) |
+                                           (static_cast<u32>(std::clamp(g >> 5, 0, 0xFF)) << 16) |
+                                           (static_cast<u32>(std::clamp(b >> 5, 0, 0xFF)) << 8);
+        }
+    }
+}
+
+template <std::size_t N>
+void ReceiveData(Memory::MemorySystem& memory, u8* output, ConversionBuffer& buf,
+                 std::size_t amount_of_data) {
+    const u8* input = memory.GetPointer(buf.address);
+    const std::size_t output_unit = buf.transfer_unit / N;
+    while (amount_of_data > 0) {
+        for (std::size_t i = 0; i < output_unit; ++i) {
+            output[i] = input[i * N];
+        }
+
+        output += output_unit;
+        input += buf.transfer_unit + buf.gap;
+        buf.address += buf.transfer_unit + buf.gap;
+        buf.image_size -= buf.transfer_unit;
+        amount_of_data -= output_unit;
+    }
+}
+
+void SendData(Memory::MemorySystem& memory, const u32* input, ConversionBuffer& buf,
+              int amount_of_data, OutputFormat output_format, u8 alpha) {
+    u8* output = memory.GetPointer(buf.address);
+    while (amount_of_data > 0) {
+        u8* unit_end = output + buf.transfer_unit;
+        while (output < unit_end) {
+            const u32 color = *input++;
+            const Common::Vec4<u8> col_vec{static_cast<u8>(color >> 24),
+                                           static_cast<u8>(color >> 16),
+                                           static_cast<u8>(color >> 8), alpha};
+            switch (output_format) {
+            case OutputFormat::RGBA8:
+                Color::EncodeRGBA8(col_vec, output);
+                output += 4;
+                break;
+            case OutputFormat::RGB8:
+                Color::EncodeRGB8(col_vec, output);
+                output += 3;
+                break;
+            case OutputFormat::RGB5A1:
+                Color::EncodeRGB5A1(col_vec, output);
+                output += 2;
+                break;
+            case OutputFormat::RGB565:
+                Color::EncodeRGB565(col_vec, output);
+                output += 2;
+                break;
+            }
+            amount_of_data -= 1;
+        }
+
+        output += buf.gap;
+        buf.address += buf.transfer_unit + buf.gap;
+        buf.image_size -= buf.transfer_unit;
+    }
+}
+
+constexpr std::array<u8, TILE_SIZE> linear_lut = [] {
+    std::array<u8, TILE_SIZE> lut{};
+    for (std::size_t i = 0; i < TILE_SIZE; ++i) {
+        lut[i] = static_cast<u8>(i);
+    }
+    return lut;
+}();
+
+constexpr std::array<u8, TILE_SIZE> morton_lut = {
+    // clang-format off
+     0,  1,  4,  5, 16, 17, 20, 21,
+     2,  3,  6,  7, 18, 19, 22, 23,
+     8,  9, 12, 13, 24, 25, 28, 29,
+    10, 11, 14, 15, 26, 27, 30, 31,
+    32, 33, 36, 37, 48, 49, 52, 53,
+    34, 35, 38, 39, 50, 51, 54, 55,
+    40, 41, 44, 45, 56, 57, 60, 61,
+    42, 43, 46, 47, 58, 59, 62, 63,
+    // clang-format on
+};
+
+void RotateTile(Rotation rotation, const ImageTile& input, ImageTile& output, int height,
+                const u8* out_map) {
+    int out_i = 0;
+    switch (rotation) {
+    case Rotation::None:
+        for (int i = 0; i < height * 8; ++i) {
+            output[out_map[i]] = input[i];
+        }
+        break;
+    case Rotation::Clockwise_90:
+        for (int x = 0; x < 8; ++x) {
+            for (int y = height - 1; y >= 0; --y) {
+                output[out_map[out_i++]] = input[y * 8 + x];
+            }
+        }
+        break;
+    case Rotation::Clockwise_180:
+        for (int i = height * 8 - 1; i >= 0; --i) {
+            output[out_map[out_i++]] = input[i];
+        }
+        break;
+    case Rotation::Clockwise_270:
+        for (int x = 8 - 1; x >= 0; --x) {
+            for (int y = 0; y < height; ++y) {
+                output[out_map[out_i++]] = input[y * 8 + x];
+            }
+        }
+        break;
+    }
+}
+
+void WriteTileToOutput(u32* output, const ImageTile& tile, int height, int line_stride) {
+    for (int y = 0; y < height; ++y) {
+        for (int x = 0; x < 8; ++x) {
+            output[y * line_stride + x] = tile[y * 8 + x];
+        }
+    }
+}
+
+void PerformConversion(Memory::MemorySystem& memory, ConversionConfiguration& cvt) {
+    const std::size_t num_tiles = cvt.input_line_width / 8;
+    std::vector<u8> data_buffer(cvt.input_line_width * 8 * 4);
+    std::vector<ImageTile> tiles(num_tiles);
+    ImageTile tmp_tile{};
+
+    const u8* tile_remap =
+        cvt.block_alignment == BlockAlignment::Linear ? linear_lut.data() : morton_lut.data();
+    const bool rotated =
+        cvt.rotation == Rotation::Clockwise_90 || cvt.rotation == Rotation::Clockwise_270;
+    const bool reversed =
+        cvt.rotation == Rotation::Clockwise_180 || cvt.rotation == Rotation::Clockwise_270;
+
+    for (unsigned int y = 0; y < cvt.input_lines; y += 8) {
+        const unsigned int row_height = std::min(cvt.input_lines - y, 8u);
+        const std::size_t row_data_size = row_height * cvt.input_line_width;
+
+        u8* input_Y = data_buffer.data();
+        u8* input_U = input_Y + 8 * cvt.input_line_width;
+        u8* input_V = input_U + 8 * cvt.input_line_width / 2;
+
+        switch (cvt.input_format) {
+        case InputFormat::YUV422_Indiv8:
+            ReceiveData<1>(memory, input_Y, cvt.src_Y, row_data_size);
+            ReceiveData<1>(memory, input_U, cvt.src_U, row_data_size / 2);
+            ReceiveData<1>(memory, input_V, cvt.src_V, row_data_size / 2);
+            break;
+        case InputFormat::YUV420_Indiv8:
+            ReceiveData<1>(memory, input_Y, cvt.src_Y, row_data_size);
+            ReceiveData<1>(memory, input_U, cvt.src_U, row_data_size / 4);
+            ReceiveData<1>(memory, input_V, cvt.src_V, row_data_size / 4);
+            break;
+        case InputFormat::YUV422_Indiv16:
+            ReceiveData<2>(memory, input_Y, cvt.src_Y, row_data_size);
+            ReceiveData<2>(memory, input_U, cvt.src_U, row_data_size / 2);
+            ReceiveData<2>(memory, input_V, cvt.src_V, row_data_size / 2);
+            break;
+        case InputFormat::YUV420_Indiv16:
+            ReceiveData<2>(memory, input_Y, cvt.src_Y, row_data_size);
+            ReceiveData<2>(memory, input_U, cvt.src_U, row_data_size / 4);
+            ReceiveData<2>(memory, input_V, cvt.src_V, row_data_size / 4);
+            break;
+        case InputFormat::YUYV422_Interleaved:
+            ReceiveData<1>(memory, input_Y, cvt.src_YUYV, row_data_size * 2);
+            break;
+        }
+
+        ConvertYUVToRGB(cvt.input_format, input_Y, input_U, input_V, tiles.data(),
+                        cvt.input_line_width, row_height, cvt.coefficients);
+
+        u32* output_buffer = reinterpret_cast<u32*>(data_buffer.data());
+        for (std::size_t i = 0; i < num_tiles; ++i) {
+            const ImageTile& tile = tiles[reversed ? num_tiles - i - 1 : i];
+            RotateTile(cvt.rotation, tile, tmp_tile, row_height, tile_remap);
+
+            if (cvt.block_alignment == BlockAlignment::Linear) {
+                WriteTileToOutput(output_buffer, tmp_tile, row_height,
+                                  rotated ? 8 : cvt.input_line_width);
+                output_buffer += rotated ? 8 * row_height : 8;
+            } else {
+                WriteTileToOutput(output_buffer, tmp_tile, 8, 8);
+                output_buffer += TILE_SIZE;
+            }
+        }
+
+        SendData(memory, reinterpret_cast<u32*>(data_buffer.data()), cvt.dst,
+                 static_cast<int>(row_data_size), cvt.output_format, static_cast<u8>(cvt.alpha));
+    }
+}
+
+} // namespace Reference
+
+/// Holds the emulated memory the conversions read from and write to
+struct Y2RFixture {
+    Y2RFixture() {
+        page_table = std::make_shared<Memory::PageTable>();
+        page_table->Clear();
+        memory.MapMemoryRegion(*page_table, SRC_Y, REGION_SIZE * 5, memory.GetFCRAMRef(0));
+        memory.SetCurrentPageTable(page_table);
+
+        std::mt19937 rng(42);
+        std::uniform_int_distribution<int> dist(0, 255);
+        u8* input = memory.GetPointer(SRC_Y);
+        std::generate(input, input + REGION_SIZE * 4, [&] { return static_cast<u8>(dist(rng)); });
+    }
+
+    /// Runs a conversion on a copy of the configuration and returns the output region
+    template <typename Function>
+    std::vector<u8> Convert(const ConversionConfiguration& config,
+                            ConversionConfiguration& result, Function convert) {
+        u8* output = memory.GetPointer(DST);
+        std::fill(output, output + REGION_SIZE, u8{0xCD});
+        result = config;
+        convert(memory, result);
+        return std::vector<u8>(output, output + REGION_SIZE);
+    }
+
+    Memory::MemorySystem memory;
+    std::shared_ptr<Memory::PageTable> page_table;
+};
+
+bool BuffersMatch(const ConversionBuffer& a, const ConversionBuffer& b) {
+    return a.address == b.address && a.image_size == b.image_size;
+}
+
+} // Anonymous namespace
+
+TEST_CASE("Y2R conversion matches the reference", "[core][hw][y2r]") {
+    Y2RFixture fixture;
+    const bool multithread = Settings::values.enable_y2r_multithread;
+
+    for (const InputFormat input_format : input_formats) {
+        for (const OutputFormat output_format : output_formats) {
+            for (const Rotation rotation : rotations) {
+                for (const BlockAlignment alignment : alignments) {
+                    INFO("input_format=" << static_cast<int>(input_format)
+                                         << " output_format=" << static_cast<int>(output_format)
+                                         << " rotation=" << static_cast<int>(rotation)
+                                         << " alignment=" << static_cast<int>(alignment));
+                    const ConversionConfiguration config =
+                        MakeConfig(input_format, output_format, rotation, alignment);
+
+                    ConversionConfiguration expected_cvt;
+                    const auto expected =
+                        fixture.Convert(config, expected_cvt, Reference::PerformConversion);
+
+                    for (const bool threaded : {false, true}) {
+                        INFO("threaded=" << threaded);
+                        Settings::values.enable_y2r_multithread = threaded;
+
+                        ConversionConfiguration cvt;
+                        const auto output =
+                            fixture.Convert(config, cvt, HW::Y2R::PerformConversion);
+                        REQUIRE(output == expected);
+                        REQUIRE(BuffersMatch(cvt.src_Y, expected_cvt.src_Y));
+                        REQUIRE(BuffersMatch(cvt.src_U, expected_cvt.src_U));
+                        REQUIRE(BuffersMatch(cvt.src_V, expected_cvt.src_V));
+                        REQUIRE(BuffersMatch(cvt.src_YUYV, expected_cvt.src_YUYV));
+                        REQUIRE(BuffersMatch(cvt.dst, expected_cvt.dst));
+                    }
+                }
+            }
+        }
+    }
+
+    Settings::values.enable_y2r_multithread = multithread;
+}
@@ -0,0 +1,60 @@
+// Copyright 2022 Citra Emulator Project
+// Licensed under GPLv2 or any later version
+// Refer to the license.txt file included.
+
+#include <chrono>
+#include <catch2/catch_test_macros.hpp>
+#include "video_core/common/present_mailbox.h"
+
+using namespace std::chrono_literals;
+using VideoCore::FramePacer;
+using VideoCore::PresentMailbox;
+
+TEST_CASE("PresentMailbox hands over the latest frame", "[video_core][present]") {
+    PresentMailbox mailbox;
+    REQUIRE(!mailbox.GetPresentSlot());
+    REQUIRE(!mailbox.WaitFrame(0us));
+
+    const u32 first = mailbox.GetRenderSlot();
+    REQUIRE(!mailbox.PushFrame());
+    REQUIRE(mailbox.GetRenderSlot() != first);
+
+    const auto presented = mailbox.WaitFrame(0us);
+    REQUIRE(presented == first);
+    REQUIRE(mailbox.GetPresentSlot() == first);
+
+    // Nothing new was pushed, the consumer keeps its frame
+    REQUIRE(!mailbox.WaitFrame(0us));
+    REQUIRE(mailbox.GetPresentSlot() == first);
+}
+
+TEST_CASE("PresentMailbox drops frames that were never presented", "[video_core][present]") {
+    PresentMailbox mailbox;
+    REQUIRE(!mailbox.PushFrame());
+    const u32 second = mailbox.GetRenderSlot();
+    REQUIRE(mailbox.PushFrame());
+
+    // The consumer only sees the newest frame and the producer never gets its slot
+    const auto presented = mailbox.WaitFrame(0us);
+    REQUIRE(presented == second);
+    REQUIRE(mailbox.GetRenderSlot() != second);
+    REQUIRE(!mailbox.PushFrame());
+    REQUIRE(mailbox.GetRenderSlot() != second);
+}
+
+TEST_CASE("FramePacer keeps the spacing of VBlanks", "[video_core][present]") {
+    FramePacer pacer;
+    const auto start = FramePacer::Clock::now();
+
+    // The first frame anchors the mapping and is presented immediately
+    REQUIRE(pacer.GetPresentTime(1000000us, start) == start);
+
+    // Frames arriving early wait for their VBlank, late ones are presented right away
+    REQUIRE(pacer.GetPresentTime(1016000us, start + 10ms) == start + 16ms);
+    REQUIRE(pacer.GetPresentTime(1032000us, start + 40ms) == start + 40ms);
+
+    // Drifting too far re-anchors on the current frame
+    REQUIRE(pacer.GetPresentTime(1048000us, start + 200ms) == start + 200ms);
+    REQUIRE(pacer.GetPresentTime(1064000us, start + 201ms) == start + 216ms);
+    REQUIRE(pacer.GetPresentTime(2000000us, start + 220ms) == start + 220ms);
+}
@@ -2,16 +2,22 @@
 // Licensed under GPLv2 or any later version
 // Refer to the license.txt file included.
 
+#include <algorithm>
 #include <array>
+#include <bit>
 #include <cstddef>
 #include <cstring>
 #include <memory>
+#include <unordered_map>
 #include <utility>
+#include <vector>
 #include "common/assert.h"
+#include "common/hash.h"
 #include "common/logging/log.h"
 #include "common/microprofile.h"
 #include "common/vector_math.h"
 #include "core/hle/service/gsp/gsp.h"
+#include "core/hw/gpu.h"
 #include "core/memory.h"
 #include "core/tracer/recorder.h"
 #include "video_core/command_processor.h"
@@ -36,7 +42,86 @@ constexpr std::array<u32, 16> expand_bits_to_bytes{
     0xff000000, 0xff0000ff, 0xff00ff00, 0xff00ffff, 0xffff0000, 0xffff00ff, 0xffffff00, 0xffffffff,
 };
 
+// Folds a 4-byte mask back to its 4-bit form, e.g. 0x00FF00FF -> 0b0101
+constexpr u32 FoldWriteMask(u32 write_mask) {
+    return (write_mask & 0x1) | ((write_mask >> 7) & 0x2) | ((write_mask >> 14) & 0x4) |
+           ((write_mask >> 21) & 0x8);
+}
+
+/// A register write decoded from a command list, with its parameter mask expanded to bytes
+struct DecodedWrite {
+    u32 id;
+    u32 value;
+    u32 write_mask;
+};
+
+/// The register writes of a command buffer in submission order
+struct DecodedCommandList {
+    PAddr address;
+    u32 length;
+    std::vector<DecodedWrite> writes;
+};
+
+// The cache is cleared once it holds this many command lists
+constexpr std::size_t MAX_DECODED_LISTS = 4096;
+
+// Decoded command lists keyed by their address, size and contents
+static std::unordered_map<u64, DecodedCommandList> decoded_lists;
+
+// Set when a command buffer jump replaces the list being processed
+static bool cmd_list_jumped = false;
+
+// Registers whose writes do more than store a value, such as triggers and data ports. These
+// are never eliminated and notify the rasterizer right away
+static constexpr std::array<bool, Regs::NUM_REGS> side_effect_regs = [] {
+    std::array<bool, Regs::NUM_REGS> regs{};
+    const auto mark = [&regs](std::size_t id, std::size_t count = 1) {
+        for (std::size_t i = 0; i < count; i++) {
+            regs[id + i] = true;
+        }
+    };
+
+    mark(PICA_REG_INDEX(trigger_irq));
+    mark(PICA_REG_INDEX(pipeline.triangle_topology));
+    mark(PICA_REG_INDEX(pipeline.restart_primitive));
+    mark(PICA_REG_INDEX(pipeline.vs_default_attributes_setup.index));
+    mark(PICA_REG_INDEX(pipeline.vs_default_attributes_setup.set_value[0]), 3);
+    mark(PICA_REG_INDEX(pipeline.command_buffer.trigger[0]), 2);
+    mark(PICA_REG_INDEX(pipeline.trigger_draw));
+    mark(PICA_REG_INDEX(pipeline.trigger_draw_indexed));
+    mark(PICA_REG_INDEX(gs.uniform_setup.set_value[0]), 8);
+    mark(PICA_REG_INDEX(gs.program.set_word[0]), 8);
+    mark(PICA_REG_INDEX(gs.swizzle_patterns.set_word[0]), 8);
+    mark(PICA_REG_INDEX(vs.uniform_setup.set_value[0]), 8);
+    mark(PICA_REG_INDEX(vs.program.set_word[0]), 8);
+    mark(PICA_REG_INDEX(vs.swizzle_patterns.set_word[0]), 8);
+    mark(PICA_REG_INDEX(lighting.lut_data[0]), 8);
+    mark(PICA_REG_INDEX(texturing.fog_lut_data[0]), 8);
+    mark(PICA_REG_INDEX(texturing.proctex_lut_data[0]), 8);
+    return regs;
+}();
+
+// Registers that changed since the rasterizer was last notified, one bit per register
+static std::array<u64, Regs::NUM_REGS / 64> dirty_regs{};
+
+// Number of writes dropped because they didn't change the register value
+static u32 eliminated_writes = 0;
+
+/// Notifies the rasterizer about the registers that changed since the last call
+static void NotifyDirtyRegisters() {
+    auto* rasterizer = VideoCore::g_renderer->Rasterizer();
+    for (std::size_t word = 0; word < dirty_regs.size(); word++) {
+        u64 bits = std::exchange(dirty_regs[word], 0);
+        while (bits != 0) {
+            const u32 bit = static_cast<u32>(std::countr_zero(bits));
+            bits &= bits - 1;
+            rasterizer->NotifyPicaRegisterChanged(static_cast<u32>(word * 64 + bit));
+        }
+    }
+}
+
 MICROPROFILE_DEFINE(GPU_Drawing, "GPU", "Drawing", MP_RGB(50, 50, 240));
+MICROPROFILE_DEFINE(GPU_CmdlistDecode, "GPU", "Cmdlist Decode", MP_RGB(100, 200, 100));
 
 static const char* GetShaderSetupTypeName(Shader::ShaderSetup& setup) {
     if (&setup == &g_state.vs) {
@@ -112,37 +197,47 @@ static void WriteUniformFloatReg(ShaderRegs& config, Shader::ShaderSetup& setup,
     }
 }
 
-static void WritePicaReg(u32 id, u32 value, u32 mask) {
+static void WritePicaReg(u32 id, u32 value, u32 write_mask) {
     auto& regs = g_state.regs;
 
     if (id >= Regs::NUM_REGS) {
         LOG_ERROR(
             HW_GPU,
             "Commandlist tried to write to invalid register 0x{:03X} (value: {:08X}, mask: {:X})",
-            id, value, mask);
+            id, value, FoldWriteMask(write_mask));
         return;
     }
 
     // TODO: Figure out how register masking acts on e.g. vs.uniform_setup.set_value
     u32 old_value = regs.reg_array[id];
 
-    const u32 write_mask = expand_bits_to_bytes[mask];
 
     regs.reg_array[id] = (old_value & ~write_mask) | (value & write_mask);
 
     // Double check for is_pica_tracing to avoid call overhead
     if (DebugUtils::IsPicaTracing()) {
-        DebugUtils::OnPicaRegWrite({(u16)id, (u16)mask, regs.reg_array[id]});
+        DebugUtils::OnPicaRegWrite(
+            {(u16)id, (u16)FoldWriteMask(write_mask), regs.reg_array[id]});
     }
 
     if (g_debug_context)
         g_debug_context->OnEvent(DebugContext::Event::PicaCommandLoaded,
                                  reinterpret_cast<void*>(&id));
 
+    // Titles often rewrite whole state blocks between draws, most of which is unchanged
+    const bool has_side_effects = side_effect_regs[id];
+    if (!has_side_effects && regs.reg_array[id] == old_value) {
+        ++eliminated_writes;
+        if (g_debug_context)
+            g_debug_context->OnEvent(DebugContext::Event::PicaCommandProcessed,
+                                     reinterpret_cast<void*>(&id));
+        return;
+    }
+
     switch (id) {
     // Trigger IRQ
     case PICA_REG_INDEX(trigger_irq):
-        Service::GSP::SignalInterrupt(Service::GSP::InterruptId::P3D);
+        GPU::SignalInterrupt(Service::GSP::InterruptId::P3D);
         break;
 
     case PICA_REG_INDEX(pipeline.triangle_topology):
@@ -243,6 +338,7 @@ static void WritePicaReg(u32 id, u32 value, u32 mask) {
                     // TODO: If drawing after every immediate mode triangle kills performance,
                     // change it to flush triangles whenever a drawing config register changes
                     // See: https://github.com/citra-emu/citra/pull/2866#issuecomment-327011550
+                    NotifyDirtyRegisters();
                     VideoCore::g_renderer->Rasterizer()->DrawTriangles();
                     if (g_debug_context) {
                         g_debug_context->OnEvent(DebugContext::Event::FinishedPrimitiveBatch,
@@ -262,10 +358,12 @@ static void WritePicaReg(u32 id, u32 value, u32 mask) {
     case PICA_REG_INDEX(pipeline.command_buffer.trigger[1]): {
         unsigned index =
             static_cast<unsigned>(id - PICA_REG_INDEX(pipeline.command_buffer.trigger[0]));
-        u32* head_ptr = (u32*)VideoCore::g_memory->GetPhysicalPointer(
-            regs.pipeline.command_buffer.GetPhysicalAddress(index));
+        const PAddr address = regs.pipeline.command_buffer.GetPhysicalAddress(index);
+        u32* head_ptr = (u32*)VideoCore::g_memory->GetPhysicalPointer(address);
+        g_state.cmd_list.addr = address;
         g_state.cmd_list.head_ptr = g_state.cmd_list.current_ptr = head_ptr;
         g_state.cmd_list.length = regs.pipeline.command_buffer.GetSize(index) / sizeof(u32);
+        cmd_list_jumped = true;
         break;
     }
 
@@ -280,6 +378,8 @@ static void WritePicaReg(u32 id, u32 value, u32 mask) {
         if (g_debug_context)
             g_debug_context->OnEvent(DebugContext::Event::IncomingPrimitiveBatch, nullptr);
 
+        NotifyDirtyRegisters();
+
         PrimitiveAssembler<Shader::OutputVertex>& primitive_assembler = g_state.primitive_assembler;
 
         bool accelerate_draw = VideoCore::g_hw_shader_enabled && primitive_assembler.IsEmpty();
@@ -637,41 +737,146 @@ static void WritePicaReg(u32 id, u32 value, u32 mask) {
         break;
     }
 
-    VideoCore::g_renderer->Rasterizer()->NotifyPicaRegisterChanged(id);
+    // Other changes are batched and forwarded to the rasterizer before the next draw
+    if (has_side_effects) {
+        VideoCore::g_renderer->Rasterizer()->NotifyPicaRegisterChanged(id);
+    } else {
+        dirty_regs[id / 64] |= u64{1} << (id % 64);
+    }
 
     if (g_debug_context)
         g_debug_context->OnEvent(DebugContext::Event::PicaCommandProcessed,
                                  reinterpret_cast<void*>(&id));
 }
 
-void ProcessCommandList(PAddr list, u32 size) {
+static DecodedCommandList DecodeCommandList(PAddr address, const u32* buffer, u32 length) {
+    MICROPROFILE_SCOPE(GPU_CmdlistDecode);
 
-    u32* buffer = (u32*)VideoCore::g_memory->GetPhysicalPointer(list);
+    DecodedCommandList decoded{address, length, {}};
+    decoded.writes.reserve(length / 2);
 
-    if (Pica::g_debug_context && Pica::g_debug_context->recorder) {
-        Pica::g_debug_context->recorder->MemoryAccessed((u8*)buffer, size, list);
+    const u32* current_ptr = buffer;
+    const u32* end_ptr = buffer + length;
+    while (current_ptr < end_ptr) {
+        // Align read pointer to 8 bytes
+        if ((buffer - current_ptr) % 2 != 0)
+            ++current_ptr;
+
+        if (current_ptr + 2 > end_ptr) {
+            break;
+        }
+
+        const u32 value = *current_ptr++;
+        const CommandHeader header = {*current_ptr++};
+        const u32 write_mask = expand_bits_to_bytes[header.parameter_mask];
+        decoded.writes.push_back({header.cmd_id, value, write_mask});
+
+        const u32 extra_data_length =
+            std::min<u32>(header.extra_data_length, static_cast<u32>(end_ptr - current_ptr));
+        for (u32 i = 0; i < extra_data_length; ++i) {
+            const u32 cmd = header.cmd_id + (header.group_commands ? i + 1 : 0);
+            decoded.writes.push_back({cmd, *current_ptr++, write_mask});
+        }
+    }
+
+    return decoded;
+}
+
+/// Returns the decoded form of the command buffer, decoding it if it's not in the cache
+static const DecodedCommandList& GetDecodedCommandList(PAddr address, const u32* buffer,
+                                                      u32 length) {
+    const u64 content_hash = Common::ComputeHash64(buffer, length * sizeof(u32));
+    const u64 key = Common::HashCombine(content_hash, (static_cast<u64>(address) << 32) | length);
+
+    auto it = decoded_lists.find(key);
+    const bool hit =
+        it != decoded_lists.end() && it->second.address == address && it->second.length == length;
+    MICROPROFILE_META_CPU("Cmdlist cache hits", hit ? 1 : 0);
+    MICROPROFILE_META_CPU("Cmdlist cache misses", hit ? 0 : 1);
+    if (hit) {
+        return it->second;
+    }
+
+    if (decoded_lists.size() >= MAX_DECODED_LISTS) {
+        decoded_lists.clear();
     }
 
+    return decoded_lists.insert_or_assign(key, DecodeCommandList(address, buffer, length))
+        .first->second;
+}
+
+static void RunCommandList(PAddr list, const u32* buffer, u32 length) {
     g_state.cmd_list.addr = list;
     g_state.cmd_list.head_ptr = g_state.cmd_list.current_ptr = buffer;
-    g_state.cmd_list.length = size / sizeof(u32);
+    g_state.cmd_list.length = length;
+    eliminated_writes = 0;
+
+    do {
+        cmd_list_jumped = false;
+
+        // A command buffer jump ends the current list and continues with the one it points to
+        const DecodedCommandList& decoded = GetDecodedCommandList(
+            g_state.cmd_list.addr, g_state.cmd_list.head_ptr, g_state.cmd_list.length);
+        for (const DecodedWrite& write : decoded.writes) {
+            WritePicaReg(write.id, write.value, write.write_mask);
+            if (cmd_list_jumped) {
+                break;
+            }
+        }
+
+        if (!cmd_list_jumped) {
+            g_state.cmd_list.current_ptr = g_state.cmd_list.head_ptr + g_state.cmd_list.length;
+        }
+    } while (cmd_list_jumped);
 
-    while (g_state.cmd_list.current_ptr < g_state.cmd_list.head_ptr + g_state.cmd_list.length) {
+    // Leave the rasterizer in sync with the registers between command lists
+    NotifyDirtyRegisters();
+    MICROPROFILE_META_CPU("Eliminated register writes", eliminated_writes);
+}
 
-        // Align read pointer to 8 bytes
-        if ((g_state.cmd_list.head_ptr - g_state.cmd_list.current_ptr) % 2 != 0)
-            ++g_state.cmd_list.current_ptr;
+void ProcessCommandList(PAddr list, u32 size) {
+
+    u32* buffer = (u32*)VideoCore::g_memory->GetPhysicalPointer(list);
+
+    if (Pica::g_debug_context && Pica::g_debug_context->recorder) {
+        Pica::g_debug_context->recorder->MemoryAccessed((u8*)buffer, size, list);
+    }
 
-        u32 value = *g_state.cmd_list.current_ptr++;
-        const CommandHeader header = {*g_state.cmd_list.current_ptr++};
+    RunCommandList(list, buffer, size / sizeof(u32));
+}
 
-        WritePicaReg(header.cmd_id, value, header.parameter_mask);
+void ProcessCommandList(PAddr list, std::span<const u32> buffer) {
+    RunCommandList(list, buffer.data(), static_cast<u32>(buffer.size()));
 
-        for (unsigned i = 0; i < header.extra_data_length; ++i) {
-            u32 cmd = header.cmd_id + (header.group_commands ? i + 1 : 0);
-            WritePicaReg(cmd, *g_state.cmd_list.current_ptr++, header.parameter_mask);
+    // The copy goes away afterwards, so point back at the list in guest memory
+    const u32* guest_buffer = (u32*)VideoCore::g_memory->GetPhysicalPointer(list);
+    g_state.cmd_list.current_ptr =
+        guest_buffer + (g_state.cmd_list.current_ptr - g_state.cmd_list.head_ptr);
+    g_state.cmd_list.head_ptr = guest_buffer;
+}
+
+bool HasCommandBufferJump(std::span<const u32> buffer) {
+    constexpr u32 first_trigger = PICA_REG_INDEX(pipeline.command_buffer.trigger[0]);
+    constexpr u32 last_trigger = PICA_REG_INDEX(pipeline.command_buffer.trigger[1]);
+
+    // Walks the command headers the same way as DecodeCommandList
+    std::size_t i = 0;
+    while (i + 2 <= buffer.size()) {
+        const CommandHeader header = {buffer[i + 1]};
+        const u32 extra_data_length =
+            std::min<u32>(header.extra_data_length, static_cast<u32>(buffer.size() - i - 2));
+
+        const u32 first_id = header.cmd_id;
+        const u32 last_id = first_id + (header.group_commands ? extra_data_length : 0);
+        if (first_id <= last_trigger && last_id >= first_trigger) {
+            return true;
         }
+
+        // Commands are aligned to 8 bytes
+        i += 2 + extra_data_length;
+        i += i % 2;
     }
+    return false;
 }
 
 } // namespace Pica::CommandProcessor
@@ -4,6 +4,7 @@
 
 #pragma once
 
+#include <span>
 #include <type_traits>
 #include "common/bit_field.h"
 #include "common/common_types.h"
@@ -34,4 +35,13 @@ static_assert(sizeof(CommandHeader) == sizeof(u32), "CommandHeader has incorrect
 
 void ProcessCommandList(PAddr list, u32 size);
 
+/**
+ * Processes a copy of the command list at the given address. The copy must not contain any
+ * command buffer jumps, as those continue with lists in guest memory.
+ */
+void ProcessCommandList(PAddr list, std::span<const u32> buffer);
+
+/// Returns true when the command list triggers a jump to another command buffer
+bool HasCommandBufferJump(std::span<const u32> buffer);
+
 } // namespace Pica::CommandProcessor
@@ -18,6 +18,11 @@ namespace VideoCore {
 // A piece of information the video frontend can query the backend about
 enum class Query {
     UniformAlignment = 0,
+    ThreadSafeShaderCompile = 1, ///< Shaders may be created and compiled from multiple threads
+    ThreadSafePipelineCompile = 2, ///< Pipelines may be created from multiple threads
+    DescriptorAllocations = 3, ///< Descriptor sets allocated during the last frame
+    DescriptorCacheHits = 4, ///< Descriptor set changes served from the cache during the last frame
+    RenderpassCount = 5, ///< Renderpasses begun during the last frame
 };
 
 // Common interface of a video backend
@@ -26,12 +31,20 @@ public:
     BackendBase(Frontend::EmuWindow& window) : window(window) {}
     virtual ~BackendBase() = default;
 
-    // Acquires the next swapchain images and begins rendering
+    // Acquires the next swapchain images and begins rendering. Returns false when there is
+    // no image to render to, including when there is no surface to present to at all
     virtual bool BeginPresent() = 0;
 
     // Triggers a swapchain buffer swap
     virtual void EndPresent() = 0;
 
+    // Submits the rendering work of the current frame without presenting it
+    virtual void SubmitFrame() = 0;
+
+    // Copies the texture to the next swapchain image and presents it. Unlike the other
+    // methods, this may be called from a thread other than the one recording rendering work
+    virtual void PresentTexture(const TextureHandle& texture) = 0;
+
     // Submits any pending work and blocks the host until it completes
     virtual void Flush() = 0;
 
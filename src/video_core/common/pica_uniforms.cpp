@@ -3,7 +3,10 @@
 // Refer to the license.txt file included.
 
 #include <algorithm>
+#include <array>
+#include <utility>
 #include "video_core/common/pica_uniforms.h"
+#include "video_core/common/shader_gen.h"
 
 namespace VideoCore {
 
@@ -22,4 +25,85 @@ void PicaUniformsData::SetFromRegs(const Pica::ShaderRegs& regs, const Pica::Sha
     });
 }
 
+void UberShaderData::SetFromConfig(const PicaFSConfig& config) {
+    using Pica::LightingRegs;
+    const auto& lighting = config.lighting;
+
+    alpha_test_func = static_cast<int>(config.alpha_test_func);
+    scissor_mode = static_cast<int>(config.scissor_test_mode);
+    texture0_type = static_cast<int>(config.texture0_type);
+    texture2_use_coord1 = config.texture2_use_coord1;
+    combiner_buffer_input = config.combiner_buffer_input;
+    w_buffering = config.depthmap_enable == Pica::RasterizerRegs::DepthBuffering::WBuffering;
+    fog_mode = static_cast<int>(config.fog_mode);
+    fog_flip = config.fog_flip;
+
+    lighting_enable = lighting.enable;
+    lighting_src_num = lighting.src_num;
+    bump_mode = static_cast<int>(lighting.bump_mode);
+    bump_selector = lighting.bump_selector;
+    bump_renorm = lighting.bump_renorm;
+    clamp_highlights = lighting.clamp_highlights;
+    enable_primary_alpha = lighting.enable_primary_alpha;
+    enable_secondary_alpha = lighting.enable_secondary_alpha;
+    enable_shadow = lighting.enable_shadow;
+    shadow_primary = lighting.shadow_primary;
+    shadow_secondary = lighting.shadow_secondary;
+    shadow_invert = lighting.shadow_invert;
+    shadow_alpha = lighting.shadow_alpha;
+    shadow_selector = lighting.shadow_selector;
+
+    std::ranges::transform(config.tev_stages, tev_stages, [](const TevStageConfigRaw& stage) {
+        return Common::Vec4u{stage.sources_raw, stage.modifiers_raw, stage.ops_raw,
+                             stage.scales_raw};
+    });
+
+    const auto IsSupported = [&lighting](LightingRegs::LightingSampler sampler) {
+        return LightingRegs::IsLightingSamplerSupported(lighting.config, sampler);
+    };
+
+    for (std::size_t i = 0; i < std::size(light_config); i++) {
+        const auto& light = lighting.light[i];
+        int flags = 0;
+        flags |= light.directional ? LightDirectional : 0;
+        flags |= light.two_sided_diffuse ? LightTwoSidedDiffuse : 0;
+        flags |= light.dist_atten_enable ? LightDistAtten : 0;
+        flags |= light.spot_atten_enable &&
+                         IsSupported(LightingRegs::LightingSampler::SpotlightAttenuation)
+                     ? LightSpotAtten
+                     : 0;
+        flags |= light.geometric_factor_0 ? LightGeometricFactor0 : 0;
+        flags |= light.geometric_factor_1 ? LightGeometricFactor1 : 0;
+        flags |= light.shadow_enable ? LightShadow : 0;
+        light_config[i] = Common::Vec4i{static_cast<int>(light.num), flags, 0, 0};
+    }
+
+    // The order must match the LUT indices used by the ubershader
+    const std::array luts = {
+        std::make_pair(&lighting.lut_d0, LightingRegs::LightingSampler::Distribution0),
+        std::make_pair(&lighting.lut_d1, LightingRegs::LightingSampler::Distribution1),
+        std::make_pair(&lighting.lut_sp, LightingRegs::LightingSampler::SpotlightAttenuation),
+        std::make_pair(&lighting.lut_fr, LightingRegs::LightingSampler::Fresnel),
+        std::make_pair(&lighting.lut_rr, LightingRegs::LightingSampler::ReflectRed),
+        std::make_pair(&lighting.lut_rg, LightingRegs::LightingSampler::ReflectGreen),
+        std::make_pair(&lighting.lut_rb, LightingRegs::LightingSampler::ReflectBlue),
+    };
+
+    for (std::size_t i = 0; i < luts.size(); i++) {
+        const auto& [lut, sampler] = luts[i];
+
+        // CP input is only available with configuration 7
+        int input = static_cast<int>(lut->type);
+        if (lut->type == LightingRegs::LightingLutInput::CP &&
+            lighting.config != LightingRegs::LightingConfig::Config7) {
+            input = LutInputZero;
+        }
+
+        // The spotlight LUT is toggled per light so its enable bit is unused
+        const bool enable = lut->enable && IsSupported(sampler);
+        lut_config[i] = Common::Vec4i{enable, lut->abs_input, input, 0};
+        lut_scale[i / 4][i % 4] = lut->scale;
+    }
+}
+
 } // namespace VideoCore
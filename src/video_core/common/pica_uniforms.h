@@ -69,6 +69,64 @@ struct UniformData {
 static_assert(sizeof(UniformData) == 0x4F0,
               "The size of the UniformData structure has changed, update the structure in the shader");
 
+struct PicaFSConfig;
+
+/**
+ * Uniform structure that describes the PICA fragment pipeline configuration to the fragment
+ * ubershader. It mirrors the parts of PicaFSConfig the ubershader is able to evaluate at runtime.
+ * NOTE: the same rule from UniformData also applies here.
+ */
+struct UberShaderData {
+    void SetFromConfig(const PicaFSConfig& config);
+
+    // Flags stored in the second component of each light_config entry
+    enum LightFlags : int {
+        LightDirectional = 1 << 0,
+        LightTwoSidedDiffuse = 1 << 1,
+        LightDistAtten = 1 << 2,
+        LightSpotAtten = 1 << 3,
+        LightGeometricFactor0 = 1 << 4,
+        LightGeometricFactor1 = 1 << 5,
+        LightShadow = 1 << 6,
+    };
+
+    // LUT input used when the configured input is not available, the LUT index is always zero
+    static constexpr int LutInputZero = -1;
+
+    int alpha_test_func;
+    int scissor_mode;
+    int texture0_type;
+    int texture2_use_coord1;
+    int combiner_buffer_input;
+    int w_buffering;
+    int fog_mode;
+    int fog_flip;
+    int lighting_enable;
+    int lighting_src_num;
+    int bump_mode;
+    int bump_selector;
+    int bump_renorm;
+    int clamp_highlights;
+    int enable_primary_alpha;
+    int enable_secondary_alpha;
+    int enable_shadow;
+    int shadow_primary;
+    int shadow_secondary;
+    int shadow_invert;
+    int shadow_alpha;
+    int shadow_selector;
+    // Raw sources, modifiers, ops and scales words of each TEV stage
+    alignas(16) Common::Vec4u tev_stages[6];
+    // Light number and enable flags of each active light slot
+    alignas(16) Common::Vec4i light_config[8];
+    // Enable, absolute input and input type of D0, D1, SP, FR, RR, RG and RB LUTs
+    alignas(16) Common::Vec4i lut_config[7];
+    alignas(16) Common::Vec4f lut_scale[2];
+};
+
+static_assert(sizeof(UberShaderData) == 0x1D0,
+              "The size of the UberShaderData structure has changed, update the structure in the shader");
+
 /**
  * Uniform struct for the Uniform Buffer Object that contains PICA vertex/geometry shader uniforms.
  * NOTE: the same rule from UniformData also applies here.
@@ -5,7 +5,8 @@
 #include <algorithm>
 #include <thread>
 #include <mutex>
-#include "core/frontend/scope_acquire_context.h"
+#include "common/thread_worker.h"
+#include "core/settings.h"
 #include "video_core/common/shader.h"
 #include "video_core/common/pipeline_cache.h"
 #include "video_core/common/shader_gen.h"
@@ -14,17 +15,6 @@
 
 namespace VideoCore {
 
-static u64 GetUniqueIdentifier(const Pica::Regs& regs, std::span<const u32> code) {
-    u64 hash = Common::ComputeHash64(regs.reg_array.data(), Pica::Regs::NUM_REGS * sizeof(u32));
-
-    if (code.size() > 0) {
-        u64 code_uid = Common::ComputeHash64(code.data(), code.size() * sizeof(u32));
-        hash = Common::HashCombine(hash, code_uid);
-    }
-
-    return hash;
-}
-
 static auto BuildVSConfigFromRaw(const ShaderDiskCacheRaw& raw) {
     Pica::Shader::ProgramCode program_code{};
     Pica::Shader::SwizzleData swizzle_data{};
@@ -48,14 +38,37 @@ PipelineCache::PipelineCache(Frontend::EmuWindow& emu_window, std::unique_ptr<Ba
     trivial_vertex_shader = backend->CreateShader(ShaderStage::Vertex, "Trivial vertex shader",
                                                   generator->GenerateTrivialVertexShader());
     trivial_vertex_shader->Compile(ShaderOptimization::Debug);
+
+    if (Settings::values.ubershader_mode != Settings::UberShaderMode::Disabled) {
+        uber_fragment_shader = backend->CreateShader(ShaderStage::Fragment, "Fragment ubershader",
+                                                     generator->GenerateFragmentUberShader());
+        uber_fragment_shader->Compile(ShaderOptimization::High);
+    }
+
+    if (Settings::values.async_pipeline_compile) {
+        if (backend->QueryDriver(Query::ThreadSafePipelineCompile) != 0) {
+            const std::size_t num_workers = std::max(1U, std::thread::hardware_concurrency() / 2);
+            compile_workers = std::make_unique<Common::ThreadWorker>(num_workers, "PipelineCompiler");
+        } else {
+            LOG_WARNING(Render_Vulkan, "Backend does not support asynchronous pipeline compilation");
+        }
+    }
 }
 
+PipelineCache::~PipelineCache() = default;
+
 PipelineHandle PipelineCache::GetPipeline(PipelineInfo& info) {
     // Update shader handles
     info.shaders[static_cast<u32>(ProgramType::VertexShader)] = current_vertex_shader;
     info.shaders[static_cast<u32>(ProgramType::GeometryShader)] = current_geometry_shader;
     info.shaders[static_cast<u32>(ProgramType::FragmentShader)] = current_fragment_shader;
 
+    using_ubershader = current_fragment_shader == uber_fragment_shader &&
+                       uber_fragment_shader.IsValid();
+    if (using_ubershader) {
+        stats.ubershader_draws++;
+    }
+
     // Search cache
     const u64 pipeline_hash = backend->PipelineInfoHash(info);
     if (auto iter = cached_pipelines.find(pipeline_hash); iter != cached_pipelines.end()) {
@@ -63,10 +76,80 @@ PipelineHandle PipelineCache::GetPipeline(PipelineInfo& info) {
     }
 
     // Create new pipeline
-    auto iter = cached_pipelines.emplace(pipeline_hash, backend->CreatePipeline(PipelineType::Graphics, info)).first;
+    if (!compile_workers) {
+        auto iter = cached_pipelines.emplace(pipeline_hash, backend->CreatePipeline(PipelineType::Graphics, info)).first;
+        return iter->second;
+    }
+
+    // Check if the pipeline is already being compiled
+    if (auto iter = pending_pipelines.find(pipeline_hash); iter != pending_pipelines.end()) {
+        PendingPipeline& pending = iter->second;
+        const bool is_ready = pending.future.wait_for(std::chrono::seconds{0}) ==
+                              std::future_status::ready;
+
+        // Stop skipping the draw if the pipeline took too long to compile
+        const u64 skipped_frames = current_frame - pending.request_frame;
+        if (is_ready || skipped_frames >= Settings::values.async_pipeline_skip_frames) {
+            PipelineHandle pipeline = pending.future.get();
+            cached_pipelines.emplace(pipeline_hash, pipeline);
+            pending_pipelines.erase(iter);
+            stats.pending_compiles = pending_pipelines.size();
+            return pipeline;
+        }
+
+        stats.fallback_draws++;
+        return GetUberShaderPipeline(info);
+    }
+
+    // Queue the pipeline for compilation. The info is copied since it's modified every draw
+    auto task = std::make_shared<std::packaged_task<PipelineHandle()>>(
+        [this, info]() { return backend->CreatePipeline(PipelineType::Graphics, info); });
+
+    pending_pipelines.emplace(pipeline_hash, PendingPipeline{
+        .future = task->get_future().share(),
+        .request_frame = current_frame
+    });
+
+    compile_workers->QueueWork([task] { (*task)(); });
+
+    stats.async_compiles++;
+    stats.pending_compiles = pending_pipelines.size();
+
+    // Wait immediately if skipping draws is disabled
+    if (Settings::values.async_pipeline_skip_frames == 0) {
+        return GetPipeline(info);
+    }
+
+    stats.fallback_draws++;
+    return GetUberShaderPipeline(info);
+}
+
+PipelineHandle PipelineCache::GetUberShaderPipeline(const PipelineInfo& info) {
+    // Draws are skipped when the ubershader isn't used or can't emulate the current state
+    if (Settings::values.ubershader_mode != Settings::UberShaderMode::Fallback || !uber_compatible) {
+        return PipelineHandle{};
+    }
+
+    PipelineInfo uber_info = info;
+    uber_info.shaders[static_cast<u32>(ProgramType::FragmentShader)] = uber_fragment_shader;
+
+    // The ubershader pipeline only depends on the fixed function state so it's built right away
+    const u64 pipeline_hash = backend->PipelineInfoHash(uber_info);
+    auto iter = cached_pipelines.find(pipeline_hash);
+    if (iter == cached_pipelines.end()) {
+        PipelineHandle pipeline = backend->CreatePipeline(PipelineType::Graphics, uber_info);
+        iter = cached_pipelines.emplace(pipeline_hash, pipeline).first;
+    }
+
+    using_ubershader = true;
+    stats.ubershader_draws++;
     return iter->second;
 }
 
+void PipelineCache::TickFrame() {
+    current_frame++;
+}
+
 bool PipelineCache::UsePicaVertexShader(const Pica::Regs& regs, Pica::Shader::ShaderSetup& setup) {
     PicaVSConfig config{regs.vs, setup};
     auto [handle, shader_str] = pica_vertex_shaders.Get(config, setup);
@@ -83,13 +166,17 @@ bool PipelineCache::UsePicaVertexShader(const Pica::Regs& regs, Pica::Shader::Sh
         program_code.insert(program_code.end(), setup.swizzle_data.begin(), setup.swizzle_data.end());
 
         // Hash the bytecode and save the pica program
-        const u64 unique_identifier = GetUniqueIdentifier(regs, program_code);
+        ShaderDiskCacheKey key{regs};
+        const u64 unique_identifier = ComputeShaderUniqueIdentifier(key, program_code);
         const ShaderDiskCacheRaw raw{unique_identifier, ProgramType::VertexShader,
-                                     regs, std::move(program_code)};
+                                     std::move(key), std::move(program_code)};
 
         disk_cache.SaveRaw(raw);
         disk_cache.SaveDecompiled(unique_identifier, shader_str.value(),
                                   VideoCore::g_hw_shader_accurate_mul);
+        disk_cache.SaveBinary(unique_identifier, handle->GetBinary(),
+                              VideoCore::g_hw_shader_accurate_mul);
+        handle->ReleaseBinary();
     }
 
     return true;
@@ -109,20 +196,87 @@ void PipelineCache::UseTrivialGeometryShader() {
     current_geometry_shader = ShaderHandle{};
 }
 
+// Procedural textures and shadow rendering are not emulated by the ubershader
+static bool IsUberShaderCompatible(const PicaFSConfig& config) {
+    return !config.proctex.enable && !config.shadow_rendering;
+}
+
 void PipelineCache::UseFragmentShader(const Pica::Regs& regs) {
     PicaFSConfig config{regs};
+    if (uber_fragment_shader.IsValid()) {
+        uber_data.SetFromConfig(config);
+        uber_compatible = IsUberShaderCompatible(config);
+
+        // Skip generating the specialized shader when benchmarking the ubershader
+        if (Settings::values.ubershader_mode == Settings::UberShaderMode::Always &&
+            uber_compatible) {
+            current_fragment_shader = uber_fragment_shader;
+            return;
+        }
+    }
+
     auto [handle, shader_str] = fragment_shaders.Get(config);
     current_fragment_shader = handle;
 
     // Save FS to the disk cache if its a new shader
     if (shader_str.has_value()) {
-        u64 unique_identifier = GetUniqueIdentifier(regs, {});
-        ShaderDiskCacheRaw raw{unique_identifier, ProgramType::FragmentShader, regs, {}};
+        ShaderDiskCacheKey key{regs};
+        const u64 unique_identifier = ComputeShaderUniqueIdentifier(key, {});
+        ShaderDiskCacheRaw raw{unique_identifier, ProgramType::FragmentShader, std::move(key), {}};
         disk_cache.SaveRaw(raw);
         disk_cache.SaveDecompiled(unique_identifier, shader_str.value(), false);
+        disk_cache.SaveBinary(unique_identifier, handle->GetBinary(), false);
+        handle->ReleaseBinary();
     }
 }
 
+/**
+ * Splits the range [0, count) in equally sized buckets and processes each one in its own thread
+ * @param num_workers The maximum number of threads to spawn
+ * @param func Callable invoked with the index of every element in the range
+ */
+template <typename Func>
+static void ParallelFor(std::size_t num_workers, std::size_t count, Func&& func) {
+    num_workers = std::clamp<std::size_t>(num_workers, 1, std::max<std::size_t>(count, 1));
+    if (num_workers == 1) {
+        for (std::size_t i = 0; i < count; i++) {
+            func(i);
+        }
+        return;
+    }
+
+    const std::size_t bucket_size{count / num_workers};
+    std::vector<std::thread> threads(num_workers);
+    for (std::size_t i = 0; i < num_workers; ++i) {
+        const bool is_last_worker = i + 1 == num_workers;
+        const std::size_t start{bucket_size * i};
+        const std::size_t end{is_last_worker ? count : start + bucket_size};
+
+        threads[i] = std::thread([&func, start, end] {
+            for (std::size_t index = start; index < end; index++) {
+                func(index);
+            }
+        });
+    }
+
+    for (auto& thread : threads) {
+        thread.join();
+    }
+}
+
+static ShaderStage ToShaderStage(ProgramType type) {
+    switch (type) {
+    case ProgramType::VertexShader:
+        return ShaderStage::Vertex;
+    case ProgramType::GeometryShader:
+        return ShaderStage::Geometry;
+    case ProgramType::FragmentShader:
+        return ShaderStage::Fragment;
+    }
+
+    return ShaderStage::Undefined;
+}
+
 void PipelineCache::LoadDiskCache(const std::atomic_bool& stop_loading, const DiskLoadCallback& callback) {
     const auto transferable = disk_cache.LoadTransferable();
     if (!transferable.has_value()) {
@@ -134,198 +288,182 @@ void PipelineCache::LoadDiskCache(const std::atomic_bool& stop_loading, const Di
     // Load uncompressed precompiled file for non-separable shaders.
     // Precompiled file for separable shaders is compressed.
     std::optional decompiled = disk_cache.LoadPrecompiled();
+    std::optional binaries = disk_cache.LoadBinaries();
     if (stop_loading) {
         return;
     }
 
-    std::mutex mutex;
-    std::atomic_bool compilation_failed = false;
-    if (callback) {
-        callback(VideoCore::LoadCallbackStage::Decompile, 0, raws.size());
-    }
-
-    std::vector<std::size_t> load_raws_index;
-    for (u64 i = 0; i < raws.size(); i++) {
-        if (stop_loading || compilation_failed) {
-            break;
-        }
-
-        const ShaderDiskCacheRaw& raw = raws[i];
+    // Check for any data corruption before spawning any work
+    for (const ShaderDiskCacheRaw& raw : raws) {
         const u64 unique_identifier = raw.GetUniqueIdentifier();
-        const u64 calculated_hash = GetUniqueIdentifier(raw.GetRawShaderConfig(), raw.GetProgramCode());
-
-        // Check for any data corruption
+        const u64 calculated_hash = ComputeShaderUniqueIdentifier(raw.GetKey(), raw.GetProgramCode());
         if (unique_identifier != calculated_hash) {
             LOG_ERROR(Render_Vulkan, "Invalid hash in entry={:016x} (obtained hash={:016x}) - removing "
-                                     "shader cache",
-                                     raw.GetUniqueIdentifier(), calculated_hash);
+                                     "shader cache", unique_identifier, calculated_hash);
+            disk_cache.InvalidateAll();
+            return;
+        }
 
+        if (raw.GetProgramType() != ProgramType::VertexShader &&
+            raw.GetProgramType() != ProgramType::FragmentShader) {
+            // Unsupported shader type got stored somehow so nuke the cache
+            LOG_CRITICAL(Frontend, "Failed to load raw ProgramType {}", raw.GetProgramType());
             disk_cache.InvalidateAll();
-            break;
+            return;
         }
+    }
 
-        const auto iter = decompiled->find(unique_identifier);
+    // Shader source generation is pure CPU work so it always runs on every available core.
+    // Shader compilation is only spread across threads when the backend allows it.
+    const std::size_t num_workers{std::max(1U, std::thread::hardware_concurrency())};
+    const bool threaded_compile = backend->QueryDriver(Query::ThreadSafeShaderCompile) != 0;
 
+    struct LoadEntry {
+        std::string source;
+        bool is_new = false;
+        bool needs_binary = true;
         ShaderHandle shader{};
-        if (iter != decompiled->end()) {
-            // Only load the vertex shader if its sanitize_mul setting matches
-            ShaderDiskCacheDecompiled& decomp = iter->second;
-            if (raw.GetProgramType() == ProgramType::VertexShader &&
-                decomp.sanitize_mul != VideoCore::g_hw_shader_accurate_mul) {
-                break;
-            }
-
-            ShaderStage stage;
-            switch (raw.GetProgramType()) {
-            case ProgramType::VertexShader:
-                stage = ShaderStage::Vertex;
-                break;
-            case ProgramType::GeometryShader:
-                stage = ShaderStage::Geometry;
-                break;
-            case ProgramType::FragmentShader:
-                stage = ShaderStage::Fragment;
-                break;
-            }
+    };
 
-            // Create shader from GLSL source
-            shader = backend->CreateShader(stage, "Precompiled shader", decomp.result);
-
-            // We have both the binary shader and the decompiled, so inject it into the
-            // cache
-            if (raw.GetProgramType() == ProgramType::VertexShader) {
-                auto [conf, setup] = BuildVSConfigFromRaw(raw);
-                std::scoped_lock lock(mutex);
-                pica_vertex_shaders.Inject(conf, decomp.result, std::move(shader));
-
-            } else if (raw.GetProgramType() == ProgramType::FragmentShader) {
-                const PicaFSConfig conf{raw.GetRawShaderConfig()};
-                std::scoped_lock lock(mutex);
-                fragment_shaders.Inject(conf, std::move(shader));
-
-            } else {
-                // Unsupported shader type got stored somehow so nuke the cache
-                LOG_CRITICAL(Frontend, "failed to load raw ProgramType {}", raw.GetProgramType());
-                compilation_failed = true;
-                break;
-            }
-        } else {
-            // Since precompiled didn't have the dump, we'll load them in the next phase
-            std::scoped_lock lock(mutex);
-            load_raws_index.push_back(i);
-        }
+    std::vector<LoadEntry> entries(raws.size());
+    std::mutex mutex;
+    std::atomic_bool compilation_failed = false;
+    std::size_t processed = 0; // It doesn't have be atomic since it's used behind a mutex
 
+    const auto ReportProgress = [&](LoadCallbackStage stage) {
+        std::scoped_lock lock{mutex};
         if (callback) {
-            callback(VideoCore::LoadCallbackStage::Decompile, i, raws.size());
+            callback(stage, ++processed, raws.size());
         }
-    }
-
+    };
 
-    // Invalidate the precompiled cache if a shader dumped shader was rejected
-    bool load_all_raws = false;
-    if (compilation_failed) {
-        disk_cache.InvalidatePrecompiled();
-        load_all_raws = true;
+    if (callback) {
+        callback(LoadCallbackStage::Decompile, 0, raws.size());
     }
 
-    const std::size_t load_raws_size = load_all_raws ? raws.size() : load_raws_index.size();
+    // Decompile stage: reuse the precompiled GLSL if it exists, otherwise generate it
+    ParallelFor(num_workers, raws.size(), [&](std::size_t i) {
+        if (stop_loading) {
+            return;
+        }
 
-    if (callback) {
-        callback(VideoCore::LoadCallbackStage::Build, 0, load_raws_size);
-    }
+        const ShaderDiskCacheRaw& raw = raws[i];
+        LoadEntry& entry = entries[i];
 
-    compilation_failed = false;
+        if (decompiled) {
+            const auto iter = decompiled->find(raw.GetUniqueIdentifier());
 
-    std::size_t built_shaders = 0; // It doesn't have be atomic since it's used behind a mutex
-    const auto LoadRawSepareble = [&](Frontend::GraphicsContext* context, std::size_t begin,
-                                      std::size_t end) {
-        Frontend::ScopeAcquireContext scope(*context);
-        for (u64 i = begin; i < end; ++i) {
-            if (stop_loading || compilation_failed) {
+            // Only use the vertex shader if its sanitize_mul setting matches
+            if (iter != decompiled->end() &&
+                (raw.GetProgramType() != ProgramType::VertexShader ||
+                 iter->second.sanitize_mul == VideoCore::g_hw_shader_accurate_mul)) {
+                entry.source = iter->second.result;
+                ReportProgress(LoadCallbackStage::Decompile);
                 return;
             }
+        }
 
-            const u64 raws_index = load_all_raws ? i : load_raws_index[i];
-            const auto& raw = raws[raws_index];
-            const u64 unique_identifier = raw.GetUniqueIdentifier();
-
-            bool sanitize_mul = false;
-            ShaderHandle shader{nullptr};
-            std::optional<std::string> result;
+        if (raw.GetProgramType() == ProgramType::VertexShader) {
+            auto [conf, setup] = BuildVSConfigFromRaw(raw);
+            entry.source = generator->GenerateVertexShader(setup, conf);
+        } else {
+            const PicaFSConfig conf{raw.GetRawShaderConfig()};
+            entry.source = generator->GenerateFragmentShader(conf);
+        }
 
-            // Otherwise decompile and build the shader at boot and save the result to the
-            // precompiled file
-            if (raw.GetProgramType() == ProgramType::VertexShader) {
-                auto [conf, setup] = BuildVSConfigFromRaw(raw);
-                result = generator->GenerateVertexShader(setup, conf);
+        entry.is_new = true;
+        ReportProgress(LoadCallbackStage::Decompile);
+    });
 
-                // Compile shader
-                shader = backend->CreateShader(ShaderStage::Vertex, "Vertex shader", result.value());
-                shader->Compile(ShaderOptimization::Debug);
+    if (stop_loading) {
+        return;
+    }
 
-                sanitize_mul = conf.sanitize_mul;
-                std::scoped_lock lock(mutex);
-                pica_vertex_shaders.Inject(conf, result.value(), std::move(shader));
+    if (callback) {
+        callback(LoadCallbackStage::Build, 0, raws.size());
+    }
 
-            } else if (raw.GetProgramType() == ProgramType::FragmentShader) {
-                const PicaFSConfig conf{raw.GetRawShaderConfig()};
-                result = generator->GenerateFragmentShader(conf);
+    // Build stage: compile the shader sources to backend objects
+    processed = 0;
+    ParallelFor(threaded_compile ? num_workers : 1, raws.size(), [&](std::size_t i) {
+        if (stop_loading || compilation_failed) {
+            return;
+        }
 
-                // Compile shader
-                shader = backend->CreateShader(ShaderStage::Fragment, "Fragment shader", result.value());
-                shader->Compile(ShaderOptimization::Debug);
+        const ShaderDiskCacheRaw& raw = raws[i];
+        LoadEntry& entry = entries[i];
 
-                std::scoped_lock lock(mutex);
-                fragment_shaders.Inject(conf, std::move(shader));
+        ShaderHandle shader{};
+        {
+            // The backend object pools are not thread safe
+            std::scoped_lock lock{mutex};
+            shader = backend->CreateShader(ToShaderStage(raw.GetProgramType()),
+                                           "Precompiled shader", entry.source);
+        }
 
-            } else {
-                // Unsupported shader type got stored somehow so nuke the cache
-                LOG_ERROR(Frontend, "Failed to load raw ProgramType {}", raw.GetProgramType());
-                compilation_failed = true;
+        // Skip the compiler entirely when a binary of this exact shader is stored
+        if (binaries) {
+            const auto iter = binaries->find(raw.GetUniqueIdentifier());
+            if (iter != binaries->end() &&
+                (raw.GetProgramType() != ProgramType::VertexShader ||
+                 iter->second.sanitize_mul == VideoCore::g_hw_shader_accurate_mul) &&
+                shader->LoadBinary(iter->second.code)) {
+                entry.needs_binary = false;
+                entry.shader = std::move(shader);
+                ReportProgress(LoadCallbackStage::Build);
                 return;
             }
+        }
 
-            if (!shader.IsValid()) {
-                LOG_ERROR(Frontend, "Compilation from raw failed {:x} {:x}",
-                          raw.GetProgramCode()[0], raw.GetProgramCode()[1]);
-                compilation_failed = true;
-                return;
-            }
+        if (!shader->Compile(ShaderOptimization::Debug)) {
+            LOG_ERROR(Frontend, "Compilation from raw failed for entry={:016x}",
+                      raw.GetUniqueIdentifier());
+            compilation_failed = true;
+            return;
+        }
 
-            std::scoped_lock lock(mutex);
+        entry.shader = std::move(shader);
+        ReportProgress(LoadCallbackStage::Build);
+    });
 
-            // If this is a new separable shader, add it the precompiled cache
-            if (result) {
-                disk_cache.SaveDecompiled(unique_identifier, *result, sanitize_mul);
-            }
+    if (compilation_failed) {
+        disk_cache.InvalidateAll();
+        return;
+    }
 
-            if (callback) {
-                callback(VideoCore::LoadCallbackStage::Build, ++built_shaders, load_raws_size);
-            }
-        }
-    };
+    if (stop_loading) {
+        return;
+    }
 
-    const std::size_t num_workers{std::max(1U, std::thread::hardware_concurrency())};
-    const std::size_t bucket_size{load_raws_size / num_workers};
-    std::vector<std::unique_ptr<Frontend::GraphicsContext>> contexts(num_workers);
-    std::vector<std::thread> threads(num_workers);
+    // Inject the built shaders into the runtime caches and remember new sources
+    for (std::size_t i = 0; i < raws.size(); i++) {
+        const ShaderDiskCacheRaw& raw = raws[i];
+        LoadEntry& entry = entries[i];
 
-    for (std::size_t i = 0; i < num_workers; ++i) {
-        const bool is_last_worker = i + 1 == num_workers;
-        const std::size_t start{bucket_size * i};
-        const std::size_t end{is_last_worker ? load_raws_size : start + bucket_size};
+        bool sanitize_mul = false;
+        if (raw.GetProgramType() == ProgramType::VertexShader) {
+            auto [conf, setup] = BuildVSConfigFromRaw(raw);
+            sanitize_mul = conf.sanitize_mul;
+        }
 
-        // On some platforms the shared context has to be created from the GUI thread
-        //contexts[i] = emu_window.CreateSharedContext();
-        threads[i] = std::thread(LoadRawSepareble, contexts[i].get(), start, end);
-    }
+        // If this is a new shader, add it the precompiled cache
+        if (entry.is_new) {
+            disk_cache.SaveDecompiled(raw.GetUniqueIdentifier(), entry.source, sanitize_mul);
+        }
 
-    for (auto& thread : threads) {
-        thread.join();
-    }
+        if (entry.needs_binary) {
+            disk_cache.SaveBinary(raw.GetUniqueIdentifier(), entry.shader->GetBinary(),
+                                  sanitize_mul);
+            entry.shader->ReleaseBinary();
+        }
 
-    if (compilation_failed) {
-        disk_cache.InvalidateAll();
+        if (raw.GetProgramType() == ProgramType::VertexShader) {
+            auto [conf, setup] = BuildVSConfigFromRaw(raw);
+            pica_vertex_shaders.Inject(conf, std::move(entry.source), std::move(entry.shader));
+        } else {
+            const PicaFSConfig conf{raw.GetRawShaderConfig()};
+            fragment_shaders.Inject(conf, std::move(entry.shader));
+        }
     }
 }
 
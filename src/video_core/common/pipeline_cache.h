@@ -5,10 +5,16 @@
 #pragma once
 
 #include <functional>
+#include <future>
 #include "video_core/regs.h"
+#include "video_core/common/pica_uniforms.h"
 #include "video_core/common/shader_runtime_cache.h"
 #include "video_core/common/shader_disk_cache.h"
 
+namespace Common {
+class ThreadWorker;
+}
+
 namespace FileUtil {
 class IOFile;
 }
@@ -32,15 +38,42 @@ enum class LoadCallbackStage : u8 {
 
 using DiskLoadCallback = std::function<void(LoadCallbackStage, std::size_t, std::size_t)>;
 
+// Statistics about asynchronous pipeline compilation
+struct PipelineCacheStats {
+    std::size_t pending_compiles = 0; ///< Pipelines currently compiling in the background
+    u64 async_compiles = 0;           ///< Total number of pipelines compiled in the background
+    u64 fallback_draws = 0;           ///< Draws that could not use their own pipeline
+    u64 ubershader_draws = 0;         ///< Draws rendered with the fragment ubershader
+};
+
 // A class that manages and caches shaders and pipelines
 class PipelineCache {
 public:
     PipelineCache(Frontend::EmuWindow& emu_window, std::unique_ptr<BackendBase>& backend);
-    ~PipelineCache() = default;
+    ~PipelineCache();
 
-    // Searches the cache for pipelines matching the information structure
+    // Searches the cache for pipelines matching the information structure. When asynchronous
+    // compilation is enabled, an invalid handle is returned while the pipeline is being built
     PipelineHandle GetPipeline(PipelineInfo& info);
 
+    // Advances the frame counter used to limit how long draws are skipped
+    void TickFrame();
+
+    // Returns true when the last pipeline returned by GetPipeline uses the fragment ubershader
+    bool IsUsingUberShader() const {
+        return using_ubershader;
+    }
+
+    // Returns the fragment configuration consumed by the ubershader
+    const UberShaderData& GetUberShaderData() const {
+        return uber_data;
+    }
+
+    // Returns the asynchronous compilation statistics
+    const PipelineCacheStats& GetStats() const {
+        return stats;
+    }
+
     // Loads backend specific shader binaries from disk
     void LoadDiskCache(const std::atomic_bool& stop_loading, const DiskLoadCallback& callback);
 
@@ -53,6 +86,10 @@ public:
     // Compiles and caches a fragment shader based on the current pica state
     void UseFragmentShader(const Pica::Regs& config);
 
+private:
+    // Returns the ubershader variant of the pipeline described by info
+    PipelineHandle GetUberShaderPipeline(const PipelineInfo& info);
+
 private:
     Frontend::EmuWindow& emu_window;
     std::unique_ptr<BackendBase>& backend;
@@ -61,6 +98,16 @@ private:
     // Keeps all the compiled graphics pipelines. The hash is decided by the backend
     std::unordered_map<u64, PipelineHandle, Common::IdentityHash> cached_pipelines;
 
+    // Pipelines being compiled in the background along with the frame they were requested
+    struct PendingPipeline {
+        std::shared_future<PipelineHandle> future;
+        u64 request_frame = 0;
+    };
+
+    std::unordered_map<u64, PendingPipeline, Common::IdentityHash> pending_pipelines;
+    PipelineCacheStats stats;
+    u64 current_frame = 0;
+
     // Current shaders
     ShaderHandle current_vertex_shader{};
     ShaderHandle current_geometry_shader{};
@@ -72,7 +119,17 @@ private:
     FragmentShaders fragment_shaders;
     ShaderHandle trivial_vertex_shader;
 
+    // Fragment ubershader and the state it reads for the current draw
+    ShaderHandle uber_fragment_shader;
+    UberShaderData uber_data{};
+    bool uber_compatible = false;
+    bool using_ubershader = false;
+
     // Serializes shader binaries to disk
     ShaderDiskCache disk_cache;
+
+    // Workers used for asynchronous pipeline compilation. Declared last so that
+    // it's destroyed (and the workers joined) before anything they reference
+    std::unique_ptr<Common::ThreadWorker> compile_workers;
 };
 } // namespace VideoCore
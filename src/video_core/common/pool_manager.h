@@ -9,7 +9,8 @@
 
 namespace VideoCore {
 
-// Manages (de)allocation of video backend resources
+// Manages (de)allocation of video backend resources. Resources may be created
+// from worker threads (shader and pipeline compilation) so the pools are thread-safe
 class PoolManager {
 public:
     template <typename T, typename... P>
@@ -26,8 +27,8 @@ public:
 
 private:
     template <typename T>
-    ObjectPool<T>& GetPoolForType() {
-        static ObjectPool<T> resource_pool;
+    ThreadSafeObjectPool<T>& GetPoolForType() {
+        static ThreadSafeObjectPool<T> resource_pool;
         return resource_pool;
     }
 };
@@ -0,0 +1,60 @@
+// Copyright 2022 Citra Emulator Project
+// Licensed under GPLv2 or any later version
+// Refer to the license.txt file included.
+
+#include <algorithm>
+#include <utility>
+#include "video_core/common/present_mailbox.h"
+
+namespace VideoCore {
+
+bool PresentMailbox::PushFrame() {
+    bool dropped;
+    {
+        std::scoped_lock lock{mutex};
+        std::swap(render_slot, ready_slot);
+        dropped = std::exchange(ready_pending, true);
+    }
+
+    frame_cv.notify_one();
+    return dropped;
+}
+
+std::optional<u32> PresentMailbox::WaitFrame(std::chrono::microseconds timeout) {
+    std::unique_lock lock{mutex};
+    if (!frame_cv.wait_for(lock, timeout, [this] { return ready_pending; })) {
+        return std::nullopt;
+    }
+
+    std::swap(present_slot, ready_slot);
+    ready_pending = false;
+    present_valid = true;
+    return present_slot;
+}
+
+std::optional<u32> PresentMailbox::GetPresentSlot() const {
+    std::scoped_lock lock{mutex};
+    if (!present_valid) {
+        return std::nullopt;
+    }
+
+    return present_slot;
+}
+
+FramePacer::Clock::time_point FramePacer::GetPresentTime(std::chrono::microseconds vblank_time,
+                                                         Clock::time_point now) {
+    if (anchored) {
+        const Clock::time_point target = anchor_time + (vblank_time - anchor_vblank);
+        if (target >= now - MAX_DRIFT && target <= now + MAX_DRIFT) {
+            // Slightly late frames are presented right away without moving the anchor
+            return std::max(target, now);
+        }
+    }
+
+    anchored = true;
+    anchor_vblank = vblank_time;
+    anchor_time = now;
+    return now;
+}
+
+} // namespace VideoCore
@@ -0,0 +1,83 @@
+// Copyright 2022 Citra Emulator Project
+// Licensed under GPLv2 or any later version
+// Refer to the license.txt file included.
+
+#pragma once
+
+#include <chrono>
+#include <condition_variable>
+#include <mutex>
+#include <optional>
+#include "common/common_types.h"
+
+namespace VideoCore {
+
+constexpr u32 PRESENT_FRAME_COUNT = 3;
+
+/**
+ * Triple buffered hand-off of finished frames between the thread that renders them and the
+ * thread that presents them. The mailbox only tracks slot indices, the frame resources live
+ * with the owner. The producer always owns one slot, so it never waits for the consumer.
+ * Pushing a frame while the previous one was never presented replaces it, which counts as a
+ * dropped frame.
+ */
+class PresentMailbox {
+public:
+    /// Returns the slot owned by the producer
+    u32 GetRenderSlot() const {
+        return render_slot;
+    }
+
+    /**
+     * Hands the render slot to the consumer and takes over the slot it replaces.
+     * @returns true when the replaced slot held a frame that was never presented
+     */
+    bool PushFrame();
+
+    /**
+     * Waits until a frame that was not presented yet is available and takes it over.
+     * @param timeout Maximum amount of time to wait for a new frame
+     * @returns The slot of the new frame or std::nullopt on timeout
+     */
+    std::optional<u32> WaitFrame(std::chrono::microseconds timeout);
+
+    /// Returns the slot last taken by the consumer, std::nullopt if it never took one
+    std::optional<u32> GetPresentSlot() const;
+
+private:
+    mutable std::mutex mutex;
+    std::condition_variable frame_cv;
+    u32 render_slot = 0;
+    u32 ready_slot = 1;
+    u32 present_slot = 2;
+    bool ready_pending = false;
+    bool present_valid = false;
+};
+
+/**
+ * Maps guest VBlank timestamps to host presentation times, so frames reach the screen with the
+ * same spacing the emulated LCD produced them at. The mapping is anchored to the first frame and
+ * re-anchored whenever emulation falls behind or runs ahead of real time by more than
+ * MAX_DRIFT, instead of trying to catch up or waiting out the difference.
+ */
+class FramePacer {
+public:
+    using Clock = std::chrono::steady_clock;
+
+    static constexpr std::chrono::microseconds MAX_DRIFT{50000};
+
+    /// Returns the host time at which the frame of the provided VBlank should be presented
+    Clock::time_point GetPresentTime(std::chrono::microseconds vblank_time, Clock::time_point now);
+
+    /// Forgets the current anchor, the next frame is presented immediately
+    void Reset() {
+        anchored = false;
+    }
+
+private:
+    bool anchored = false;
+    std::chrono::microseconds anchor_vblank{0};
+    Clock::time_point anchor_time{};
+};
+
+} // namespace VideoCore
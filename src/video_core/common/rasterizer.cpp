@@ -106,7 +106,8 @@ constexpr PipelineLayoutInfo RASTERIZER_PIPELINE_LAYOUT = {
             BindingType::Uniform,
             BindingType::TexelBuffer,
             BindingType::TexelBuffer,
-            BindingType::TexelBuffer
+            BindingType::TexelBuffer,
+            BindingType::Uniform
         }, // Texture unit set
         BindingGroup{
             BindingType::Texture,
@@ -202,6 +203,7 @@ Rasterizer::Rasterizer(Frontend::EmuWindow& emu_window, std::unique_ptr<BackendB
     uniform_buffer_alignment = 64;
     uniform_size_aligned_vs = Common::AlignUp<std::size_t>(sizeof(VSUniformData), uniform_buffer_alignment);
     uniform_size_aligned_fs = Common::AlignUp<std::size_t>(sizeof(UniformData), uniform_buffer_alignment);
+    uniform_size_aligned_uber = Common::AlignUp<std::size_t>(sizeof(UberShaderData), uniform_buffer_alignment);
 
     // Create pipeline cache
     pipeline_cache = std::make_unique<PipelineCache>(emu_window, backend);
@@ -220,6 +222,15 @@ void Rasterizer::LoadDiskResources(const std::atomic_bool& stop_loading, const D
     pipeline_cache->LoadDiskCache(stop_loading, callback);
 }
 
+void Rasterizer::TickFrame() {
+    pipeline_cache->TickFrame();
+    res_cache.UpdateCustomTextures();
+}
+
+const PipelineCacheStats& Rasterizer::GetPipelineCacheStats() const {
+    return pipeline_cache->GetStats();
+}
+
 void Rasterizer::SyncEntireState() {
     // Sync fixed function state
     SyncClipEnabled();
@@ -651,11 +662,18 @@ bool Rasterizer::Draw(bool accelerate, bool is_indexed) {
     // Sync and bind the shader
     if (shader_dirty) {
         pipeline_cache->UseFragmentShader(regs);
+        uniform_block_data.uber_dirty = true;
         shader_dirty = false;
     }
 
-    // Sync the viewport
+    // Skip the draw if its pipeline is still being compiled in the background
     PipelineHandle raster_pipeline = pipeline_cache->GetPipeline(raster_info);
+    if (!raster_pipeline.IsValid()) {
+        vertex_batch.clear();
+        return true;
+    }
+
+    // Sync the viewport
     raster_pipeline->ApplyDynamic(raster_info);
     raster_pipeline->SetViewport(surfaces_rect.left + viewport_rect_unscaled.left * res_scale,
                                  surfaces_rect.bottom + viewport_rect_unscaled.bottom * res_scale,
@@ -2054,8 +2072,9 @@ void Rasterizer::SyncAndUploadLUTs() {
 void Rasterizer::UploadUniforms(PipelineHandle pipeline, bool accelerate_draw) {
     bool sync_vs = accelerate_draw;
     bool sync_fs = uniform_block_data.dirty;
+    bool sync_uber = uniform_block_data.uber_dirty;
 
-    if (!sync_vs && !sync_fs) {
+    if (!sync_vs && !sync_fs && !sync_uber) {
         return;
     }
 
@@ -2080,11 +2099,24 @@ void Rasterizer::UploadUniforms(PipelineHandle pipeline, bool accelerate_draw) {
         uniform_buffer_fs->Commit(uniform_size_aligned_fs);
     }
 
+    // The ubershader state is always kept bound since every pipeline shares the layout
+    if (sync_uber) {
+        auto uniforms = uniform_buffer_fs->Map(uniform_size_aligned_uber, uniform_buffer_alignment);
+        uniform_block_data.current_uber_offset = uniform_buffer_fs->GetCurrentOffset();
+
+        std::memcpy(uniforms.data(), &pipeline_cache->GetUberShaderData(), sizeof(UberShaderData));
+
+        uniform_block_data.uber_dirty = false;
+        uniform_buffer_fs->Commit(uniform_size_aligned_uber);
+    }
+
     // Bind updated ranges
     pipeline->BindBuffer(UTILITY_GROUP, 0, uniform_buffer_vs, uniform_block_data.current_vs_offset,
                          sizeof(VSUniformData));
     pipeline->BindBuffer(UTILITY_GROUP, 1, uniform_buffer_fs, uniform_block_data.current_fs_offset,
                          sizeof(UniformData));
+    pipeline->BindBuffer(UTILITY_GROUP, 5, uniform_buffer_fs, uniform_block_data.current_uber_offset,
+                         sizeof(UberShaderData));
 }
 
 } // namespace VideoCore
@@ -15,6 +15,7 @@ class EmuWindow;
 
 namespace VideoCore {
 class PipelineCache;
+struct PipelineCacheStats;
 
 enum class LoadCallbackStage : u8;
 using DiskLoadCallback = std::function<void(LoadCallbackStage, std::size_t, std::size_t)>;
@@ -67,6 +68,12 @@ public:
     /// Syncs entire status to match PICA registers
     void SyncEntireState();
 
+    /// Notifies the rasterizer that a frame has been presented
+    void TickFrame();
+
+    /// Returns the asynchronous pipeline compilation statistics
+    const PipelineCacheStats& GetPipelineCacheStats() const;
+
 private:
     /// Syncs the clip enabled status to match the PICA register
     void SyncClipEnabled();
@@ -208,6 +215,8 @@ private:
         bool dirty = true;
         u32 current_vs_offset = 0;
         u32 current_fs_offset = 0;
+        bool uber_dirty = true;
+        u32 current_uber_offset = 0;
     } uniform_block_data{};
 
     // Pipeline information structure used to identify a rasterizer pipeline
@@ -223,6 +232,7 @@ private:
     std::size_t uniform_buffer_alignment;
     std::size_t uniform_size_aligned_vs = 0;
     std::size_t uniform_size_aligned_fs = 0;
+    std::size_t uniform_size_aligned_uber = 0;
 
     // Rasterizer used buffers (vertex, index, uniform, lut)
     BufferHandle vertex_buffer, index_buffer;
@@ -3,6 +3,7 @@
 // Refer to the license.txt file included.
 
 #include <algorithm>
+#include <bitset>
 #include <cmath>
 #include <optional>
 #include <boost/range/iterator_range.hpp>
@@ -12,11 +13,14 @@
 #include "common/texture.h"
 #include "common/vector_math.h"
 #include "core/core.h"
+#include "core/hle/kernel/process.h"
+#include "core/hw/gpu_transfer.h"
 #include "core/memory.h"
 #include "core/settings.h"
 #include "video_core/pica_state.h"
 #include "video_core/common/backend.h"
 #include "video_core/common/rasterizer_cache.h"
+#include "video_core/common/texture_dumper.h"
 #include "video_core/utils.h"
 #include "video_core/video_core.h"
 
@@ -470,19 +474,14 @@ void CachedSurface::FlushBuffer(PAddr flush_start, PAddr flush_end) {
     const u32 end_offset = flush_end - addr;
 
     if (type == SurfaceType::Fill) {
-        const u32 coarse_start_offset = start_offset - (start_offset % fill_size);
-        const u32 backup_bytes = start_offset % fill_size;
-        std::array<u8, 4> backup_data;
-        if (backup_bytes)
-            std::memcpy(&backup_data[0], &dst_buffer[coarse_start_offset], backup_bytes);
-
-        for (u32 offset = coarse_start_offset; offset < end_offset; offset += fill_size) {
-            std::memcpy(&dst_buffer[offset], &fill_data[0],
-                        std::min(fill_size, end_offset - offset));
+        // Rotate the pattern so that it starts at the flush start offset
+        std::array<u8, 4> pattern;
+        for (u32 i = 0; i < fill_size; i++) {
+            pattern[i] = fill_data[(start_offset + i) % fill_size];
         }
 
-        if (backup_bytes)
-            std::memcpy(&dst_buffer[coarse_start_offset], &backup_data[0], backup_bytes);
+        GPU::FillPattern(&dst_buffer[start_offset], end_offset - start_offset, pattern.data(),
+                         fill_size);
     } else if (!is_tiled) {
         ASSERT(type == SurfaceType::Color);
         if (pixel_format == PixelFormat::RGBA8) {
@@ -510,39 +509,26 @@ void CachedSurface::FlushBuffer(PAddr flush_start, PAddr flush_end) {
 
 bool CachedSurface::LoadCustomTexture(u64 tex_hash) {
     auto& custom_tex_cache = Core::System::GetInstance().CustomTexCache();
-    const auto& image_interface = Core::System::GetInstance().GetImageInterface();
-
-    if (custom_tex_cache.IsTextureCached(tex_hash)) {
-        custom_tex_info = custom_tex_cache.LookupTexture(tex_hash);
-        return true;
-    }
-
+    custom_tex = nullptr;
     if (!custom_tex_cache.CustomTextureExists(tex_hash)) {
         return false;
     }
 
-    const auto& path_info = custom_tex_cache.LookupTexturePathInfo(tex_hash);
-    if (!image_interface->DecodePNG(custom_tex_info.tex, custom_tex_info.width,
-                                    custom_tex_info.height, path_info.path)) {
-        LOG_ERROR(Render_OpenGL, "Failed to load custom texture {}", path_info.path);
-        return false;
-    }
-
-    const std::bitset<32> width_bits(custom_tex_info.width);
-    const std::bitset<32> height_bits(custom_tex_info.height);
-    if (width_bits.count() != 1 || height_bits.count() != 1) {
-        LOG_ERROR(Render_OpenGL, "Texture {} size is not a power of 2", path_info.path);
-        return false;
+    if (Settings::values.async_custom_loading) {
+        custom_tex = custom_tex_cache.LookupTexture(tex_hash);
+        if (!custom_tex) {
+            // Keep the guest texture until the worker threads are done with the custom one
+            custom_tex_cache.RequestTexture(tex_hash);
+            owner.QueueCustomTexture(shared_from_this(), tex_hash);
+        }
+    } else {
+        custom_tex = custom_tex_cache.LoadTexture(tex_hash);
     }
 
-    LOG_DEBUG(Render_OpenGL, "Loaded custom texture from {}", path_info.path);
-    Common::FlipRGBA8Texture(custom_tex_info.tex, custom_tex_info.width, custom_tex_info.height);
-    custom_tex_cache.CacheTexture(tex_hash, custom_tex_info.tex, custom_tex_info.width,
-                                  custom_tex_info.height);
-    return true;
+    return custom_tex != nullptr;
 }
 
-/*void CachedSurface::DumpTexture(GLuint target_tex, u64 tex_hash) {
+void CachedSurface::DumpTexture(u64 tex_hash) {
     // Make sure the texture size is a power of 2
     // If not, the surface is actually a framebuffer
     std::bitset<32> width_bits(width);
@@ -553,53 +539,24 @@ bool CachedSurface::LoadCustomTexture(u64 tex_hash) {
         return;
     }
 
-    // Dump texture to RGBA8 and encode as PNG
-    const auto& image_interface = Core::System::GetInstance().GetImageInterface();
-    auto& custom_tex_cache = Core::System::GetInstance().CustomTexCache();
-    std::string dump_path =
-        fmt::format("{}textures/{:016X}/", FileUtil::GetUserPath(FileUtil::UserPath::DumpDir),
-                    Core::System::GetInstance().Kernel().GetCurrentProcess()->codeset->program_id);
-    if (!FileUtil::CreateFullPath(dump_path)) {
-        LOG_ERROR(Render, "Unable to create {}", dump_path);
+    if (type != SurfaceType::Color && type != SurfaceType::Texture) {
         return;
     }
 
-    dump_path += fmt::format("tex1_{}x{}_{:016X}_{}.png", width, height, tex_hash, pixel_format);
-    if (!custom_tex_cache.IsTextureDumped(tex_hash) && !FileUtil::Exists(dump_path)) {
-        custom_tex_cache.SetTextureDumped(tex_hash);
-
-        LOG_INFO(Render_OpenGL, "Dumping texture to {}", dump_path);
-        std::vector<u8> decoded_texture;
-        decoded_texture.resize(width * height * 4);
-        OpenGLState state = OpenGLState::GetCurState();
-        GLuint old_texture = state.texture_units[0].texture_2d;
-        state.Apply();
-
-        // GetTexImageOES is used even if not using OpenGL ES to work around a small issue that
-        // happens if using custom textures with texture dumping at the same.
-        // Let's say there's 2 textures that are both 32x32 and one of them gets replaced with a
-        // higher quality 256x256 texture. If the 256x256 texture is displayed first and the
-        // 32x32 texture gets uploaded to the same underlying OpenGL texture, the 32x32 texture
-        // will appear in the corner of the 256x256 texture. If texture dumping is enabled and
-        // the 32x32 is undumped, Citra will attempt to dump it. Since the underlying OpenGL
-        // texture is still 256x256, Citra crashes because it thinks the texture is only 32x32.
-        // GetTexImageOES conveniently only dumps the specified region, and works on both
-        // desktop and ES.
-        // if the backend isn't OpenGL ES, this won't be initialized yet
-        if (!owner.texture_downloader_es)
-            owner.texture_downloader_es = std::make_unique<TextureDownloaderES>(false);
-        owner.texture_downloader_es->GetTexImage(GL_TEXTURE_2D, 0, GL_RGBA, GL_UNSIGNED_BYTE,
-                                                 height, width, &decoded_texture[0]);
-        state.texture_units[0].texture_2d = old_texture;
-        state.Apply();
-        Common::FlipRGBA8Texture(decoded_texture, width, height);
-        if (!image_interface->EncodePNG(dump_path, decoded_texture, width, height))
-            LOG_ERROR(Render_OpenGL, "Failed to save decoded texture");
-    }
-}*/
+    // The writer is created on first use as the title isn't known when the cache is created
+    if (!owner.texture_dumper) {
+        auto& system = Core::System::GetInstance();
+        const u64 program_id = system.Kernel().GetCurrentProcess()->codeset->program_id;
+        owner.texture_dumper =
+            std::make_unique<TextureDumper>(program_id, system.GetImageInterface());
+    }
+
+    owner.texture_dumper->DumpTexture(tex_hash, pixel_format, width, height, gl_buffer);
+}
 
 MICROPROFILE_DEFINE(TextureUL, "RasterizerCache", "Texture Upload", MP_RGB(128, 192, 64));
-void CachedSurface::UploadTexture(Common::Rectangle<u32> rect) {
+void CachedSurface::UploadTexture(Common::Rectangle<u32> rect,
+                                  std::shared_ptr<const Core::CustomTexInfo> loaded_custom_tex) {
     if (type == SurfaceType::Fill) {
         return;
     }
@@ -613,7 +570,11 @@ void CachedSurface::UploadTexture(Common::Rectangle<u32> rect) {
         tex_hash = Common::ComputeHash64(gl_buffer.data(), gl_buffer.size());
     }
 
-    if (Settings::values.custom_textures) {
+    custom_tex_hash = tex_hash;
+    if (loaded_custom_tex) {
+        custom_tex = std::move(loaded_custom_tex);
+        is_custom = true;
+    } else if (Settings::values.custom_textures) {
         is_custom = LoadCustomTexture(tex_hash);
     }
 
@@ -636,8 +597,8 @@ void CachedSurface::UploadTexture(Common::Rectangle<u32> rect) {
         y0 = 0;
 
         if (is_custom) {
-            texture_info.width = custom_tex_info.width;
-            texture_info.height = custom_tex_info.height;
+            texture_info.width = custom_tex->width;
+            texture_info.height = custom_tex->height;
         } else {
             texture_info.width = rect.GetWidth();
             texture_info.height = rect.GetHeight();
@@ -652,15 +613,15 @@ void CachedSurface::UploadTexture(Common::Rectangle<u32> rect) {
     ASSERT(stride * GetBytesPerPixel(pixel_format) % 4 == 0);
     if (is_custom) {
         if (res_scale == 1) {
-            texture_info.width = custom_tex_info.width;
-            texture_info.height = custom_tex_info.height;
+            texture_info.width = custom_tex->width;
+            texture_info.height = custom_tex->height;
             texture_info.UpdateMipLevels();
 
             texture = owner.AllocateSurfaceTexture(texture_info);
         }
 
-        Rect2D rect{x0, y0, custom_tex_info.width, custom_tex_info.height};
-        texture->Upload(rect, custom_tex_info.width, custom_tex_info.tex);
+        Rect2D rect{x0, y0, custom_tex->width, custom_tex->height};
+        texture->Upload(rect, custom_tex->width, custom_tex->tex);
     } else {
         const u32 update_size = rect.GetWidth() * rect.GetHeight() * GetBytesPerPixel(pixel_format);
         auto data = std::span<const u8>{gl_buffer.data() + buffer_offset, update_size};
@@ -668,8 +629,9 @@ void CachedSurface::UploadTexture(Common::Rectangle<u32> rect) {
         target_tex->Upload(rect, stride, data);
     }
 
-    /*if (Settings::values.dump_textures && !is_custom)
-        DumpTexture(target_tex, tex_hash);*/
+    if (Settings::values.dump_textures && !is_custom) {
+        DumpTexture(tex_hash);
+    }
 
     if (res_scale != 1) {
         auto scaled_rect = rect;
@@ -677,8 +639,9 @@ void CachedSurface::UploadTexture(Common::Rectangle<u32> rect) {
         scaled_rect.top *= res_scale;
         scaled_rect.right *= res_scale;
         scaled_rect.bottom *= res_scale;
-        auto from_rect = is_custom ? Common::Rectangle<u32>{0, custom_tex_info.height, custom_tex_info.width, 0}
-                                   : Common::Rectangle<u32>{0, rect.GetHeight(), rect.GetWidth(), 0};
+        auto from_rect = is_custom
+                             ? Common::Rectangle<u32>{0, custom_tex->height, custom_tex->width, 0}
+                             : Common::Rectangle<u32>{0, rect.GetHeight(), rect.GetWidth(), 0};
 
         /*if (!owner.texture_filterer->Filter(unscaled_tex.handle, from_rect, texture.handle,
                                             scaled_rect, type, read_fb_handle, draw_fb_handle)) {
@@ -1524,6 +1487,45 @@ void RasterizerCache::ClearAll(bool flush) {
     dirty_regions -= SurfaceInterval(0x0, 0xFFFFFFFF);
     surface_cache -= SurfaceInterval(0x0, 0xFFFFFFFF);
     remove_surfaces.clear();
+    pending_custom_surfaces.clear();
+}
+
+void RasterizerCache::QueueCustomTexture(const Surface& surface, u64 tex_hash) {
+    std::lock_guard lock{mutex};
+    pending_custom_surfaces.emplace_back(surface, tex_hash);
+}
+
+void RasterizerCache::UpdateCustomTextures() {
+    std::lock_guard lock{mutex};
+    if (pending_custom_surfaces.empty()) {
+        return;
+    }
+
+    // Uploading can queue surfaces again, so it's done after the pending list has been updated
+    std::vector<std::pair<Surface, std::shared_ptr<const Core::CustomTexInfo>>> ready_surfaces;
+    auto& custom_tex_cache = Core::System::GetInstance().CustomTexCache();
+    std::erase_if(pending_custom_surfaces, [&](const auto& pending) {
+        const auto& [weak_surface, tex_hash] = pending;
+        const Surface surface = weak_surface.lock();
+
+        // The surface was destroyed or its contents changed since the texture was requested
+        if (!surface || surface->is_custom || surface->custom_tex_hash != tex_hash) {
+            return true;
+        }
+
+        if (auto custom_tex = custom_tex_cache.LookupTexture(tex_hash)) {
+            ready_surfaces.emplace_back(surface, std::move(custom_tex));
+            return true;
+        }
+
+        // Decoding failed or the request was dropped
+        return !custom_tex_cache.IsTextureQueued(tex_hash);
+    });
+
+    // The texture is passed along as the cache may evict it before the upload looks it up again
+    for (auto& [surface, custom_tex] : ready_surfaces) {
+        surface->UploadTexture({0, surface->height, surface->width, 0}, std::move(custom_tex));
+    }
 }
 
 void RasterizerCache::FlushRegion(PAddr addr, u32 size, Surface flush_surface) {
@@ -131,10 +131,12 @@ struct CachedSurface : SurfaceParams, std::enable_shared_from_this<CachedSurface
 
     // Custom texture loading and dumping
     bool LoadCustomTexture(u64 tex_hash);
-    //void DumpTexture(GLuint target_tex, u64 tex_hash);
+    void DumpTexture(u64 tex_hash);
 
-    // Upload/Download data in gl_buffer in/to this surface's texture
-    void UploadTexture(Common::Rectangle<u32> rect);
+    // Upload/Download data in gl_buffer in/to this surface's texture. A custom texture that was
+    // already loaded for the contents of gl_buffer can be given to skip the lookup
+    void UploadTexture(Common::Rectangle<u32> rect,
+                       std::shared_ptr<const Core::CustomTexInfo> loaded_custom_tex = nullptr);
     void DownloadTexture(const Common::Rectangle<u32>& rect);
 
     void Fill(Common::Rectangle<u32> rect, const u8* data);
@@ -201,7 +203,8 @@ public:
     std::array<std::shared_ptr<SurfaceWatcher>, 7> level_watchers;
 
     bool is_custom = false;
-    Core::CustomTexInfo custom_tex_info;
+    u64 custom_tex_hash = 0;
+    std::shared_ptr<const Core::CustomTexInfo> custom_tex;
 
 private:
     RasterizerCache& owner;
@@ -215,6 +218,7 @@ struct CachedTextureCube {
 };
 
 class BackendBase;
+class TextureDumper;
 
 class RasterizerCache {
 public:
@@ -276,6 +280,13 @@ public:
     // Clear all cached resources tracked by this cache manager
     void ClearAll(bool flush);
 
+    // Waits for the custom texture of the surface to be decoded, the guest texture is used
+    // meanwhile
+    void QueueCustomTexture(const Surface& surface, u64 tex_hash);
+
+    // Replaces the guest textures of surfaces whose custom textures finished decoding
+    void UpdateCustomTextures();
+
 private:
     void DuplicateSurface(const Surface& src_surface, const Surface& dest_surface);
 
@@ -328,8 +339,12 @@ private:
     // for accelerating texture clear operations
     std::unordered_map<FramebufferInfo, FramebufferHandle> framebuffer_cache;
 
+    // Surfaces waiting for their custom texture to be decoded
+    std::vector<std::pair<std::weak_ptr<CachedSurface>, u64>> pending_custom_surfaces;
+
 public:
     std::unique_ptr<BackendBase>& backend;
+    std::unique_ptr<TextureDumper> texture_dumper;
     //std::unique_ptr<TextureFilterer> texture_filterer;
     //std::unique_ptr<FormatReinterpreterOpenGL> format_reinterpreter;
     //std::unique_ptr<TextureDownloaderES> texture_downloader_es;
@@ -2,9 +2,13 @@
 // Licensed under GPLv2 or any later version
 // Refer to the license.txt file included.
 
+#include <algorithm>
 #include <glm/gtc/matrix_transform.hpp>
 #include "common/assert.h"
 #include "common/logging/log.h"
+#include "common/microprofile.h"
+#include "common/thread.h"
+#include "core/core.h"
 #include "core/frontend/emu_window.h"
 #include "core/frontend/framebuffer_layout.h"
 #include "core/hw/gpu.h"
@@ -151,6 +155,14 @@ static constexpr PipelineLayoutInfo RENDERER_PIPELINE_LAYOUT = {
     .push_constant_block_size = sizeof(PresentUniformData)
 };
 
+// Interval between two VBlanks of the emulated LCD
+constexpr std::chrono::microseconds FRAME_INTERVAL{
+    static_cast<s64>(1000000 / GPU::SCREEN_REFRESH_RATE)};
+
+// Number of intervals without a new frame after which the last one stops being repeated,
+// so a paused emulation doesn't keep presenting
+constexpr u32 MAX_REPEATED_FRAMES = 4;
+
 DisplayRenderer::DisplayRenderer(Frontend::EmuWindow& window) : render_window(window) {
     //window.mailbox = nullptr;
     backend = std::make_unique<Vulkan::Backend>(window);
@@ -171,7 +183,8 @@ DisplayRenderer::DisplayRenderer(Frontend::EmuWindow& window) : render_window(wi
     PipelineInfo present_pipeline_info = {
         .vertex_layout = ScreenRectVertex::GetVertexLayout(),
         .layout = RENDERER_PIPELINE_LAYOUT,
-        .color_attachment = TextureFormat::PresentColor,
+        .color_attachment = Settings::values.use_present_thread ? TextureFormat::RGBA8 :
+                                                                  TextureFormat::PresentColor,
         .depth_attachment = TextureFormat::Undefined
     };
 
@@ -210,9 +223,19 @@ DisplayRenderer::DisplayRenderer(Frontend::EmuWindow& window) : render_window(wi
 
     // Bind sampler. TODO: Sampler hot-reload?
     present_pipelines[0]->BindSampler(1, 0, screen_sampler);
+
+    if (Settings::values.use_present_thread) {
+        present_thread_running = true;
+        present_thread = std::thread(&DisplayRenderer::PresentLoop, this);
+    }
 }
 
 DisplayRenderer::~DisplayRenderer() {
+    if (present_thread.joinable()) {
+        present_thread_running = false;
+        present_thread.join();
+    }
+
     // Must flush the backend before destroying any pipelines!
     backend->Flush();
 }
@@ -361,17 +384,17 @@ void DisplayRenderer::ReloadPresentPipeline() {
     uniform_data.reverse_interlaced = (render_3d == Settings::StereoRenderOption::ReverseInterlaced);
 }
 
-void DisplayRenderer::DrawSingleScreen(u32 screen, bool rotate, float x, float y, float w, float h) {
+void DisplayRenderer::DrawSingleScreen(FramebufferHandle target, u32 screen, bool rotate,
+                                       float x, float y, float w, float h) {
     const ScreenInfo& screen_info = screen_infos[screen];
     const auto& texcoords = screen_info.display_texcoords;
 
-    // Set the swapchain framebuffer to clear mode
-    FramebufferHandle display = backend->GetWindowFramebuffer();
-    display->SetLoadOp(LoadOp::Clear);
-    display->SetClearValues(clear_color, 0.f, 0);
+    // Set the target framebuffer to clear mode
+    target->SetLoadOp(LoadOp::Clear);
+    target->SetClearValues(clear_color, 0.f, 0);
 
     // Update viewport and scissor
-    const auto& color_surface = display->GetColorAttachment();
+    const auto& color_surface = target->GetColorAttachment();
     current_pipeline->SetViewport(0.f, 0.f, color_surface->GetWidth(), color_surface->GetHeight());
     current_pipeline->SetScissor(0, 0, color_surface->GetWidth(), color_surface->GetHeight());
 
@@ -422,10 +445,10 @@ void DisplayRenderer::DrawSingleScreen(u32 screen, bool rotate, float x, float y
     // Bind the vertex buffer and draw
     const std::array offsets = {mapped_offset};
     backend->BindVertexBuffer(vertex_buffer, offsets);
-    backend->Draw(current_pipeline, display, 0, vertices.size());
+    backend->Draw(current_pipeline, target, 0, vertices.size());
 }
 
-void DisplayRenderer::DrawScreens(bool flipped) {
+void DisplayRenderer::DrawScreens(FramebufferHandle target, bool flipped) {
     const auto& layout = render_window.GetFramebufferLayout();
     if (VideoCore::g_renderer_bg_color_update_requested.exchange(false)) {
         // Update background color before drawing
@@ -452,19 +475,19 @@ void DisplayRenderer::DrawScreens(bool flipped) {
     uniform_data.layer = 0;
     if (layout.top_screen_enabled) {
         if (Settings::values.render_3d == Settings::StereoRenderOption::Off) {
-            DrawSingleScreen(0, layout.is_rotated, top_screen.left, top_screen.top,
+            DrawSingleScreen(target, 0, layout.is_rotated, top_screen.left, top_screen.top,
                              top_screen.GetWidth(), top_screen.GetHeight());
         } else if (Settings::values.render_3d == Settings::StereoRenderOption::SideBySide) {
-            DrawSingleScreen(0, layout.is_rotated, top_screen.left / 2.f, top_screen.top,
+            DrawSingleScreen(target, 0, layout.is_rotated, top_screen.left / 2.f, top_screen.top,
                              top_screen.GetWidth() / 2.f, top_screen.GetHeight());
             uniform_data.layer = 1;
-            DrawSingleScreen(1, layout.is_rotated, (top_screen.left / 2.f) + (layout.width / 2.f), top_screen.top,
+            DrawSingleScreen(target, 1, layout.is_rotated, (top_screen.left / 2.f) + (layout.width / 2.f), top_screen.top,
                              top_screen.GetWidth() / 2.f, top_screen.GetHeight());
         } else if (Settings::values.render_3d == Settings::StereoRenderOption::CardboardVR) {
-            DrawSingleScreen(0, layout.is_rotated, layout.top_screen.left, layout.top_screen.top,
+            DrawSingleScreen(target, 0, layout.is_rotated, layout.top_screen.left, layout.top_screen.top,
                              layout.top_screen.GetWidth(), layout.top_screen.GetHeight());
             uniform_data.layer = 1;
-            DrawSingleScreen(1, layout.is_rotated, layout.cardboard.top_screen_right_eye + (layout.width / 2.f),
+            DrawSingleScreen(target, 1, layout.is_rotated, layout.cardboard.top_screen_right_eye + (layout.width / 2.f),
                              layout.top_screen.top, layout.top_screen.GetWidth(), layout.top_screen.GetHeight());
         }
     }
@@ -525,14 +548,106 @@ void DisplayRenderer::DrawScreens(bool flipped) {
     }*/
 }
 
-void DisplayRenderer::SwapBuffers() {
+void DisplayRenderer::SwapBuffers(std::chrono::microseconds vblank_time) {
     // Configure current framebuffer and recreate swapchain if necessary
     PrepareRendertarget();
 
-    // Present the 3DS screens
-    if (backend->BeginPresent()) {
-        DrawScreens(false);
+    if (present_thread.joinable()) {
+        // Render the 3DS screens off-screen and hand them to the present thread
+        PresentFrame& frame = present_frames[mailbox.GetRenderSlot()];
+        ConfigurePresentFrame(frame);
+        DrawScreens(frame.framebuffer, false);
+        backend->SubmitFrame();
+
+        frame.vblank_time = vblank_time;
+        frame.submit_time = FramePacer::Clock::now();
+        if (mailbox.PushFrame()) {
+            if (auto& perf_stats = Core::System::GetInstance().perf_stats; perf_stats) {
+                perf_stats->AddDroppedFrame();
+            }
+        }
+    } else if (backend->BeginPresent()) {
+        // Present the 3DS screens
+        DrawScreens(backend->GetWindowFramebuffer(), false);
         backend->EndPresent();
+    } else {
+        // Nothing can be presented, for example when running headless, but the rendering
+        // work of the frame still has to be submitted
+        backend->SubmitFrame();
+    }
+
+    m_current_frame++;
+    rasterizer->TickFrame();
+}
+
+void DisplayRenderer::ConfigurePresentFrame(PresentFrame& frame) {
+    const auto& layout = render_window.GetFramebufferLayout();
+    const u32 width = std::max(layout.width, 1u);
+    const u32 height = std::max(layout.height, 1u);
+    if (frame.texture.IsValid() && frame.texture->GetWidth() == width &&
+        frame.texture->GetHeight() == height) {
+        return;
+    }
+
+    const TextureInfo texture_info = {
+        .width = static_cast<u16>(width),
+        .height = static_cast<u16>(height),
+        .levels = 1,
+        .type = TextureType::Texture2D,
+        .view_type = TextureViewType::View2D,
+        .format = TextureFormat::RGBA8
+    };
+
+    frame.texture = backend->CreateTexture(texture_info);
+
+    const FramebufferInfo framebuffer_info = {
+        .color = frame.texture
+    };
+
+    frame.framebuffer = backend->CreateFramebuffer(framebuffer_info);
+    frame.framebuffer->SetDrawRect({0, height, width, 0});
+}
+
+void DisplayRenderer::PresentLoop() {
+    Common::SetCurrentThreadName("PresentThread");
+    MicroProfileOnThreadCreate("PresentThread");
+
+    while (present_thread_running) {
+        PresentNextFrame();
+    }
+
+    MicroProfileOnThreadExit();
+}
+
+void DisplayRenderer::PresentNextFrame() {
+    using Clock = FramePacer::Clock;
+    auto& perf_stats = Core::System::GetInstance().perf_stats;
+
+    // Wait a bit longer than a VBlank for a new frame before showing the last one again
+    if (const auto slot = mailbox.WaitFrame(FRAME_INTERVAL + FRAME_INTERVAL / 4); slot) {
+        const PresentFrame& frame = present_frames[*slot];
+        std::this_thread::sleep_until(pacer.GetPresentTime(frame.vblank_time, Clock::now()));
+        backend->PresentTexture(frame.texture);
+        missed_frames = 0;
+
+        if (perf_stats) {
+            const auto latency = Clock::now() - frame.submit_time;
+            perf_stats->AddPresentedFrame(
+                std::chrono::duration_cast<Core::PerfStats::Clock::duration>(latency));
+        }
+        return;
+    }
+
+    const auto slot = mailbox.GetPresentSlot();
+    if (!slot || ++missed_frames > MAX_REPEATED_FRAMES) {
+        // Emulation is paused or loading. Start pacing from scratch when it resumes
+        pacer.Reset();
+        return;
+    }
+
+    backend->PresentTexture(present_frames[*slot].texture);
+    if (perf_stats) {
+        perf_stats->AddDuplicatedFrame();
     }
 }
 
@@ -4,11 +4,16 @@
 
 #pragma once
 
+#include <atomic>
+#include <chrono>
 #include <memory>
+#include <thread>
 #include <glm/glm.hpp>
 #include "common/math_util.h"
 #include "core/hw/gpu.h"
+#include "video_core/common/framebuffer.h"
 #include "video_core/common/pipeline.h"
+#include "video_core/common/present_mailbox.h"
 
 namespace Frontend {
 class EmuWindow;
@@ -64,13 +69,21 @@ struct ScreenRectVertex {
 
 constexpr u32 PRESENT_PIPELINES = 3;
 
+// A frame rendered off-screen and handed to the present thread
+struct PresentFrame {
+    TextureHandle texture;
+    FramebufferHandle framebuffer;
+    std::chrono::microseconds vblank_time{0};
+    FramePacer::Clock::time_point submit_time{};
+};
+
 class DisplayRenderer {
 public:
     DisplayRenderer(Frontend::EmuWindow& window);
     ~DisplayRenderer();
 
-    void SwapBuffers();
-    void TryPresent(int timeout_ms) {}
+    // Draws the emulated screens of the VBlank that occurred at the provided emulated time
+    void SwapBuffers(std::chrono::microseconds vblank_time);
 
     float GetCurrentFPS() const {
         return m_current_fps;
@@ -107,12 +120,22 @@ private:
     // Updates the sampler used for special effects
     void ReloadSampler() {}
 
-    // Draws the emulated screens to the emulator window.
-    void DrawScreens(bool flipped);
+    // Draws the emulated screens to the provided framebuffer.
+    void DrawScreens(FramebufferHandle target, bool flipped);
 
-    // Draws a single texture to the emulator window, optionally rotating
+    // Draws a single texture to the provided framebuffer, optionally rotating
     // the texture to correct for the 3DS's LCD rotation.
-    void DrawSingleScreen(u32 screen, bool rotated, float x, float y, float w, float h);
+    void DrawSingleScreen(FramebufferHandle target, u32 screen, bool rotated,
+                          float x, float y, float w, float h);
+
+    // (Re)creates the off-screen target of the frame to match the window size
+    void ConfigurePresentFrame(PresentFrame& frame);
+
+    // Presents frames handed over by SwapBuffers until the renderer is destroyed
+    void PresentLoop();
+
+    // Waits for the next frame and presents it at the time its VBlank maps to
+    void PresentNextFrame();
 
     // Loads framebuffer from emulated memory into the display information structure
     void LoadFBToScreenInfo(const GPU::Regs::FramebufferConfig& framebuffer,
@@ -139,6 +162,14 @@ private:
     std::array<ScreenInfo, 3> screen_infos;
     PresentUniformData uniform_data;
     BufferHandle vertex_buffer;
+
+    // Off-screen frames and the thread presenting them when use_present_thread is enabled
+    std::array<PresentFrame, PRESENT_FRAME_COUNT> present_frames;
+    PresentMailbox mailbox;
+    FramePacer pacer;
+    u32 missed_frames = 0;
+    std::atomic<bool> present_thread_running{false};
+    std::thread present_thread;
 };
 
 } // namespace VideoCore
@@ -41,6 +41,20 @@ public:
     // Compiles the shader source code
     virtual bool Compile(ShaderOptimization level) = 0;
 
+    // Returns the backend binary produced by the last successful Compile, if the backend has one.
+    // The binary is only kept until ReleaseBinary is called
+    virtual std::span<const u32> GetBinary() const {
+        return {};
+    }
+
+    // Frees the binary returned by GetBinary once it's no longer needed
+    virtual void ReleaseBinary() {}
+
+    // Creates the shader from a binary previously returned by GetBinary, skipping compilation
+    virtual bool LoadBinary(std::span<const u32> binary) {
+        return false;
+    }
+
     // Returns the name given the shader module
     std::string_view GetName() const {
         return name;
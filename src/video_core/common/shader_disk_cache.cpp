@@ -3,9 +3,11 @@
 // Refer to the license.txt file included.
 
 #include <cstring>
+#include <string_view>
 #include <fmt/format.h>
 #include "common/common_paths.h"
 #include "common/file_util.h"
+#include "common/hash.h"
 #include "common/logging/log.h"
 #include "common/scm_rev.h"
 #include "common/zstd_compression.h"
@@ -13,6 +15,7 @@
 #include "core/settings.h"
 #include "video_core/common/backend.h"
 #include "video_core/common/shader_disk_cache.h"
+#include "video_core/common/shader_gen.h"
 
 namespace VideoCore {
 
@@ -27,7 +30,69 @@ enum class PrecompiledEntryKind : u32 {
     Dump = 1,
 };
 
-constexpr u32 NativeVersion = 1;
+// Version 1 stored the full Pica register file with every entry
+constexpr u32 LegacyRegsVersion = 1;
+constexpr u32 NativeVersion = 2;
+
+struct RegisterRange {
+    u32 start;
+    u32 count;
+};
+
+#define SHADER_REG_RANGE(field_name, count) RegisterRange{PICA_REG_INDEX(field_name), count}
+#define SHADER_REG_AT(field_name, offset) RegisterRange{PICA_REG_INDEX(field_name) + offset, 1}
+
+// Registers read by PicaFSConfig and PicaVSConfig. TEV stage const colors are uniforms
+// so they are skipped, same with the lighting colors, LUT data ports and per light vectors.
+constexpr std::array SHADER_KEY_REGISTERS = {
+    SHADER_REG_RANGE(rasterizer.scissor_test, 1),
+    SHADER_REG_RANGE(rasterizer.depthmap_enable, 1),
+    SHADER_REG_RANGE(texturing.main_config, 1),
+    SHADER_REG_AT(texturing.texture0, 2), // TextureConfig::type
+    SHADER_REG_RANGE(texturing.shadow, 1),
+    SHADER_REG_RANGE(texturing.proctex, 1),
+    SHADER_REG_RANGE(texturing.proctex_lut, 2), // proctex_lut and proctex_lut_offset
+    SHADER_REG_RANGE(texturing.tev_stage0, 3),
+    SHADER_REG_AT(texturing.tev_stage0, 4),
+    SHADER_REG_RANGE(texturing.tev_stage1, 3),
+    SHADER_REG_AT(texturing.tev_stage1, 4),
+    SHADER_REG_RANGE(texturing.tev_stage2, 3),
+    SHADER_REG_AT(texturing.tev_stage2, 4),
+    SHADER_REG_RANGE(texturing.tev_stage3, 3),
+    SHADER_REG_AT(texturing.tev_stage3, 4),
+    SHADER_REG_RANGE(texturing.tev_combiner_buffer_input, 1), // Includes fog mode and flip
+    SHADER_REG_RANGE(texturing.tev_stage4, 3),
+    SHADER_REG_AT(texturing.tev_stage4, 4),
+    SHADER_REG_RANGE(texturing.tev_stage5, 3),
+    SHADER_REG_AT(texturing.tev_stage5, 4),
+    SHADER_REG_RANGE(framebuffer.output_merger, 1), // fragment_operation_mode
+    SHADER_REG_RANGE(framebuffer.output_merger.alpha_test, 1),
+    SHADER_REG_RANGE(lighting.light[0].config, 1),
+    SHADER_REG_RANGE(lighting.light[1].config, 1),
+    SHADER_REG_RANGE(lighting.light[2].config, 1),
+    SHADER_REG_RANGE(lighting.light[3].config, 1),
+    SHADER_REG_RANGE(lighting.light[4].config, 1),
+    SHADER_REG_RANGE(lighting.light[5].config, 1),
+    SHADER_REG_RANGE(lighting.light[6].config, 1),
+    SHADER_REG_RANGE(lighting.light[7].config, 1),
+    SHADER_REG_RANGE(lighting.max_light_index, 3), // max_light_index, config0 and config1
+    SHADER_REG_RANGE(lighting.disable, 1),
+    SHADER_REG_RANGE(lighting.abs_lut_input, 3), // abs_lut_input, lut_input and lut_scale
+    SHADER_REG_RANGE(lighting.light_enable, 1),
+    SHADER_REG_RANGE(vs.main_offset, 1),
+    SHADER_REG_RANGE(vs.output_mask, 1),
+};
+
+#undef SHADER_REG_AT
+#undef SHADER_REG_RANGE
+
+constexpr std::size_t SHADER_KEY_SIZE = [] {
+    std::size_t size = 0;
+    for (const RegisterRange& range : SHADER_KEY_REGISTERS) {
+        size += range.count;
+    }
+    return size;
+}();
 
 ShaderCacheVersionHash GetShaderCacheVersionHash() {
     ShaderCacheVersionHash hash{};
@@ -36,21 +101,103 @@ ShaderCacheVersionHash GetShaderCacheVersionHash() {
     return hash;
 }
 
+ShaderDiskCacheKey::ShaderDiskCacheKey(const Pica::Regs& regs) {
+    values.reserve(SHADER_KEY_SIZE);
+    for (const RegisterRange& range : SHADER_KEY_REGISTERS) {
+        const auto begin = regs.reg_array.begin() + range.start;
+        values.insert(values.end(), begin, begin + range.count);
+    }
+}
+
+std::size_t ShaderDiskCacheKey::Size() {
+    return SHADER_KEY_SIZE;
+}
+
+Pica::Regs ShaderDiskCacheKey::ToRegs() const {
+    Pica::Regs regs{};
+    if (values.size() != SHADER_KEY_SIZE) {
+        return regs;
+    }
+
+    auto value_iter = values.begin();
+    for (const RegisterRange& range : SHADER_KEY_REGISTERS) {
+        std::copy_n(value_iter, range.count, regs.reg_array.begin() + range.start);
+        value_iter += range.count;
+    }
+
+    return regs;
+}
+
+u64 ShaderDiskCacheKey::Hash() const {
+    return Common::ComputeHash64(values.data(), values.size() * sizeof(u32));
+}
+
+u64 ComputeShaderUniqueIdentifier(const ShaderDiskCacheKey& key, std::span<const u32> code) {
+    u64 hash = key.Hash();
+
+    if (code.size() > 0) {
+        u64 code_uid = Common::ComputeHash64(code.data(), code.size() * sizeof(u32));
+        hash = Common::HashCombine(hash, code_uid);
+    }
+
+    return hash;
+}
+
 bool ShaderDiskCacheRaw::Load(FileUtil::IOFile& file) {
     if (file.ReadBytes(&unique_identifier, sizeof(u64)) != sizeof(u64) ||
         file.ReadBytes(&program_type, sizeof(u32)) != sizeof(u32)) {
         return false;
     }
 
+    u32 key_version{};
+    u32 key_len{};
+    if (file.ReadBytes(&key_version, sizeof(u32)) != sizeof(u32) ||
+        file.ReadBytes(&key_len, sizeof(u32)) != sizeof(u32)) {
+        return false;
+    }
+
+    // A key with a different layout cannot be interpreted
+    if (key_version != ShaderDiskCacheKey::Version || key_len != ShaderDiskCacheKey::Size()) {
+        return false;
+    }
+
+    std::vector<u32> values(key_len);
+    if (file.ReadArray(values.data(), key_len) != key_len) {
+        return false;
+    }
+
+    key = ShaderDiskCacheKey{std::move(values)};
+    return LoadProgramCode(file);
+}
+
+bool ShaderDiskCacheRaw::LoadLegacy(FileUtil::IOFile& file) {
+    if (file.ReadBytes(&unique_identifier, sizeof(u64)) != sizeof(u64) ||
+        file.ReadBytes(&program_type, sizeof(u32)) != sizeof(u32)) {
+        return false;
+    }
+
     u64 reg_array_len{};
-    if (file.ReadBytes(&reg_array_len, sizeof(u64)) != sizeof(u64)) {
+    if (file.ReadBytes(&reg_array_len, sizeof(u64)) != sizeof(u64) ||
+        reg_array_len > Pica::Regs::NUM_REGS) {
         return false;
     }
 
+    Pica::Regs config{};
     if (file.ReadArray(config.reg_array.data(), reg_array_len) != reg_array_len) {
         return false;
     }
 
+    if (!LoadProgramCode(file)) {
+        return false;
+    }
+
+    // The identifier depends on the key so it has to be recomputed
+    key = ShaderDiskCacheKey{config};
+    unique_identifier = ComputeShaderUniqueIdentifier(key, program_code);
+    return true;
+}
+
+bool ShaderDiskCacheRaw::LoadProgramCode(FileUtil::IOFile& file) {
     // Read in type specific configuration
     if (program_type == ProgramType::VertexShader) {
         u64 code_len{};
@@ -73,12 +220,13 @@ bool ShaderDiskCacheRaw::Save(FileUtil::IOFile& file) const {
         return false;
     }
 
-    // Just for future proofing, save the sizes of the array to the file
-    const std::size_t reg_array_len = Pica::Regs::NUM_REGS;
-    if (file.WriteObject(static_cast<u64>(reg_array_len)) != 1) {
+    // Save the key layout version and size so incompatible keys can be detected
+    const std::span<const u32> key_values = key.GetValues();
+    if (file.WriteObject(ShaderDiskCacheKey::Version) != 1 ||
+        file.WriteObject(static_cast<u32>(key_values.size())) != 1) {
         return false;
     }
-    if (file.WriteArray(config.reg_array.data(), reg_array_len) != reg_array_len) {
+    if (file.WriteArray(key_values.data(), key_values.size()) != key_values.size()) {
         return false;
     }
 
@@ -120,7 +268,8 @@ std::optional<std::vector<ShaderDiskCacheRaw>> ShaderDiskCache::LoadTransferable
         return std::nullopt;
     }
 
-    if (version < NativeVersion) {
+    const bool is_legacy = version == LegacyRegsVersion;
+    if (version < NativeVersion && !is_legacy) {
         LOG_INFO(Render_Vulkan, "Transferable shader cache is old - removing");
         file.Close();
         InvalidateAll();
@@ -145,7 +294,7 @@ std::optional<std::vector<ShaderDiskCacheRaw>> ShaderDiskCache::LoadTransferable
         switch (kind) {
         case TransferableEntryKind::Raw: {
             ShaderDiskCacheRaw entry;
-            if (!entry.Load(file)) {
+            if (!(is_legacy ? entry.LoadLegacy(file) : entry.Load(file))) {
                 LOG_ERROR(Render_Vulkan, "Failed to load transferable raw entry - skipping");
                 return std::nullopt;
             }
@@ -160,10 +309,42 @@ std::optional<std::vector<ShaderDiskCacheRaw>> ShaderDiskCache::LoadTransferable
         }
     }
 
+    if (is_legacy) {
+        file.Close();
+        MigrateTransferable(raws);
+    }
+
     LOG_INFO(Render_OpenGL, "Found a transferable disk cache with {} entries", raws.size());
     return {std::move(raws)};
 }
 
+void ShaderDiskCache::MigrateTransferable(const std::vector<ShaderDiskCacheRaw>& raws) {
+    LOG_INFO(Render_OpenGL, "Migrating transferable shader cache with {} entries to version {}",
+             raws.size(), NativeVersion);
+
+    // The unique identifiers have changed so the precompiled entries can no longer be matched
+    InvalidatePrecompiled();
+    if (!FileUtil::Delete(GetTransferablePath())) {
+        LOG_ERROR(Render_OpenGL, "Failed to remove old transferable file={}",
+                  GetTransferablePath());
+        return;
+    }
+
+    FileUtil::IOFile file = AppendTransferableFile();
+    if (!file.IsOpen()) {
+        return;
+    }
+
+    for (const ShaderDiskCacheRaw& entry : raws) {
+        if (file.WriteObject(TransferableEntryKind::Raw) != 1 || !entry.Save(file)) {
+            LOG_ERROR(Render_OpenGL, "Failed to migrate transferable cache entry - removing");
+            file.Close();
+            InvalidateAll();
+            return;
+        }
+    }
+}
+
 std::optional<ShaderDecompiledMap> ShaderDiskCache::LoadPrecompiled() {
     if (!IsUsable()) {
         return std::nullopt;
@@ -234,6 +415,75 @@ std::optional<ShaderDecompiledMap> ShaderDiskCache::LoadPrecompiled() {
     return decompiled;
 }
 
+std::optional<ShaderBinaryMap> ShaderDiskCache::LoadBinaries() {
+    if (!IsUsable()) {
+        return std::nullopt;
+    }
+
+    FileUtil::IOFile file(GetBinaryPath(), "rb");
+    if (!file.IsOpen()) {
+        LOG_INFO(Render_Vulkan, "No shader binary cache found for game with title id={}",
+                 GetTitleID());
+        return std::nullopt;
+    }
+
+    const auto Invalidate = [&file, this](std::string_view reason) -> std::nullopt_t {
+        LOG_INFO(Render_Vulkan, "Shader binary cache {} - removing", reason);
+        file.Close();
+        if (!FileUtil::Delete(GetBinaryPath())) {
+            LOG_ERROR(Render_Vulkan, "Failed to invalidate binary file={}", GetBinaryPath());
+        }
+
+        return std::nullopt;
+    };
+
+    ShaderCacheVersionHash file_hash{};
+    u32 generator_version{};
+    if (file.ReadArray(file_hash.data(), file_hash.size()) != file_hash.size() ||
+        file.ReadArray(&generator_version, 1) != 1) {
+        return Invalidate("is corrupted");
+    }
+
+    // The binaries are only valid for the exact generated source they were compiled from
+    if (file_hash != GetShaderCacheVersionHash() ||
+        generator_version != ShaderGeneratorBase::Version) {
+        return Invalidate("is from another version of the emulator");
+    }
+
+    ShaderBinaryMap binary_map{};
+    while (file.Tell() < file.GetSize()) {
+        u64 unique_identifier{};
+        bool sanitize_mul{};
+        u32 code_size{};
+        u64 code_hash{};
+        if (file.ReadArray(&unique_identifier, 1) != 1 || file.ReadArray(&sanitize_mul, 1) != 1 ||
+            file.ReadArray(&code_size, 1) != 1 || file.ReadArray(&code_hash, 1) != 1) {
+            return Invalidate("is corrupted");
+        }
+
+        // Don't trust the size before knowing that the file holds that much data
+        if (static_cast<u64>(code_size) * sizeof(u32) > file.GetSize() - file.Tell()) {
+            return Invalidate("is corrupted");
+        }
+
+        std::vector<u32> code(code_size);
+        if (file.ReadArray(code.data(), code.size()) != code.size() ||
+            Common::ComputeHash64(code.data(), code.size() * sizeof(u32)) != code_hash) {
+            return Invalidate("is corrupted");
+        }
+
+        // Later entries were compiled with a newer sanitize_mul setting, let them win
+        binaries.insert_or_assign(unique_identifier, sanitize_mul);
+        binary_map.insert_or_assign(unique_identifier, ShaderDiskCacheBinary{
+            .code = std::move(code),
+            .sanitize_mul = sanitize_mul
+        });
+    }
+
+    LOG_INFO(Render_Vulkan, "Found a shader binary cache with {} entries", binary_map.size());
+    return binary_map;
+}
+
 std::optional<ShaderDiskCacheDecompiled> ShaderDiskCache::LoadDecompiledEntry() {
 
     bool sanitize_mul;
@@ -299,10 +549,14 @@ void ShaderDiskCache::InvalidateAll() {
 void ShaderDiskCache::InvalidatePrecompiled() {
     // Clear virtual precompiled cache file
     decompressed_precompiled_cache.resize(0);
+    binaries.clear();
 
     if (!FileUtil::Delete(GetPrecompiledPath())) {
         LOG_ERROR(Render_OpenGL, "Failed to invalidate precompiled file={}", GetPrecompiledPath());
     }
+    if (!FileUtil::Delete(GetBinaryPath())) {
+        LOG_ERROR(Render_Vulkan, "Failed to invalidate binary file={}", GetBinaryPath());
+    }
 }
 
 void ShaderDiskCache::SaveRaw(const ShaderDiskCacheRaw& entry) {
@@ -345,6 +599,39 @@ void ShaderDiskCache::SaveDecompiled(u64 unique_identifier, const std::string& c
     }
 }
 
+void ShaderDiskCache::SaveBinary(u64 unique_identifier, std::span<const u32> code,
+                                 bool sanitize_mul) {
+    if (!IsUsable() || code.empty())
+        return;
+
+    const auto iter = binaries.find(unique_identifier);
+    if (iter != binaries.end() && iter->second == sanitize_mul) {
+        // The binary already exists
+        return;
+    }
+
+    FileUtil::IOFile file = AppendBinaryFile();
+    if (!file.IsOpen()) {
+        return;
+    }
+
+    const u64 code_hash = Common::ComputeHash64(code.data(), code.size_bytes());
+    if (file.WriteObject(unique_identifier) != 1 || file.WriteObject(sanitize_mul) != 1 ||
+        file.WriteObject(static_cast<u32>(code.size())) != 1 || file.WriteObject(code_hash) != 1 ||
+        file.WriteArray(code.data(), code.size()) != code.size()) {
+        LOG_ERROR(Render_Vulkan, "Failed to save shader binary entry - removing");
+        file.Close();
+        if (!FileUtil::Delete(GetBinaryPath())) {
+            LOG_ERROR(Render_Vulkan, "Failed to invalidate binary file={}", GetBinaryPath());
+        }
+
+        binaries.clear();
+        return;
+    }
+
+    binaries.insert_or_assign(unique_identifier, sanitize_mul);
+}
+
 bool ShaderDiskCache::IsUsable() const {
     return tried_to_load && Settings::values.use_disk_shader_cache;
 }
@@ -396,6 +683,31 @@ FileUtil::IOFile ShaderDiskCache::AppendPrecompiledFile() {
     return file;
 }
 
+FileUtil::IOFile ShaderDiskCache::AppendBinaryFile() {
+    if (!EnsureDirectories())
+        return {};
+
+    const auto binary_path{GetBinaryPath()};
+    const bool existed = FileUtil::Exists(binary_path);
+
+    FileUtil::IOFile file(binary_path, "ab");
+    if (!file.IsOpen()) {
+        LOG_ERROR(Render_Vulkan, "Failed to open shader binary cache in path={}", binary_path);
+        return {};
+    }
+    if (!existed || file.GetSize() == 0) {
+        // If the file didn't exist, write the versions the binaries depend on
+        const auto hash{GetShaderCacheVersionHash()};
+        if (file.WriteArray(hash.data(), hash.size()) != hash.size() ||
+            file.WriteObject(ShaderGeneratorBase::Version) != 1) {
+            LOG_ERROR(Render_Vulkan, "Failed to write shader binary cache version in path={}",
+                      binary_path);
+            return {};
+        }
+    }
+    return file;
+}
+
 void ShaderDiskCache::SavePrecompiledHeaderToVirtualPrecompiledCache() {
     const ShaderCacheVersionHash hash = GetShaderCacheVersionHash();
     if (!SaveArrayToPrecompiled(hash.data(), hash.size())) {
@@ -415,7 +727,8 @@ bool ShaderDiskCache::EnsureDirectories() const {
 
     return CreateDir(FileUtil::GetUserPath(FileUtil::UserPath::ShaderDir)) &&
            CreateDir(GetBaseDir()) && CreateDir(GetTransferableDir()) &&
-           CreateDir(GetPrecompiledDir()) && CreateDir(GetPrecompiledShaderDir());
+           CreateDir(GetPrecompiledDir()) && CreateDir(GetPrecompiledShaderDir()) &&
+           CreateDir(GetBinaryDir());
 }
 
 std::string ShaderDiskCache::GetTransferablePath() {
@@ -426,6 +739,10 @@ std::string ShaderDiskCache::GetPrecompiledPath() {
     return FileUtil::SanitizePath(GetPrecompiledShaderDir() + DIR_SEP_CHR + GetTitleID() + ".bin");
 }
 
+std::string ShaderDiskCache::GetBinaryPath() {
+    return FileUtil::SanitizePath(GetBinaryDir() + DIR_SEP_CHR + GetTitleID() + ".bin");
+}
+
 std::string ShaderDiskCache::GetTransferableDir() const {
     return GetBaseDir() + DIR_SEP "transferable";
 }
@@ -438,6 +755,10 @@ std::string ShaderDiskCache::GetPrecompiledShaderDir() const {
     return GetPrecompiledDir() + DIR_SEP "separable";
 }
 
+std::string ShaderDiskCache::GetBinaryDir() const {
+    return GetPrecompiledDir() + DIR_SEP "binary";
+}
+
 std::string ShaderDiskCache::GetBaseDir() const {
     return FileUtil::GetUserPath(FileUtil::UserPath::ShaderDir) + DIR_SEP "opengl";
 }
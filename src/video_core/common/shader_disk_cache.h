@@ -6,6 +6,8 @@
 
 #include <optional>
 #include <memory>
+#include <span>
+#include <vector>
 #include <unordered_map>
 #include "video_core/regs.h"
 #include "video_core/common/shader.h"
@@ -26,18 +28,56 @@ enum class ProgramType : u32 {
     FragmentShader = 2
 };
 
+/**
+ * Compact representation of the Pica register state that influences host shader generation.
+ * Only the registers read by PicaFSConfig and PicaVSConfig are stored, which keeps transferable
+ * cache entries small and makes hashing them cheap compared to the full register file.
+ * @note Bump Version whenever the register table in shader_disk_cache.cpp changes
+ */
+class ShaderDiskCacheKey {
+public:
+    static constexpr u32 Version = 1;
+
+    ShaderDiskCacheKey() = default;
+    explicit ShaderDiskCacheKey(const Pica::Regs& regs);
+    explicit ShaderDiskCacheKey(std::vector<u32> values) : values(std::move(values)) {}
+
+    // Returns the number of register words stored in the key
+    static std::size_t Size();
+
+    // Reconstructs a register file with only the shader relevant registers set
+    Pica::Regs ToRegs() const;
+
+    // Returns the hash of the stored register values
+    u64 Hash() const;
+
+    // Returns an immutable span to the stored register values
+    std::span<const u32> GetValues() const {
+        return values;
+    }
+
+private:
+    std::vector<u32> values{};
+};
+
+// Returns the unique identifier of a shader from its register key and program code
+u64 ComputeShaderUniqueIdentifier(const ShaderDiskCacheKey& key, std::span<const u32> code);
+
 // Describes a shader how it's used by the Pica GPU
 class ShaderDiskCacheRaw {
 public:
     ShaderDiskCacheRaw() = default;
-    ShaderDiskCacheRaw(u64 unique_identifier, ProgramType program_type, Pica::Regs config,
+    ShaderDiskCacheRaw(u64 unique_identifier, ProgramType program_type, ShaderDiskCacheKey key,
                        std::vector<u32> program_code) : unique_identifier(unique_identifier),
-        program_type(program_type), config(config), program_code(program_code) {}
+        program_type(program_type), key(std::move(key)), program_code(std::move(program_code)) {}
     ~ShaderDiskCacheRaw() = default;
 
     bool Load(FileUtil::IOFile& file);
     bool Save(FileUtil::IOFile& file) const;
 
+    // Loads an entry written by the old transferable format that stored the full register file
+    bool LoadLegacy(FileUtil::IOFile& file);
+
     // Returns the unique hash of the program code and pica registers
     u64 GetUniqueIdentifier() const {
         return unique_identifier;
@@ -53,15 +93,24 @@ public:
         return program_code;
     }
 
+    // Returns the compact register key used to generate the program code
+    const ShaderDiskCacheKey& GetKey() const {
+        return key;
+    }
+
     // Returns the pica register state used to generate the program code
-    const Pica::Regs& GetRawShaderConfig() const {
-        return config;
+    Pica::Regs GetRawShaderConfig() const {
+        return key.ToRegs();
     }
 
+private:
+    // Reads the vertex shader program code that follows the register state
+    bool LoadProgramCode(FileUtil::IOFile& file);
+
 private:
     u64 unique_identifier = 0;
     ProgramType program_type{};
-    Pica::Regs config{};
+    ShaderDiskCacheKey key{};
     std::vector<u32> program_code{};
 };
 
@@ -73,6 +122,14 @@ struct ShaderDiskCacheDecompiled {
 
 using ShaderDecompiledMap = std::unordered_map<u64, ShaderDiskCacheDecompiled>;
 
+// Contains the backend binary of a compiled shader
+struct ShaderDiskCacheBinary {
+    std::vector<u32> code;
+    bool sanitize_mul;
+};
+
+using ShaderBinaryMap = std::unordered_map<u64, ShaderDiskCacheBinary>;
+
 class BackendBase;
 
 class ShaderDiskCache {
@@ -98,6 +155,13 @@ public:
     /// Loads the transferable cache. Returns empty on failure.
     std::optional<ShaderDecompiledMap> LoadPrecompiled();
 
+    /// Loads the shader binary file. If the file is from another emulator or generator
+    /// version, it gets deleted. Returns empty on failure.
+    std::optional<ShaderBinaryMap> LoadBinaries();
+
+    /// Appends a compiled shader binary to the binary file. Skips entries that are already stored.
+    void SaveBinary(u64 unique_identifier, std::span<const u32> code, bool sanitize_mul);
+
 private:
     /// Loads a decompiled cache entry from m_precompiled_cache_virtual_file.
     /// Returns empty on failure.
@@ -110,12 +174,18 @@ private:
     /// Saves a decompiled entry to the virtual precompiled cache. Does not check for collisions.
     bool SaveDecompiledToCache(u64 unique_identifier, const std::string& code, bool sanitize_mul);
 
+    /// Rewrites the transferable file from the legacy full register format to the current one.
+    void MigrateTransferable(const std::vector<ShaderDiskCacheRaw>& raws);
+
     /// Returns if the cache can be used
     bool IsUsable() const;
 
     /// Opens current game's transferable file and write it's header if it doesn't exist
     FileUtil::IOFile AppendTransferableFile();
 
+    /// Opens current game's binary file and write it's header if it doesn't exist
+    FileUtil::IOFile AppendBinaryFile();
+
     /// Save precompiled header to precompiled_cache_in_memory
     void SavePrecompiledHeaderToVirtualPrecompiledCache();
 
@@ -128,6 +198,9 @@ private:
     /// Gets current game's precompiled file path
     std::string GetPrecompiledPath();
 
+    /// Gets current game's shader binary file path
+    std::string GetBinaryPath();
+
     /// Get user's transferable directory path
     std::string GetTransferableDir() const;
 
@@ -136,6 +209,9 @@ private:
 
     std::string GetPrecompiledShaderDir() const;
 
+    /// Get user's shader binary directory path
+    std::string GetBinaryDir() const;
+
     /// Get user's shader directory path
     std::string GetBaseDir() const;
 
@@ -190,6 +266,9 @@ private:
     // Stored transferable shaders
     std::unordered_map<u64, ShaderDiskCacheRaw> transferable;
 
+    // Stored shader binaries and the sanitize_mul setting they were compiled with
+    std::unordered_map<u64, bool> binaries;
+
     // The cache has been loaded at boot
     bool tried_to_load{};
 
@@ -216,6 +216,9 @@ struct PicaFixedGSConfig {
  */
 class ShaderGeneratorBase {
 public:
+    // Bump whenever the generated code changes so cached shader binaries get discarded
+    static constexpr u32 Version = 1;
+
     ShaderGeneratorBase() = default;
     virtual ~ShaderGeneratorBase() = default;
 
@@ -248,6 +251,14 @@ public:
      * @returns String of the shader source code
      */
     virtual std::string GenerateFragmentShader(const PicaFSConfig& config) = 0;
+
+    /**
+     * Generates the GLSL fragment ubershader program source code. Unlike GenerateFragmentShader
+     * the PICA fragment state is read at runtime from the UberShaderData uniform block, so a
+     * single program covers every configuration except procedural textures and shadow rendering
+     * @returns String of the shader source code
+     */
+    virtual std::string GenerateFragmentUberShader() = 0;
 };
 
 } // namespace VideoCore
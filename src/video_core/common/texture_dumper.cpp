@@ -0,0 +1,120 @@
+// Copyright 2022 Citra Emulator Project
+// Licensed under GPLv2 or any later version
+// Refer to the license.txt file included.
+
+#include <cstring>
+#include <fmt/format.h>
+#include "common/assert.h"
+#include "common/color.h"
+#include "common/logging/log.h"
+#include "common/texture.h"
+#include "core/frontend/image_interface.h"
+#include "video_core/common/texture_dumper.h"
+
+namespace VideoCore {
+
+using PixelFormat = SurfaceParams::PixelFormat;
+using SurfaceType = SurfaceParams::SurfaceType;
+
+constexpr std::string_view INDEX_FILE = "dumped_textures.bin";
+
+/// Converts the contents of a surface buffer to RGBA8
+static std::vector<u8> ConvertToRGBA8(PixelFormat format, u32 width, u32 height,
+                                      const std::vector<u8>& data) {
+    // Texture formats are already decoded to RGBA8 and RGBA8 is byteswapped when loaded
+    if (format == PixelFormat::RGBA8 ||
+        SurfaceParams::GetFormatType(format) == SurfaceType::Texture) {
+        return data;
+    }
+
+    const auto decode = [format](const u8* bytes) -> Common::Vec4<u8> {
+        switch (format) {
+        case PixelFormat::RGB8:
+            return {bytes[0], bytes[1], bytes[2], 255};
+        case PixelFormat::RGB5A1:
+            return Color::DecodeRGB5A1(bytes);
+        case PixelFormat::RGB565:
+            return Color::DecodeRGB565(bytes);
+        case PixelFormat::RGBA4:
+            return Color::DecodeRGBA4(bytes);
+        default:
+            UNREACHABLE_MSG("Unknown color format {}", static_cast<u32>(format));
+            return {};
+        }
+    };
+
+    const u32 bytes_per_pixel = SurfaceParams::GetFormatBpp(format) / 8;
+    std::vector<u8> rgba(static_cast<std::size_t>(width) * height * 4);
+    for (std::size_t i = 0; i < static_cast<std::size_t>(width) * height; i++) {
+        auto color = decode(&data[i * bytes_per_pixel]);
+        std::memcpy(&rgba[i * 4], color.AsArray(), 4);
+    }
+
+    return rgba;
+}
+
+TextureDumper::TextureDumper(u64 program_id,
+                             std::shared_ptr<Frontend::ImageInterface> image_interface)
+    : image_interface{std::move(image_interface)},
+      dump_path{fmt::format("{}textures/{:016X}/",
+                            FileUtil::GetUserPath(FileUtil::UserPath::DumpDir), program_id)},
+      writer{1, "TextureDumper"} {
+    if (!FileUtil::CreateFullPath(dump_path)) {
+        LOG_ERROR(Render, "Unable to create {}", dump_path);
+        return;
+    }
+
+    const std::string index_path = dump_path + std::string{INDEX_FILE};
+    if (FileUtil::IOFile index_in{index_path, "rb"}; index_in.IsOpen()) {
+        std::vector<u64> hashes(index_in.GetSize() / sizeof(u64));
+        hashes.resize(index_in.ReadArray(hashes.data(), hashes.size()));
+        dumped_textures.insert(hashes.begin(), hashes.end());
+        LOG_INFO(Render, "Skipping {} textures dumped previously", dumped_textures.size());
+    }
+
+    index_file = FileUtil::IOFile(index_path, "ab");
+}
+
+void TextureDumper::DumpTexture(u64 hash, PixelFormat format, u32 width, u32 height,
+                                std::span<const u8> data) {
+    if (dumped_textures.contains(hash)) {
+        return;
+    }
+
+    if (queued_bytes + data.size() > MAX_QUEUED_BYTES) {
+        LOG_DEBUG(Render, "Texture dumper is behind, skipping {:016X}", hash);
+        return;
+    }
+
+    dumped_textures.insert(hash);
+    queued_bytes += data.size();
+    writer.QueueWork([this, hash, format, width, height,
+                      texture = std::vector<u8>(data.begin(), data.end())] {
+        WriteTexture(hash, format, width, height, texture);
+        queued_bytes -= texture.size();
+    });
+}
+
+void TextureDumper::WriteTexture(u64 hash, PixelFormat format, u32 width, u32 height,
+                                 const std::vector<u8>& data) {
+    const std::string path = fmt::format("{}tex1_{}x{}_{:016X}_{}.png", dump_path, width, height,
+                                         hash, static_cast<u32>(format));
+
+    if (!FileUtil::Exists(path)) {
+        std::vector<u8> decoded_texture = ConvertToRGBA8(format, width, height, data);
+        Common::FlipRGBA8Texture(decoded_texture, width, height);
+
+        LOG_INFO(Render, "Dumping texture to {}", path);
+        if (!image_interface->EncodePNG(path, decoded_texture, width, height)) {
+            LOG_ERROR(Render, "Failed to save decoded texture");
+            return;
+        }
+    }
+
+    if (index_file.IsOpen()) {
+        index_file.WriteObject(hash);
+        index_file.Flush();
+    }
+}
+
+} // namespace VideoCore
@@ -0,0 +1,60 @@
+// Copyright 2022 Citra Emulator Project
+// Licensed under GPLv2 or any later version
+// Refer to the license.txt file included.
+
+#pragma once
+
+#include <atomic>
+#include <memory>
+#include <span>
+#include <string>
+#include <unordered_set>
+#include <vector>
+#include "common/common_types.h"
+#include "common/file_util.h"
+#include "common/thread_worker.h"
+#include "video_core/common/surface_params.h"
+
+namespace Frontend {
+class ImageInterface;
+} // namespace Frontend
+
+namespace VideoCore {
+
+/**
+ * Dumps the textures of a title to PNG files on a background writer thread. The rendering
+ * thread only copies the texture data, the conversion to RGBA8, file checks and PNG encoding
+ * happen on the writer. Dumped hashes are appended to an index file in the dump directory, so
+ * textures dumped by earlier sessions are skipped right away. Removing the index dumps them again.
+ */
+class TextureDumper {
+public:
+    /// Maximum amount of texture data waiting for the writer, textures are skipped beyond it
+    static constexpr std::size_t MAX_QUEUED_BYTES = 64 * 1024 * 1024;
+
+    TextureDumper(u64 program_id, std::shared_ptr<Frontend::ImageInterface> image_interface);
+
+    /**
+     * Queues a texture for dumping unless it was dumped before. Textures skipped because the
+     * writer is behind are queued again the next time they are dumped.
+     * @param data The texture in the layout of CachedSurface::gl_buffer, bottom row first
+     */
+    void DumpTexture(u64 hash, SurfaceParams::PixelFormat format, u32 width, u32 height,
+                     std::span<const u8> data);
+
+private:
+    void WriteTexture(u64 hash, SurfaceParams::PixelFormat format, u32 width, u32 height,
+                      const std::vector<u8>& data);
+
+private:
+    std::shared_ptr<Frontend::ImageInterface> image_interface;
+    std::string dump_path;
+    std::unordered_set<u64> dumped_textures;
+    std::atomic<std::size_t> queued_bytes{0};
+
+    // Only accessed by the writer thread, which is stopped first on destruction
+    FileUtil::IOFile index_file;
+    Common::ThreadWorker writer;
+};
+
+} // namespace VideoCore
@@ -4,8 +4,8 @@
 
 #define VULKAN_HPP_NO_CONSTRUCTORS
 #include <functional>
+#include <utility>
 #include "common/file_util.h"
-#include "common/linear_disk_cache.h"
 #include "core/core.h"
 #include "core/frontend/emu_window.h"
 #include "video_core/renderer_vulkan/vk_backend.h"
@@ -44,31 +44,10 @@ constexpr vk::IndexType ToVkIndexType(AttribType type) {
     }
 }
 
-class PipelineCacheReadCallback : public LinearDiskCacheReader<u32, u8>
-{
-public:
-  PipelineCacheReadCallback(std::vector<u8>* data) : m_data(data) {}
-  void Read(const u32& key, const u8* value, u32 value_size) override
-  {
-    m_data->resize(value_size);
-    if (value_size > 0)
-      memcpy(m_data->data(), value, value_size);
-  }
-
-private:
-  std::vector<u8>* m_data;
-};
-
-class PipelineCacheReadIgnoreCallback : public LinearDiskCacheReader<u32, u8>
-{
-public:
-  void Read(const u32& key, const u8* value, u32 value_size) override {}
-};
-
-
 Backend::Backend(Frontend::EmuWindow& window) : BackendBase(window),
     instance(window), scheduler(instance, pool_manager), renderpass_cache(instance),
-    swapchain(instance, scheduler, renderpass_cache, pool_manager, instance.GetSurface()) {
+    swapchain(instance, scheduler, renderpass_cache, pool_manager, instance.GetSurface()),
+    pipeline_cache(instance) {
 
     // TODO: Properly report GPU hardware
     auto& telemetry_session = Core::System::GetInstance().TelemetrySession();
@@ -77,27 +56,7 @@ Backend::Backend(Frontend::EmuWindow& window) : BackendBase(window),
     telemetry_session.AddField(user_system, "GPU_Model", "GTX 1650");
     telemetry_session.AddField(user_system, "GPU_Vulkan_Version", "Vulkan 1.3");
 
-    vk::PipelineCacheCreateInfo cache_info{};
-
-    std::vector<u8> disk_data;
-    LinearDiskCache<u32, u8> disk_cache;
-    PipelineCacheReadCallback read_callback(&disk_data);
-    if (disk_cache.OpenAndRead(pipeline_cache_filename.c_str(), read_callback) != 1) {
-        disk_data.clear();
-    }
-
-    if (!disk_data.empty()) {
-        // Don't use this data. In fact, we should delete it to prevent it from being used next time.
-        FileUtil::Delete(pipeline_cache_filename);
-    } else {
-        cache_info.initialDataSize = disk_data.size();
-        cache_info.pInitialData = disk_data.data();
-    }
-
-    // Create pipeline cache object
     vk::Device device = instance.GetDevice();
-    pipeline_cache = device.createPipelineCache(cache_info);
-
     constexpr std::array pool_sizes = {
         vk::DescriptorPoolSize{vk::DescriptorType::eUniformBuffer, 1024},
         vk::DescriptorPoolSize{vk::DescriptorType::eUniformBufferDynamic, 1024},
@@ -113,12 +72,28 @@ Backend::Backend(Frontend::EmuWindow& window) : BackendBase(window),
     };
 
     // Create descriptor pools
-    for (u32 pool = 0; pool < SCHEDULER_COMMAND_COUNT; pool++) {
+    for (u32 pool = 0; pool < scheduler.GetSlotCount(); pool++) {
         descriptor_pools[pool] = device.createDescriptorPool(pool_info);
     }
 
     auto callback = std::bind(&Backend::OnCommandSwitch, this, std::placeholders::_1);
     scheduler.SetSwitchCallback(callback);
+
+    const vk::CommandPoolCreateInfo present_pool_info = {
+        .flags = vk::CommandPoolCreateFlagBits::eResetCommandBuffer,
+        .queueFamilyIndex = instance.GetGraphicsQueueFamilyIndex()
+    };
+
+    present_command_pool = device.createCommandPool(present_pool_info);
+
+    const vk::CommandBufferAllocateInfo present_buffer_info = {
+        .commandPool = present_command_pool,
+        .level = vk::CommandBufferLevel::ePrimary,
+        .commandBufferCount = 1
+    };
+
+    present_command_buffer = device.allocateCommandBuffers(present_buffer_info)[0];
+    present_fence = device.createFence({});
 }
 
 Backend::~Backend() {
@@ -126,50 +101,139 @@ Backend::~Backend() {
     vk::Device device = instance.GetDevice();
     device.waitIdle();
 
-    auto data = device.getPipelineCacheData(pipeline_cache);
-
-    // Delete the old cache and re-create.
-    FileUtil::Delete(pipeline_cache_filename);
-
-    // We write a single key of 1, with the entire pipeline cache data.
-    // Not ideal, but our disk cache class does not support just writing a single blob
-    // of data without specifying a key.
-    LinearDiskCache<u32, u8> disk_cache;
-    PipelineCacheReadIgnoreCallback callback;
-    disk_cache.OpenAndRead(pipeline_cache_filename.c_str(), callback);
-    disk_cache.Append(1, data.data(), static_cast<u32>(data.size()));
-    disk_cache.Close();
-
-    device.destroyPipelineCache(pipeline_cache);
-
-    for (u32 pool = 0; pool < SCHEDULER_COMMAND_COUNT; pool++) {
+    for (u32 pool = 0; pool < scheduler.GetSlotCount(); pool++) {
         device.destroyDescriptorPool(descriptor_pools[pool]);
     }
+
+    device.destroyFence(present_fence);
+    device.destroyCommandPool(present_command_pool);
 }
 
 bool Backend::BeginPresent() {
+    // Headless runs have nothing to present to
+    if (instance.IsHeadless()) {
+        return false;
+    }
+
     const auto& layout = window.GetFramebufferLayout();
     if (swapchain.NeedsRecreation()) {
         swapchain.Create(layout.width, layout.height, false);
     }
 
-    swapchain.AcquireNextImage();
-    return true;
+    return swapchain.AcquireNextImage();
 }
 
 void Backend::EndPresent() {
     // Transition swapchain image to present layout
     vk::CommandBuffer command_buffer = scheduler.GetRenderCommandBuffer();
-    /*if (renderpass_active) {
-        command_buffer.endRenderPass();
-        renderpass_active = false;
-    }*/
-
     swapchain.GetCurrentImage()->Transition(command_buffer, vk::ImageLayout::ePresentSrcKHR);
 
     // Submit and present
     scheduler.Submit(false, true, swapchain.GetAvailableSemaphore(), swapchain.GetPresentSemaphore());
     swapchain.Present();
+    EndFrame();
+}
+
+void Backend::SubmitFrame() {
+    scheduler.Submit(false, true);
+    EndFrame();
+}
+
+void Backend::PresentTexture(const TextureHandle& texture_handle) {
+    if (instance.IsHeadless()) {
+        return;
+    }
+
+    const auto& layout = window.GetFramebufferLayout();
+    if (swapchain.NeedsRecreation()) {
+        swapchain.Create(layout.width, layout.height, false);
+    }
+
+    if (!swapchain.AcquireNextImage()) {
+        return;
+    }
+
+    Texture* texture = static_cast<Texture*>(texture_handle.Get());
+    Texture* image = swapchain.GetCurrentImage();
+    const vk::Extent2D extent = swapchain.GetExtent();
+
+    const vk::CommandBufferBeginInfo begin_info = {
+        .flags = vk::CommandBufferUsageFlagBits::eOneTimeSubmit
+    };
+
+    // The texture was rendered by work submitted to the same queue before it was handed over,
+    // so the layout transition is enough to order the copy after it
+    vk::CommandBuffer command_buffer = present_command_buffer;
+    command_buffer.begin(begin_info);
+    texture->Transition(command_buffer, vk::ImageLayout::eTransferSrcOptimal);
+    image->Transition(command_buffer, vk::ImageLayout::eTransferDstOptimal);
+
+    const vk::ImageBlit image_blit = {
+        .srcSubresource = {
+            .aspectMask = vk::ImageAspectFlagBits::eColor,
+            .mipLevel = 0,
+            .baseArrayLayer = 0,
+            .layerCount = 1
+        },
+        .srcOffsets = std::array{
+            vk::Offset3D{0, 0, 0},
+            vk::Offset3D{static_cast<s32>(texture->GetWidth()),
+                         static_cast<s32>(texture->GetHeight()), 1}
+        },
+        .dstSubresource = {
+            .aspectMask = vk::ImageAspectFlagBits::eColor,
+            .mipLevel = 0,
+            .baseArrayLayer = 0,
+            .layerCount = 1
+        },
+        .dstOffsets = std::array{
+            vk::Offset3D{0, 0, 0},
+            vk::Offset3D{static_cast<s32>(extent.width), static_cast<s32>(extent.height), 1}
+        }
+    };
+
+    command_buffer.blitImage(texture->GetHandle(), vk::ImageLayout::eTransferSrcOptimal,
+                             image->GetHandle(), vk::ImageLayout::eTransferDstOptimal,
+                             image_blit, vk::Filter::eLinear);
+    image->Transition(command_buffer, vk::ImageLayout::ePresentSrcKHR);
+    command_buffer.end();
+
+    const vk::Semaphore wait_semaphore = swapchain.GetAvailableSemaphore();
+    const vk::Semaphore signal_semaphore = swapchain.GetPresentSemaphore();
+    const vk::PipelineStageFlags wait_stage_mask = vk::PipelineStageFlagBits::eTransfer;
+    const vk::SubmitInfo submit_info = {
+        .waitSemaphoreCount = 1,
+        .pWaitSemaphores = &wait_semaphore,
+        .pWaitDstStageMask = &wait_stage_mask,
+        .commandBufferCount = 1,
+        .pCommandBuffers = &command_buffer,
+        .signalSemaphoreCount = 1,
+        .pSignalSemaphores = &signal_semaphore
+    };
+
+    {
+        std::scoped_lock lock{instance.GetQueueMutex()};
+        instance.GetGraphicsQueue().submit(submit_info, present_fence);
+    }
+
+    swapchain.Present();
+
+    // The texture is handed back to the renderer after this returns, so the copy must be done
+    vk::Device device = instance.GetDevice();
+    if (device.waitForFences(present_fence, true, UINT64_MAX) != vk::Result::eSuccess) {
+        LOG_ERROR(Render_Vulkan, "Waiting for the present fence failed!");
+    }
+
+    device.resetFences(present_fence);
+}
+
+void Backend::EndFrame() {
+    // Persist new pipelines regularly so they aren't lost if the emulator crashes
+    pipeline_cache.PeriodicSave();
+
+    last_frame_allocations = std::exchange(descriptor_allocations, 0);
+    last_frame_cache_hits = std::exchange(descriptor_cache_hits, 0);
+    last_frame_renderpasses = scheduler.ResetRenderpassCount();
 }
 
 void Backend::Flush() {
@@ -184,6 +248,25 @@ FramebufferHandle Backend::GetWindowFramebuffer() {
     return framebuffer;
 }
 
+u64 Backend::QueryDriver(Query query) {
+    switch (query) {
+    case Query::ThreadSafeShaderCompile:
+        // vkCreateShaderModule does not require any external synchronization
+        return 1;
+    case Query::ThreadSafePipelineCompile:
+        // Each thread builds pipelines with its own pipeline cache shard
+        return 1;
+    case Query::DescriptorAllocations:
+        return last_frame_allocations;
+    case Query::DescriptorCacheHits:
+        return last_frame_cache_hits;
+    case Query::RenderpassCount:
+        return last_frame_renderpasses;
+    default:
+        return 0;
+    }
+}
+
 u64 Backend::PipelineInfoHash(const PipelineInfo& info) {
     const bool hash_all = !instance.IsExtendedDynamicStateSupported();
     if (hash_all) {
@@ -209,11 +292,12 @@ FramebufferHandle Backend::CreateFramebuffer(FramebufferInfo info) {
     // Get renderpass
     TextureFormat color = info.color.IsValid() ? info.color->GetFormat() : TextureFormat::Undefined;
     TextureFormat depth = info.depth_stencil.IsValid() ? info.depth_stencil->GetFormat() : TextureFormat::Undefined;
-    vk::RenderPass load_renderpass = GetRenderPass(color, depth, false);
-    vk::RenderPass clear_renderpass = GetRenderPass(color, depth, true);
+    vk::RenderPass load_renderpass = GetRenderPass(color, depth, vk::AttachmentLoadOp::eLoad);
+    vk::RenderPass clear_renderpass = GetRenderPass(color, depth, vk::AttachmentLoadOp::eClear);
+    vk::RenderPass discard_renderpass = GetRenderPass(color, depth, vk::AttachmentLoadOp::eDontCare);
 
     return pool_manager.Allocate<Framebuffer>(instance, scheduler, pool_manager, info,
-                                              load_renderpass, clear_renderpass);
+                                              load_renderpass, clear_renderpass, discard_renderpass);
 }
 
 TextureHandle Backend::CreateTexture(TextureInfo info) {
@@ -224,17 +308,25 @@ PipelineHandle Backend::CreatePipeline(PipelineType type, PipelineInfo info) {
     // Get renderpass
     vk::RenderPass renderpass = GetRenderPass(info.color_attachment, info.depth_attachment);
 
-    // Find an owner first
+    // Find an owner first, pipelines may be created from the async compile workers
     const u64 layout_hash = Common::ComputeHash64(&info.layout, sizeof(PipelineLayoutInfo));
-    if (auto iter = pipeline_owners.find(layout_hash); iter != pipeline_owners.end()) {
-        return pool_manager.Allocate<Pipeline>(instance, scheduler, pool_manager, *iter->second.get(), type,
-                                               info, renderpass, pipeline_cache);
+    PipelineOwner* owner = nullptr;
+    {
+        std::scoped_lock lock{pipeline_owner_mutex};
+        auto iter = pipeline_owners.find(layout_hash);
+        if (iter == pipeline_owners.end()) {
+            // Create the layout
+            iter = pipeline_owners.emplace(layout_hash, std::make_unique<PipelineOwner>(instance, info.layout)).first;
+        }
+
+        owner = iter->second.get();
     }
 
-    // Create the layout
-    auto result = pipeline_owners.emplace(layout_hash, std::make_unique<PipelineOwner>(instance, info.layout));
-    return pool_manager.Allocate<Pipeline>(instance, scheduler, pool_manager, *result.first->second.get(), type,
-                                           info, renderpass, pipeline_cache);
+    PipelineHandle pipeline = pool_manager.Allocate<Pipeline>(instance, scheduler, pool_manager,
+                                                              *owner, type, info, renderpass,
+                                                              pipeline_cache.GetThreadCache());
+    pipeline_cache.MarkDirty();
+    return pipeline;
 }
 
 SamplerHandle Backend::CreateSampler(SamplerInfo info) {
@@ -252,14 +344,14 @@ void Backend::BindVertexBuffer(BufferHandle buffer, std::span<const u64> offsets
     std::array<vk::Buffer, 16> buffers;
     buffers.fill(vertex->GetHandle());
 
-    vk::CommandBuffer command_buffer = scheduler.GetRenderCommandBuffer();
+    vk::CommandBuffer command_buffer = scheduler.GetRenderpassCommandBuffer();
     command_buffer.bindVertexBuffers(0, buffer_count, buffers.data(), offsets.data());
 }
 
 void Backend::BindIndexBuffer(BufferHandle buffer, AttribType index_type, u64 offset) {
     const Buffer* index = static_cast<const Buffer*>(buffer.Get());
 
-    vk::CommandBuffer command_buffer = scheduler.GetRenderCommandBuffer();
+    vk::CommandBuffer command_buffer = scheduler.GetRenderpassCommandBuffer();
     command_buffer.bindIndexBuffer(index->GetHandle(), 0, ToVkIndexType(index_type));
 }
 
@@ -274,14 +366,11 @@ void Backend::Draw(PipelineHandle pipeline_handle, FramebufferHandle draw_frameb
 
     // Bind pipeline
     const Pipeline* pipeline = static_cast<const Pipeline*>(pipeline_handle.Get());
-    vk::CommandBuffer command_buffer = scheduler.GetRenderCommandBuffer();
+    vk::CommandBuffer command_buffer = scheduler.GetRenderpassCommandBuffer();
     command_buffer.bindPipeline(ToVkPipelineBindPoint(pipeline->GetType()), pipeline->GetHandle());
 
-    // Submit draw
+    // Submit draw. The renderpass is kept open for the draws that follow
     command_buffer.draw(num_vertices, 1, base_vertex, 0);
-
-    // End renderpass
-    command_buffer.endRenderPass();
 }
 
 void Backend::DrawIndexed(PipelineHandle pipeline_handle, FramebufferHandle draw_framebuffer,
@@ -294,22 +383,19 @@ void Backend::DrawIndexed(PipelineHandle pipeline_handle, FramebufferHandle draw
 
     // Bind pipeline
     const Pipeline* pipeline = static_cast<const Pipeline*>(pipeline_handle.Get());
-    vk::CommandBuffer command_buffer = scheduler.GetRenderCommandBuffer();
+    vk::CommandBuffer command_buffer = scheduler.GetRenderpassCommandBuffer();
     command_buffer.bindPipeline(ToVkPipelineBindPoint(pipeline->GetType()), pipeline->GetHandle());
 
-    // Submit draw
+    // Submit draw. The renderpass is kept open for the draws that follow
     command_buffer.drawIndexed(num_indices, 1, base_index, base_vertex, 0);
-
-    // End renderpass
-    command_buffer.endRenderPass();
-
 }
 
-vk::RenderPass Backend::GetRenderPass(TextureFormat color, TextureFormat depth, bool is_clear) const {
+vk::RenderPass Backend::GetRenderPass(TextureFormat color, TextureFormat depth,
+                                      vk::AttachmentLoadOp load_op) const {
     if (color == TextureFormat::PresentColor) {
         return renderpass_cache.GetPresentRenderpass();
     } else {
-        return renderpass_cache.GetRenderpass(color, depth, is_clear);
+        return renderpass_cache.GetRenderpass(color, depth, load_op);
     }
 }
 
@@ -324,38 +410,46 @@ void Backend::BindDescriptorSets(PipelineHandle handle) {
             // Get the ready descriptor if it hasn't been modified
             bound_sets[i] = pipeline_owner.descriptor_bank[i];
         } else {
-            // Otherwise allocate a new set and update it with the needed data
-            u32 pool_index = scheduler.GetCurrentSlotIndex();
-            const vk::DescriptorSetAllocateInfo alloc_info = {
-                .descriptorPool = descriptor_pools[pool_index],
-                .descriptorSetCount = 1,
-                .pSetLayouts = &pipeline_owner.GetDescriptorSetLayouts()[i]
-            };
-
-            vk::Device device = instance.GetDevice();
-            vk::DescriptorSet set = device.allocateDescriptorSets(alloc_info)[0];
-            device.updateDescriptorSetWithTemplate(set, pipeline_owner.GetUpdateTemplate(i),
-                                                   reinterpret_cast<const void*>(pipeline_owner.GetData(i)));
-
-            bound_sets[i] = set;
-            pipeline_owner.descriptor_bank[i] = set;
+            // Reuse a set written earlier in this command slot with the same resources
+            auto [iter, new_set] = pipeline_owner.set_cache[i].try_emplace(pipeline_owner.GetDataHash(i));
+            PipelineOwner::CachedSet& cached = iter->second;
+            if (!new_set && pipeline_owner.IsDataEqual(i, cached.data.data())) {
+                descriptor_cache_hits++;
+            } else {
+                // Otherwise allocate a new set and update it with the needed data
+                u32 pool_index = scheduler.GetCurrentSlotIndex();
+                const vk::DescriptorSetAllocateInfo alloc_info = {
+                    .descriptorPool = descriptor_pools[pool_index],
+                    .descriptorSetCount = 1,
+                    .pSetLayouts = &pipeline_owner.GetDescriptorSetLayouts()[i]
+                };
+
+                vk::Device device = instance.GetDevice();
+                vk::DescriptorSet set = device.allocateDescriptorSets(alloc_info)[0];
+                device.updateDescriptorSetWithTemplate(set, pipeline_owner.GetUpdateTemplate(i),
+                                                       reinterpret_cast<const void*>(pipeline_owner.GetData(i)));
+
+                // On a hash collision the older set is replaced, it stays valid until the pool
+                // is reset so any command buffer still referencing it is unaffected
+                cached.data = pipeline_owner.update_data[i];
+                cached.set = set;
+                descriptor_allocations++;
+            }
+
+            bound_sets[i] = cached.set;
+            pipeline_owner.descriptor_bank[i] = cached.set;
             pipeline_owner.descriptor_dirty[i] = false;
         }
     }
 
     // Bind the descriptor sets
-    vk::CommandBuffer command_buffer = scheduler.GetRenderCommandBuffer();
+    vk::CommandBuffer command_buffer = scheduler.GetRenderpassCommandBuffer();
     command_buffer.bindDescriptorSets(ToVkPipelineBindPoint(handle->GetType()), pipeline_owner.GetLayout(),
                                       0, set_count, bound_sets.data(), 0, nullptr);
 }
 
 void Backend::BeginRenderpass(FramebufferHandle draw_framebuffer) {
-    /*if (draw_framebuffer == current_framebuffer && renderpass_active) {
-        return;
-    }*/
-
     Framebuffer* framebuffer = static_cast<Framebuffer*>(draw_framebuffer.Get());
-    //current_framebuffer = draw_framebuffer;
 
     u32 clear_value_count = 0;
     std::array<vk::ClearValue, 2> clear_values{};
@@ -372,27 +466,27 @@ void Backend::BeginRenderpass(FramebufferHandle draw_framebuffer) {
         clear_values[clear_value_count++].depthStencil.stencil = framebuffer->clear_stencil_value;
     }
 
+    // Attachments that were never written have nothing worth loading
+    const bool is_clear = framebuffer->GetLoadOp() == LoadOp::Clear;
+    const bool is_undefined = !is_clear && framebuffer->IsContentUndefined();
+
     // Transition attachments to required layout
     framebuffer->PrepareAttachments();
 
-    // Use the clear renderpass if the framebuffer was configured so
+    // Use the clear renderpass if the framebuffer was configured so. Loading passes cover
+    // the entire framebuffer, which allows draws with different viewports to share them
     const vk::RenderPassBeginInfo renderpass_begin = {
-        .renderPass = framebuffer->GetLoadOp() == LoadOp::Load ?
-                      framebuffer->GetLoadRenderpass() :
-                      framebuffer->GetClearRenderpass(),
+        .renderPass = is_clear ? framebuffer->GetClearRenderpass() :
+                      is_undefined ? framebuffer->GetDiscardRenderpass() :
+                      framebuffer->GetLoadRenderpass(),
         .framebuffer = framebuffer->GetHandle(),
-        .renderArea = ToVkRect2D(framebuffer->GetDrawRect()),
+        .renderArea = is_clear ? ToVkRect2D(framebuffer->GetDrawRect()) : framebuffer->GetFullArea(),
         .clearValueCount = clear_value_count,
         .pClearValues = clear_values.data()
     };
 
-    vk::CommandBuffer command_buffer = scheduler.GetRenderCommandBuffer();
-    /*if (renderpass_active) {
-        command_buffer.endRenderPass();
-    }
-    */
-    command_buffer.beginRenderPass(renderpass_begin, vk::SubpassContents::eInline);
-    //renderpass_active = true;
+    // Consecutive draws to the same framebuffer are recorded in the same renderpass
+    scheduler.BeginRenderpass(renderpass_begin, !is_clear);
 }
 
 void Backend::OnCommandSwitch(u32 new_slot) {
@@ -402,9 +496,13 @@ void Backend::OnCommandSwitch(u32 new_slot) {
     vk::Device device = instance.GetDevice();
     device.resetDescriptorPool(descriptor_pools[new_slot]);
 
-    // Mark all descriptor sets as dirty
+    // Mark all descriptor sets as dirty and forget the sets allocated from the pool
+    std::scoped_lock lock{pipeline_owner_mutex};
     for (auto& [key, owner] : pipeline_owners) {
         owner->descriptor_dirty.fill(true);
+        for (auto& cache : owner->set_cache) {
+            cache.clear();
+        }
     }
 }
 
@@ -4,12 +4,14 @@
 
 #pragma once
 
+#include <mutex>
 #include <unordered_map>
 #include "video_core/common/backend.h"
 #include "video_core/renderer_vulkan/vk_task_scheduler.h"
 #include "video_core/renderer_vulkan/vk_swapchain.h"
 #include "video_core/renderer_vulkan/vk_instance.h"
 #include "video_core/renderer_vulkan/vk_pipeline.h"
+#include "video_core/renderer_vulkan/vk_pipeline_cache.h"
 #include "video_core/renderer_vulkan/vk_renderpass_cache.h"
 
 namespace VideoCore::Vulkan {
@@ -21,10 +23,12 @@ public:
 
     bool BeginPresent() override;
     void EndPresent() override;
+    void SubmitFrame() override;
+    void PresentTexture(const TextureHandle& texture) override;
     void Flush() override;
 
     FramebufferHandle GetWindowFramebuffer() override;
-    u64 QueryDriver(Query query) override { return 0; }
+    u64 QueryDriver(Query query) override;
     u64 PipelineInfoHash(const PipelineInfo& info) override;
 
     BufferHandle CreateBuffer(BufferInfo info) override;
@@ -55,7 +59,8 @@ public:
     }
 
 private:
-    vk::RenderPass GetRenderPass(TextureFormat color, TextureFormat depth, bool is_clear = false) const;
+    vk::RenderPass GetRenderPass(TextureFormat color, TextureFormat depth,
+                                 vk::AttachmentLoadOp load_op = vk::AttachmentLoadOp::eLoad) const;
 
     // Allocates and binds descriptor sets for the provided pipeline
     void BindDescriptorSets(PipelineHandle pipeline);
@@ -65,18 +70,32 @@ private:
 
     void OnCommandSwitch(u32 new_slot);
 
+    // Updates the per-frame statistics and persists new pipelines
+    void EndFrame();
+
 private:
     Instance instance;
     CommandScheduler scheduler;
     RenderpassCache renderpass_cache;
     Swapchain swapchain;
 
-    vk::PipelineCache pipeline_cache;
-    std::string pipeline_cache_filename = "pipeline_cache.bin";
+    ShardedPipelineCache pipeline_cache;
     std::unordered_map<u64, std::unique_ptr<PipelineOwner>, Common::IdentityHash> pipeline_owners;
-    std::array<vk::DescriptorPool, SCHEDULER_COMMAND_COUNT> descriptor_pools;
-    //FramebufferHandle current_framebuffer;
-    //bool renderpass_active = false;
+    std::mutex pipeline_owner_mutex;
+    std::array<vk::DescriptorPool, MAX_SCHEDULER_COMMAND_COUNT> descriptor_pools;
+
+    // Command recording state of PresentTexture, which is separate from the scheduler
+    // so that it can be used from the present thread
+    vk::CommandPool present_command_pool;
+    vk::CommandBuffer present_command_buffer;
+    vk::Fence present_fence;
+
+    // Descriptor set and renderpass statistics of the current and the last presented frame
+    u32 descriptor_allocations = 0;
+    u32 descriptor_cache_hits = 0;
+    u32 last_frame_allocations = 0;
+    u32 last_frame_cache_hits = 0;
+    u32 last_frame_renderpasses = 0;
 };
 
 } // namespace Vulkan
@@ -19,9 +19,11 @@ inline vk::Rect2D ToVkRect2D(Rect2D rect) {
 }
 
 Framebuffer::Framebuffer(Instance& instance, CommandScheduler& scheduler, PoolManager& pool_manager,
-                         const FramebufferInfo& info, vk::RenderPass load_renderpass, vk::RenderPass clear_renderpass) :
+                         const FramebufferInfo& info, vk::RenderPass load_renderpass, vk::RenderPass clear_renderpass,
+                         vk::RenderPass discard_renderpass) :
     FramebufferBase(info), instance(instance), scheduler(scheduler), pool_manager(pool_manager),
-    load_renderpass(load_renderpass), clear_renderpass(clear_renderpass) {
+    load_renderpass(load_renderpass), clear_renderpass(clear_renderpass),
+    discard_renderpass(discard_renderpass) {
 
     const Texture* color = static_cast<const Texture*>(info.color.Get());
     const Texture* depth_stencil = static_cast<const Texture*>(info.depth_stencil.Get());
@@ -38,14 +40,17 @@ Framebuffer::Framebuffer(Instance& instance, CommandScheduler& scheduler, PoolMa
     }
 
     const Texture* valid_texture = color ? color : depth_stencil;
+    width = valid_texture->GetWidth();
+    height = valid_texture->GetHeight();
+
     const vk::FramebufferCreateInfo framebuffer_info = {
         // The load and clear renderpass are compatible according to the specification
         // so there is no need to create multiple framebuffers
         .renderPass = load_renderpass,
         .attachmentCount = attachment_count,
         .pAttachments = attachments.data(),
-        .width = valid_texture->GetWidth(),
-        .height = valid_texture->GetHeight(),
+        .width = width,
+        .height = height,
         .layers = 1
     };
 
@@ -95,23 +100,40 @@ void Framebuffer::DoClear() {
         .pClearValues = clear_values.data()
     };
 
-    // Begin clear pass
-    vk::CommandBuffer command_buffer = scheduler.GetRenderCommandBuffer();
-    command_buffer.beginRenderPass(begin_info, vk::SubpassContents::eInline);
-    command_buffer.endRenderPass();
+    // Begin the clear pass and leave it open, so draws to this framebuffer
+    // that follow can be recorded in it instead of starting a new pass
+    scheduler.BeginRenderpass(begin_info, false);
 }
 
 void Framebuffer::PrepareAttachments() {
+    Texture* color = static_cast<Texture*>(info.color.Get());
+    Texture* depth_stencil = static_cast<Texture*>(info.depth_stencil.Get());
+
+    // Barriers end the active renderpass so only request the command buffer when needed
+    const bool color_ready = !color || color->GetLayout() == vk::ImageLayout::eColorAttachmentOptimal;
+    const bool depth_ready = !depth_stencil ||
+            depth_stencil->GetLayout() == vk::ImageLayout::eDepthStencilAttachmentOptimal;
+    if (color_ready && depth_ready) {
+        return;
+    }
+
     vk::CommandBuffer command_buffer = scheduler.GetRenderCommandBuffer();
-    if (info.color.IsValid()) {
-        Texture* color = static_cast<Texture*>(info.color.Get());
+    if (color) {
         color->Transition(command_buffer, vk::ImageLayout::eColorAttachmentOptimal);
     }
 
-    if (info.depth_stencil.IsValid()) {
-        Texture* depth_stencil = static_cast<Texture*>(info.depth_stencil.Get());
+    if (depth_stencil) {
         depth_stencil->Transition(command_buffer, vk::ImageLayout::eDepthStencilAttachmentOptimal);
     }
 }
 
+bool Framebuffer::IsContentUndefined() const {
+    const Texture* color = static_cast<const Texture*>(info.color.Get());
+    const Texture* depth_stencil = static_cast<const Texture*>(info.depth_stencil.Get());
+
+    // Images that were never written are still in the undefined layout
+    return (!color || color->GetLayout() == vk::ImageLayout::eUndefined) &&
+           (!depth_stencil || depth_stencil->GetLayout() == vk::ImageLayout::eUndefined);
+}
+
 } // namespace VideoCore::Vulkan
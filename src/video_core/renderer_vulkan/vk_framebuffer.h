@@ -21,7 +21,7 @@ class Framebuffer : public VideoCore::FramebufferBase {
 public:
     Framebuffer(Instance& instance, CommandScheduler& scheduler, PoolManager& pool_manager,
                 const FramebufferInfo& info, vk::RenderPass load_renderpass,
-                vk::RenderPass clear_renderpass);
+                vk::RenderPass clear_renderpass, vk::RenderPass discard_renderpass);
     ~Framebuffer() override;
 
     void Free() override;
@@ -45,6 +45,19 @@ public:
         return clear_renderpass;
     }
 
+    // Returns the renderpass with VK_LOAD_OP_DONT_CARE (used when the contents are undefined)
+    vk::RenderPass GetDiscardRenderpass() const {
+        return discard_renderpass;
+    }
+
+    // Returns true when no attachment holds defined contents yet
+    bool IsContentUndefined() const;
+
+    // Returns the area covering the entire framebuffer
+    vk::Rect2D GetFullArea() const {
+        return vk::Rect2D{.offset = {0, 0}, .extent = {width, height}};
+    }
+
 private:
     Instance& instance;
     CommandScheduler& scheduler;
@@ -52,7 +65,8 @@ private:
 
     // Vulkan framebuffer
     vk::Framebuffer framebuffer;
-    vk::RenderPass load_renderpass, clear_renderpass;
+    vk::RenderPass load_renderpass, clear_renderpass, discard_renderpass;
+    u32 width = 0, height = 0;
 };
 
 } // namespace VideoCore::Vulkan
@@ -48,7 +48,11 @@ Instance::Instance(Frontend::EmuWindow& window) {
     // Create VkInstance
     instance = vk::createInstance(instance_info);
     VULKAN_HPP_DEFAULT_DISPATCHER.init(instance);
-    surface = CreateSurface(instance, window);
+
+    // Headless windows have no surface, the frames are then rendered without being presented
+    if (window_info.type != Frontend::WindowSystemType::Headless) {
+        surface = CreateSurface(instance, window);
+    }
 
     // TODO: GPU select dialog
     physical_device = instance.enumeratePhysicalDevices()[0];
@@ -62,7 +66,9 @@ Instance::~Instance() {
     device.waitIdle();
     vmaDestroyAllocator(allocator);
     device.destroy();
-    instance.destroySurfaceKHR(surface);
+    if (surface) {
+        instance.destroySurfaceKHR(surface);
+    }
     instance.destroy();
 }
 
@@ -79,8 +85,23 @@ bool Instance::CreateDevice(bool validation_enabled) {
         LOG_WARNING(Render_Vulkan, "Geometry shaders not availabe! Accelerated rendering not possible!");
     }
 
+    // Timeline semaphores are core in Vulkan 1.2 and let the scheduler track every submission
+    // with a single counter instead of a fence per command slot
+    if (vk::enumerateInstanceVersion() >= VK_API_VERSION_1_2 &&
+        physical_device.getProperties().apiVersion >= VK_API_VERSION_1_2) {
+        const auto timeline_chain = physical_device.getFeatures2<vk::PhysicalDeviceFeatures2,
+                                                                 vk::PhysicalDeviceTimelineSemaphoreFeatures>();
+        timeline_semaphores =
+            timeline_chain.get<vk::PhysicalDeviceTimelineSemaphoreFeatures>().timelineSemaphore;
+    }
+
+    vk::PhysicalDeviceTimelineSemaphoreFeatures timeline_features = {
+        .timelineSemaphore = true
+    };
+
     // Enable some common features other emulators like Dolphin use
     const vk::PhysicalDeviceFeatures2 features = {
+        .pNext = timeline_semaphores ? &timeline_features : nullptr,
         .features = {
             .robustBufferAccess = available.robustBufferAccess,
             .geometryShader = available.geometryShader,
@@ -139,7 +160,9 @@ bool Instance::CreateDevice(bool validation_enabled) {
     };
 
     // Add required extensions
-    AddExtension(VK_KHR_SWAPCHAIN_EXTENSION_NAME, true);
+    if (surface) {
+        AddExtension(VK_KHR_SWAPCHAIN_EXTENSION_NAME, true);
+    }
 
     // Check for optional features
     //dynamic_rendering = AddExtension(VK_KHR_DYNAMIC_RENDERING_EXTENSION_NAME, false);
@@ -160,15 +183,16 @@ bool Instance::CreateDevice(bool validation_enabled) {
         if (family_properties[i].queueFlags & vk::QueueFlagBits::eGraphics) {
             graphics_queue_family_index = i;
 
-            // If this queue also supports presentation we are finished
-            if (physical_device.getSurfaceSupportKHR(i, surface)) {
+            // If this queue also supports presentation we are finished. Without a surface
+            // nothing is presented, so the graphics queue is used for both
+            if (!surface || physical_device.getSurfaceSupportKHR(i, surface)) {
                 present_queue_family_index = i;
                 break;
             }
         }
 
         // Check if queue supports presentation
-        if (physical_device.getSurfaceSupportKHR(i, surface)) {
+        if (surface && physical_device.getSurfaceSupportKHR(i, surface)) {
             present_queue_family_index = i;
         }
     }
@@ -5,6 +5,7 @@
 #pragma once
 
 #include <memory>
+#include <mutex>
 #include "common/common_types.h"
 #include "video_core/renderer_vulkan/vk_common.h"
 
@@ -30,6 +31,11 @@ public:
         return surface;
     }
 
+    /// Returns true when there is no surface to present to
+    bool IsHeadless() const {
+        return !surface;
+    }
+
     /// Returns the current physical device
     vk::PhysicalDevice GetPhysicalDevice() const {
         return physical_device;
@@ -61,6 +67,11 @@ public:
         return present_queue;
     }
 
+    /// Returns the mutex that serializes submissions and presentation on the queues
+    std::mutex& GetQueueMutex() const {
+        return queue_mutex;
+    }
+
     /// Feature support
     bool IsDynamicRenderingSupported() const {
         return dynamic_rendering;
@@ -74,6 +85,10 @@ public:
         return push_descriptors;
     }
 
+    bool IsTimelineSemaphoreSupported() const {
+        return timeline_semaphores;
+    }
+
     /// Returns the minimum required alignment for uniforms
     vk::DeviceSize UniformMinAlignment() const {
         return device_limits.minUniformBufferOffsetAlignment;
@@ -93,6 +108,7 @@ private:
     // Queue family indexes
     u32 present_queue_family_index = 0, graphics_queue_family_index = 0;
     vk::Queue present_queue, graphics_queue;
+    mutable std::mutex queue_mutex;
 
     // Core vulkan objects
     vk::Device device;
@@ -106,6 +122,7 @@ private:
     bool dynamic_rendering = false;
     bool extended_dynamic_state = false;
     bool push_descriptors = false;
+    bool timeline_semaphores = false;
 };
 
 } // namespace VideoCore::Vulkan
@@ -390,9 +390,12 @@ void Pipeline::BindTexture(u32 group, u32 slot, TextureHandle handle) {
     Texture* texture = static_cast<Texture*>(handle.Get());
 
     // NOTE: To prevent validation errors when using the image without uploading
-    // transition it now to VK_IMAGE_LAYOUT_SHADER_READONLY_OPTIMAL
-    vk::CommandBuffer command_buffer = scheduler.GetRenderCommandBuffer();
-    texture->Transition(command_buffer, vk::ImageLayout::eShaderReadOnlyOptimal);
+    // transition it now to VK_IMAGE_LAYOUT_SHADER_READONLY_OPTIMAL. The barrier ends the
+    // active renderpass so skip it when the image is already in the right layout
+    if (texture->GetLayout() != vk::ImageLayout::eShaderReadOnlyOptimal) {
+        vk::CommandBuffer command_buffer = scheduler.GetRenderCommandBuffer();
+        texture->Transition(command_buffer, vk::ImageLayout::eShaderReadOnlyOptimal);
+    }
 
     const DescriptorData data = {
         .image_info = vk::DescriptorImageInfo{
@@ -441,7 +444,7 @@ void Pipeline::BindSampler(u32 group, u32 slot, SamplerHandle handle) {
 }
 
 void Pipeline::BindPushConstant(std::span<const std::byte> data) {
-    vk::CommandBuffer command_buffer = scheduler.GetRenderCommandBuffer();
+    vk::CommandBuffer command_buffer = scheduler.GetRenderpassCommandBuffer();
     command_buffer.pushConstants(owner.GetLayout(),
                                  vk::ShaderStageFlagBits::eVertex | vk::ShaderStageFlagBits::eFragment,
                                  0, data.size(), data.data());
@@ -449,17 +452,17 @@ void Pipeline::BindPushConstant(std::span<const std::byte> data) {
 
 // Viewport and scissor are always dynamic
 void Pipeline::SetViewport(float x, float y, float width, float height) {
-    vk::CommandBuffer command_buffer = scheduler.GetRenderCommandBuffer();
+    vk::CommandBuffer command_buffer = scheduler.GetRenderpassCommandBuffer();
     command_buffer.setViewport(0, vk::Viewport{x, y, width, height, 0.f, 1.f});
 }
 
 void Pipeline::SetScissor(s32 x, s32 y, u32 width, u32 height) {
-    vk::CommandBuffer command_buffer = scheduler.GetRenderCommandBuffer();
+    vk::CommandBuffer command_buffer = scheduler.GetRenderpassCommandBuffer();
     command_buffer.setScissor(0, vk::Rect2D{{x, y}, {width, height}});
 }
 
 void Pipeline::ApplyDynamic(const PipelineInfo& info) {
-    vk::CommandBuffer command_buffer = scheduler.GetRenderCommandBuffer();
+    vk::CommandBuffer command_buffer = scheduler.GetRenderpassCommandBuffer();
     command_buffer.setStencilCompareMask(vk::StencilFaceFlagBits::eFrontAndBack, info.depth_stencil.stencil_compare_mask);
     command_buffer.setStencilWriteMask(vk::StencilFaceFlagBits::eFrontAndBack, info.depth_stencil.stencil_write_mask);
     command_buffer.setStencilReference(vk::StencilFaceFlagBits::eFrontAndBack, info.depth_stencil.stencil_reference);
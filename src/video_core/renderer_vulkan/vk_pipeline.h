@@ -5,6 +5,9 @@
 #pragma once
 
 #include <array>
+#include <cstring>
+#include <unordered_map>
+#include "common/hash.h"
 #include "video_core/common/pipeline.h"
 #include "video_core/renderer_vulkan/vk_common.h"
 
@@ -70,6 +73,16 @@ public:
         return update_templates.at(set);
     }
 
+    // Returns the hash of the resources currently assigned to the provided set index
+    u64 GetDataHash(u32 set) const {
+        return Common::ComputeHash64(update_data.at(set).data(), sizeof(SetData));
+    }
+
+    // Returns true when the resources assigned to the provided set index match the given data
+    bool IsDataEqual(u32 set, const void* data) const {
+        return std::memcmp(update_data.at(set).data(), data, sizeof(SetData)) == 0;
+    }
+
 private:
     Instance& instance;
     vk::PipelineLayout pipeline_layout = VK_NULL_HANDLE;
@@ -82,6 +95,17 @@ private:
     using SetData = std::array<DescriptorData, MAX_BINDINGS_IN_GROUP>;
     std::array<SetData, MAX_BINDING_GROUPS> update_data{};
     std::array<bool, MAX_BINDING_GROUPS> descriptor_dirty{true};
+
+    // Descriptor sets written during the current command slot keyed by the hash of their data.
+    // Switching back to a previously bound resource tuple reuses the set instead of allocating.
+    // The data is kept alongside the set so that hash collisions are detected on lookup
+    struct CachedSet {
+        SetData data;
+        vk::DescriptorSet set;
+    };
+
+    using SetCache = std::unordered_map<u64, CachedSet, Common::IdentityHash>;
+    std::array<SetCache, MAX_BINDING_GROUPS> set_cache;
 };
 
 class Pipeline : public VideoCore::PipelineBase {
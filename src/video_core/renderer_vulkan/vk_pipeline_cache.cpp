@@ -0,0 +1,224 @@
+// Copyright 2022 Citra Emulator Project
+// Licensed under GPLv2 or any later version
+// Refer to the license.txt file included.
+
+#define VULKAN_HPP_NO_CONSTRUCTORS
+#include <array>
+#include <cstring>
+#include "common/file_util.h"
+#include "common/hash.h"
+#include "common/logging/log.h"
+#include "video_core/renderer_vulkan/vk_instance.h"
+#include "video_core/renderer_vulkan/vk_pipeline_cache.h"
+
+namespace VideoCore::Vulkan {
+
+// Minimum time between two periodic saves of the pipeline cache
+constexpr auto SAVE_INTERVAL = std::chrono::seconds{30};
+
+constexpr u32 CACHE_MAGIC = 0x43504B56; // VKPC
+constexpr u32 CACHE_VERSION = 1;
+
+// Header written in front of the driver blob. The driver version isn't part of the
+// blob header so it's stored here to discard the cache after driver updates
+struct CacheFileHeader {
+    u32 magic;
+    u32 version;
+    u32 driver_version;
+    u32 reserved;
+    u64 data_size;
+    u64 data_hash;
+};
+
+// Layout of VK_PIPELINE_CACHE_HEADER_VERSION_ONE at the start of the driver blob
+struct DriverBlobHeader {
+    u32 header_size;
+    u32 header_version;
+    u32 vendor_id;
+    u32 device_id;
+    std::array<u8, VK_UUID_SIZE> cache_uuid;
+};
+
+ShardedPipelineCache::ShardedPipelineCache(const Instance& instance)
+    : instance(instance), properties(instance.GetPhysicalDevice().getProperties()),
+      last_save(std::chrono::steady_clock::now()) {
+    initial_data = Load();
+
+    const vk::PipelineCacheCreateInfo cache_info = {
+        .initialDataSize = initial_data.size(),
+        .pInitialData = initial_data.data()
+    };
+
+    vk::Device device = instance.GetDevice();
+    merged_cache = device.createPipelineCache(cache_info);
+}
+
+ShardedPipelineCache::~ShardedPipelineCache() {
+    save_worker.WaitForRequests();
+    Save();
+
+    vk::Device device = instance.GetDevice();
+    for (const auto& [thread_id, shard] : shards) {
+        device.destroyPipelineCache(shard);
+    }
+
+    device.destroyPipelineCache(merged_cache);
+}
+
+vk::PipelineCache ShardedPipelineCache::GetThreadCache() {
+    std::scoped_lock lock{shard_mutex};
+    const std::thread::id thread_id = std::this_thread::get_id();
+    if (auto iter = shards.find(thread_id); iter != shards.end()) {
+        return iter->second;
+    }
+
+    // Seed every shard with the disk data so all threads benefit from it
+    const vk::PipelineCacheCreateInfo cache_info = {
+        .initialDataSize = initial_data.size(),
+        .pInitialData = initial_data.data()
+    };
+
+    vk::Device device = instance.GetDevice();
+    vk::PipelineCache shard = device.createPipelineCache(cache_info);
+    shards.emplace(thread_id, shard);
+
+    return shard;
+}
+
+void ShardedPipelineCache::PeriodicSave() {
+    if (new_pipelines.load(std::memory_order_relaxed) == 0) {
+        return;
+    }
+
+    // Skip this save if the previous one is still running, it will be retried next interval
+    const auto now = std::chrono::steady_clock::now();
+    if (now - last_save < SAVE_INTERVAL || save_worker.NumPendingTasks() != 0) {
+        return;
+    }
+
+    last_save = now;
+    save_worker.QueueWork([this] { Save(); });
+}
+
+void ShardedPipelineCache::Save() {
+    std::scoped_lock lock{save_mutex};
+    // Pipelines created while saving are counted again, they might miss the merge below
+    const u32 pending = new_pipelines.exchange(0);
+    if (pending == 0) {
+        return;
+    }
+
+    std::vector<vk::PipelineCache> sources;
+    {
+        std::scoped_lock shard_lock{shard_mutex};
+        sources.reserve(shards.size());
+        for (const auto& [thread_id, shard] : shards) {
+            sources.push_back(shard);
+        }
+    }
+
+    // Pipeline caches are internally synchronized so the shards can keep being used
+    vk::Device device = instance.GetDevice();
+    if (!sources.empty()) {
+        device.mergePipelineCaches(merged_cache, sources);
+    }
+
+    const std::vector<u8> data = device.getPipelineCacheData(merged_cache);
+    const CacheFileHeader header = {
+        .magic = CACHE_MAGIC,
+        .version = CACHE_VERSION,
+        .driver_version = properties.driverVersion,
+        .reserved = 0,
+        .data_size = data.size(),
+        .data_hash = Common::ComputeHash64(data.data(), data.size())
+    };
+
+    // Write to a temporary file first so a crash while saving doesn't corrupt the cache
+    const std::string path = GetCachePath();
+    const std::string temp_path = path + ".tmp";
+    {
+        FileUtil::IOFile file{temp_path, "wb"};
+        if (file.WriteObject(header) != 1 ||
+            file.WriteBytes(data.data(), data.size()) != data.size()) {
+            LOG_ERROR(Render_Vulkan, "Failed to write pipeline cache to {}", temp_path);
+            new_pipelines.fetch_add(pending, std::memory_order_relaxed);
+            return;
+        }
+    }
+
+    if (!FileUtil::Replace(temp_path, path)) {
+        LOG_ERROR(Render_Vulkan, "Failed to move pipeline cache to {}", path);
+        new_pipelines.fetch_add(pending, std::memory_order_relaxed);
+        return;
+    }
+
+    LOG_DEBUG(Render_Vulkan, "Saved {} bytes of pipeline cache data", data.size());
+}
+
+std::vector<u8> ShardedPipelineCache::Load() {
+    const std::string path = GetCachePath();
+    if (!FileUtil::Exists(path)) {
+        return {};
+    }
+
+    FileUtil::IOFile file{path, "rb"};
+    CacheFileHeader header{};
+    if (file.ReadBytes(&header, sizeof(header)) != sizeof(header) || header.magic != CACHE_MAGIC ||
+        header.version != CACHE_VERSION) {
+        LOG_WARNING(Render_Vulkan, "Pipeline cache file is invalid, ignoring it");
+        return {};
+    }
+
+    if (header.driver_version != properties.driverVersion) {
+        LOG_INFO(Render_Vulkan, "Driver version changed, ignoring pipeline cache");
+        return {};
+    }
+
+    // Don't trust the size in the header before it has been checked against the file
+    const u64 file_size = file.GetSize();
+    if (file_size < sizeof(header) || header.data_size > file_size - sizeof(header)) {
+        LOG_WARNING(Render_Vulkan, "Pipeline cache file is truncated, ignoring it");
+        return {};
+    }
+
+    std::vector<u8> data(header.data_size);
+    if (file.ReadBytes(data.data(), data.size()) != data.size() ||
+        Common::ComputeHash64(data.data(), data.size()) != header.data_hash) {
+        LOG_WARNING(Render_Vulkan, "Pipeline cache file is corrupted, ignoring it");
+        return {};
+    }
+
+    if (!IsCompatible(data)) {
+        LOG_INFO(Render_Vulkan, "Pipeline cache was created by a different device, ignoring it");
+        return {};
+    }
+
+    LOG_INFO(Render_Vulkan, "Loaded {} bytes of pipeline cache data", data.size());
+    return data;
+}
+
+bool ShardedPipelineCache::IsCompatible(std::span<const u8> data) const {
+    if (data.size() < sizeof(DriverBlobHeader)) {
+        return false;
+    }
+
+    DriverBlobHeader header;
+    std::memcpy(&header, data.data(), sizeof(header));
+
+    return header.header_size >= sizeof(DriverBlobHeader) &&
+           header.header_version == static_cast<u32>(vk::PipelineCacheHeaderVersion::eOne) &&
+           header.vendor_id == properties.vendorID && header.device_id == properties.deviceID &&
+           std::memcmp(header.cache_uuid.data(), properties.pipelineCacheUUID.data(),
+                       VK_UUID_SIZE) == 0;
+}
+
+std::string ShardedPipelineCache::GetCachePath() const {
+    const std::string dir = FileUtil::GetUserPath(FileUtil::UserPath::ShaderDir) + DIR_SEP "vulkan";
+    if (!FileUtil::CreateFullPath(dir + DIR_SEP)) {
+        LOG_ERROR(Render_Vulkan, "Failed to create directory={}", dir);
+    }
+
+    return dir + DIR_SEP "pipeline_cache.bin";
+}
+
+} // namespace VideoCore::Vulkan
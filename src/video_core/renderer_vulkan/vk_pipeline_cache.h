@@ -0,0 +1,75 @@
+// Copyright 2022 Citra Emulator Project
+// Licensed under GPLv2 or any later version
+// Refer to the license.txt file included.
+
+#pragma once
+
+#include <atomic>
+#include <chrono>
+#include <mutex>
+#include <span>
+#include <string>
+#include <thread>
+#include <unordered_map>
+#include <vector>
+#include "common/common_types.h"
+#include "common/thread_worker.h"
+#include "video_core/renderer_vulkan/vk_common.h"
+
+namespace VideoCore::Vulkan {
+
+class Instance;
+
+/**
+ * Manages the driver pipeline cache. Every thread that creates pipelines gets its own
+ * VkPipelineCache shard to avoid contention inside the driver. The shards are merged with
+ * vkMergePipelineCaches and the result is periodically written to disk, so a crash only loses
+ * the pipelines built since the last save.
+ */
+class ShardedPipelineCache {
+public:
+    ShardedPipelineCache(const Instance& instance);
+    ~ShardedPipelineCache();
+
+    // Returns the pipeline cache shard owned by the calling thread
+    vk::PipelineCache GetThreadCache();
+
+    // Notifies that a new pipeline was created and the cache contents changed
+    void MarkDirty() {
+        new_pipelines.fetch_add(1, std::memory_order_relaxed);
+    }
+
+    // Saves the cache in the background if it changed and enough time has passed since the
+    // last save. The merge and the disk write never block the calling thread
+    void PeriodicSave();
+
+    // Merges all shards and writes the result to disk
+    void Save();
+
+private:
+    // Reads the cache file and returns its contents if they are usable by the current device
+    std::vector<u8> Load();
+
+    // Returns true when the driver blob header matches the current physical device
+    bool IsCompatible(std::span<const u8> data) const;
+
+    std::string GetCachePath() const;
+
+private:
+    const Instance& instance;
+    vk::PhysicalDeviceProperties properties;
+
+    // Receives the shard contents when merging, also holds the data loaded from disk
+    vk::PipelineCache merged_cache;
+    std::vector<u8> initial_data;
+
+    std::mutex shard_mutex;
+    std::unordered_map<std::thread::id, vk::PipelineCache> shards;
+
+    std::mutex save_mutex;
+    std::atomic<u32> new_pipelines{0};
+    std::chrono::steady_clock::time_point last_save;
+    Common::ThreadWorker save_worker{1, "VkPipelineCacheSave"};
+};
+
+} // namespace VideoCore::Vulkan
@@ -26,6 +26,12 @@ static constexpr std::array depth_stencil_formats = {
     vk::Format::eD24UnormS8Uint,
 };
 
+static constexpr std::array LOAD_OPS = {
+    vk::AttachmentLoadOp::eLoad,
+    vk::AttachmentLoadOp::eClear,
+    vk::AttachmentLoadOp::eDontCare
+};
+
 RenderpassCache::RenderpassCache(Instance& instance) : instance(instance) {
     // Pre-create all needed renderpasses by the renderer
     for (u32 color = 0; color <= MAX_COLOR_FORMATS; color++) {
@@ -37,15 +43,13 @@ RenderpassCache::RenderpassCache(Instance& instance) : instance(instance) {
             vk::Format color_format = instance.GetFormatAlternative(color_formats[color]);
             vk::Format depth_stencil_format = instance.GetFormatAlternative(depth_stencil_formats[depth]);
 
-            // Construct both load and clear pass
-            cached_renderpasses[color][depth][0] = CreateRenderPass(color_format, depth_stencil_format,
-                                                                    vk::AttachmentLoadOp::eLoad,
-                                                                    vk::ImageLayout::eColorAttachmentOptimal,
-                                                                    vk::ImageLayout::eColorAttachmentOptimal);
-            cached_renderpasses[color][depth][1] = CreateRenderPass(color_format, depth_stencil_format,
-                                                                    vk::AttachmentLoadOp::eClear,
-                                                                    vk::ImageLayout::eColorAttachmentOptimal,
-                                                                    vk::ImageLayout::eColorAttachmentOptimal);
+            // Construct the load, clear and dont care pass
+            for (const auto load_op : LOAD_OPS) {
+                cached_renderpasses[color][depth][static_cast<u32>(load_op)] =
+                        CreateRenderPass(color_format, depth_stencil_format, load_op,
+                                         vk::ImageLayout::eColorAttachmentOptimal,
+                                         vk::ImageLayout::eColorAttachmentOptimal);
+            }
         }
     }
 }
@@ -58,12 +62,10 @@ RenderpassCache::~RenderpassCache() {
                 continue;
              }
 
-            auto& load_pass = cached_renderpasses[color][depth][0];
-            auto& clear_pass = cached_renderpasses[color][depth][1];
-
             // Destroy renderpasses
-            device.destroyRenderPass(load_pass);
-            device.destroyRenderPass(clear_pass);
+            for (const auto load_op : LOAD_OPS) {
+                device.destroyRenderPass(cached_renderpasses[color][depth][static_cast<u32>(load_op)]);
+            }
         }
     }
 
@@ -79,12 +81,13 @@ void RenderpassCache::CreatePresentRenderpass(vk::Format format) {
     }
 }
 
-vk::RenderPass RenderpassCache::GetRenderpass(TextureFormat color, TextureFormat depth, bool is_clear) const {
+vk::RenderPass RenderpassCache::GetRenderpass(TextureFormat color, TextureFormat depth,
+                                              vk::AttachmentLoadOp load_op) const {
     const u32 color_index = static_cast<u32>(color);
     const u32 depth_index = (depth == TextureFormat::Undefined ? 0 : (static_cast<u32>(depth) - MAX_COLOR_FORMATS));
 
     ASSERT(color_index <= MAX_COLOR_FORMATS && depth_index <= MAX_DEPTH_FORMATS);
-    return cached_renderpasses[color_index][depth_index][is_clear];
+    return cached_renderpasses[color_index][depth_index][static_cast<u32>(load_op)];
 }
 
 vk::RenderPass RenderpassCache::CreateRenderPass(vk::Format color, vk::Format depth, vk::AttachmentLoadOp load_op,
@@ -119,12 +122,17 @@ vk::RenderPass RenderpassCache::CreateRenderPass(vk::Format color, vk::Format de
     }
 
     if (depth != vk::Format::eUndefined) {
+        // Formats without stencil don't need to load or store it
+        const bool has_stencil = depth == vk::Format::eD24UnormS8Uint ||
+                                 depth == vk::Format::eD32SfloatS8Uint ||
+                                 depth == vk::Format::eD16UnormS8Uint;
         attachments[attachment_count] = vk::AttachmentDescription{
             .format = depth,
             .loadOp = load_op,
             .storeOp = vk::AttachmentStoreOp::eStore,
-            .stencilLoadOp = vk::AttachmentLoadOp::eLoad,
-            .stencilStoreOp = vk::AttachmentStoreOp::eStore,
+            .stencilLoadOp = has_stencil ? load_op : vk::AttachmentLoadOp::eDontCare,
+            .stencilStoreOp = has_stencil ? vk::AttachmentStoreOp::eStore
+                                          : vk::AttachmentStoreOp::eDontCare,
             .initialLayout = vk::ImageLayout::eDepthStencilAttachmentOptimal,
             .finalLayout = vk::ImageLayout::eDepthStencilAttachmentOptimal
         };
@@ -19,7 +19,9 @@ public:
     // Creates the renderpass used when rendering to the swapchain
     void CreatePresentRenderpass(vk::Format format);
 
-    vk::RenderPass GetRenderpass(TextureFormat color, TextureFormat depth, bool is_clear) const;
+    // Returns the renderpass for the provided attachment formats and load operation
+    vk::RenderPass GetRenderpass(TextureFormat color, TextureFormat depth,
+                                 vk::AttachmentLoadOp load_op) const;
 
     // Returns the special swapchain renderpass
     vk::RenderPass GetPresentRenderpass() const {
@@ -35,8 +37,8 @@ private:
 
     // Special renderpass used for rendering to the swapchain
     vk::RenderPass present_renderpass;
-    // [color_format][depth_format][is_clear_pass]
-    vk::RenderPass cached_renderpasses[MAX_COLOR_FORMATS+1][MAX_DEPTH_FORMATS+1][2];
+    // [color_format][depth_format][load_op] where load_op is one of LOAD, CLEAR or DONT_CARE
+    vk::RenderPass cached_renderpasses[MAX_COLOR_FORMATS+1][MAX_DEPTH_FORMATS+1][3];
 };
 
 } // namespace VideoCore::Vulkan
@@ -138,21 +138,19 @@ EShLanguage ToEshShaderStage(ShaderStage stage) {
 }
 
 bool InitializeCompiler() {
-    static bool glslang_initialized = false;
-
-    if (glslang_initialized) {
+    // Shaders can be compiled from multiple threads when loading the disk cache,
+    // function local statics guarantee the process is initialized exactly once
+    static const bool glslang_initialized = [] {
+        if (!glslang::InitializeProcess()) {
+            LOG_CRITICAL(Render_Vulkan, "Failed to initialize glslang shader compiler");
+            return false;
+        }
+
+        std::atexit([]() { glslang::FinalizeProcess(); });
         return true;
-    }
-
-    if (!glslang::InitializeProcess()) {
-        LOG_CRITICAL(Render_Vulkan, "Failed to initialize glslang shader compiler");
-        return false;
-    }
-
-    std::atexit([]() { glslang::FinalizeProcess(); });
+    }();
 
-    glslang_initialized = true;
-    return true;
+    return glslang_initialized;
 }
 
 Shader::Shader(Instance& instance, PoolManager& pool_manager, ShaderStage stage, std::string_view name,
@@ -225,9 +223,20 @@ bool Shader::Compile(ShaderOptimization level) {
         LOG_INFO(Render_Vulkan, "SPIR-V conversion messages: {}", spv_messages);
     }
 
+    spirv = std::move(out_code);
+    return LoadBinary(spirv);
+}
+
+bool Shader::LoadBinary(std::span<const u32> binary) {
+    constexpr u32 SPIRV_MAGIC = 0x07230203;
+    if (binary.empty() || binary[0] != SPIRV_MAGIC) {
+        LOG_ERROR(Render_Vulkan, "Shader binary is not a valid SPIR-V module");
+        return false;
+    }
+
     const vk::ShaderModuleCreateInfo shader_info = {
-        .codeSize = out_code.size() * sizeof(u32),
-        .pCode = out_code.data()
+        .codeSize = binary.size_bytes(),
+        .pCode = binary.data()
     };
 
     vk::Device device = instance.GetDevice();
@@ -25,6 +25,16 @@ public:
 
     bool Compile(ShaderOptimization level) override;
 
+    std::span<const u32> GetBinary() const override {
+        return spirv;
+    }
+
+    void ReleaseBinary() override {
+        spirv = {};
+    }
+
+    bool LoadBinary(std::span<const u32> binary) override;
+
     /// Returns the underlying vulkan shader module handle
     vk::ShaderModule GetHandle() const {
         return module;
@@ -34,6 +44,7 @@ private:
     Instance& instance;
     PoolManager& pool_manager;
     vk::ShaderModule module;
+    std::vector<u32> spirv; ///< Compiled module, kept until it's written to the disk cache
 };
 
 } // namespace VideoCore::Vulkan
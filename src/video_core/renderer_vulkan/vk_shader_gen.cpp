@@ -7,6 +7,7 @@
 #include "common/bit_field.h"
 #include "common/logging/log.h"
 #include "core/core.h"
+#include "video_core/common/pica_uniforms.h"
 #include "video_core/renderer_vulkan/vk_shader_gen.h"
 
 using Pica::FramebufferRegs;
@@ -66,6 +67,87 @@ layout (std140, set = 0, binding = 1) uniform shader_data {
 };
 )";
 
+constexpr std::string_view FragmentShaderBindingsDef = R"(
+    in vec4 gl_FragCoord;
+
+    layout (location = 0) out vec4 color;
+
+
+    layout(set = 0, binding = 2) uniform samplerBuffer texture_buffer_lut_lf;
+    layout(set = 0, binding = 3) uniform samplerBuffer texture_buffer_lut_rg;
+    layout(set = 0, binding = 4) uniform samplerBuffer texture_buffer_lut_rgba;
+
+    layout(set = 1, binding = 0) uniform texture2D tex0;
+    layout(set = 1, binding = 1) uniform texture2D tex1;
+    layout(set = 1, binding = 2) uniform texture2D tex2;
+    layout(set = 1, binding = 3) uniform textureCube tex_cube;
+
+    layout(set = 2, binding = 0) uniform sampler tex0_sampler;
+    layout(set = 2, binding = 1) uniform sampler tex1_sampler;
+    layout(set = 2, binding = 2) uniform sampler tex2_sampler;
+    layout(set = 2, binding = 3) uniform sampler tex_cube_sampler;
+
+    #if ALLOW_SHADOW
+    layout(r32ui) uniform readonly uimage2D shadow_texture_px;
+    layout(r32ui) uniform readonly uimage2D shadow_texture_nx;
+    layout(r32ui) uniform readonly uimage2D shadow_texture_py;
+    layout(r32ui) uniform readonly uimage2D shadow_texture_ny;
+    layout(r32ui) uniform readonly uimage2D shadow_texture_pz;
+    layout(r32ui) uniform readonly uimage2D shadow_texture_nz;
+    layout(r32ui) uniform uimage2D shadow_buffer;
+    #endif
+)";
+
+constexpr std::string_view FragmentShaderHelpersDef = R"(
+    // Rotate the vector v by the quaternion q
+    vec3 quaternion_rotate(vec4 q, vec3 v) {
+        return v + 2.0 * cross(q.xyz, cross(q.xyz, v) + q.w * v);
+    }
+
+    float LookupLightingLUT(int lut_index, int index, float delta) {
+        vec2 entry = texelFetch(texture_buffer_lut_lf, lighting_lut_offset[lut_index >> 2][lut_index & 3] + index).rg;
+        return entry.r + entry.g * delta;
+    }
+
+    float LookupLightingLUTUnsigned(int lut_index, float pos) {
+        int index = clamp(int(pos * 256.0), 0, 255);
+        float delta = pos * 256.0 - float(index);
+        return LookupLightingLUT(lut_index, index, delta);
+    }
+
+    float LookupLightingLUTSigned(int lut_index, float pos) {
+        int index = clamp(int(pos * 128.0), -128, 127);
+        float delta = pos * 128.0 - float(index);
+        if (index < 0) index += 256;
+        return LookupLightingLUT(lut_index, index, delta);
+    }
+
+    float byteround(float x) {
+        return round(x * 255.0) * (1.0 / 255.0);
+    }
+
+    vec2 byteround(vec2 x) {
+        return round(x * 255.0) * (1.0 / 255.0);
+    }
+
+    vec3 byteround(vec3 x) {
+        return round(x * 255.0) * (1.0 / 255.0);
+    }
+
+    vec4 byteround(vec4 x) {
+        return round(x * 255.0) * (1.0 / 255.0);
+    }
+
+    // PICA's LOD formula for 2D textures.
+    // This LOD formula is the same as the LOD lower limit defined in OpenGL.
+    // f(x, y) >= max{m_u, m_v, m_w}
+    // (See OpenGL 4.6 spec, 8.14.1 - Scale Factor and Level-of-Detail)
+    float getLod(vec2 coord) {
+        vec2 d = max(abs(dFdx(coord)), abs(dFdy(coord)));
+        return log2(max(d.x, d.y));
+    }
+)";
+
 static std::string GetVertexInterfaceDeclaration(bool is_output) {
     std::string out;
 
@@ -1037,87 +1119,13 @@ std::string ShaderGenerator::GenerateFragmentShader(const PicaFSConfig& config)
 
     out += GetVertexInterfaceDeclaration(false);
 
-    out += R"(
-    in vec4 gl_FragCoord;
-
-    layout (location = 0) out vec4 color;
-
-
-    layout(set = 0, binding = 2) uniform samplerBuffer texture_buffer_lut_lf;
-    layout(set = 0, binding = 3) uniform samplerBuffer texture_buffer_lut_rg;
-    layout(set = 0, binding = 4) uniform samplerBuffer texture_buffer_lut_rgba;
-
-    layout(set = 1, binding = 0) uniform texture2D tex0;
-    layout(set = 1, binding = 1) uniform texture2D tex1;
-    layout(set = 1, binding = 2) uniform texture2D tex2;
-    layout(set = 1, binding = 3) uniform textureCube tex_cube;
-
-    layout(set = 2, binding = 0) uniform sampler tex0_sampler;
-    layout(set = 2, binding = 1) uniform sampler tex1_sampler;
-    layout(set = 2, binding = 2) uniform sampler tex2_sampler;
-    layout(set = 2, binding = 3) uniform sampler tex_cube_sampler;
-
-    #if ALLOW_SHADOW
-    layout(r32ui) uniform readonly uimage2D shadow_texture_px;
-    layout(r32ui) uniform readonly uimage2D shadow_texture_nx;
-    layout(r32ui) uniform readonly uimage2D shadow_texture_py;
-    layout(r32ui) uniform readonly uimage2D shadow_texture_ny;
-    layout(r32ui) uniform readonly uimage2D shadow_texture_pz;
-    layout(r32ui) uniform readonly uimage2D shadow_texture_nz;
-    layout(r32ui) uniform uimage2D shadow_buffer;
-    #endif
-    )";
+    out += FragmentShaderBindingsDef;
 
     out += UniformBlockDef;
 
-    out += R"(
-    // Rotate the vector v by the quaternion q
-    vec3 quaternion_rotate(vec4 q, vec3 v) {
-        return v + 2.0 * cross(q.xyz, cross(q.xyz, v) + q.w * v);
-    }
-
-    float LookupLightingLUT(int lut_index, int index, float delta) {
-        vec2 entry = texelFetch(texture_buffer_lut_lf, lighting_lut_offset[lut_index >> 2][lut_index & 3] + index).rg;
-        return entry.r + entry.g * delta;
-    }
-
-    float LookupLightingLUTUnsigned(int lut_index, float pos) {
-        int index = clamp(int(pos * 256.0), 0, 255);
-        float delta = pos * 256.0 - float(index);
-        return LookupLightingLUT(lut_index, index, delta);
-    }
-
-    float LookupLightingLUTSigned(int lut_index, float pos) {
-        int index = clamp(int(pos * 128.0), -128, 127);
-        float delta = pos * 128.0 - float(index);
-        if (index < 0) index += 256;
-        return LookupLightingLUT(lut_index, index, delta);
-    }
-
-    float byteround(float x) {
-        return round(x * 255.0) * (1.0 / 255.0);
-    }
-
-    vec2 byteround(vec2 x) {
-        return round(x * 255.0) * (1.0 / 255.0);
-    }
-
-    vec3 byteround(vec3 x) {
-        return round(x * 255.0) * (1.0 / 255.0);
-    }
+    out += FragmentShaderHelpersDef;
 
-    vec4 byteround(vec4 x) {
-        return round(x * 255.0) * (1.0 / 255.0);
-    }
-
-    // PICA's LOD formula for 2D textures.
-    // This LOD formula is the same as the LOD lower limit defined in OpenGL.
-    // f(x, y) >= max{m_u, m_v, m_w}
-    // (See OpenGL 4.6 spec, 8.14.1 - Scale Factor and Level-of-Detail)
-    float getLod(vec2 coord) {
-        vec2 d = max(abs(dFdx(coord)), abs(dFdy(coord)));
-        return log2(max(d.x, d.y));
-    }
+    out += R"(
 
     #if ALLOW_SHADOW
 
@@ -1384,6 +1392,524 @@ do {
     return out;
 }
 
+constexpr std::string_view UberShaderBlockDef = R"(
+layout (std140, set = 0, binding = 5) uniform uber_data {
+    int alpha_test_func;
+    int scissor_mode;
+    int texture0_type;
+    int texture2_use_coord1;
+    int combiner_buffer_input;
+    int w_buffering;
+    int fog_mode;
+    int fog_flip;
+    int lighting_enable;
+    int lighting_src_num;
+    int bump_mode;
+    int bump_selector;
+    int bump_renorm;
+    int clamp_highlights_enable;
+    int enable_primary_alpha;
+    int enable_secondary_alpha;
+    int enable_shadow;
+    int shadow_primary;
+    int shadow_secondary;
+    int shadow_invert;
+    int shadow_alpha;
+    int shadow_selector;
+    uvec4 tev_stages[NUM_TEV_STAGES];
+    ivec4 light_config[NUM_LIGHTS];
+    ivec4 lut_config[7];
+    vec4 lut_scale[2];
+};
+)";
+
+std::string ShaderGenerator::GenerateFragmentUberShader() {
+    std::string out;
+
+    out += R"(
+    #version 450
+    )";
+    out += "#extension GL_ARB_separate_shader_objects : enable\n";
+
+    out += GetVertexInterfaceDeclaration(false);
+    out += FragmentShaderBindingsDef;
+    out += UniformBlockDef;
+    out += UberShaderBlockDef;
+    out += FragmentShaderHelpersDef;
+
+    // Light flags and LUT indices must match the layout written by UberShaderData
+    out += fmt::format(R"(
+#define LIGHT_DIRECTIONAL {}
+#define LIGHT_TWO_SIDED_DIFFUSE {}
+#define LIGHT_DIST_ATTEN {}
+#define LIGHT_SPOT_ATTEN {}
+#define LIGHT_GEOMETRIC_FACTOR_0 {}
+#define LIGHT_GEOMETRIC_FACTOR_1 {}
+#define LIGHT_SHADOW {}
+
+#define LUT_D0 0
+#define LUT_D1 1
+#define LUT_SP 2
+#define LUT_FR 3
+#define LUT_RR 4
+#define LUT_RG 5
+#define LUT_RB 6
+)",
+                       UberShaderData::LightDirectional, UberShaderData::LightTwoSidedDiffuse,
+                       UberShaderData::LightDistAtten, UberShaderData::LightSpotAtten,
+                       UberShaderData::LightGeometricFactor0,
+                       UberShaderData::LightGeometricFactor1, UberShaderData::LightShadow);
+
+    out += R"(
+// Shadow textures are not implemented by this backend, see ALLOW_SHADOW
+vec4 shadowTexture(vec2 uv, float w) {
+    return vec4(1.0);
+}
+
+vec4 shadowTextureCube(vec2 uv, float w) {
+    return vec4(1.0);
+}
+
+vec4 rounded_primary_color;
+vec4 primary_fragment_color;
+vec4 secondary_fragment_color;
+vec4 combiner_buffer;
+vec4 next_combiner_buffer;
+vec4 last_tex_env_out;
+
+// Texture units are sampled once up front since TEV stages may read them multiple times.
+// The fourth unit is the procedural texture which is not supported by the ubershader
+vec4 tex_color[4];
+
+vec3 normal;
+vec3 tangent;
+vec3 light_vector;
+vec3 half_vector;
+vec3 spot_dir;
+
+vec4 SampleTexture(int unit) {
+    switch (unit) {
+    case 0:
+        // Only unit 0 respects the texturing type
+        switch (texture0_type) {
+        case 0: // Texture2D
+            return textureLod(sampler2D(tex0, tex0_sampler), texcoord0, getLod(texcoord0 * vec2(textureSize(sampler2D(tex0, tex0_sampler), 0))));
+        case 1: // TextureCube
+            return texture(samplerCube(tex_cube, tex_cube_sampler), vec3(texcoord0, texcoord0_w));
+        case 2: // Shadow2D
+            return shadowTexture(texcoord0, texcoord0_w);
+        case 3: // Projection2D
+            return textureProj(sampler2D(tex0, tex0_sampler), vec3(texcoord0, texcoord0_w));
+        case 4: // ShadowCube
+            return shadowTextureCube(texcoord0, texcoord0_w);
+        default: // Disabled
+            return vec4(0.0);
+        }
+    case 1:
+        return textureLod(sampler2D(tex1, tex1_sampler), texcoord1, getLod(texcoord1 * vec2(textureSize(sampler2D(tex1, tex1_sampler), 0))));
+    case 2: {
+        vec2 coord = texture2_use_coord1 != 0 ? texcoord1 : texcoord2;
+        return textureLod(sampler2D(tex2, tex2_sampler), coord, getLod(coord * vec2(textureSize(sampler2D(tex2, tex2_sampler), 0))));
+    }
+    default:
+        return vec4(0.0);
+    }
+}
+
+vec4 GetSource(uint source, int stage) {
+    switch (source) {
+    case 0u: return rounded_primary_color;
+    case 1u: return primary_fragment_color;
+    case 2u: return secondary_fragment_color;
+    case 3u: return tex_color[0];
+    case 4u: return tex_color[1];
+    case 5u: return tex_color[2];
+    case 6u: return tex_color[3];
+    case 13u: return combiner_buffer;
+    case 14u: return const_color[stage];
+    case 15u: return last_tex_env_out;
+    default: return vec4(0.0);
+    }
+}
+
+vec3 ColorModifier(uint modifier, vec4 value) {
+    switch (modifier) {
+    case 0u: return value.rgb;
+    case 1u: return vec3(1.0) - value.rgb;
+    case 2u: return value.aaa;
+    case 3u: return vec3(1.0) - value.aaa;
+    case 4u: return value.rrr;
+    case 5u: return vec3(1.0) - value.rrr;
+    case 8u: return value.ggg;
+    case 9u: return vec3(1.0) - value.ggg;
+    case 12u: return value.bbb;
+    case 13u: return vec3(1.0) - value.bbb;
+    default: return vec3(0.0);
+    }
+}
+
+float AlphaModifier(uint modifier, vec4 value) {
+    switch (modifier) {
+    case 0u: return value.a;
+    case 1u: return 1.0 - value.a;
+    case 2u: return value.r;
+    case 3u: return 1.0 - value.r;
+    case 4u: return value.g;
+    case 5u: return 1.0 - value.g;
+    case 6u: return value.b;
+    case 7u: return 1.0 - value.b;
+    default: return 0.0;
+    }
+}
+
+vec3 ColorCombiner(uint op, vec3 v[3]) {
+    vec3 result;
+    switch (op) {
+    case 0u: result = v[0]; break;
+    case 1u: result = v[0] * v[1]; break;
+    case 2u: result = v[0] + v[1]; break;
+    case 3u: result = v[0] + v[1] - vec3(0.5); break;
+    case 4u: result = v[0] * v[2] + v[1] * (vec3(1.0) - v[2]); break;
+    case 5u: result = v[0] - v[1]; break;
+    case 6u:
+    case 7u: result = vec3(dot(v[0] - vec3(0.5), v[1] - vec3(0.5)) * 4.0); break;
+    case 8u: result = v[0] * v[1] + v[2]; break;
+    case 9u: result = min(v[0] + v[1], vec3(1.0)) * v[2]; break;
+    default: result = vec3(0.0); break;
+    }
+    return clamp(result, vec3(0.0), vec3(1.0));
+}
+
+float AlphaCombiner(uint op, float v[3]) {
+    float result;
+    switch (op) {
+    case 0u: result = v[0]; break;
+    case 1u: result = v[0] * v[1]; break;
+    case 2u: result = v[0] + v[1]; break;
+    case 3u: result = v[0] + v[1] - 0.5; break;
+    case 4u: result = v[0] * v[2] + v[1] * (1.0 - v[2]); break;
+    case 5u: result = v[0] - v[1]; break;
+    case 8u: result = v[0] * v[1] + v[2]; break;
+    case 9u: result = min(v[0] + v[1], 1.0) * v[2]; break;
+    default: result = 0.0; break;
+    }
+    return clamp(result, 0.0, 1.0);
+}
+
+uint TevMultiplier(uint scale) {
+    return scale < 3u ? (1u << scale) : 1u;
+}
+
+void WriteTevStage(int index) {
+    uvec4 stage = tev_stages[index];
+    uint color_op = bitfieldExtract(stage.z, 0, 4);
+    uint alpha_op = bitfieldExtract(stage.z, 16, 4);
+
+    vec3 color_results[3] = vec3[3](
+        ColorModifier(bitfieldExtract(stage.y, 0, 4), GetSource(bitfieldExtract(stage.x, 0, 4), index)),
+        ColorModifier(bitfieldExtract(stage.y, 4, 4), GetSource(bitfieldExtract(stage.x, 4, 4), index)),
+        ColorModifier(bitfieldExtract(stage.y, 8, 4), GetSource(bitfieldExtract(stage.x, 8, 4), index)));
+
+    // Round the output of each TEV stage to maintain the PICA's 8 bits of precision
+    vec3 color_output = byteround(ColorCombiner(color_op, color_results));
+
+    float alpha_output;
+    if (color_op == 7u) {
+        // result of Dot3_RGBA operation is also placed to the alpha component
+        alpha_output = color_output[0];
+    } else {
+        float alpha_results[3] = float[3](
+            AlphaModifier(bitfieldExtract(stage.y, 12, 3), GetSource(bitfieldExtract(stage.x, 16, 4), index)),
+            AlphaModifier(bitfieldExtract(stage.y, 16, 3), GetSource(bitfieldExtract(stage.x, 20, 4), index)),
+            AlphaModifier(bitfieldExtract(stage.y, 20, 3), GetSource(bitfieldExtract(stage.x, 24, 4), index)));
+        alpha_output = byteround(AlphaCombiner(alpha_op, alpha_results));
+    }
+
+    float color_multiplier = float(TevMultiplier(bitfieldExtract(stage.w, 0, 2)));
+    float alpha_multiplier = float(TevMultiplier(bitfieldExtract(stage.w, 16, 2)));
+    last_tex_env_out = vec4(clamp(color_output * color_multiplier, vec3(0.0), vec3(1.0)),
+                            clamp(alpha_output * alpha_multiplier, 0.0, 1.0));
+
+    combiner_buffer = next_combiner_buffer;
+    if (index < 4) {
+        if ((combiner_buffer_input & (1 << index)) != 0) {
+            next_combiner_buffer.rgb = last_tex_env_out.rgb;
+        }
+        if (((combiner_buffer_input >> 4) & (1 << index)) != 0) {
+            next_combiner_buffer.a = last_tex_env_out.a;
+        }
+    }
+}
+
+// Samples the specified lookup table for specular lighting
+float GetLutValue(int sampler_index, int lut, bool two_sided_diffuse) {
+    ivec4 config = lut_config[lut];
+    float index;
+    switch (config.z) {
+    case 0: // NH
+        index = dot(normal, normalize(half_vector));
+        break;
+    case 1: // VH
+        index = dot(normalize(view), normalize(half_vector));
+        break;
+    case 2: // NV
+        index = dot(normal, normalize(view));
+        break;
+    case 3: // LN
+        index = dot(light_vector, normal);
+        break;
+    case 4: // SP
+        index = dot(light_vector, spot_dir);
+        break;
+    case 5: // CP
+        index = dot(normalize(half_vector) - normal * dot(normal, normalize(half_vector)), tangent);
+        break;
+    default:
+        index = 0.0;
+        break;
+    }
+
+    float value;
+    if (config.y != 0) {
+        // LUT index is in the range of (0.0, 1.0)
+        index = two_sided_diffuse ? abs(index) : max(index, 0.0);
+        value = LookupLightingLUTUnsigned(sampler_index, index);
+    } else {
+        // LUT index is in the range of (-1.0, 1.0)
+        value = LookupLightingLUTSigned(sampler_index, index);
+    }
+
+    return lut_scale[lut >> 2][lut & 3] * value;
+}
+
+void WriteLighting() {
+    vec4 diffuse_sum = vec4(0.0, 0.0, 0.0, 1.0);
+    vec4 specular_sum = vec4(0.0, 0.0, 0.0, 1.0);
+    vec3 refl_value = vec3(0.0);
+    float dot_product = 0.0;
+    float clamp_highlights = 1.0;
+    float geo_factor = 1.0;
+
+    // Compute fragment normals and tangents
+    vec3 surface_normal = vec3(0.0, 0.0, 1.0);
+    vec3 surface_tangent = vec3(1.0, 0.0, 0.0);
+    if (bump_mode == 1) {
+        // Bump mapping is enabled using a normal map
+        surface_normal = 2.0 * tex_color[bump_selector].rgb - 1.0;
+        if (bump_renorm != 0) {
+            float val = (1.0 - (surface_normal.x*surface_normal.x + surface_normal.y*surface_normal.y));
+            surface_normal.z = sqrt(max(val, 0.0));
+        }
+    } else if (bump_mode == 2) {
+        // Bump mapping is enabled using a tangent map
+        surface_tangent = 2.0 * tex_color[bump_selector].rgb - 1.0;
+    }
+
+    // Rotate the surface-local normal by the interpolated normal quaternion to convert it to
+    // eyespace.
+    vec4 normalized_normquat = normalize(normquat);
+    normal = quaternion_rotate(normalized_normquat, surface_normal);
+    tangent = quaternion_rotate(normalized_normquat, surface_tangent);
+
+    vec4 shadow = vec4(1.0);
+    if (enable_shadow != 0) {
+        shadow = tex_color[shadow_selector];
+        if (shadow_invert != 0) {
+            shadow = vec4(1.0) - shadow;
+        }
+    }
+
+    // Emulate each enabled light
+    for (int light_index = 0; light_index < lighting_src_num; light_index++) {
+        int num = light_config[light_index].x;
+        int flags = light_config[light_index].y;
+        bool two_sided_diffuse = (flags & LIGHT_TWO_SIDED_DIFFUSE) != 0;
+
+        // Compute light vector (directional or positional)
+        if ((flags & LIGHT_DIRECTIONAL) != 0) {
+            light_vector = normalize(light_src[num].position);
+        } else {
+            light_vector = normalize(light_src[num].position + view);
+        }
+
+        spot_dir = light_src[num].spot_direction;
+        half_vector = normalize(view) + light_vector;
+
+        // Compute dot product of light_vector and normal, adjust if lighting is one-sided or
+        // two-sided
+        dot_product = two_sided_diffuse ? abs(dot(light_vector, normal))
+                                        : max(dot(light_vector, normal), 0.0);
+
+        // If enabled, clamp specular component if lighting result is zero
+        if (clamp_highlights_enable != 0) {
+            clamp_highlights = sign(dot_product);
+        }
+
+        // If enabled, compute spot light attenuation value
+        float spot_atten = 1.0;
+        if ((flags & LIGHT_SPOT_ATTEN) != 0) {
+            spot_atten = GetLutValue(8 + num, LUT_SP, two_sided_diffuse);
+        }
+
+        // If enabled, compute distance attenuation value
+        float dist_atten = 1.0;
+        if ((flags & LIGHT_DIST_ATTEN) != 0) {
+            float index = clamp(light_src[num].dist_atten_scale * length(-view - light_src[num].position) +
+                                light_src[num].dist_atten_bias, 0.0, 1.0);
+            dist_atten = LookupLightingLUTUnsigned(16 + num, index);
+        }
+
+        if ((flags & (LIGHT_GEOMETRIC_FACTOR_0 | LIGHT_GEOMETRIC_FACTOR_1)) != 0) {
+            geo_factor = dot(half_vector, half_vector);
+            geo_factor = geo_factor == 0.0 ? 0.0 : min(dot_product / geo_factor, 1.0);
+        }
+
+        // Specular 0 component
+        float d0_lut_value = lut_config[LUT_D0].x != 0 ? GetLutValue(0, LUT_D0, two_sided_diffuse) : 1.0;
+        vec3 specular_0 = d0_lut_value * light_src[num].specular_0;
+        if ((flags & LIGHT_GEOMETRIC_FACTOR_0) != 0) {
+            specular_0 *= geo_factor;
+        }
+
+        // If enabled, lookup the reflect values, green and blue fall back to the red one
+        refl_value.r = lut_config[LUT_RR].x != 0 ? GetLutValue(6, LUT_RR, two_sided_diffuse) : 1.0;
+        refl_value.g = lut_config[LUT_RG].x != 0 ? GetLutValue(5, LUT_RG, two_sided_diffuse) : refl_value.r;
+        refl_value.b = lut_config[LUT_RB].x != 0 ? GetLutValue(4, LUT_RB, two_sided_diffuse) : refl_value.r;
+
+        // Specular 1 component
+        float d1_lut_value = lut_config[LUT_D1].x != 0 ? GetLutValue(1, LUT_D1, two_sided_diffuse) : 1.0;
+        vec3 specular_1 = d1_lut_value * refl_value * light_src[num].specular_1;
+        if ((flags & LIGHT_GEOMETRIC_FACTOR_1) != 0) {
+            specular_1 *= geo_factor;
+        }
+
+        // Fresnel
+        // Note: only the last entry in the light slots applies the Fresnel factor
+        if (light_index == lighting_src_num - 1 && lut_config[LUT_FR].x != 0) {
+            float value = GetLutValue(3, LUT_FR, two_sided_diffuse);
+            if (enable_primary_alpha != 0) {
+                diffuse_sum.a = value;
+            }
+            if (enable_secondary_alpha != 0) {
+                specular_sum.a = value;
+            }
+        }
+
+        bool light_shadow = (flags & LIGHT_SHADOW) != 0;
+        vec3 shadow_primary_value = (shadow_primary != 0 && light_shadow) ? shadow.rgb : vec3(1.0);
+        vec3 shadow_secondary_value = (shadow_secondary != 0 && light_shadow) ? shadow.rgb : vec3(1.0);
+
+        // Compute primary fragment color (diffuse lighting) function
+        diffuse_sum.rgb += ((light_src[num].diffuse * dot_product) + light_src[num].ambient) *
+                           dist_atten * spot_atten * shadow_primary_value;
+
+        // Compute secondary fragment color (specular lighting) function
+        specular_sum.rgb += (specular_0 + specular_1) * clamp_highlights * dist_atten *
+                            spot_atten * shadow_secondary_value;
+    }
+
+    // Apply shadow attenuation to alpha components if enabled
+    if (shadow_alpha != 0) {
+        if (enable_primary_alpha != 0) {
+            diffuse_sum.a *= shadow.a;
+        }
+        if (enable_secondary_alpha != 0) {
+            specular_sum.a *= shadow.a;
+        }
+    }
+
+    // Sum final lighting result
+    diffuse_sum.rgb += lighting_global_ambient;
+    primary_fragment_color = clamp(diffuse_sum, vec4(0.0), vec4(1.0));
+    secondary_fragment_color = clamp(specular_sum, vec4(0.0), vec4(1.0));
+}
+
+bool AlphaTestFails() {
+    int alpha = int(last_tex_env_out.a * 255.0);
+    switch (alpha_test_func) {
+    case 0: return true;                    // Never
+    case 2: return alpha != alphatest_ref;  // Equal
+    case 3: return alpha == alphatest_ref;  // NotEqual
+    case 4: return alpha >= alphatest_ref;  // LessThan
+    case 5: return alpha > alphatest_ref;   // LessThanOrEqual
+    case 6: return alpha <= alphatest_ref;  // GreaterThan
+    case 7: return alpha < alphatest_ref;   // GreaterThanOrEqual
+    default: return false;                  // Always
+    }
+}
+
+void main() {
+    rounded_primary_color = byteround(primary_color);
+    primary_fragment_color = vec4(0.0);
+    secondary_fragment_color = vec4(0.0);
+
+    // Do not do any sort of processing if it's obvious we're not going to pass the alpha test
+    if (alpha_test_func == 0) {
+        discard;
+    }
+
+    // Scissor test, mode 1 excludes the pixels inside the box while mode 3 keeps only those
+    if (scissor_mode != 0) {
+        bool inside = gl_FragCoord.x >= float(scissor_x1) && gl_FragCoord.y >= float(scissor_y1) &&
+                      gl_FragCoord.x < float(scissor_x2) && gl_FragCoord.y < float(scissor_y2);
+        if (inside != (scissor_mode == 3)) {
+            discard;
+        }
+    }
+
+    float z_over_w = 2.0 * gl_FragCoord.z - 1.0;
+    float depth = z_over_w * depth_scale + depth_offset;
+    if (w_buffering != 0) {
+        depth /= gl_FragCoord.w;
+    }
+
+    tex_color[0] = SampleTexture(0);
+    tex_color[1] = SampleTexture(1);
+    tex_color[2] = SampleTexture(2);
+    tex_color[3] = vec4(0.0);
+
+    if (lighting_enable != 0) {
+        WriteLighting();
+    }
+
+    combiner_buffer = vec4(0.0);
+    next_combiner_buffer = tev_combiner_buffer_color;
+    last_tex_env_out = vec4(0.0);
+
+    for (int index = 0; index < NUM_TEV_STAGES; index++) {
+        WriteTevStage(index);
+    }
+
+    if (AlphaTestFails()) {
+        discard;
+    }
+
+    if (fog_mode == 5) {
+        // Get index into fog LUT
+        float fog_index = (fog_flip != 0 ? 1.0 - depth : depth) * 128.0;
+
+        // Generate clamped fog factor from LUT for given fog index
+        float fog_i = clamp(floor(fog_index), 0.0, 127.0);
+        float fog_f = fog_index - fog_i;
+        vec2 fog_lut_entry = texelFetch(texture_buffer_lut_lf, int(fog_i) + fog_lut_offset).rg;
+        float fog_factor = clamp(fog_lut_entry.r + fog_lut_entry.g * fog_f, 0.0, 1.0);
+
+        // Blend the fog
+        last_tex_env_out.rgb = mix(fog_color.rgb, last_tex_env_out.rgb, fog_factor);
+    } else if (fog_mode == 7) {
+        // Gas mode is not implemented
+        discard;
+    }
+
+    gl_FragDepth = depth;
+    // Round the final fragment color to maintain the PICA's 8 bits of precision
+    color = byteround(last_tex_env_out);
+}
+)";
+
+    return out;
+}
+
 std::string ShaderGenerator::GenerateTrivialVertexShader() {
     std::string out;
     out += "#version 450\n";
@@ -17,6 +17,7 @@ public:
     std::string GenerateVertexShader(const Pica::Shader::ShaderSetup& setup, const PicaVSConfig& config) override;
     std::string GenerateFixedGeometryShader(const PicaFixedGSConfig& config) override;
     std::string GenerateFragmentShader(const PicaFSConfig& config) override;
+    std::string GenerateFragmentUberShader() override;
 };
 
 } // namespace VideoCore
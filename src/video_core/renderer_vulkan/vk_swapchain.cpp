@@ -17,8 +17,17 @@ Swapchain::Swapchain(Instance& instance, CommandScheduler& scheduler, Renderpass
                      PoolManager& pool_manager, vk::SurfaceKHR surface) : instance(instance), scheduler(scheduler),
     renderpass_cache(renderpass_cache), pool_manager(pool_manager), surface(surface) {
 
-    // Set the surface format early for RenderpassCache to create the present renderpass
-    Configure(0, 0);
+    // Set the surface format early for RenderpassCache to create the present renderpass.
+    // Without a surface the swapchain is never created, but the renderpass is still needed
+    // for the present pipelines
+    if (surface) {
+        Configure(0, 0);
+    } else {
+        surface_format = vk::SurfaceFormatKHR{
+            .format = vk::Format::eB8G8R8A8Unorm,
+            .colorSpace = vk::ColorSpaceKHR::eSrgbNonlinear
+        };
+    }
 
     // Create the present renderpass
     renderpass_cache.CreatePresentRenderpass(surface_format.format);
@@ -29,7 +38,9 @@ Swapchain::~Swapchain() {
     vk::Device device = instance.GetDevice();
     device.destroySemaphore(render_finished);
     device.destroySemaphore(image_available);
-    device.destroySwapchainKHR(swapchain);
+    if (swapchain) {
+        device.destroySwapchainKHR(swapchain);
+    }
 }
 
 void Swapchain::Create(u32 width, u32 height, bool vsync_enabled) {
@@ -57,7 +68,8 @@ void Swapchain::Create(u32 width, u32 height, bool vsync_enabled) {
         .imageColorSpace = surface_format.colorSpace,
         .imageExtent = extent,
         .imageArrayLayers = 1,
-        .imageUsage = vk::ImageUsageFlagBits::eColorAttachment,
+        .imageUsage = vk::ImageUsageFlagBits::eColorAttachment |
+                      vk::ImageUsageFlagBits::eTransferDst,
         .imageSharingMode = sharing_mode,
         .queueFamilyIndexCount = queue_family_indices_count,
         .pQueueFamilyIndices   = queue_family_indices.data(),
@@ -111,14 +123,14 @@ void Swapchain::Create(u32 width, u32 height, bool vsync_enabled) {
 
         vk::RenderPass renderpass = renderpass_cache.GetPresentRenderpass();
         framebuffers[i] = pool_manager.Allocate<Framebuffer>(instance, scheduler, pool_manager, framebuffer_info,
-                                                             renderpass, renderpass);
+                                                             renderpass, renderpass, renderpass);
     }
 }
 
 // Wait for maximum of 1 second
 constexpr u64 ACQUIRE_TIMEOUT = 1000000000;
 
-void Swapchain::AcquireNextImage() {
+bool Swapchain::AcquireNextImage() {
     vk::Device device = instance.GetDevice();
     vk::Result result = device.acquireNextImageKHR(swapchain, ACQUIRE_TIMEOUT,
                                                    image_available, VK_NULL_HANDLE,
@@ -131,11 +143,13 @@ void Swapchain::AcquireNextImage() {
         break;
     case vk::Result::eErrorOutOfDateKHR:
         is_outdated = true;
-        break;
+        return false;
     default:
         LOG_ERROR(Render_Vulkan, "vkAcquireNextImageKHR returned unknown result");
-        break;
+        return false;
     }
+
+    return true;
 }
 
 void Swapchain::Present() {
@@ -147,8 +161,12 @@ void Swapchain::Present() {
         .pImageIndices = &current_image
     };
 
-    vk::Queue present_queue = instance.GetPresentQueue();
-    vk::Result result = present_queue.presentKHR(present_info);
+    vk::Result result;
+    {
+        std::scoped_lock lock{instance.GetQueueMutex()};
+        vk::Queue present_queue = instance.GetPresentQueue();
+        result = present_queue.presentKHR(present_info);
+    }
 
     switch (result) {
     case vk::Result::eSuccess:
@@ -30,8 +30,8 @@ public:
     // Creates (or recreates) the swapchain with a given size.
     void Create(u32 width, u32 height, bool vsync_enabled);
 
-    // Acquires the next image in the swapchain.
-    void AcquireNextImage();
+    // Acquires the next image in the swapchain. Returns false when no image could be acquired
+    bool AcquireNextImage();
 
     // Presents the current image and move to the next one
     void Present();
@@ -3,7 +3,10 @@
 // Refer to the license.txt file included.
 
 #define VULKAN_HPP_NO_CONSTRUCTORS
+#include <algorithm>
+#include "common/assert.h"
 #include "common/logging/log.h"
+#include "core/settings.h"
 #include "video_core/common/pool_manager.h"
 #include "video_core/renderer_vulkan/vk_task_scheduler.h"
 #include "video_core/renderer_vulkan/vk_instance.h"
@@ -20,6 +23,8 @@ constexpr BufferInfo STAGING_INFO = {
 CommandScheduler::CommandScheduler(Instance& instance, PoolManager& pool_manager) : instance(instance),
     pool_manager(pool_manager) {
 
+    slot_count = std::clamp<u32>(Settings::values.frames_in_flight, 2, MAX_SCHEDULER_COMMAND_COUNT);
+
     vk::Device device = instance.GetDevice();
     const vk::CommandPoolCreateInfo pool_info = {
         .flags = vk::CommandPoolCreateFlagBits::eResetCommandBuffer,
@@ -32,16 +37,32 @@ CommandScheduler::CommandScheduler(Instance& instance, PoolManager& pool_manager
     vk::CommandBufferAllocateInfo buffer_info = {
         .commandPool = command_pool,
         .level = vk::CommandBufferLevel::ePrimary,
-        .commandBufferCount = 2 * SCHEDULER_COMMAND_COUNT
+        .commandBufferCount = 2 * slot_count
     };
 
     // Allocate all command buffers
     const auto command_buffers = device.allocateCommandBuffers(buffer_info);
 
+    // Track completion with a single timeline semaphore when the device supports it
+    if (instance.IsTimelineSemaphoreSupported()) {
+        const vk::StructureChain semaphore_chain{
+            vk::SemaphoreCreateInfo{},
+            vk::SemaphoreTypeCreateInfo{
+                .semaphoreType = vk::SemaphoreType::eTimeline,
+                .initialValue = 0
+            }
+        };
+
+        timeline = device.createSemaphore(semaphore_chain.get());
+    }
+
+    LOG_INFO(Render_Vulkan, "Using {} command slots with {}", slot_count,
+             IsTimelineMode() ? "a timeline semaphore" : "fences");
+
     // Initialize command slots
-    for (std::size_t i = 0; i < commands.size(); i++) {
+    for (u32 i = 0; i < slot_count; i++) {
         commands[i] = CommandSlot{
-            .fence = device.createFence({}),
+            .fence = IsTimelineMode() ? vk::Fence{} : device.createFence({}),
             .render_command_buffer = command_buffers[2 * i],
             .upload_command_buffer = command_buffers[2 * i + 1],
         };
@@ -67,46 +88,70 @@ CommandScheduler::~CommandScheduler() {
     // Submit any remaining work
     Submit(true, false);
 
-    for (auto& command : commands) {
-        device.destroyFence(command.fence);
+    // Clean up any scheduled resources
+    for (auto& [fence_counter, func] : cleanups) {
+        func(device, allocator);
+    }
 
-        // Clean up any scheduled resources
-        for (auto& func : command.cleanups) {
-            func(device, allocator);
-        }
+    for (u32 i = 0; i < slot_count; i++) {
+        device.destroyFence(commands[i].fence);
     }
 
+    device.destroySemaphore(timeline);
     device.destroyCommandPool(command_pool);
 }
 
 void CommandScheduler::Synchronize() {
-    // Don't synchronize the same command twicec
-    CommandSlot& command = commands[current_command];
-    if (command.fence_counter <= completed_fence_counter) {
+    const CommandSlot& command = commands[current_command];
+    WaitFor(command.fence_counter);
+}
+
+void CommandScheduler::WaitFor(u64 fence_counter) {
+    // Don't synchronize the same command twice
+    if (fence_counter <= completed_fence_counter) {
         return;
     }
 
-    // Wait for this command buffer to be completed.
     vk::Device device = instance.GetDevice();
-    if (device.waitForFences(command.fence, true, UINT64_MAX) != vk::Result::eSuccess) {
-        LOG_ERROR(Render_Vulkan, "Waiting for fences failed!");
-    }
+    if (IsTimelineMode()) {
+        const vk::SemaphoreWaitInfo wait_info = {
+            .semaphoreCount = 1,
+            .pSemaphores = &timeline,
+            .pValues = &fence_counter
+        };
 
-    // Cleanup resources for command buffers that have completed along with the current one
-    const u64 now_fence_counter = command.fence_counter;
-    VmaAllocator allocator = instance.GetAllocator();
-    for (CommandSlot& command : commands) {
-        if (command.fence_counter < now_fence_counter &&
-            command.fence_counter > completed_fence_counter) {
-            for (auto& func: command.cleanups) {
-                func(device, allocator);
-            }
+        if (device.waitSemaphores(wait_info, UINT64_MAX) != vk::Result::eSuccess) {
+            LOG_ERROR(Render_Vulkan, "Waiting for timeline semaphore failed!");
+        }
 
-            command.cleanups.clear();
+        // The GPU might have progressed further than requested, resolve all of it at once
+        completed_fence_counter = std::max(fence_counter, device.getSemaphoreCounterValue(timeline));
+    } else {
+        const auto iter = std::find_if(commands.begin(), commands.begin() + slot_count,
+                                       [fence_counter](const CommandSlot& command) {
+                                           return command.fence_counter == fence_counter;
+                                       });
+
+        // Wait for this command buffer to be completed. Submissions to the same queue
+        // complete in order, so every older command has completed as well
+        ASSERT(iter != commands.begin() + slot_count);
+        if (device.waitForFences(iter->fence, true, UINT64_MAX) != vk::Result::eSuccess) {
+            LOG_ERROR(Render_Vulkan, "Waiting for fences failed!");
         }
+
+        completed_fence_counter = fence_counter;
     }
 
-    completed_fence_counter = now_fence_counter;
+    ReleaseResources();
+}
+
+void CommandScheduler::ReleaseResources() {
+    vk::Device device = instance.GetDevice();
+    VmaAllocator allocator = instance.GetAllocator();
+    while (!cleanups.empty() && cleanups.front().first <= completed_fence_counter) {
+        cleanups.front().second(device, allocator);
+        cleanups.pop_front();
+    }
 }
 
 void CommandScheduler::SetSwitchCallback(std::function<void(u32)> callback) {
@@ -117,6 +162,7 @@ void CommandScheduler::Submit(bool wait_completion, bool begin_next,
                               vk::Semaphore wait_semaphore, vk::Semaphore signal_semaphore) {
 
     // End command buffers
+    EndRenderpass();
     const CommandSlot& command = commands[current_command];
     command.render_command_buffer.end();
     if (command.use_upload_buffer) {
@@ -127,7 +173,6 @@ void CommandScheduler::Submit(bool wait_completion, bool begin_next,
         vk::PipelineStageFlagBits::eColorAttachmentOutput,
     };
 
-    const u32 signal_semaphore_count = signal_semaphore ? 1u : 0u;
     const u32 wait_semaphore_count = wait_semaphore ? 1u : 0u;
     u32 command_buffer_count = 0;
     std::array<vk::CommandBuffer, 2> command_buffers;
@@ -138,20 +183,47 @@ void CommandScheduler::Submit(bool wait_completion, bool begin_next,
 
     command_buffers[command_buffer_count++] = command.render_command_buffer;
 
+    // The timeline semaphore is signaled along with the binary one, which ignores its value
+    u32 signal_semaphore_count = 0;
+    std::array<vk::Semaphore, 2> signal_semaphores;
+    std::array<u64, 2> signal_values;
+
+    if (IsTimelineMode()) {
+        signal_semaphores[signal_semaphore_count] = timeline;
+        signal_values[signal_semaphore_count++] = command.fence_counter;
+    }
+
+    if (signal_semaphore) {
+        signal_semaphores[signal_semaphore_count] = signal_semaphore;
+        signal_values[signal_semaphore_count++] = 0;
+    }
+
+    const u64 wait_value = 0;
+    const vk::TimelineSemaphoreSubmitInfo timeline_info = {
+        .waitSemaphoreValueCount = wait_semaphore_count,
+        .pWaitSemaphoreValues = &wait_value,
+        .signalSemaphoreValueCount = signal_semaphore_count,
+        .pSignalSemaphoreValues = signal_values.data()
+    };
+
     // Prepeare submit info
     const vk::SubmitInfo submit_info = {
+        .pNext = IsTimelineMode() ? &timeline_info : nullptr,
         .waitSemaphoreCount = wait_semaphore_count,
         .pWaitSemaphores = &wait_semaphore,
         .pWaitDstStageMask = wait_stage_masks.data(),
         .commandBufferCount = command_buffer_count,
         .pCommandBuffers = command_buffers.data(),
         .signalSemaphoreCount = signal_semaphore_count,
-        .pSignalSemaphores = &signal_semaphore,
+        .pSignalSemaphores = signal_semaphores.data(),
     };
 
     // Submit the command buffer
-    vk::Queue queue = instance.GetGraphicsQueue();
-    queue.submit(submit_info, command.fence);
+    {
+        std::scoped_lock lock{instance.GetQueueMutex()};
+        vk::Queue queue = instance.GetGraphicsQueue();
+        queue.submit(submit_info, command.fence);
+    }
 
     // Block host until the GPU catches up
     if (wait_completion) {
@@ -165,8 +237,43 @@ void CommandScheduler::Submit(bool wait_completion, bool begin_next,
 }
 
 void CommandScheduler::Schedule(std::function<void(vk::Device, VmaAllocator)>&& func) {
-    CommandSlot& command = commands[current_command];
-    command.cleanups.push_back(func);
+    const CommandSlot& command = commands[current_command];
+    cleanups.emplace_back(command.fence_counter, std::move(func));
+}
+
+void CommandScheduler::BeginRenderpass(const vk::RenderPassBeginInfo& begin_info, bool mergeable) {
+    const vk::Rect2D& area = begin_info.renderArea;
+    const auto Contains = [&area](const vk::Rect2D& outer) {
+        return area.offset.x >= outer.offset.x && area.offset.y >= outer.offset.y &&
+               s64{area.offset.x} + area.extent.width <= s64{outer.offset.x} + outer.extent.width &&
+               s64{area.offset.y} + area.extent.height <= s64{outer.offset.y} + outer.extent.height;
+    };
+
+    // Keep recording in the active renderpass if nothing else happened in between
+    if (mergeable && renderpass_active && renderpass_framebuffer == begin_info.framebuffer &&
+        Contains(renderpass_area)) {
+        return;
+    }
+
+    EndRenderpass();
+
+    vk::CommandBuffer command_buffer = commands[current_command].render_command_buffer;
+    command_buffer.beginRenderPass(begin_info, vk::SubpassContents::eInline);
+
+    renderpass_active = true;
+    renderpass_framebuffer = begin_info.framebuffer;
+    renderpass_area = area;
+    renderpass_count++;
+}
+
+void CommandScheduler::EndRenderpass() {
+    if (!renderpass_active) {
+        return;
+    }
+
+    vk::CommandBuffer command_buffer = commands[current_command].render_command_buffer;
+    command_buffer.endRenderPass();
+    renderpass_active = false;
 }
 
 vk::CommandBuffer CommandScheduler::GetUploadCommandBuffer() {
@@ -184,7 +291,7 @@ vk::CommandBuffer CommandScheduler::GetUploadCommandBuffer() {
 }
 
 void CommandScheduler::SwitchSlot() {
-    current_command = (current_command + 1) % SCHEDULER_COMMAND_COUNT;
+    current_command = (current_command + 1) % slot_count;
     CommandSlot& command = commands[current_command];
 
     // Wait for the GPU to finish with all resources for this command.
@@ -198,8 +305,11 @@ void CommandScheduler::SwitchSlot() {
     };
 
     // Move to the next command buffer.
-    vk::Device device = instance.GetDevice();
-    device.resetFences(command.fence);
+    if (!IsTimelineMode()) {
+        vk::Device device = instance.GetDevice();
+        device.resetFences(command.fence);
+    }
+
     command.render_command_buffer.begin(begin_info);
     command.fence_counter = next_fence_counter++;
     command.use_upload_buffer = false;
@@ -6,7 +6,9 @@
 
 #include <memory>
 #include <array>
+#include <deque>
 #include <functional>
+#include <utility>
 #include "common/common_types.h"
 #include "video_core/renderer_vulkan/vk_buffer.h"
 #include "video_core/renderer_vulkan/vk_common.h"
@@ -17,7 +19,9 @@ class PoolManager;
 
 namespace VideoCore::Vulkan {
 
+// Default and maximum number of command slots that can be in flight at the same time
 constexpr u32 SCHEDULER_COMMAND_COUNT = 4;
+constexpr u32 MAX_SCHEDULER_COMMAND_COUNT = 8;
 
 class Buffer;
 class Instance;
@@ -44,10 +48,29 @@ public:
     // This is useful for vertex/uniform buffer uploads that happen once per frame
     vk::CommandBuffer GetUploadCommandBuffer();
 
-    // Returns the command buffer used for rendering
-    vk::CommandBuffer GetRenderCommandBuffer() const {
-        const CommandSlot& command = commands[current_command];
-        return command.render_command_buffer;
+    // Returns the command buffer used for rendering. Any active renderpass is ended
+    // since transfers and barriers can't be recorded inside one
+    vk::CommandBuffer GetRenderCommandBuffer() {
+        EndRenderpass();
+        return commands[current_command].render_command_buffer;
+    }
+
+    // Returns the command buffer used for rendering without ending the active renderpass.
+    // Only commands that are valid inside a renderpass should be recorded to it
+    vk::CommandBuffer GetRenderpassCommandBuffer() const {
+        return commands[current_command].render_command_buffer;
+    }
+
+    // Begins a new renderpass. When mergeable is true and the active renderpass targets the same
+    // framebuffer and covers the requested area, the active one is kept open instead
+    void BeginRenderpass(const vk::RenderPassBeginInfo& begin_info, bool mergeable);
+
+    // Ends the active renderpass, if any
+    void EndRenderpass();
+
+    // Returns the number of renderpasses begun since the last call and resets the counter
+    u32 ResetRenderpassCount() {
+        return std::exchange(renderpass_count, 0);
     }
 
     // Returns the upload buffer of the active command slot
@@ -61,10 +84,26 @@ public:
         return current_command;
     }
 
+    // Returns the number of command slots that can be in flight
+    inline u32 GetSlotCount() const {
+        return slot_count;
+    }
+
+    // Returns true when submissions are tracked with a timeline semaphore
+    inline bool IsTimelineMode() const {
+        return timeline != VK_NULL_HANDLE;
+    }
+
 private:
     // Activates the next command slot and optionally waits for its completion
     void SwitchSlot();
 
+    // Blocks the host until the submission with the provided counter value completes
+    void WaitFor(u64 fence_counter);
+
+    // Invokes every deferred operation whose submission has completed
+    void ReleaseResources();
+
 private:
     Instance& instance;
     PoolManager& pool_manager;
@@ -78,13 +117,27 @@ private:
         vk::CommandBuffer render_command_buffer;
         vk::CommandBuffer upload_command_buffer;
         BufferHandle upload_buffer;
-        std::vector<std::function<void(vk::Device, VmaAllocator)>> cleanups;
     };
 
+    // Deferred operations tagged with the counter value of the submission that uses them.
+    // Counter values only increase so the queue is always sorted
+    using Cleanup = std::function<void(vk::Device, VmaAllocator)>;
+    std::deque<std::pair<u64, Cleanup>> cleanups;
+
+    // Signaled with the counter value of each submission, replaces the slot fences when supported
+    vk::Semaphore timeline = VK_NULL_HANDLE;
+
     vk::CommandPool command_pool = VK_NULL_HANDLE;
-    std::array<CommandSlot, SCHEDULER_COMMAND_COUNT> commands;
+    std::array<CommandSlot, MAX_SCHEDULER_COMMAND_COUNT> commands;
     std::function<void(u32)> switch_callback;
+    u32 slot_count = SCHEDULER_COMMAND_COUNT;
     u32 current_command = 0;
+
+    // State of the renderpass recorded in the current command buffer
+    bool renderpass_active = false;
+    vk::Framebuffer renderpass_framebuffer = VK_NULL_HANDLE;
+    vk::Rect2D renderpass_area{};
+    u32 renderpass_count = 0;
 };
 
 }  // namespace Vulkan